@@ -11,13 +11,20 @@
 #define BIT7Z_HPP
 
 #include "bitarchiveeditor.hpp"
+#include "bitarchivemerger.hpp"
 #include "bitarchivereader.hpp"
+#include "bitarchiverepacker.hpp"
 #include "bitarchivewriter.hpp"
+#include "bitdeltacompressor.hpp"
+#include "bitdeltareader.hpp"
+#include "bitdigest.hpp"
 #include "bitexception.hpp"
 #include "bitfilecompressor.hpp"
 #include "bitfileextractor.hpp"
+#include "bithasher.hpp"
 #include "bitmemcompressor.hpp"
 #include "bitmemextractor.hpp"
+#include "bitresourcelimits.hpp"
 #include "bitstreamcompressor.hpp"
 #include "bitstreamextractor.hpp"
 
@@ -12,11 +12,13 @@
 
 #include <string>
 
+#include "bitdigest.hpp"
 #include "bitformat.hpp"
 #include "bittypes.hpp"
 #include "bitwindows.hpp"
 
 //! @cond IGNORE_BLOCK_IN_DOXYGEN
+struct IHashers;
 struct IInArchive;
 struct IOutArchive;
 
@@ -82,9 +84,23 @@ class Bit7zLibrary final {
          */
         void setLargePageMode();
 
+        /**
+         * @brief Checks whether the given type of digest can be computed using this library.
+         *
+         * The digests are computed using the hashers provided by the 7-Zip library, when available;
+         * otherwise, bit7z falls back to its own implementations of the CRC32, CRC64, SHA-1, and SHA-256 digests.
+         *
+         * @param type  the type of digest to be checked.
+         *
+         * @return true if the given type of digest is supported, false otherwise.
+         */
+        BIT7Z_NODISCARD auto isDigestSupported( DigestType type ) const -> bool;
+
     private:
         HMODULE mLibrary;
         FARPROC mCreateObjectFunc;
+        FARPROC mGetHashersFunc;
+        FARPROC mGetModulePropFunc;
 
         BIT7Z_NODISCARD
         auto initInArchive( const BitInFormat& format ) const -> CMyComPtr< IInArchive >;
@@ -92,8 +108,18 @@ class Bit7zLibrary final {
         BIT7Z_NODISCARD
         auto initOutArchive( const BitInOutFormat& format ) const -> CMyComPtr< IOutArchive >;
 
+        // Returns the hashers provided by the 7-Zip library (nullptr, if the library doesn't provide any).
+        BIT7Z_NODISCARD
+        auto initHashers() const -> CMyComPtr< IHashers >;
+
+        /* Returns the version of the library, encoded as (major << 16) | minor;
+         * 0 if the library doesn't report it (i.e., 7-Zip versions before 23.01, and p7zip). */
+        BIT7Z_NODISCARD
+        auto version() const -> uint32_t;
+
         friend class BitInputArchive;
         friend class BitOutputArchive;
+        friend class ItemHasherFactory;
 };
 
 }  // namespace bit7z
@@ -10,6 +10,7 @@
 #ifndef BITABSTRACTARCHIVECREATOR_HPP
 #define BITABSTRACTARCHIVECREATOR_HPP
 
+#include <chrono>
 #include <map>
 #include <memory>
 
@@ -18,6 +19,7 @@
 #include "bitcompressionmethod.hpp"
 #include "bitformat.hpp"
 #include "bitinputarchive.hpp"
+#include "bititemsvector.hpp"
 
 struct IOutStream;
 struct ISequentialOutStream;
@@ -28,16 +30,87 @@ using std::ostream;
 
 class ArchiveProperties;
 
+struct EncoderSettings;
+
 /**
  * @brief Enumeration representing how an archive creator should deal when the output archive already exists.
  */
 enum struct UpdateMode {
     None, ///< The creator will throw an exception (unless the OverwriteMode is not None).
-    Append, ///< The creator will append the new items to the existing archive.
+    Append, ///< The creator will append the new items to the existing archive (in place, for zip and tar archives).
     Update, ///< New items whose path already exists in the archive will overwrite the old ones, other will be appended.
+    Sync, ///< Like Update, but only the new items that differ from the old ones (e.g., in size or modification time)
+          ///< are compressed.
     BIT7Z_DEPRECATED_ENUMERATOR( Overwrite, Update, "Since v4.0; please use the UpdateMode::Update enumerator." ) ///< @deprecated since v4.0; please use the UpdateMode::Update enumerator.
 };
 
+/**
+ * @brief Enumeration representing how an archive creator should deal with items whose content is already compressed.
+ */
+enum struct CompressionPolicy : std::uint8_t {
+    CompressAll,        ///< All the items are compressed using the configured compression method (default).
+    StoreIncompressible ///< Items detected as already compressed (e.g., JPEGs, videos, archives) are stored
+                        ///< without compression, while the others are compressed using the configured method.
+};
+
+/**
+ * @brief Enumeration representing what an archive creator should do when the estimated memory usage
+ * of the encoder exceeds the memory budget.
+ */
+enum struct MemoryBudgetPolicy : std::uint8_t {
+    Fail,    ///< The compression fails (before starting) with a BitError::MemoryBudgetExceeded error.
+    AutoTune ///< The number of threads and, if needed, the dictionary size are scaled down to fit the budget;
+             ///< the compression fails only if the encoder cannot fit the budget even after the scaling.
+};
+
+/**
+ * @brief Struct containing the options controlling how items are grouped into solid blocks
+ * (see BitAbstractArchiveCreator::setSolidOptions).
+ */
+struct SolidOptions {
+    bool groupByExtension = false; ///< Whether to sort the items by extension and to start a new block for each one.
+    uint64_t maxBlockSize = 0;     ///< The maximum size (in bytes) of the data in each block (0 = 7-Zip's default).
+    uint64_t maxBlockFiles = 0;    ///< The maximum number of files in each block (0 = no limit).
+};
+
+/**
+ * @brief Struct containing the options controlling how UpdateMode::Sync compares the new items with the old ones
+ * (see BitAbstractArchiveCreator::setSyncOptions).
+ */
+struct SyncOptions {
+    bool compareContent = false; ///< Whether to compare the CRC of the items, rather than their modification time.
+    bool removeMissing = false;  ///< Whether to remove the old items that were not added again.
+};
+
+/**
+ * @brief Struct describing where an item would be placed in a solid archive, and how expensive it is to extract it
+ * (see BitAbstractArchiveCreator::planSolidBlocks).
+ */
+struct SolidItemPlan {
+    tstring path;        ///< The path of the item in the archive.
+    uint64_t size;       ///< The size (in bytes) of the item.
+    uint32_t block;      ///< The index of the solid block containing the item.
+    uint64_t decodeCost; ///< The amount of data (in bytes) to be decoded for extracting only this item.
+};
+
+/**
+ * @brief The default maximum amount of data (in bytes) compressed by BitAbstractArchiveCreator::estimate.
+ */
+constexpr uint64_t kDefaultEstimateSampleSize = 16 * 1024 * 1024; // 16 MiB
+
+/**
+ * @brief Struct containing the estimated outcome of a compression operation (see BitAbstractArchiveCreator::estimate).
+ */
+struct CompressionEstimate {
+    uint64_t inputSize = 0;     ///< The total size (in bytes) of the items to be compressed.
+    uint64_t sampledSize = 0;   ///< The amount of data (in bytes) actually compressed to compute the estimate.
+    uint64_t estimatedSize = 0; ///< The estimated size (in bytes) of the compressed data.
+    double ratio = 0.0;         ///< The estimated compression ratio (i.e., compressed size / input size).
+    double throughput = 0.0;    ///< The estimated compression throughput (in bytes per second).
+    std::chrono::milliseconds estimatedTime{ 0 }; ///< The estimated duration of the compression.
+    uint64_t peakMemory = 0;    ///< An approximation of the peak memory (in bytes) used by the encoder.
+};
+
 /**
  * @brief Abstract class representing a generic archive creator.
  */
@@ -93,11 +166,21 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD auto solidMode() const noexcept -> bool;
 
+        /**
+         * @return the options controlling how items are grouped into solid blocks.
+         */
+        BIT7Z_NODISCARD auto solidOptions() const noexcept -> const SolidOptions&;
+
         /**
          * @return the update mode used when updating existing archives.
          */
         BIT7Z_NODISCARD auto updateMode() const noexcept -> UpdateMode;
 
+        /**
+         * @return the options controlling how UpdateMode::Sync compares the new items with the old ones.
+         */
+        BIT7Z_NODISCARD auto syncOptions() const noexcept -> const SyncOptions&;
+
         /**
          * @return the volume size (in bytes) used when creating multi-volume archives
          *         (a 0 value means that all files are going in a single archive).
@@ -106,7 +189,8 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
 
         /**
          * @return the number of threads used when creating/updating an archive
-         *         (a 0 value means that it will use the 7-zip default value).
+         *         (a 0 value means that it will use the CPU limit given by default_resource_limits(), if any,
+         *         or the 7-zip default value).
          */
         BIT7Z_NODISCARD auto threadsCount() const noexcept -> uint32_t;
 
@@ -115,6 +199,58 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD auto storeSymbolicLinks() const noexcept -> bool;
 
+        /**
+         * @return the maximum amount of memory (in bytes) used for reading input files in advance
+         *         (a 0 value means that input files are read only when requested by the encoder).
+         */
+        BIT7Z_NODISCARD auto readAheadBudget() const noexcept -> uint64_t;
+
+        /**
+         * @return the number of background threads used for reading input files in advance
+         *         (a 0 value means that bit7z will choose it based on the available hardware threads).
+         */
+        BIT7Z_NODISCARD auto readAheadThreads() const noexcept -> uint32_t;
+
+        /**
+         * @return the order in which the new items are read and added to the output archive.
+         */
+        BIT7Z_NODISCARD auto itemsOrder() const noexcept -> ItemsOrder;
+
+        /**
+         * @return the policy used for dealing with items whose content is already compressed.
+         */
+        BIT7Z_NODISCARD auto compressionPolicy() const noexcept -> CompressionPolicy;
+
+        /**
+         * @return whether the files having identical content are deduplicated when compressing.
+         */
+        BIT7Z_NODISCARD auto deduplicateContent() const noexcept -> bool;
+
+        /**
+         * @return the maximum amount of memory (in bytes) the encoder is allowed to use
+         *         (a 0 value means that there is no limit).
+         */
+        BIT7Z_NODISCARD auto memoryBudget() const noexcept -> uint64_t;
+
+        /**
+         * @return what the creator does when the encoder's estimated memory usage exceeds the memory budget.
+         */
+        BIT7Z_NODISCARD auto memoryBudgetPolicy() const noexcept -> MemoryBudgetPolicy;
+
+        /**
+         * @brief Estimates the memory (in bytes) that the encoder will use with the current settings.
+         *
+         * The estimate is computed from the compression method, level, dictionary size, and number of threads
+         * (after the auto-tuning, if the MemoryBudgetPolicy::AutoTune policy is used); it is an approximation
+         * of the memory requirements reported by 7-Zip, and it can be queried before starting any compression.
+         * It also takes into account whether the format compresses multiple items in parallel (zip archives),
+         * and the maximum size of the solid blocks (if set); the word size is not considered.
+         * For the LZMA2 encoders of non-solid archives, the estimate is an upper bound (the items sizes are not known).
+         *
+         * @return the estimated memory usage of the encoder.
+         */
+        BIT7Z_NODISCARD auto estimatedMemoryUsage() const -> uint64_t;
+
         /**
          * @brief Sets up a password for the output archives.
          *
@@ -197,6 +333,20 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         void setSolidMode( bool solidMode ) noexcept;
 
+        /**
+         * @brief Sets how items are grouped into solid blocks when the solid compression is enabled.
+         *
+         * Grouping the items by extension usually improves the compression ratio, while limiting the size
+         * (or the number of files) of the blocks reduces the amount of data to be decoded for extracting
+         * a single item from the archive, at the cost of a lower ratio.
+         * Files bigger than the maximum block size end up in blocks of their own.
+         *
+         * @note The options have effect only when the solid mode is enabled and the format supports it (i.e., 7z).
+         *
+         * @param options the solid block options.
+         */
+        void setSolidOptions( const SolidOptions& options ) noexcept;
+
         /**
          * @brief Sets whether and how the creator can update existing archives or not.
          *
@@ -207,6 +357,16 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         virtual void setUpdateMode( UpdateMode mode );
 
+        /**
+         * @brief Sets the options controlling how UpdateMode::Sync compares the new items with the old ones.
+         *
+         * @note Modification times are compared with a two seconds tolerance for formats other than 7z,
+         *       since most of them store the times with a lower precision.
+         *
+         * @param options the sync options.
+         */
+        void setSyncOptions( const SyncOptions& options ) noexcept;
+
         /**
          * @brief Sets whether the creator can update existing archives or not.
          *
@@ -243,6 +403,176 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
          */
         void setStoreSymbolicLinks( bool storeSymlinks ) noexcept;
 
+        /**
+         * @brief Sets the maximum amount of memory to be used for reading input files in advance.
+         *
+         * When a non-zero budget is set, background threads open and read the upcoming input files
+         * (in the same order they are requested by the encoder) while the encoder is busy compressing,
+         * so that the encoder doesn't have to wait for the file opening and first-read latencies.
+         * This is especially useful when compressing many small files stored on high-latency storage.
+         *
+         * @note Only files not bigger than a quarter of the budget are read in advance;
+         *       bigger files, as well as buffer and stream items, are read as usual.
+         *
+         * @param budget the maximum amount of memory (in bytes) to be used for the read-ahead buffers
+         *               (a 0 value disables the reading of input files in advance).
+         */
+        void setReadAheadBudget( uint64_t budget ) noexcept;
+
+        /**
+         * @brief Sets the number of background threads to be used for reading input files in advance.
+         *
+         * @note This setting has effects only if a non-zero read-ahead budget was set.
+         *
+         * @param threadsCount the number of threads desired (a 0 value means that bit7z will choose it).
+         */
+        void setReadAheadThreads( uint32_t threadsCount ) noexcept;
+
+        /**
+         * @brief Sets the order in which the new items are read and added to the output archive.
+         *
+         * Sorting the input files by their physical location (ItemsOrder::FileIndex or ItemsOrder::PhysicalOffset)
+         * avoids random seeks when reading many files from spinning disks or network-attached storage.
+         * The paths of the items inside the output archive are not affected.
+         *
+         * @note Some formats (e.g., 7z) sort the items by themselves before compressing them; in this case,
+         *       setting a read-ahead budget allows reading the input files in the desired order anyway.
+         *
+         * @param order the desired order of the items.
+         */
+        void setItemsOrder( ItemsOrder order ) noexcept;
+
+        /**
+         * @brief Sets the policy to be used for dealing with items whose content is already compressed.
+         *
+         * With CompressionPolicy::StoreIncompressible, each new item is analyzed before the compression
+         * (using its extension and, for filesystem files, the signature and the entropy of a small prefix
+         * of its content): items detected as incompressible are stored using the Copy method,
+         * while all the other items are compressed using the configured compression method.
+         *
+         * @note This policy has effects only when creating new 7z or zip archives (not when updating existing ones)
+         *       to files or buffers, using a compression method different from Copy,
+         *       and without splitting the output into volumes.
+         *       Since 7-Zip doesn't allow choosing the compression method of each item, the incompressible items
+         *       are appended to the archive in a second update pass (which copies the already compressed data
+         *       of the first pass without recompressing it); hence, they will be the last items in the archive.
+         *       The second pass writes the whole archive again (i.e., the compressed items are written twice,
+         *       and a temporary copy of the archive is needed), except for zip archive files, to which
+         *       the stored items are appended in place (unless the output is mirrored or hashed while being written,
+         *       or the archive needs zip64 records).
+         *
+         * @param policy the desired compression policy.
+         */
+        void setCompressionPolicy( CompressionPolicy policy ) noexcept;
+
+        /**
+         * @brief Sets whether the new files having identical content must be deduplicated.
+         *
+         * Before compressing, the new filesystem files are grouped by size, and the candidates are compared
+         * by their CRC32 and finally byte by byte. Then:
+         *  - in tar archives, each duplicate is stored as a hard link to the first file having the same content,
+         *    provided that the 7-Zip library supports it (7-Zip 23.01 or later);
+         *  - in solid 7z archives, the items are sorted by type (as with SolidOptions::groupByExtension,
+         *    but without starting a new block for each extension): since 7-Zip sorts them by extension
+         *    and then by file name, the duplicates having the same file name are compressed next to each other,
+         *    so the repeated content costs almost nothing (the ones with different names gain nothing);
+         *  - in the other formats (e.g., zip, which compresses each item on its own), the duplicates are only
+         *    reported (wim archives already store each content once on their own).
+         *
+         * The sets of duplicate files found are reported by BitOutputArchive::duplicateSets().
+         *
+         * @note Finding the duplicates requires reading all the candidate files before compressing them.
+         *
+         * @note When extracting tar archives, bit7z creates the hard links from the files they refer to.
+         *
+         * @param deduplicate whether to deduplicate the content of the new files.
+         */
+        void setDeduplicateContent( bool deduplicate ) noexcept;
+
+        /**
+         * @brief Sets the maximum amount of memory the encoder is allowed to use when compressing.
+         *
+         * The check is performed before starting the compression, using the estimate given by estimatedMemoryUsage().
+         *
+         * @note When no budget is set, the encoder settings are auto-tuned, if possible, to fit the memory limit
+         *       of the process given by default_resource_limits() (if any).
+         *
+         * @param budget the memory budget in bytes (a 0 value means that there is no explicit limit).
+         * @param policy (optional) what to do when the encoder's estimated memory usage exceeds the budget.
+         */
+        void setMemoryBudget( uint64_t budget, MemoryBudgetPolicy policy = MemoryBudgetPolicy::Fail ) noexcept;
+
+        /**
+         * @brief Estimates the compression ratio, the throughput, and the memory usage that the current settings
+         * of this creator (format, method, level, dictionary size, threads, ...) would have on the given items.
+         *
+         * A sample of blocks (up to the given sample size), evenly spread over the content of the items,
+         * is compressed in memory using the real encoder, and the results are extrapolated to the whole input.
+         * Hence, the estimate is only as accurate as the sample is representative of the input:
+         * in particular, the benefits of large dictionaries and solid compression on redundant inputs
+         * may be underestimated.
+         *
+         * @note Only filesystem files and buffers are sampled; the other items are accounted in the input size,
+         *       assuming they have the same compression ratio as the sampled ones.
+         *       The peak memory is computed from the encoder settings, and it is not measured.
+         *
+         * @param items      the items whose compression must be estimated.
+         * @param sampleSize (optional) the maximum amount of data (in bytes) to be compressed for the estimate.
+         *
+         * @return the estimated outcome of the compression (the ratio is 0 if no data could be sampled).
+         */
+        BIT7Z_NODISCARD auto estimate( const BitItemsVector& items,
+                                       uint64_t sampleSize = kDefaultEstimateSampleSize ) const -> CompressionEstimate;
+
+        /**
+         * @brief Estimates the compression ratio, the throughput, and the memory usage that the current settings
+         * of this creator would have on the given filesystem paths (indexed as they would be when compressing them).
+         *
+         * @param inPaths    the paths of the files/directories whose compression must be estimated.
+         * @param sampleSize (optional) the maximum amount of data (in bytes) to be compressed for the estimate.
+         *
+         * @return the estimated outcome of the compression (the ratio is 0 if no data could be sampled).
+         */
+        BIT7Z_NODISCARD auto estimate( const std::vector< tstring >& inPaths,
+                                       uint64_t sampleSize = kDefaultEstimateSampleSize ) const -> CompressionEstimate;
+
+        /**
+         * @brief Plans how the given items would be grouped into solid blocks using the current settings
+         * of this creator, reporting for each item the amount of data to be decoded for extracting it alone
+         * (i.e., the size of the item plus the size of all the items preceding it in its solid block).
+         *
+         * @note The plan mirrors the rules used by 7-Zip for splitting the items into solid blocks;
+         *       when the solid compression is not used, each item is decoded on its own.
+         *       Directories and empty files are not reported, since they have no data to be decoded.
+         *
+         * @param items the items to be planned.
+         *
+         * @return the planned items, in the order they would be stored in the archive.
+         */
+        BIT7Z_NODISCARD auto planSolidBlocks( const BitItemsVector& items ) const -> std::vector< SolidItemPlan >;
+
+        /**
+         * @brief Plans how the given filesystem paths (indexed as they would be when compressing them)
+         * would be grouped into solid blocks using the current settings of this creator.
+         *
+         * @param inPaths the paths of the files/directories to be planned.
+         *
+         * @return the planned items, in the order they would be stored in the archive.
+         */
+        BIT7Z_NODISCARD auto planSolidBlocks( const std::vector< tstring >& inPaths ) const
+            -> std::vector< SolidItemPlan >;
+
+        /**
+         * @brief Finds the files having identical content among the given filesystem paths
+         * (indexed as they would be when compressing them), as done when deduplicating the content.
+         *
+         * @param inPaths the paths of the files/directories to be checked.
+         *
+         * @return the sets of files having identical content.
+         */
+        BIT7Z_NODISCARD auto findDuplicates( const std::vector< tstring >& inPaths ) const
+            -> std::vector< DuplicateSet >;
+
         /**
          * @brief Sets a property for the output archive format as described by the 7-zip documentation
          * (e.g., https://sevenzip.osdn.jp/chm/cmdline/switches/method.htm).
@@ -282,6 +612,14 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
 
         BIT7Z_NODISCARD auto archiveProperties() const -> ArchiveProperties;
 
+        BIT7Z_NODISCARD auto archiveProperties( BitCompressionMethod method ) const -> ArchiveProperties;
+
+        BIT7Z_NODISCARD auto indexPaths( const std::vector< tstring >& inPaths ) const -> BitItemsVector;
+
+        BIT7Z_NODISCARD auto configuredEncoderSettings( BitCompressionMethod method ) const -> EncoderSettings;
+
+        BIT7Z_NODISCARD auto encoderSettings( BitCompressionMethod method ) const -> EncoderSettings;
+
         friend class BitOutputArchive;
 
     private:
@@ -294,9 +632,18 @@ class BitAbstractArchiveCreator : public BitAbstractArchiveHandler {
         uint32_t mWordSize;
         bool mCryptHeaders;
         bool mSolidMode;
+        SolidOptions mSolidOptions;
         uint64_t mVolumeSize;
         uint32_t mThreadsCount;
         bool mStoreSymbolicLinks;
+        uint64_t mReadAheadBudget;
+        uint32_t mReadAheadThreads;
+        ItemsOrder mItemsOrder;
+        CompressionPolicy mCompressionPolicy;
+        bool mDeduplicateContent;
+        uint64_t mMemoryBudget;
+        MemoryBudgetPolicy mMemoryBudgetPolicy;
+        SyncOptions mSyncOptions;
         std::map< std::wstring, BitPropVariant > mExtraProperties;
 };
 
@@ -12,9 +12,11 @@
 
 #include <cstdint>
 #include <functional>
+#include <vector>
 
 #include "bit7zlibrary.hpp"
 #include "bitdefines.hpp"
+#include "bitdigest.hpp"
 
 namespace bit7z {
 
@@ -50,11 +52,18 @@ using PasswordCallback = std::function< tstring() >;
 
 /**
  * @brief Enumeration representing how a handler should deal when an output file already exists.
+ *
+ * @note The IfNewer, IfDifferent, and IfDifferentContent modes apply only when extracting to the filesystem,
+ *       where the up-to-date files are excluded from the extraction in advance (so the corresponding items are not
+ *       even decoded, whenever the archive format allows it); in any other case, they behave like Overwrite.
  */
 enum struct OverwriteMode {
     None = 0, ///< The handler will throw an exception if the output file or buffer already exists.
     Overwrite, ///< The handler will overwrite the old file or buffer with the new one.
     Skip, ///< The handler will skip writing to the output file or buffer.
+    IfNewer, ///< The handler will overwrite only the files older than the extracted items.
+    IfDifferent, ///< The handler will overwrite only the files having a different size or modified time.
+    IfDifferentContent, ///< Like IfDifferent, but the files differing only in the modified time are compared by CRC.
 //TODO:    RenameOutput,
 //TODO:    RenameExisting
 };
@@ -68,6 +77,26 @@ enum struct FilterPolicy {
     Exclude  ///< Do not extract/compress the items that match the pattern.
 };
 
+/**
+ * @brief Enumeration representing whether the items stored without compression (e.g., the files in a tar archive)
+ *        can be extracted by copying their data directly from the archive file to the output files.
+ */
+enum struct StoredCopyMode {
+    Disabled, ///< The items are always extracted through 7-Zip's decoders.
+    Verify, ///< The stored items are copied directly, and their CRC (if stored in the archive) is verified.
+    NoVerify ///< The stored items are copied directly, without verifying their CRC.
+};
+
+/**
+ * @brief Enumeration representing how the items having identical content (i.e., the files with the same size
+ *        and CRC32) should be written when extracting an archive to the filesystem.
+ */
+enum struct DuplicateItemsMode {
+    Extract, ///< Each item is extracted to its own file.
+    HardLink, ///< Only the first item of each set is extracted, and the others are created as hard links to it.
+    Reflink ///< Only the first item of each set is extracted, and the others are created as clones (reflinks) of it.
+};
+
 /**
  * @brief Abstract class representing a generic archive handler.
  */
@@ -134,11 +163,42 @@ class BitAbstractArchiveHandler {
          */
         BIT7Z_NODISCARD auto passwordCallback() const -> PasswordCallback;
 
+        /**
+         * @return the current digest callback.
+         */
+        BIT7Z_NODISCARD auto digestCallback() const -> DigestCallback;
+
+        /**
+         * @return the types of digests computed over the extracted items when a digest callback is set.
+         */
+        BIT7Z_NODISCARD auto digestTypes() const -> const std::vector< DigestType >&;
+
         /**
          * @return the current OverwriteMode.
          */
         BIT7Z_NODISCARD auto overwriteMode() const -> OverwriteMode;
 
+        /**
+         * @return the current StoredCopyMode.
+         */
+        BIT7Z_NODISCARD auto storedCopyMode() const -> StoredCopyMode;
+
+        /**
+         * @return the current DuplicateItemsMode.
+         */
+        BIT7Z_NODISCARD auto duplicateItemsMode() const -> DuplicateItemsMode;
+
+        /**
+         * @return a boolean value indicating whether the small extracted files are written asynchronously.
+         */
+        BIT7Z_NODISCARD auto asyncFileOutput() const noexcept -> bool;
+
+        /**
+         * @return the window (in bytes) used for coalescing the read-ahead hints given when extracting an archive file
+         *         (zero if the hints are disabled).
+         */
+        BIT7Z_NODISCARD auto readAheadWindow() const noexcept -> uint64_t;
+
         /**
          * @brief Sets up a password to be used by the archive handler.
          *
@@ -218,6 +278,26 @@ class BitAbstractArchiveHandler {
          */
         void setPasswordCallback( const PasswordCallback& callback );
 
+        /**
+         * @brief Sets the function to be called with the digests of each item successfully extracted or tested.
+         *
+         * The digests are computed over the items' content while it is written to the output (a file, a buffer,
+         * a stream, or a callback), so the extracted data doesn't need to be read again. When testing an archive,
+         * the content of the items is hashed without being written anywhere.
+         *
+         * @note Setting an empty callback disables the computation of the digests.
+         *
+         * @param callback  the digest callback to be used.
+         */
+        void setDigestCallback( const DigestCallback& callback );
+
+        /**
+         * @brief Sets the types of digests to be computed over the extracted items (by default, only the CRC32).
+         *
+         * @param types  the types of digests to be computed.
+         */
+        void setDigestTypes( const std::vector< DigestType >& types );
+
         /**
          * @brief Sets how the handler should behave when it tries to output to an existing file or buffer.
          *
@@ -225,6 +305,72 @@ class BitAbstractArchiveHandler {
          */
         void setOverwriteMode( OverwriteMode mode );
 
+        /**
+         * @brief Sets whether the stored (i.e., uncompressed) items of zip and tar archives are extracted to the
+         *        filesystem by copying their data directly from the archive file (by default, they are not).
+         *
+         * On Linux, the data is copied by the kernel (via copy_file_range), without passing through user space;
+         * on filesystems supporting it (e.g., Btrfs and XFS), the output files can even share the archive's extents.
+         *
+         * @note The direct copy is used only when extracting an archive file to a directory, and no digest callback
+         *       is set; the items not eligible for the direct copy are extracted as usual.
+         *
+         * @param mode  the StoredCopyMode to be used by the handler.
+         */
+        void setStoredCopyMode( StoredCopyMode mode );
+
+        /**
+         * @brief Sets how the items having identical content are written when extracting an archive to a directory
+         *        (by default, each item is extracted to its own file).
+         *
+         * The sets of identical items are planned in advance using the sizes and CRCs stored in the archive,
+         * so that only the first item of each set is decoded (whenever the archive format allows it),
+         * while the others are created on disk from the first one.
+         *
+         * @note The content of the items is not compared: items without a stored CRC (e.g., in tar archives)
+         *       are always extracted to their own files.
+         * @note Hard links share the attributes and the modified time of the files, so only the items having
+         *       the same metadata are linked. If the filesystem doesn't support hard links or reflinks,
+         *       the duplicates are copied from the first item of their set.
+         *
+         * @param mode  the DuplicateItemsMode to be used by the handler.
+         */
+        void setDuplicateItemsMode( DuplicateItemsMode mode );
+
+        /**
+         * @brief Sets whether the small files extracted to the filesystem are written asynchronously
+         *        (by default, they are not).
+         *
+         * On Linux, the content of the small items is kept in memory, and the files are created in batches through
+         * an io_uring instance (opening, writing, and closing each file with a single chain of linked requests),
+         * so that extracting many small files doesn't cost a sequence of system calls per file.
+         *
+         * @note If io_uring is not available (e.g., on other systems, on Linux versions older than 5.19, or when
+         *       io_uring is disabled), the files are written as usual.
+         * @note The write errors are reported when the queued files are flushed, at the end of the extraction.
+         *
+         * @param enabled  the setting for writing the small extracted files asynchronously.
+         */
+        void setAsyncFileOutput( bool enabled ) noexcept;
+
+        /**
+         * @brief Sets whether the handler gives the OS hints about the parts of the archive file that will be read
+         *        by an extraction (by default, it doesn't).
+         *
+         * Before extracting, the handler locates the data of the items to be extracted (using the entries of zip
+         * and tar archives, the blocks of 7z archives, or the offsets reported by the other formats);
+         * the data ranges separated by gaps smaller than the given window are coalesced.
+         * During the extraction, the OS is asked to read ahead the upcoming ranges (POSIX_FADV_WILLNEED),
+         * and to drop from its cache the ranges already read (POSIX_FADV_DONTNEED).
+         * This is mostly useful for extracting a few items from big archives stored on slow disks.
+         *
+         * @note The hints are supported only on POSIX systems providing posix_fadvise (e.g., Linux),
+         *       and only when extracting an archive file (i.e., not an in-memory buffer or a stream).
+         *
+         * @param window  the maximum gap (in bytes) between coalesced ranges; zero disables the hints.
+         */
+        void setReadAheadWindow( uint64_t window ) noexcept;
+
     protected:
         explicit BitAbstractArchiveHandler( const Bit7zLibrary& lib,
                                             tstring password = {},
@@ -235,6 +381,10 @@ class BitAbstractArchiveHandler {
         tstring mPassword;
         bool mRetainDirectories;
         OverwriteMode mOverwriteMode;
+        StoredCopyMode mStoredCopyMode;
+        DuplicateItemsMode mDuplicateItemsMode;
+        bool mAsyncFileOutput;
+        uint64_t mReadAheadWindow;
 
         //CALLBACKS
         TotalCallback mTotalCallback;
@@ -242,6 +392,8 @@ class BitAbstractArchiveHandler {
         RatioCallback mRatioCallback;
         FileCallback mFileCallback;
         PasswordCallback mPasswordCallback;
+        DigestCallback mDigestCallback;
+        std::vector< DigestType > mDigestTypes;
 };
 
 }  // namespace bit7z
@@ -10,7 +10,9 @@
 #ifndef BITARCHIVEEDITOR_HPP
 #define BITARCHIVEEDITOR_HPP
 
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "bitarchivewriter.hpp"
 
@@ -18,7 +20,10 @@ namespace bit7z {
 
 using std::vector;
 
-using EditedItems = std::unordered_map< uint32_t, BitItemsVector::value_type >;
+// The edited items of the input archive, indexed by their index in the input archive (nullptr if not edited).
+using EditedItems = std::vector< BitItemsVector::value_type >;
+
+class RenamedItem;
 
 enum struct DeletePolicy : std::uint8_t {
     ItemOnly,
@@ -82,6 +87,51 @@ class BIT7Z_MAYBE_UNUSED BitArchiveEditor final : public BitArchiveWriter {
          */
         void renameItem( const tstring& oldPath, const tstring& newPath );
 
+        /**
+         * @brief Requests to change the paths of the given items.
+         *
+         * @note All the paths are checked before renaming any item, so if an exception is thrown,
+         *       no item is renamed.
+         *
+         * @param renamedPaths the map from the old paths (in the archive) of the items to be renamed
+         *                     to their new paths.
+         *
+         * @throws BitException if some old path could not be found in the archive.
+         */
+        void renameItems( const std::map< tstring, tstring >& renamedPaths );
+
+        /**
+         * @brief Requests to change the attributes of the item at the specified index.
+         *
+         * @param index      the index of the item to be edited.
+         * @param attributes the new attributes of the item.
+         */
+        void setItemAttributes( uint32_t index, uint32_t attributes );
+
+        /**
+         * @brief Requests to change the attributes of the item at the specified path.
+         *
+         * @param itemPath   the path (in the archive) of the item to be edited.
+         * @param attributes the new attributes of the item.
+         */
+        void setItemAttributes( const tstring& itemPath, uint32_t attributes );
+
+        /**
+         * @brief Requests to change the last write time of the item at the specified index.
+         *
+         * @param index         the index of the item to be edited.
+         * @param lastWriteTime the new last write time of the item.
+         */
+        void setItemLastWriteTime( uint32_t index, const time_type& lastWriteTime );
+
+        /**
+         * @brief Requests to change the last write time of the item at the specified path.
+         *
+         * @param itemPath      the path (in the archive) of the item to be edited.
+         * @param lastWriteTime the new last write time of the item.
+         */
+        void setItemLastWriteTime( const tstring& itemPath, const time_type& lastWriteTime );
+
         /**
          * @brief Requests to update the content of the item at the specified index
          *        with the data from the given file.
@@ -136,6 +186,19 @@ class BIT7Z_MAYBE_UNUSED BitArchiveEditor final : public BitArchiveWriter {
          */
         void updateItem( const tstring& itemPath, istream& inStream );
 
+        /**
+         * @brief Requests to update the content of the given items with the data from the given files.
+         *
+         * @note All the paths are checked before updating any item, so if an exception is thrown,
+         *       no item is updated.
+         *
+         * @param updatedFiles the map from the paths (in the archive) of the items to be updated
+         *                     to the paths of the files containing their new data.
+         *
+         * @throws BitException if some item path could not be found in the archive.
+         */
+        void updateItems( const std::map< tstring, tstring >& updatedFiles );
+
         /**
          * @brief Marks as deleted the item at the given index.
          *
@@ -172,18 +235,85 @@ class BIT7Z_MAYBE_UNUSED BitArchiveEditor final : public BitArchiveWriter {
          */
         void deleteItem( const tstring& itemPath, DeletePolicy policy = DeletePolicy::ItemOnly );
 
+        /**
+         * @brief Marks as deleted the archive's item(s) with the specified paths.
+         *
+         * @note This is equivalent to calling deleteItem for each path, but all the items of the archive
+         *       are visited only once.
+         *
+         * @note All the paths are checked before marking any item as deleted, so if an exception is thrown,
+         *       no item is marked as deleted.
+         *
+         * @param itemPaths the paths (in the archive) of the items to be deleted.
+         * @param policy    the policy to be used when deleting items.
+         *
+         * @throws BitException if some path is empty or invalid, or if no matching item could be found for it.
+         */
+        void deleteItems( const std::vector< tstring >& itemPaths, DeletePolicy policy = DeletePolicy::ItemOnly );
+
+        /**
+         * @brief Creates a new archive containing only the specified items of the input archive,
+         *        reusing their compressed data (i.e., without extracting and recompressing them, when possible).
+         *
+         * @note Zip and tar items are copied as they are; for the other formats, the items are copied by 7-Zip's
+         *       update mechanism (e.g., the solid blocks of a 7z archive are recompressed only if some of their
+         *       items are not exported).
+         *
+         * @note The input archive is left untouched, and the pending changes are not applied to the exported items.
+         *
+         * @param indices the indices (in the input archive) of the items to be exported.
+         * @param outFile the path of the new archive (it must be different from the path of the input archive).
+         *
+         * @throws BitException if some index is invalid, or if the new archive could not be created.
+         */
+        void exportItems( const std::vector< uint32_t >& indices, const tstring& outFile );
+
         /**
          * @brief Applies the requested changes (i.e., rename/update/delete operations) to the input archive.
+         *
+         * @note If only metadata changes (i.e., renames, attributes, and last write times) are pending,
+         *       and the archive format supports it (currently, only zip archives not using zip64 records),
+         *       the changes are committed in place, rewriting only the archive's metadata
+         *       (and moving the data of the renamed items only if their new path doesn't fit in their local header).
+         *       Otherwise, the whole archive is rewritten.
          */
         void applyChanges();
 
     private:
+        // The path of an item of the input archive, and whether it is a folder.
+        struct ArchivedItemEntry {
+            native_string path;
+            bool isDir;
+        };
+
         EditedItems mEditedItems;
+        uint32_t mEditedItemsCount;
+
+        /* The items of the input archive, either lazily read from it, or derived from the changes applied
+         * to it (so that we don't need to reopen the archive just to know its new content). */
+        std::vector< ArchivedItemEntry > mArchivedItems;
+
+        // The index of the items of the input archive by path (lazily built by findItem).
+        std::unordered_map< tstring, uint32_t > mItemsIndex;
+
+        auto archivedItems() -> const std::vector< ArchivedItemEntry >&;
+
+        auto committedItems() -> std::vector< ArchivedItemEntry >;
+
+        auto exportRawItems( const std::vector< bool >& exportedItems, const fs::path& outPath ) -> bool;
 
         auto findItem( const tstring& itemPath ) -> uint32_t;
 
+        auto editedItem( uint32_t index ) const noexcept -> const GenericInputItem*;
+
+        void setEditedItem( uint32_t index, BitItemsVector::value_type item );
+
         void checkIndex( uint32_t index );
 
+        auto metadataItem( uint32_t index ) -> RenamedItem&;
+
+        auto applyMetadataChanges( const tstring& archivePath, bool& isOrderChanged ) -> bool;
+
         auto itemProperty( InputIndex index, BitProperty property ) const -> BitPropVariant override;
 
         auto itemStream( InputIndex index, ISequentialInStream** inStream ) const -> HRESULT override;
@@ -41,12 +41,14 @@ class BitArchiveItemInfo final : public BitArchiveItem {
     private:
         map< BitProperty, BitPropVariant > mItemProperties;
 
-        /* BitArchiveItem objects can be created and updated only by BitArchiveReader */
+        /* BitArchiveItem objects can be created and updated only by BitArchiveReader and BitDeltaReader */
         explicit BitArchiveItemInfo( uint32_t itemIndex );
 
         void setProperty( BitProperty property, const BitPropVariant& value );
 
         friend class BitArchiveReader;
+
+        friend class BitDeltaReader;
 };
 
 }  // namespace bit7z
@@ -0,0 +1,84 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITARCHIVEMERGER_HPP
+#define BITARCHIVEMERGER_HPP
+
+#include <vector>
+
+#include "bitabstractarchivecreator.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Enumeration representing how the merge of archives resolves the files having the same path
+ * in more than one archive.
+ *
+ * @note Folders with the same path are never considered conflicting: the merged archive contains only one of them.
+ */
+enum struct MergePolicy : std::uint8_t {
+    KeepLast,  ///< The file of the last archive containing the path is kept (default).
+    KeepFirst, ///< The file of the first archive containing the path is kept.
+    Fail       ///< The merge fails (before writing anything) with a std::errc::file_exists error.
+};
+
+/**
+ * @brief The BitArchiveMerger class allows merging several archives of the same format into a single archive.
+ *
+ * Zip and tar archives are merged by copying the entries of the input archives as they are, without extracting
+ * and recompressing them; only the archive structures (e.g., the central directory of zip archives) are rebuilt.
+ * The other formats (and the zip archives that would need zip64 records) are merged by copying as they are
+ * the items of the biggest input archive (e.g., the solid blocks of a 7z archive), and recompressing only the items
+ * of the other archives.
+ */
+class BitArchiveMerger final : public BitAbstractArchiveCreator {
+    public:
+        /**
+         * @brief Constructs a BitArchiveMerger object.
+         *
+         * @param lib    the 7z library used.
+         * @param format the format of the input and output archives (it must support multiple files).
+         */
+        BitArchiveMerger( const Bit7zLibrary& lib, const BitInOutFormat& format );
+
+        /**
+         * @brief Sets how the files having the same path in more than one input archive are handled.
+         *
+         * @param policy the merge policy to be used.
+         */
+        void setMergePolicy( MergePolicy policy ) noexcept;
+
+        /**
+         * @return the policy used for handling the files having the same path in more than one input archive.
+         */
+        BIT7Z_NODISCARD auto mergePolicy() const noexcept -> MergePolicy;
+
+        /**
+         * @brief Merges the given archives into a new archive.
+         *
+         * For zip and tar archives, the items of the output archive are in the order of the input archives;
+         * when merged without recompression, the output zip archive keeps the comment of the first input archive
+         * having one.
+         *
+         * @param inArchives the paths of the archives to be merged.
+         * @param outArchive the path of the resulting archive.
+         */
+        void merge( const std::vector< tstring >& inArchives, const tstring& outArchive ) const;
+
+    private:
+        MergePolicy mMergePolicy;
+
+        auto mergeRawArchives( const std::vector< tstring >& inArchives, const fs::path& outPath ) const -> bool;
+
+        void mergeArchives( const std::vector< tstring >& inArchives, const fs::path& outPath ) const;
+};
+
+}  // namespace bit7z
+
+#endif //BITARCHIVEMERGER_HPP
@@ -0,0 +1,93 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITARCHIVEREPACKER_HPP
+#define BITARCHIVEREPACKER_HPP
+
+#include "bitabstractarchivecreator.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitArchiveRepacker class allows recompressing the items of an archive into a new archive,
+ * using the format and the compression settings of the repacker (e.g., a higher compression level).
+ *
+ * The items are never extracted to the filesystem: they are decompressed by a background thread
+ * and streamed to the encoder through bounded in-memory pipes, so that the decompression and the compression
+ * of the items run concurrently. If the output format supports it, the compression itself is multithreaded
+ * (see BitAbstractArchiveCreator::setThreadsCount).
+ *
+ * @note The items are decompressed in the order of the input archive, while some formats (e.g., 7z) compress them
+ *       in their own order: the items decompressed in advance are buffered in memory up to the memory limit
+ *       (see setMemoryLimit), and then in a temporary file created next to the output archive.
+ */
+class BitArchiveRepacker final : public BitAbstractArchiveCreator {
+    public:
+        /**
+         * @brief Constructs a BitArchiveRepacker object.
+         *
+         * @param lib    the 7z library used.
+         * @param format the output archive format.
+         */
+        BitArchiveRepacker( const Bit7zLibrary& lib, const BitInOutFormat& format );
+
+        /**
+         * @brief Sets the capacity of the in-memory pipe used for streaming each item from the decoder
+         * to the encoder.
+         *
+         * @note If the encoder requests the items in an order different from the one of the input archive
+         *       (e.g., when sorting the items by name), the items decompressed in advance are buffered
+         *       regardless of this capacity, up to the memory limit (see setMemoryLimit).
+         *
+         * @param capacity the capacity (in bytes) of the pipe of each item.
+         */
+        void setPipeCapacity( uint64_t capacity ) noexcept;
+
+        /**
+         * @return the capacity (in bytes) of the in-memory pipe used for streaming each item.
+         */
+        BIT7Z_NODISCARD auto pipeCapacity() const noexcept -> uint64_t;
+
+        /**
+         * @brief Sets the maximum amount of memory used for buffering the content of all the items.
+         *
+         * When the encoder requests the items in an order different from the one of the input archive,
+         * the items decompressed in advance are buffered in memory up to this limit; beyond it, they are written
+         * to a temporary file next to the output archive, and read back when requested by the encoder.
+         *
+         * @param limit the maximum amount of memory (in bytes) used for buffering the items.
+         */
+        void setMemoryLimit( uint64_t limit ) noexcept;
+
+        /**
+         * @return the maximum amount of memory (in bytes) used for buffering the items.
+         */
+        BIT7Z_NODISCARD auto memoryLimit() const noexcept -> uint64_t;
+
+        /**
+         * @brief Recompresses the items of the given archive into a new archive.
+         *
+         * @param inArchive  the path of the archive to be repacked.
+         * @param outArchive the path of the resulting archive.
+         * @param inFormat   the format of the input archive.
+         * @param inPassword the password needed for extracting the input archive (if any).
+         */
+        void repack( const tstring& inArchive,
+                     const tstring& outArchive,
+                     const BitInFormat& inFormat BIT7Z_DEFAULT_FORMAT,
+                     const tstring& inPassword = {} ) const;
+
+    private:
+        uint64_t mPipeCapacity;
+        uint64_t mMemoryLimit;
+};
+
+}  // namespace bit7z
+
+#endif //BITARCHIVEREPACKER_HPP
@@ -0,0 +1,58 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITDELTACOMPRESSOR_HPP
+#define BITDELTACOMPRESSOR_HPP
+
+#include <vector>
+
+#include "bitabstractarchivecreator.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief The BitDeltaCompressor class allows creating delta archives, i.e., archives containing only the files
+ * that are new or changed with respect to a chain of existing archives (a base archive followed by its deltas).
+ *
+ * Besides the changed files, each delta archive contains a manifest listing the unchanged files,
+ * which are read from the previous archives of the chain; files not listed in the manifest and not contained
+ * in the delta archive are considered deleted. Chains of delta archives can be read using the BitDeltaReader class.
+ *
+ * @note Files are compared using their size and modification time or, optionally, their CRC32
+ * (see BitAbstractArchiveCreator::setSyncOptions).
+ */
+class BitDeltaCompressor final : public BitAbstractArchiveCreator {
+    public:
+        /**
+         * @brief Constructs a BitDeltaCompressor object.
+         *
+         * @param lib    the 7z library used.
+         * @param format the output archive format (it must support multiple files).
+         */
+        BitDeltaCompressor( const Bit7zLibrary& lib, const BitInOutFormat& format );
+
+        /**
+         * @brief Creates a delta archive containing the files and folders (among the given paths)
+         * that are new or changed with respect to the given chain of archives.
+         *
+         * @note The ".bit7z-delta" path is reserved to the manifest of the delta archive:
+         *       a BitException is thrown if a file to be compressed has this path.
+         *
+         * @param baseChain the paths of the base archive followed by its delta archives (in creation order).
+         * @param inPaths   the paths of the files and folders to be compared and compressed.
+         * @param outFile   the path of the resulting delta archive.
+         */
+        void compressDelta( const std::vector< tstring >& baseChain,
+                            const std::vector< tstring >& inPaths,
+                            const tstring& outFile ) const;
+};
+
+}  // namespace bit7z
+
+#endif //BITDELTACOMPRESSOR_HPP
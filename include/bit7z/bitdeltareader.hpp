@@ -0,0 +1,101 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITDELTAREADER_HPP
+#define BITDELTAREADER_HPP
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "bitabstractarchiveopener.hpp"
+#include "bitarchiveiteminfo.hpp"
+
+namespace bit7z {
+
+class ArchiveChain;
+
+/**
+ * @brief The BitDeltaReader class allows reading a chain of archives made of a base archive followed by
+ * its delta archives (see BitDeltaCompressor) as if it was a single archive.
+ *
+ * Each item is read from the most recent archive of the chain containing it.
+ */
+class BitDeltaReader final : public BitAbstractArchiveOpener {
+    public:
+        /**
+         * @brief Constructs a BitDeltaReader object, opening the given chain of archives.
+         *
+         * @param lib           the 7z library used.
+         * @param archiveChain  the paths of the base archive followed by its delta archives (in creation order).
+         * @param format        the format of the archives.
+         * @param password      (optional) the password needed for opening the archives.
+         */
+        BitDeltaReader( const Bit7zLibrary& lib,
+                        const std::vector< tstring >& archiveChain,
+                        const BitInFormat& format BIT7Z_DEFAULT_FORMAT,
+                        const tstring& password = {} );
+
+        BitDeltaReader( const BitDeltaReader& ) = delete;
+
+        BitDeltaReader( BitDeltaReader&& ) = delete;
+
+        auto operator=( const BitDeltaReader& ) -> BitDeltaReader& = delete;
+
+        auto operator=( BitDeltaReader&& ) -> BitDeltaReader& = delete;
+
+        ~BitDeltaReader() override;
+
+        /**
+         * @return a vector of all the items of the chain (sorted by path),
+         *         whose indices are the ones to be used with the extractTo methods.
+         */
+        BIT7Z_NODISCARD auto items() const -> std::vector< BitArchiveItemInfo >;
+
+        /**
+         * @return the number of items in the chain.
+         */
+        BIT7Z_NODISCARD auto itemsCount() const -> uint32_t;
+
+        /**
+         * @param path the path of the item to be searched.
+         *
+         * @return true if the chain contains an item with the given path, false otherwise.
+         */
+        BIT7Z_NODISCARD auto contains( const tstring& path ) const -> bool;
+
+        /**
+         * @brief Extracts all the items of the chain to the chosen directory.
+         *
+         * @param outDir the output directory where the extracted files will be put.
+         */
+        void extractTo( const tstring& outDir ) const;
+
+        /**
+         * @brief Extracts the specified item to the given buffer.
+         *
+         * @param outBuffer the output buffer where the content of the item will be put.
+         * @param index     the index of the item to be extracted.
+         */
+        void extractTo( std::vector< byte_t >& outBuffer, uint32_t index ) const;
+
+        /**
+         * @brief Extracts the content of all the (file) items of the chain to the given map.
+         *
+         * @param outMap the output map, having as keys the paths of the items.
+         */
+        void extractTo( std::map< tstring, std::vector< byte_t > >& outMap ) const;
+
+    private:
+        std::unique_ptr< ArchiveChain > mChain;
+};
+
+}  // namespace bit7z
+
+#endif //BITDELTAREADER_HPP
@@ -0,0 +1,53 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITDIGEST_HPP
+#define BITDIGEST_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Enumeration representing the digests (checksums and hashes) that can be computed over the items' content.
+ */
+enum struct DigestType : std::uint8_t {
+    Crc32,  ///< The CRC32 used by zip and 7z archives.
+    Crc64,  ///< The CRC64 used by xz archives (ECMA-182 polynomial).
+    Sha1,   ///< The SHA-1 hash.
+    Sha256, ///< The SHA-256 hash.
+    Xxh64,  ///< The XXH64 hash (available only with the hashers of recent versions of the 7-Zip library).
+    Blake2sp ///< The BLAKE2sp hash (available only with the hashers of recent versions of the 7-Zip library).
+};
+
+/**
+ * @brief The bytes of a digest; checksums (CRCs and XXH64) are stored in big-endian order
+ *        (e.g., the CRC32 0xCBF43926 is { 0xCB, 0xF4, 0x39, 0x26 }).
+ */
+using Digest = std::vector< byte_t >;
+
+/**
+ * @brief The digests computed over the content of an item.
+ */
+using ItemDigests = std::map< DigestType, Digest >;
+
+/**
+ * @brief A std::function whose arguments are the index of an item in the archive, and the digests computed
+ *        over its content.
+ */
+using DigestCallback = std::function< void( uint32_t, const ItemDigests& ) >;
+
+}  // namespace bit7z
+
+#endif //BITDIGEST_HPP
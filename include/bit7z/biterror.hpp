@@ -41,6 +41,8 @@ enum struct BitError {
     UnsupportedVariantType,
     WrongUpdateMode,
     InvalidZipPassword,
+    MemoryBudgetExceeded,
+    InvalidDeltaChain,
 };
 
 auto make_error_code( BitError error ) -> std::error_code;
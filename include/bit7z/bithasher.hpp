@@ -0,0 +1,139 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITHASHER_HPP
+#define BITHASHER_HPP
+
+#include <istream>
+#include <map>
+#include <vector>
+
+#include "bit7zlibrary.hpp"
+#include "bitdigest.hpp"
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+class BitItemsVector;
+
+/**
+ * @brief A map associating the path of each hashed file with its digests.
+ */
+using HashedFiles = std::map< tstring, ItemDigests >;
+
+/**
+ * @brief The BitHasher class allows computing the digests of files, buffers, and streams
+ * using the hashers provided by the 7-Zip library (see Bit7zLibrary::isDigestSupported).
+ *
+ * Files are read through the same input streams used for compressing them, and several files can be hashed
+ * in parallel (e.g., for verifying or deduplicating large sets of files).
+ */
+class BitHasher final {
+    public:
+        /**
+         * @brief Constructs a BitHasher object.
+         *
+         * @param lib    the 7z library used.
+         * @param types  the types of digests to be computed.
+         */
+        explicit BitHasher( const Bit7zLibrary& lib, std::vector< DigestType > types = { DigestType::Sha256 } );
+
+        /**
+         * @return the Bit7zLibrary object used by the hasher.
+         */
+        BIT7Z_NODISCARD auto library() const noexcept -> const Bit7zLibrary&;
+
+        /**
+         * @return the types of digests computed by the hasher.
+         */
+        BIT7Z_NODISCARD auto digestTypes() const -> const std::vector< DigestType >&;
+
+        /**
+         * @return the number of threads used for hashing multiple files (0 means that bit7z chooses it).
+         */
+        BIT7Z_NODISCARD auto threadsCount() const noexcept -> uint32_t;
+
+        /**
+         * @brief Sets the types of digests to be computed by the hasher.
+         *
+         * @param types  the types of digests to be computed.
+         */
+        void setDigestTypes( const std::vector< DigestType >& types );
+
+        /**
+         * @brief Sets the number of threads used for hashing multiple files.
+         *
+         * @param threadsCount  the number of threads desired (a 0 value means that bit7z will choose it).
+         */
+        void setThreadsCount( uint32_t threadsCount ) noexcept;
+
+        /**
+         * @brief Computes the digests of the given file.
+         *
+         * @param inFile  the path of the file to be hashed.
+         *
+         * @return the digests of the file.
+         */
+        BIT7Z_NODISCARD auto hashFile( const tstring& inFile ) const -> ItemDigests;
+
+        /**
+         * @brief Computes the digests of the given buffer.
+         *
+         * @param inBuffer  the buffer to be hashed.
+         *
+         * @return the digests of the buffer.
+         */
+        BIT7Z_NODISCARD auto hashBuffer( const std::vector< byte_t >& inBuffer ) const -> ItemDigests;
+
+        /**
+         * @brief Computes the digests of the content of the given stream, from its current position to its end.
+         *
+         * @param inStream  the stream to be hashed.
+         *
+         * @return the digests of the stream content.
+         */
+        BIT7Z_NODISCARD auto hashStream( std::istream& inStream ) const -> ItemDigests;
+
+        /**
+         * @brief Computes, in parallel, the digests of the files at the given paths (the content of the directories
+         * is hashed recursively).
+         *
+         * @note If some files cannot be read, a BitException is thrown after hashing all the other files,
+         *       reporting the failed ones.
+         *
+         * @param inPaths  the paths of the files and directories to be hashed.
+         *
+         * @return the digests of each file, indexed by the file path.
+         */
+        BIT7Z_NODISCARD auto hashFiles( const std::vector< tstring >& inPaths ) const -> HashedFiles;
+
+        /**
+         * @brief Computes, in parallel, the digests of the files in the given directory matching the filter.
+         *
+         * @param inDir      the directory containing the files to be hashed.
+         * @param filter     the wildcard filter the file names must match (by default, all the files are hashed).
+         * @param recursive  if true, the files in the subdirectories are hashed too.
+         *
+         * @return the digests of each file, indexed by the file path.
+         */
+        BIT7Z_NODISCARD auto hashDirectory( const tstring& inDir,
+                                            const tstring& filter = {},
+                                            bool recursive = true ) const -> HashedFiles;
+
+    private:
+        const Bit7zLibrary& mLibrary;
+        std::vector< DigestType > mDigestTypes;
+        uint32_t mThreadsCount;
+
+        auto hashItems( const BitItemsVector& items ) const -> HashedFiles;
+};
+
+}  // namespace bit7z
+
+#endif //BITHASHER_HPP
@@ -269,6 +269,10 @@ class BitInputArchive {
 
         friend class BitOutputArchive;
 
+        friend class BitArchiveEditor;
+
+        friend class BitArchiveRepacker;
+
     private:
         IInArchive* mInArchive;
         const BitInFormat* mDetectedFormat;
@@ -10,6 +10,7 @@
 #ifndef BITITEMSVECTOR_HPP
 #define BITITEMSVECTOR_HPP
 
+#include <functional>
 #include <map>
 #include <memory>
 
@@ -42,6 +43,26 @@ struct IndexingOptions {
 };
 /** @endcond **/
 
+/**
+ * @brief Enumeration representing the order in which the items of a BitItemsVector are fed to archive creators.
+ */
+enum struct ItemsOrder : std::uint8_t {
+    Indexing,      ///< The items are kept in the order they were indexed (i.e., directory-walk order).
+    FileIndex,     ///< Filesystem items are sorted by their file index (i.e., the inode number on Unix systems).
+    PhysicalOffset, ///< Filesystem items are sorted by the physical offset of their first extent on the storage
+                    ///< device (Linux only); items whose offset is unknown are sorted by their file index.
+    Extension       ///< Items are grouped by extension, and sorted by their path in the archive within each group
+                    ///< (improving the compression ratio of solid archives, as similar files end up close together).
+};
+
+/**
+ * @brief Struct describing a set of items having identical content (see BitItemsVector::deduplicate).
+ */
+struct DuplicateSet {
+    uint64_t size;                ///< The size (in bytes) of the content of each item.
+    std::vector< tstring > paths; ///< The paths of the items in the archive (the first item stores the content).
+};
+
 /**
  * @brief The BitItemsVector class represents a vector of generic input items, i.e., items that can come
  * from the filesystem, from memory buffers, or from standard streams.
@@ -124,6 +145,55 @@ class BitItemsVector final {
          */
         void indexStream( std::istream& inStream, const tstring& name );
 
+        /**
+         * @brief Sorts the items in the vector according to the given order.
+         *
+         * @note Only the order of the items changes: the paths the items will have inside archives are unchanged.
+         *       Non-filesystem items (i.e., buffers and streams) are placed after the filesystem ones,
+         *       keeping their relative order.
+         *
+         * @param order the order to be used for sorting the items.
+         */
+        void reorder( ItemsOrder order );
+
+        /**
+         * @brief Finds the filesystem files having identical content (comparing their sizes, their CRC32,
+         * and finally their bytes), optionally replacing the duplicates with hard links.
+         *
+         * @note The order of the items is unchanged.
+         *
+         * @param useHardLinks whether the duplicates must be stored as hard links to the first file of their set
+         *                     (e.g., in tar archives), rather than with their own copy of the content.
+         *
+         * @return the sets of files having identical content.
+         */
+        auto deduplicate( bool useHardLinks = false ) -> std::vector< DuplicateSet >;
+
+        /**
+         * @brief Moves the items satisfying the given predicate out of this vector.
+         *
+         * @note The relative order of the items is preserved, both in this vector and in the returned one.
+         *
+         * @param predicate the predicate to be satisfied by the items to be moved.
+         *
+         * @return a vector containing the items satisfying the predicate.
+         */
+        auto extract( const std::function< bool( const GenericInputItem& ) >& predicate ) -> BitItemsVector;
+
+        /**
+         * @brief Moves all the items of the given vector at the end of this vector.
+         *
+         * @param other the vector whose items must be moved.
+         */
+        void append( BitItemsVector&& other );
+
+        /**
+         * @brief Moves the given item at the end of this vector.
+         *
+         * @param item the item to be moved.
+         */
+        void append( GenericInputItemPtr&& item );
+
         /**
          * @return the size of the items vector.
          */
@@ -165,6 +235,8 @@ class BitItemsVector final {
         GenericInputItemVector mItems;
 
         void indexItem( const FilesystemItem& item, IndexingOptions options );
+
+        void reorderByExtension();
 };
 
 }  // namespace bit7z
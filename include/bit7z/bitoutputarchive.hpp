@@ -11,9 +11,10 @@
 #define BITOUTPUTARCHIVE_HPP
 
 #include <istream>
-#include <set>
+#include <vector>
 
 #include "bitabstractarchivecreator.hpp"
+#include "bitdigest.hpp"
 #include "bititemsvector.hpp"
 #include "bitexception.hpp" //for FailedFiles
 #include "bitpropvariant.hpp"
@@ -29,7 +30,8 @@ namespace bit7z {
 
 using std::istream;
 
-using DeletedItems = std::set< uint32_t >;
+// Bitmap of the deleted items of the input archive, indexed by their index in the input archive.
+using DeletedItems = std::vector< bool >;
 
 /* General note: I tried my best to explain how indices work here, but it is a bit complex. */
 
@@ -54,6 +56,8 @@ enum class InputIndex : std::uint32_t {};
 
 class UpdateCallback;
 
+class ItemPrefetcher;
+
 /**
  * @brief The BitOutputArchive class, given a creator object, allows creating new archives.
  */
@@ -216,6 +220,48 @@ class BitOutputArchive {
          */
         void compressTo( std::ostream& outStream );
 
+        /**
+         * @brief Adds a buffer that will receive a copy of the archives produced by the next compressTo calls.
+         *
+         * The archive is written to the output and to all the mirrors at the same time,
+         * so it doesn't need to be read again for copying it somewhere else.
+         *
+         * @note The buffer must outlive the compression operations, and its previous content is discarded.
+         *
+         * @param outBuffer the mirror buffer.
+         */
+        void addOutputMirror( std::vector< byte_t >& outBuffer );
+
+        /**
+         * @brief Adds a file that will receive a copy of the archives produced by the next compressTo calls.
+         *
+         * @note The file is overwritten if it already exists.
+         *
+         * @param outFile the path of the mirror file.
+         */
+        void addOutputMirror( const tstring& outFile );
+
+        /**
+         * @brief Removes all the output mirrors added to this object.
+         */
+        void clearOutputMirrors() noexcept;
+
+        /**
+         * @brief Sets the types of digests to be computed over the archives produced by the next compressTo calls.
+         *
+         * The digests are computed while the archive is being written. However, some formats (e.g., 7z and zip)
+         * patch the headers already written at the end of the compression: in this case, the digests are computed
+         * from the final archive, reading it from an in-memory buffer (the output buffer or a mirror one) if any.
+         *
+         * @param types the types of digests to be computed (no digest is computed if empty).
+         */
+        void setArchiveDigestTypes( const std::vector< DigestType >& types );
+
+        /**
+         * @return the digests of the archive produced by the last compressTo call.
+         */
+        auto archiveDigests() const noexcept -> const ItemDigests&;
+
         /**
          * @return the total number of items added to the output archive object.
          */
@@ -233,10 +279,16 @@ class BitOutputArchive {
          */
         auto creator() const noexcept -> const BitAbstractArchiveCreator&;
 
+        /**
+         * @return the sets of new files having identical content found by the last compression operation
+         *         (see BitAbstractArchiveCreator::setDeduplicateContent).
+         */
+        auto duplicateSets() const noexcept -> const std::vector< DuplicateSet >&;
+
         /**
          * @brief Default destructor.
          */
-        virtual ~BitOutputArchive() = default;
+        virtual ~BitOutputArchive();
 
     protected:
         virtual auto itemProperty( InputIndex index, BitProperty property ) const -> BitPropVariant;
@@ -247,6 +299,9 @@ class BitOutputArchive {
 
         virtual auto hasNewProperties( uint32_t index ) const noexcept -> bool;
 
+        // The update mode used when the output archive has an input archive (by default, the one of the creator).
+        virtual auto effectiveUpdateMode() const noexcept -> UpdateMode;
+
         auto itemInputIndex( uint32_t newIndex ) const noexcept -> InputIndex;
 
         auto outputItemProperty( uint32_t index, BitProperty property ) const -> BitPropVariant;
@@ -255,47 +310,83 @@ class BitOutputArchive {
 
         auto indexInArchive( uint32_t index ) const noexcept -> uint32_t;
 
-        inline auto inputArchive() const -> BitInputArchive* {
-            return mInputArchive.get();
-        }
+        auto inputArchive() const -> BitInputArchive*;
 
-        inline void setInputArchive( std::unique_ptr< BitInputArchive >&& inputArchive ) {
-            mInputArchive = std::move( inputArchive );
+        inline auto hasInputArchive() const -> bool {
+            return mInputArchive != nullptr || !mDeferredArchivePath.empty();
         }
 
+        void setInputArchive( std::unique_ptr< BitInputArchive >&& inputArchive );
+
+        /* Sets the archive at the given path as the input archive, without opening it
+         * (it will be opened by inputArchive() the first time it is needed). */
+        void setInputArchive( const tstring& archivePath, uint32_t itemsCount );
+
         inline auto inputArchiveItemsCount() const -> uint32_t {
             return mInputArchiveItemsCount;
         }
 
-        inline void setDeletedIndex( uint32_t index ) {
-            mDeletedItems.insert( index );
-        }
+        void setDeletedIndex( uint32_t index );
 
         inline auto isDeletedIndex( uint32_t index ) const -> bool {
-            return mDeletedItems.find( index ) != mDeletedItems.cend();
+            return index < mDeletedItems.size() && mDeletedItems[ index ];
         }
 
         inline auto hasDeletedIndexes() const -> bool {
-            return !mDeletedItems.empty();
+            return mDeletedItemsCount > 0;
         }
 
         inline auto hasNewItems() const -> bool {
             return mNewItemsVector.size() > 0;
         }
 
+        inline auto newItems() -> BitItemsVector& {
+            return mNewItemsVector;
+        }
+
         friend class UpdateCallback;
 
     private:
         const BitAbstractArchiveCreator& mArchiveCreator;
 
-        unique_ptr< BitInputArchive > mInputArchive;
-        uint32_t mInputArchiveItemsCount;
+        // Note: the input archive is lazily opened by inputArchive(), hence these members are mutable.
+        mutable unique_ptr< BitInputArchive > mInputArchive;
+        mutable tstring mDeferredArchivePath;
+        mutable uint32_t mInputArchiveItemsCount;
 
         BitItemsVector mNewItemsVector;
         DeletedItems mDeletedItems;
+        uint32_t mDeletedItemsCount;
 
         mutable FailedFiles mFailedFiles;
 
+        // Reads the new items in advance during a compression operation (only if a read-ahead budget was set).
+        unique_ptr< ItemPrefetcher > mPrefetcher;
+
+        // The sets of new items having identical content (see BitAbstractArchiveCreator::setDeduplicateContent).
+        std::vector< DuplicateSet > mDuplicateSets;
+
+        // Whether the new items are being stored without compression (see CompressionPolicy::StoreIncompressible).
+        bool mStoringItems;
+
+        // Whether the new items have already been compared with the old ones (see UpdateMode::Sync).
+        bool mItemsSynced;
+
+        // The buffers (or, if buffer is null, the files) receiving a copy of the produced archives.
+        struct OutputMirror {
+            std::vector< byte_t >* buffer;
+            tstring path;
+        };
+
+        std::vector< OutputMirror > mOutputMirrors;
+
+        std::vector< DigestType > mArchiveDigestTypes;
+
+        ItemDigests mArchiveDigests;
+
+        // Whether the archive digests must be computed from the final output (see setArchiveDigestTypes).
+        bool mArchiveDigestsPending;
+
         /* mInputIndices:
          *  - Position i = index in range [0, itemsCount() - 1] used by UpdateCallback.
          *  - Value at position i = corresponding index in the input archive (type InputIndex).
@@ -315,12 +406,41 @@ class BitOutputArchive {
 
         BitOutputArchive( const BitAbstractArchiveCreator& creator, const fs::path& inArc );
 
-        void compressToFile( const fs::path& outFile, UpdateCallback* updateCallback );
+        void compressToFile( const fs::path& outFile, UpdateCallback* updateCallback, bool finalOutput = true );
 
-        void compressOut( IOutArchive* outArc, IOutStream* outStream, UpdateCallback* updateCallback );
+        auto canAppendInPlace( const fs::path& outFile ) const -> bool;
+
+        auto appendInPlace( const fs::path& outFile, UpdateCallback* updateCallback ) -> bool;
+
+        void compressOut( IOutArchive* outArc,
+                          IOutStream* outStream,
+                          UpdateCallback* updateCallback,
+                          bool finalOutput = true );
+
+        auto teesOutput() const noexcept -> bool;
+
+        auto openOutputMirrors() const -> std::vector< CMyComPtr< IOutStream > >;
+
+        auto hashMirroredArchive() -> bool;
+
+        void finishArchiveDigests( const fs::path& outFile );
+
+        void finishArchiveDigests( const std::vector< byte_t >& outBuffer );
+
+        void finishArchiveDigests( std::ostream& outStream, std::streampos startPosition );
 
         void setArchiveProperties( IOutArchive* outArchive ) const;
 
+        auto detachIncompressibleItems() -> BitItemsVector;
+
+        void beginStoringItems( BitItemsVector& storedItems, unique_ptr< BitInputArchive >&& firstPassArchive );
+
+        void endStoringItems( BitItemsVector& storedItems ) noexcept;
+
+        void deleteUpdatedItems();
+
+        void syncNewItems();
+
         void updateInputIndices();
 };
 
@@ -0,0 +1,68 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef BITRESOURCELIMITS_HPP
+#define BITRESOURCELIMITS_HPP
+
+#include <cstdint>
+
+#include "bitdefines.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Struct containing the limits on the system resources available to the process.
+ */
+struct ResourceLimits {
+    uint32_t cpuCount = 0;    ///< The number of CPUs the process can use (0 = unknown, i.e., no limit).
+    uint64_t memoryLimit = 0; ///< The amount of memory (in bytes) the process can use (0 = unknown, i.e., no limit).
+};
+
+/**
+ * @brief Detects the limits on the resources available to the process.
+ *
+ * On Linux, the CPU limit is the minimum among the CPU quota of the process' cgroup (v1 or v2, including
+ * the ones of its ancestors) and the number of CPUs in its affinity mask (i.e., its cpuset), and it is reported
+ * only if it is below the number of CPUs of the system; the memory limit is the memory limit of the cgroup.
+ * On other systems, no limit is detected.
+ *
+ * @note The detection is performed only once, and the result is cached.
+ *
+ * @return the detected resource limits.
+ */
+BIT7Z_NODISCARD auto detected_resource_limits() -> ResourceLimits;
+
+/**
+ * @return the resource limits used by archive creators and openers for their default settings, i.e.,
+ *         the ones set with set_default_resource_limits or, if none were set, the detected ones.
+ *
+ * When the number of threads of a creator is not set, it defaults to the CPU limit (if any), rather than to the
+ * number of CPUs of the system; similarly, archive openers use it as the number of decoding threads.
+ * When the memory budget of a creator is not set, it defaults to the memory limit (if any),
+ * using the MemoryBudgetPolicy::AutoTune policy.
+ */
+BIT7Z_NODISCARD auto default_resource_limits() -> ResourceLimits;
+
+/**
+ * @brief Overrides the resource limits used by archive creators and openers for their default settings.
+ *
+ * @note Passing a default constructed ResourceLimits object disables any limit.
+ *
+ * @param limits the resource limits to be used.
+ */
+void set_default_resource_limits( const ResourceLimits& limits );
+
+/**
+ * @brief Restores the use of the detected resource limits for the default settings of archive creators and openers.
+ */
+void reset_default_resource_limits();
+
+}  // namespace bit7z
+
+#endif //BITRESOURCELIMITS_HPP
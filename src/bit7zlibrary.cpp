@@ -13,11 +13,14 @@
 #include "bit7zlibrary.hpp"
 #include "bitexception.hpp"
 #include "bitformat.hpp"
+#include "bitpropvariant.hpp"
 #include "internal/com.hpp"
 #include "internal/guids.hpp"
+#include "internal/hasher.hpp"
 #include "internal/stringutil.hpp"
 
 #include <7zip/Archive/IArchive.h>
+#include <7zip/ICoder.h>
 
 #ifdef _WIN32
 #   define Bit7zLoadLibrary( lib_name ) LoadLibraryW( WIDEN( (lib_name) ).c_str() )
@@ -44,6 +47,12 @@ Bit7zLibrary::Bit7zLibrary( const tstring& libraryPath ) : mLibrary( Bit7zLoadLi
         FreeLibrary( mLibrary );
         throw BitException( "Failed to get CreateObject function", ERROR_CODE( std::errc::invalid_seek ) );
     }
+
+    // Note: old versions of the 7-Zip library don't provide any hasher, so this function might be missing.
+    mGetHashersFunc = GetProcAddress( mLibrary, "GetHashers" );
+
+    // Note: this function was introduced in 7-Zip 23.01, so it is missing in older versions of 7-Zip (and in p7zip).
+    mGetModulePropFunc = GetProcAddress( mLibrary, "GetModuleProp" );
 }
 
 Bit7zLibrary::~Bit7zLibrary() {
@@ -64,6 +73,25 @@ void Bit7zLibrary::setLargePageMode() {
     }
 }
 
+// The identifier of the version property reported by the GetModuleProp function (NModulePropID::kVersion in 7-Zip).
+constexpr PROPID kModuleVersionProperty = 1;
+
+using GetModulePropFunc = HRESULT ( WINAPI* )( PROPID propID, PROPVARIANT* value );
+
+auto Bit7zLibrary::version() const -> uint32_t {
+    if ( mGetModulePropFunc == nullptr ) {
+        return 0;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto getModuleProp = reinterpret_cast< GetModulePropFunc >( mGetModulePropFunc );
+    BitPropVariant value;
+    if ( getModuleProp( kModuleVersionProperty, &value ) != S_OK || !value.isUInt32() ) {
+        return 0;
+    }
+    return value.getUInt32();
+}
+
 using CreateObjectFunc = HRESULT ( WINAPI* )( const GUID* clsID, const GUID* interfaceID, void** out );
 
 // Making the code not build when choosing a wrong interface type (only IInArchive and IOutArchive are supported!).
@@ -110,3 +138,27 @@ auto Bit7zLibrary::initOutArchive( const BitInOutFormat& format ) const -> CMyCo
     }
     return outArchive;
 }
+
+auto Bit7zLibrary::isDigestSupported( DigestType type ) const -> bool {
+    const auto hashers = initHashers();
+    if ( hashers != nullptr && find_hasher( hashers, type ) < hashers->GetNumHashers() ) {
+        return true;
+    }
+    return make_hasher( type ) != nullptr;
+}
+
+using GetHashersFunc = HRESULT ( WINAPI* )( IHashers** hashers );
+
+auto Bit7zLibrary::initHashers() const -> CMyComPtr< IHashers > {
+    if ( mGetHashersFunc == nullptr ) {
+        return nullptr;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto getHashers = reinterpret_cast< GetHashersFunc >( mGetHashersFunc );
+    CMyComPtr< IHashers > hashers;
+    if ( getHashers( &hashers ) != S_OK ) {
+        return nullptr;
+    }
+    return hashers;
+}
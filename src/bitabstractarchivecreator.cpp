@@ -15,7 +15,12 @@
 #include "bitabstractarchivecreator.hpp"
 #include "biterror.hpp"
 #include "bitexception.hpp"
+#include "bitresourcelimits.hpp"
 #include "internal/archiveproperties.hpp"
+#include "internal/compressionestimator.hpp"
+#include "internal/encodermemory.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/solidplanner.hpp"
 
 using namespace bit7z;
 
@@ -123,9 +128,18 @@ BitAbstractArchiveCreator::BitAbstractArchiveCreator( const Bit7zLibrary& lib,
       mWordSize( 0 ),
       mCryptHeaders( false ),
       mSolidMode( false ),
+      mSolidOptions{},
       mVolumeSize( 0 ),
       mThreadsCount( 0 ),
-      mStoreSymbolicLinks{ false } {
+      mStoreSymbolicLinks{ false },
+      mReadAheadBudget{ 0 },
+      mReadAheadThreads{ 0 },
+      mItemsOrder{ ItemsOrder::Indexing },
+      mCompressionPolicy{ CompressionPolicy::CompressAll },
+      mDeduplicateContent{ false },
+      mMemoryBudget{ 0 },
+      mMemoryBudgetPolicy{ MemoryBudgetPolicy::Fail },
+      mSyncOptions{} {
     setRetainDirectories( false );
 }
 
@@ -161,10 +175,18 @@ auto BitAbstractArchiveCreator::solidMode() const noexcept -> bool {
     return mSolidMode;
 }
 
+auto BitAbstractArchiveCreator::solidOptions() const noexcept -> const SolidOptions& {
+    return mSolidOptions;
+}
+
 auto BitAbstractArchiveCreator::updateMode() const noexcept -> UpdateMode {
     return mUpdateMode;
 }
 
+auto BitAbstractArchiveCreator::syncOptions() const noexcept -> const SyncOptions& {
+    return mSyncOptions;
+}
+
 auto BitAbstractArchiveCreator::volumeSize() const noexcept -> uint64_t {
     return mVolumeSize;
 }
@@ -177,6 +199,94 @@ auto BitAbstractArchiveCreator::storeSymbolicLinks() const noexcept -> bool {
     return mStoreSymbolicLinks;
 }
 
+auto BitAbstractArchiveCreator::readAheadBudget() const noexcept -> uint64_t {
+    return mReadAheadBudget;
+}
+
+auto BitAbstractArchiveCreator::readAheadThreads() const noexcept -> uint32_t {
+    return mReadAheadThreads;
+}
+
+auto BitAbstractArchiveCreator::itemsOrder() const noexcept -> ItemsOrder {
+    return mItemsOrder;
+}
+
+auto BitAbstractArchiveCreator::compressionPolicy() const noexcept -> CompressionPolicy {
+    return mCompressionPolicy;
+}
+
+auto BitAbstractArchiveCreator::deduplicateContent() const noexcept -> bool {
+    return mDeduplicateContent;
+}
+
+auto BitAbstractArchiveCreator::memoryBudget() const noexcept -> uint64_t {
+    return mMemoryBudget;
+}
+
+auto BitAbstractArchiveCreator::memoryBudgetPolicy() const noexcept -> MemoryBudgetPolicy {
+    return mMemoryBudgetPolicy;
+}
+
+auto BitAbstractArchiveCreator::estimatedMemoryUsage() const -> uint64_t {
+    return encoder_memory_usage( encoderSettings( mCompressionMethod ) );
+}
+
+auto BitAbstractArchiveCreator::estimate( const BitItemsVector& items,
+                                          uint64_t sampleSize ) const -> CompressionEstimate {
+    return estimate_compression( *this, items, sampleSize );
+}
+
+auto BitAbstractArchiveCreator::estimate( const std::vector< tstring >& inPaths,
+                                          uint64_t sampleSize ) const -> CompressionEstimate {
+    return estimate_compression( *this, indexPaths( inPaths ), sampleSize );
+}
+
+auto BitAbstractArchiveCreator::planSolidBlocks( const BitItemsVector& items ) const -> std::vector< SolidItemPlan > {
+    return plan_solid_blocks( *this, items );
+}
+
+auto BitAbstractArchiveCreator::planSolidBlocks( const std::vector< tstring >& inPaths ) const
+    -> std::vector< SolidItemPlan > {
+    return plan_solid_blocks( *this, indexPaths( inPaths ) );
+}
+
+auto BitAbstractArchiveCreator::findDuplicates( const std::vector< tstring >& inPaths ) const
+    -> std::vector< DuplicateSet > {
+    return indexPaths( inPaths ).deduplicate();
+}
+
+auto dictionary_property_name( const BitInOutFormat& format, BitCompressionMethod method ) -> const wchar_t*;
+
+auto BitAbstractArchiveCreator::configuredEncoderSettings( BitCompressionMethod method ) const -> EncoderSettings {
+    EncoderSettings settings = configured_encoder_settings( *this, method );
+    // Note: the dictionary size set via the format properties is meaningful only for the configured method.
+    apply_format_properties( settings, mExtraProperties, method == mCompressionMethod ?
+                                                         dictionary_property_name( mFormat, method ) : nullptr );
+    return settings;
+}
+
+auto BitAbstractArchiveCreator::encoderSettings( BitCompressionMethod method ) const -> EncoderSettings {
+    const EncoderSettings settings = configuredEncoderSettings( method );
+    if ( mMemoryBudget == 0 ) {
+        // No explicit budget: we try (best-effort) to fit the memory limit of the process, if any.
+        const uint64_t memoryLimit = default_resource_limits().memoryLimit;
+        return memoryLimit != 0 ? tune_encoder_settings( settings, memoryLimit ) : settings;
+    }
+    if ( mMemoryBudgetPolicy != MemoryBudgetPolicy::AutoTune ) {
+        return settings;
+    }
+    return tune_encoder_settings( settings, mMemoryBudget );
+}
+
+auto BitAbstractArchiveCreator::indexPaths( const std::vector< tstring >& inPaths ) const -> BitItemsVector {
+    IndexingOptions options{};
+    options.retainFolderStructure = retainDirectories();
+    options.followSymlinks = !mStoreSymbolicLinks;
+    BitItemsVector items;
+    items.indexPaths( inPaths, options );
+    return items;
+}
+
 void BitAbstractArchiveCreator::setPassword( const tstring& password ) {
     setPassword( password, mCryptHeaders );
 }
@@ -250,6 +360,10 @@ void BitAbstractArchiveCreator::setSolidMode( bool solidMode ) noexcept {
     mSolidMode = solidMode;
 }
 
+void BitAbstractArchiveCreator::setSolidOptions( const SolidOptions& options ) noexcept {
+    mSolidOptions = options;
+}
+
 void BitAbstractArchiveCreator::setUpdateMode( UpdateMode mode ) {
     mUpdateMode = mode;
 }
@@ -259,6 +373,10 @@ void BitAbstractArchiveCreator::setUpdateMode( bool canUpdate ) {
     setUpdateMode( canUpdate ? UpdateMode::Append : UpdateMode::None );
 }
 
+void BitAbstractArchiveCreator::setSyncOptions( const SyncOptions& options ) noexcept {
+    mSyncOptions = options;
+}
+
 void BitAbstractArchiveCreator::setVolumeSize( uint64_t volumeSize ) noexcept {
     mVolumeSize = volumeSize;
 }
@@ -273,6 +391,31 @@ void BitAbstractArchiveCreator::setStoreSymbolicLinks( bool storeSymlinks ) noex
     setSolidMode( storeSymlinks );
 }
 
+void BitAbstractArchiveCreator::setReadAheadBudget( uint64_t budget ) noexcept {
+    mReadAheadBudget = budget;
+}
+
+void BitAbstractArchiveCreator::setReadAheadThreads( uint32_t threadsCount ) noexcept {
+    mReadAheadThreads = threadsCount;
+}
+
+void BitAbstractArchiveCreator::setItemsOrder( ItemsOrder order ) noexcept {
+    mItemsOrder = order;
+}
+
+void BitAbstractArchiveCreator::setCompressionPolicy( CompressionPolicy policy ) noexcept {
+    mCompressionPolicy = policy;
+}
+
+void BitAbstractArchiveCreator::setDeduplicateContent( bool deduplicate ) noexcept {
+    mDeduplicateContent = deduplicate;
+}
+
+void BitAbstractArchiveCreator::setMemoryBudget( uint64_t budget, MemoryBudgetPolicy policy ) noexcept {
+    mMemoryBudget = budget;
+    mMemoryBudgetPolicy = policy;
+}
+
 auto dictionary_property_name( const BitInOutFormat& format, BitCompressionMethod method ) -> const wchar_t* {
     if ( format == BitFormat::SevenZip ) {
         return ( method == BitCompressionMethod::Ppmd ? L"0mem" : L"0d" );
@@ -287,7 +430,41 @@ auto word_size_property_name( const BitInOutFormat& format, BitCompressionMethod
     return ( method == BitCompressionMethod::Ppmd ? L"o" : L"fb" );
 }
 
+// Whether 7-Zip can use multiple threads to compress archives of the given format.
+auto has_multithreaded_encoder( const BitInOutFormat& format ) noexcept -> bool {
+    return format == BitFormat::SevenZip || format == BitFormat::Zip ||
+           format == BitFormat::Xz || format == BitFormat::BZip2;
+}
+
+auto solid_block_specification( const SolidOptions& options ) -> std::wstring {
+    // Note: the syntax of the solid block specification is "[e][{N}f][{N}b]" (see the documentation of 7-Zip).
+    std::wstring result;
+    if ( options.groupByExtension ) {
+        result += L'e';
+    }
+    if ( options.maxBlockFiles > 0 ) {
+        result += std::to_wstring( options.maxBlockFiles ) + L'f';
+    }
+    if ( options.maxBlockSize > 0 ) {
+        result += std::to_wstring( options.maxBlockSize ) + L'b';
+    }
+    return result;
+}
+
 auto BitAbstractArchiveCreator::archiveProperties() const -> ArchiveProperties {
+    return archiveProperties( mCompressionMethod );
+}
+
+auto BitAbstractArchiveCreator::archiveProperties( BitCompressionMethod method ) const -> ArchiveProperties {
+    // Note: the dictionary and word sizes are meaningful only for the configured compression method.
+    const bool isConfiguredMethod = method == mCompressionMethod;
+
+    const EncoderSettings configuredSettings = configuredEncoderSettings( method );
+    const EncoderSettings settings = encoderSettings( method );
+    if ( mMemoryBudget != 0 && encoder_memory_usage( settings ) > mMemoryBudget ) {
+        throw BitException( "Cannot compress within the memory budget",
+                            make_error_code( BitError::MemoryBudgetExceeded ) );
+    }
     ArchiveProperties properties = {};
     if ( mCryptHeaders && mFormat.hasFeature( FormatFeatures::HeaderEncryption ) ) {
         properties.setProperty( L"he", true );
@@ -295,13 +472,23 @@ auto BitAbstractArchiveCreator::archiveProperties() const -> ArchiveProperties {
     if ( mFormat.hasFeature( FormatFeatures::CompressionLevel ) ) {
         properties.setProperty( L"x", static_cast< uint32_t >( mCompressionLevel ) );
 
-        if ( mFormat.hasFeature( FormatFeatures::MultipleMethods ) && mCompressionMethod != mFormat.defaultMethod() ) {
+        if ( mFormat.hasFeature( FormatFeatures::MultipleMethods ) && method != mFormat.defaultMethod() ) {
             const auto* propertyName = ( mFormat == BitFormat::SevenZip ) ? L"0" : L"m";
-            properties.setProperty( propertyName, method_name( mCompressionMethod ) );
+            properties.setProperty( propertyName, method_name( method ) );
         }
     }
     if ( mFormat.hasFeature( FormatFeatures::SolidArchive ) ) {
-        properties.setProperty( L"s", mSolidMode );
+        const std::wstring solidBlockSpec = solid_block_specification( mSolidOptions );
+        if ( mSolidMode && !solidBlockSpec.empty() ) {
+            properties.setProperty( L"s", solidBlockSpec );
+        } else {
+            properties.setProperty( L"s", mSolidMode );
+        }
+        /* Note: when deduplicating, sorting by type makes 7-Zip place the duplicates having the same file name
+         *       next to each other, so that they are compressed cheaply (7-Zip sorts the items on its own). */
+        if ( mSolidMode && ( mSolidOptions.groupByExtension || mDeduplicateContent ) ) {
+            properties.setProperty( L"qs", true );
+        }
 #ifndef _WIN32
         if ( mSolidMode ) {
             /* NOTE: Apparently, p7zip requires the filters to be set off for the solid compression to work.
@@ -312,16 +499,28 @@ auto BitAbstractArchiveCreator::archiveProperties() const -> ArchiveProperties {
         }
 #endif
     }
-    if ( mThreadsCount != 0 ) {
-        properties.setProperty( L"mt", mThreadsCount );
+    /* Note: the auto-tuning (if any) might have changed the number of threads and the dictionary size,
+     *       including the ones set via the format properties, which are hence replaced by the tuned values. */
+    const bool hasThreadsProperty = mExtraProperties.count( L"mt" ) != 0;
+    if ( mThreadsCount != 0 || hasThreadsProperty || ( has_multithreaded_encoder( mFormat ) &&
+                                                       ( default_resource_limits().cpuCount != 0 ||
+                                                         settings.threads != configuredSettings.threads ) ) ) {
+        properties.setProperty( L"mt", settings.threads );
     }
-    if ( mDictionarySize != 0 ) {
-        properties.setProperty( dictionary_property_name( mFormat, mCompressionMethod ),
-                                std::to_wstring( mDictionarySize ) + L"b" );
+    const auto* dictionaryPropertyName = dictionary_property_name( mFormat, mCompressionMethod );
+    const bool hasDictionaryProperty = isConfiguredMethod && mExtraProperties.count( dictionaryPropertyName ) != 0;
+    if ( isConfiguredMethod && ( mDictionarySize != 0 || hasDictionaryProperty ||
+                                 settings.dictionarySize != configuredSettings.dictionarySize ) ) {
+        properties.setProperty( dictionaryPropertyName, std::to_wstring( settings.dictionarySize ) + L"b" );
     }
-    if ( mWordSize != 0 ) {
+    if ( isConfiguredMethod && mWordSize != 0 ) {
         properties.setProperty( word_size_property_name( mFormat, mCompressionMethod ), mWordSize );
     }
-    properties.addProperties( mExtraProperties );
+    for ( const auto& property : mExtraProperties ) {
+        if ( property.first == L"mt" || ( hasDictionaryProperty && property.first == dictionaryPropertyName ) ) {
+            continue;
+        }
+        properties.setProperty( property.first.c_str(), property.second );
+    }
     return properties;
 }
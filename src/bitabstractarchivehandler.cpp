@@ -20,7 +20,12 @@ BitAbstractArchiveHandler::BitAbstractArchiveHandler( const Bit7zLibrary& lib,
     : mLibrary{ lib },
       mPassword{ std::move( password ) },
       mRetainDirectories{ true },
-      mOverwriteMode{ overwriteMode } {}
+      mOverwriteMode{ overwriteMode },
+      mStoredCopyMode{ StoredCopyMode::Disabled },
+      mDuplicateItemsMode{ DuplicateItemsMode::Extract },
+      mAsyncFileOutput{ false },
+      mReadAheadWindow{ 0 },
+      mDigestTypes{ DigestType::Crc32 } {}
 
 auto BitAbstractArchiveHandler::library() const noexcept -> const Bit7zLibrary& {
     return mLibrary;
@@ -58,10 +63,34 @@ auto BitAbstractArchiveHandler::passwordCallback() const -> PasswordCallback {
     return mPasswordCallback;
 }
 
+auto BitAbstractArchiveHandler::digestCallback() const -> DigestCallback {
+    return mDigestCallback;
+}
+
+auto BitAbstractArchiveHandler::digestTypes() const -> const std::vector< DigestType >& {
+    return mDigestTypes;
+}
+
 auto BitAbstractArchiveHandler::overwriteMode() const -> OverwriteMode {
     return mOverwriteMode;
 }
 
+auto BitAbstractArchiveHandler::storedCopyMode() const -> StoredCopyMode {
+    return mStoredCopyMode;
+}
+
+auto BitAbstractArchiveHandler::duplicateItemsMode() const -> DuplicateItemsMode {
+    return mDuplicateItemsMode;
+}
+
+auto BitAbstractArchiveHandler::asyncFileOutput() const noexcept -> bool {
+    return mAsyncFileOutput;
+}
+
+auto BitAbstractArchiveHandler::readAheadWindow() const noexcept -> uint64_t {
+    return mReadAheadWindow;
+}
+
 void BitAbstractArchiveHandler::setPassword( const tstring& password ) {
     mPassword = password;
 }
@@ -94,6 +123,30 @@ void BitAbstractArchiveHandler::setPasswordCallback( const PasswordCallback& cal
     mPasswordCallback = callback;
 }
 
+void BitAbstractArchiveHandler::setDigestCallback( const DigestCallback& callback ) {
+    mDigestCallback = callback;
+}
+
+void BitAbstractArchiveHandler::setDigestTypes( const std::vector< DigestType >& types ) {
+    mDigestTypes = types;
+}
+
 void BitAbstractArchiveHandler::setOverwriteMode( OverwriteMode mode ) {
     mOverwriteMode = mode;
 }
+
+void BitAbstractArchiveHandler::setStoredCopyMode( StoredCopyMode mode ) {
+    mStoredCopyMode = mode;
+}
+
+void BitAbstractArchiveHandler::setDuplicateItemsMode( DuplicateItemsMode mode ) {
+    mDuplicateItemsMode = mode;
+}
+
+void BitAbstractArchiveHandler::setAsyncFileOutput( bool enabled ) noexcept {
+    mAsyncFileOutput = enabled;
+}
+
+void BitAbstractArchiveHandler::setReadAheadWindow( uint64_t window ) noexcept {
+    mReadAheadWindow = window;
+}
@@ -10,12 +10,16 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+
 #include "bitarchiveeditor.hpp"
 
 #include "biterror.hpp"
 #include "bitexception.hpp"
 #include "internal/bufferitem.hpp"
+#include "internal/dateutil.hpp"
 #include "internal/fsitem.hpp"
+#include "internal/inplaceappend.hpp"
 #include "internal/renameditem.hpp"
 #include "internal/stdinputitem.hpp"
 #include "internal/stringutil.hpp"
@@ -28,7 +32,7 @@ BitArchiveEditor::BitArchiveEditor( const Bit7zLibrary& lib,
                                     const tstring& inFile,
                                     const BitInOutFormat& format,
                                     const tstring& password )
-    : BitArchiveWriter( lib, inFile, format, password ) {
+    : BitArchiveWriter( lib, inFile, format, password ), mEditedItemsCount{ 0 } {
     if ( inputArchive() != nullptr ) {
         return; // Input file was correctly read by base class BitOutputArchive constructor
     }
@@ -51,46 +55,89 @@ BitArchiveEditor::~BitArchiveEditor() = default;
 
 void BitArchiveEditor::renameItem( uint32_t index, const tstring& newPath ) {
     checkIndex( index );
-    mEditedItems[ index ] = std::make_unique< RenamedItem >( *inputArchive(), index, newPath ); //-V108
+    metadataItem( index ).setPath( newPath );
 }
 
 void BitArchiveEditor::renameItem( const tstring& oldPath, const tstring& newPath ) {
-    auto index = findItem( oldPath );
-    mEditedItems[ index ] = std::make_unique< RenamedItem >( *inputArchive(), index, newPath ); //-V108
+    metadataItem( findItem( oldPath ) ).setPath( newPath );
+}
+
+void BitArchiveEditor::renameItems( const std::map< tstring, tstring >& renamedPaths ) {
+    std::vector< uint32_t > indices;
+    indices.reserve( renamedPaths.size() );
+    for ( const auto& renamedPath : renamedPaths ) {
+        indices.push_back( findItem( renamedPath.first ) );
+    }
+    auto index = indices.cbegin();
+    for ( const auto& renamedPath : renamedPaths ) {
+        metadataItem( *index++ ).setPath( renamedPath.second );
+    }
+}
+
+void BitArchiveEditor::setItemAttributes( uint32_t index, uint32_t attributes ) {
+    checkIndex( index );
+    metadataItem( index ).setAttributes( attributes );
+}
+
+void BitArchiveEditor::setItemAttributes( const tstring& itemPath, uint32_t attributes ) {
+    metadataItem( findItem( itemPath ) ).setAttributes( attributes );
+}
+
+void BitArchiveEditor::setItemLastWriteTime( uint32_t index, const time_type& lastWriteTime ) {
+    checkIndex( index );
+    metadataItem( index ).setLastWriteTime( time_type_to_FILETIME( lastWriteTime ) );
+}
+
+void BitArchiveEditor::setItemLastWriteTime( const tstring& itemPath, const time_type& lastWriteTime ) {
+    metadataItem( findItem( itemPath ) ).setLastWriteTime( time_type_to_FILETIME( lastWriteTime ) );
 }
 
 void BitArchiveEditor::updateItem( uint32_t index, const tstring& inFile ) {
     checkIndex( index );
-    auto itemName = inputArchive()->itemProperty( index, BitProperty::Path );
-    mEditedItems[ index ] = std::make_unique< FilesystemItem >( tstring_to_path( inFile ), itemName.getNativeString() ); //-V108
+    const auto& itemName = archivedItems()[ index ].path;
+    setEditedItem( index, std::make_unique< FilesystemItem >( tstring_to_path( inFile ), itemName ) );
 }
 
 void BitArchiveEditor::updateItem( uint32_t index, const std::vector< byte_t >& inBuffer ) {
     checkIndex( index );
-    auto itemName = inputArchive()->itemProperty( index, BitProperty::Path );
-    mEditedItems[ index ] = std::make_unique< BufferItem >( inBuffer, itemName.getNativeString() ); //-V108
+    const auto& itemName = archivedItems()[ index ].path;
+    setEditedItem( index, std::make_unique< BufferItem >( inBuffer, itemName ) );
 }
 
 void BitArchiveEditor::updateItem( uint32_t index, std::istream& inStream ) {
     checkIndex( index );
-    auto itemName = inputArchive()->itemProperty( index, BitProperty::Path );
-    mEditedItems[ index ] = std::make_unique< StdInputItem >( inStream, itemName.getNativeString() ); //-V108
+    const auto& itemName = archivedItems()[ index ].path;
+    setEditedItem( index, std::make_unique< StdInputItem >( inStream, itemName ) );
 }
 
 void BitArchiveEditor::updateItem( const tstring& itemPath, const tstring& inFile ) {
-    mEditedItems[ findItem( itemPath ) ] = std::make_unique< FilesystemItem >( tstring_to_path( inFile ), //-V108
-                                                                               tstring_to_path( itemPath ) );
+    setEditedItem( findItem( itemPath ),
+                   std::make_unique< FilesystemItem >( tstring_to_path( inFile ), tstring_to_path( itemPath ) ) );
 }
 
 void BitArchiveEditor::updateItem( const tstring& itemPath, const std::vector< byte_t >& inBuffer ) {
-    mEditedItems[ findItem( itemPath ) ] = std::make_unique< BufferItem >( inBuffer, itemPath ); //-V108
+    setEditedItem( findItem( itemPath ), std::make_unique< BufferItem >( inBuffer, itemPath ) );
 }
 
 void BitArchiveEditor::updateItem( const tstring& itemPath, std::istream& inStream ) {
-    mEditedItems[ findItem( itemPath ) ] = std::make_unique< StdInputItem >( inStream, itemPath ); //-V108
+    setEditedItem( findItem( itemPath ), std::make_unique< StdInputItem >( inStream, itemPath ) );
+}
+
+void BitArchiveEditor::updateItems( const std::map< tstring, tstring >& updatedFiles ) {
+    std::vector< uint32_t > indices;
+    indices.reserve( updatedFiles.size() );
+    for ( const auto& updatedFile : updatedFiles ) {
+        indices.push_back( findItem( updatedFile.first ) );
+    }
+    auto index = indices.cbegin();
+    for ( const auto& updatedFile : updatedFiles ) {
+        setEditedItem( *index++, std::make_unique< FilesystemItem >( tstring_to_path( updatedFile.second ),
+                                                                     tstring_to_path( updatedFile.first ) ) );
+    }
 }
 
 void BitArchiveEditor::deleteItem( uint32_t index, DeletePolicy policy ) {
+    const auto& items = archivedItems();
     if ( index >= inputArchiveItemsCount() ) {
         throw BitException( "Cannot delete item at index " + std::to_string( index ),
                             make_error_code( BitError::InvalidIndex ) );
@@ -98,87 +145,182 @@ void BitArchiveEditor::deleteItem( uint32_t index, DeletePolicy policy ) {
 
     markItemAsDeleted( index );
 
-    const auto& deletedItem = inputArchive()->itemAt( index );
-    if ( !deletedItem.isDir() || policy == DeletePolicy::ItemOnly ) {
+    const auto& deletedItem = items[ index ];
+    if ( !deletedItem.isDir || policy == DeletePolicy::ItemOnly ) {
         return;
     }
 
-    const auto deletedPath = deletedItem.nativePath() + fs::path::preferred_separator;
+    const auto deletedPath = deletedItem.path + fs::path::preferred_separator;
     if ( deletedPath.size() <= 1 ) { // The original path was empty
         return;
     }
 
-    for ( const auto& item: *inputArchive() ) {
-        if ( starts_with( item.nativePath(), deletedPath ) ) {
-            markItemAsDeleted( item.index() );
+    for ( uint32_t itemIndex = 0; itemIndex < items.size(); ++itemIndex ) {
+        if ( starts_with( items[ itemIndex ].path, deletedPath ) ) {
+            markItemAsDeleted( itemIndex );
         }
     }
 }
 
-/**
- * Determines if the given itemPath is within the specified base directory.
- *
- * @param itemPath The path to the item to be checked.
- * @param isDir    A boolean indicating whether the itemPath represents a directory.
- * @param base     The base directory against which the itemPath is checked.
- *
- * @return true if the itemPath is located within the base directory, false otherwise.
- */
-inline auto isInsidePath( const fs::path& itemPath, bool isDir, const fs::path& base ) -> bool {
-    const auto relativePath = itemPath.lexically_relative( base ).native();
-    /* The relative path of the item with respect to the base directory can be:
-     * 1) A single dot component;
-     * 2) A path not starting with a dot-dot component (i.e., the item is inside the base path);
-     * 3) A path starting with a dot-dot component (i.e., the item is outside the base path).
-     *
-     * This function is called after having evaluated itemPath == base to false;
-     * also, 7-Zip reports folder paths without trailing separators.
-     * Hence, the first case can be restricted further to only the case
-     * where the base path has a trailing path separator: this means that if
-     * the relative path is a single dot, the item must be a folder to be considered inside the base path.
-     *
-     * The remaining cases 2 and 3 are checked as follows:
-     *   - Either the relative path doesn't start with two dots (and then the item is inside the base path) or
-     *   - It starts with two dots, but it is not a dot-dot component (e.g., a normal filename starting with two dots).
-     */
-    return ( relativePath != BIT7Z_NATIVE_STRING( "." ) || isDir ) &&
-           ( !starts_with( relativePath, BIT7Z_NATIVE_STRING( ".." ) ) ||
-             ( relativePath.size() > 2 && !isPathSeparator( relativePath[ 2 ] ) ) );
+void BitArchiveEditor::deleteItem( const tstring& itemPath, DeletePolicy policy ) {
+    deleteItems( { itemPath }, policy );
 }
 
-void BitArchiveEditor::deleteItem( const tstring& itemPath, DeletePolicy policy ) {
-    // The path to be deleted must be relative to the root of the archive.
-    if ( itemPath.empty() || isPathSeparator( itemPath.front() ) ) {
+void BitArchiveEditor::deleteItems( const std::vector< tstring >& itemPaths, DeletePolicy policy ) {
+    /* The normalized forms of the paths to be deleted, mapped to their position in itemPaths.
+     * Paths with a trailing separator are kept separately, as they can only match folders (and their content). */
+    std::unordered_map< native_string, std::size_t > deletedPaths;
+    std::unordered_map< native_string, std::size_t > deletedFolders;
+    for ( std::size_t position = 0; position < itemPaths.size(); ++position ) {
+        const auto& itemPath = itemPaths[ position ];
+
+        // The path to be deleted must be relative to the root of the archive.
+        if ( itemPath.empty() || isPathSeparator( itemPath.front() ) ) {
+            throw BitException( "Could not mark any path as deleted",
+                                std::make_error_code( std::errc::invalid_argument ), itemPath );
+        }
+
+        const auto deletedPath = tstring_to_path( itemPath ).lexically_normal();
+        if ( deletedPath.has_filename() ) {
+            deletedPaths.emplace( deletedPath.native(), position );
+        } else {
+            deletedFolders.emplace( deletedPath.parent_path().native(), position );
+        }
+    }
+
+    /* The current item is marked as deleted if either:
+     *  - its path is equal to a path to be deleted; or
+     *  - we need to recursively delete directories, and either the item is a folder whose path is equal to
+     *    a path to be deleted (with a trailing separator), or one of its parent folders is to be deleted.
+     * Note: 7-Zip reports folder paths without trailing separators. */
+    std::vector< bool > isPathMatched( itemPaths.size(), false );
+    std::vector< uint32_t > deletedIndices;
+    const auto matchPath = [ & ]( const std::unordered_map< native_string, std::size_t >& paths,
+                                  const native_string& path ) -> bool {
+        const auto match = paths.find( path );
+        if ( match == paths.cend() ) {
+            return false;
+        }
+        isPathMatched[ match->second ] = true;
+        return true;
+    };
+    const auto& items = archivedItems();
+    for ( uint32_t index = 0; index < items.size(); ++index ) {
+        const native_string& path = items[ index ].path;
+        bool isDeleted = matchPath( deletedPaths, path );
+        if ( policy == DeletePolicy::RecurseDirs ) {
+            isDeleted = ( items[ index ].isDir && matchPath( deletedFolders, path ) ) || isDeleted;
+            for ( auto separator = path.rfind( fs::path::preferred_separator );
+                  separator != native_string::npos && separator > 0;
+                  separator = path.rfind( fs::path::preferred_separator, separator - 1 ) ) {
+                const native_string parentPath = path.substr( 0, separator );
+                isDeleted = matchPath( deletedPaths, parentPath ) || isDeleted;
+                isDeleted = matchPath( deletedFolders, parentPath ) || isDeleted;
+            }
+        }
+        if ( isDeleted ) {
+            deletedIndices.push_back( index );
+        }
+    }
+
+    const auto unmatchedPath = std::find( isPathMatched.cbegin(), isPathMatched.cend(), false );
+    if ( unmatchedPath != isPathMatched.cend() ) {
         throw BitException( "Could not mark any path as deleted",
-                            std::make_error_code( std::errc::invalid_argument ), itemPath );
+                            std::make_error_code( std::errc::no_such_file_or_directory ),
+                            itemPaths[ static_cast< std::size_t >( unmatchedPath - isPathMatched.cbegin() ) ] );
+    }
+    for ( const auto index : deletedIndices ) {
+        markItemAsDeleted( index );
     }
+}
 
-    bool deleted = false;
+// A copy of an input archive without the items not being exported.
+class ExportOutputArchive final : public BitOutputArchive {
+    public:
+        ExportOutputArchive( const BitAbstractArchiveCreator& creator,
+                             const tstring& archivePath,
+                             const std::vector< bool >& exportedItems )
+            : BitOutputArchive( creator ) {
+            setInputArchive( std::make_unique< BitInputArchive >( creator, archivePath ) );
+            for ( uint32_t index = 0; index < inputArchiveItemsCount(); ++index ) {
+                if ( index >= exportedItems.size() || !exportedItems[ index ] ) {
+                    setDeletedIndex( index );
+                }
+            }
+        }
 
-    // Normalized form of the path to be deleted inside the archive.
-    const auto deletedPath = tstring_to_path( itemPath ).lexically_normal();
-    for ( const auto& item: *inputArchive() ) {
-        const fs::path path = item.nativePath();
+    protected:
+        // Note: there are no new items, so the old ones must be kept regardless of the creator's update mode.
+        auto effectiveUpdateMode() const noexcept -> UpdateMode override {
+            return UpdateMode::Append;
+        }
+};
+
+void BitArchiveEditor::exportItems( const std::vector< uint32_t >& indices, const tstring& outFile ) {
+    std::vector< bool > exportedItems( inputArchiveItemsCount(), false );
+    for ( const auto index : indices ) {
+        if ( index >= exportedItems.size() ) {
+            throw BitException( "Cannot export item at index " + std::to_string( index ),
+                                make_error_code( BitError::InvalidIndex ) );
+        }
+        exportedItems[ index ] = true;
+    }
 
-        // The current item is marked as deleted if either:
-        //  - it is lexicographically equivalent to the path to be deleted; or
-        //  - we need to recursively delete directories,
-        //    and the path of the item is (lexicographically) inside the path to be deleted.
-        if ( path == deletedPath ||
-             ( policy == DeletePolicy::RecurseDirs && isInsidePath( path, item.isDir(), deletedPath ) ) ) {
-            markItemAsDeleted( item.index() );
-            deleted = true;
+    const tstring archivePath = inputArchive()->archivePath();
+    const fs::path outPath = tstring_to_path( outFile );
+    std::error_code error;
+    if ( fs::exists( outPath, error ) ) {
+        if ( fs::equivalent( tstring_to_path( archivePath ), outPath, error ) ) {
+            throw BitException( "Cannot export the items to the input archive",
+                                std::make_error_code( std::errc::invalid_argument ), outFile );
+        }
+        if ( overwriteMode() == OverwriteMode::Skip ) {
+            return;
+        }
+        if ( overwriteMode() == OverwriteMode::None ) {
+            throw BitException( "Cannot export the items",
+                                std::make_error_code( std::errc::file_exists ), outFile );
+        }
+        if ( !fs::remove( outPath, error ) ) {
+            throw BitException( "Failed to delete the old archive file", error, outFile );
         }
     }
 
-    if ( !deleted ) {
-        throw BitException( "Could not mark any path as deleted",
-                            std::make_error_code( std::errc::no_such_file_or_directory ), itemPath );
+    if ( exportRawItems( exportedItems, outPath ) ) {
+        return;
     }
+    ExportOutputArchive outputArchive{ *this, archivePath, exportedItems };
+    outputArchive.compressTo( outFile );
+}
+
+auto BitArchiveEditor::exportRawItems( const std::vector< bool >& exportedItems, const fs::path& outPath ) -> bool {
+    const BitInOutFormat& format = compressionFormat();
+    if ( format != BitFormat::Zip && format != BitFormat::Tar ) {
+        return false;
+    }
+    RawEntriesSource source{ tstring_to_path( inputArchive()->archivePath() ), {}, {} };
+    const auto& items = archivedItems();
+    if ( !read_raw_entries( format, source ) || source.entries.size() != items.size() ) {
+        return false;
+    }
+
+    // Note: the entries are expected to be in the same order of the items; otherwise, we let 7-Zip copy the items.
+    std::size_t exportedCount = 0;
+    for ( std::size_t index = 0; index < source.entries.size(); ++index ) {
+        if ( !exportedItems[ index ] ) {
+            continue;
+        }
+        if ( source.entries[ index ].path != fs::path( items[ index ].path ).generic_u8string() ) {
+            return false;
+        }
+        source.entries[ exportedCount++ ] = std::move( source.entries[ index ] );
+    }
+    source.entries.resize( exportedCount );
+    return write_raw_archive( format, { source }, outPath );
 }
 
 void BitArchiveEditor::markItemAsDeleted( uint32_t index ) {
-    mEditedItems.erase( index );
+    setEditedItem( index, nullptr );
     setDeletedIndex( index );
 }
 
@@ -191,27 +333,163 @@ void BitArchiveEditor::setUpdateMode( UpdateMode mode ) {
 }
 
 void BitArchiveEditor::applyChanges() {
-    if ( !hasNewItems() && mEditedItems.empty() && !hasDeletedIndexes() ) {
+    if ( !hasNewItems() && mEditedItemsCount == 0 && !hasDeletedIndexes() ) {
         // Nothing to do here!
         return;
     }
     auto archivePath = inputArchive()->archivePath();
-    compressTo( archivePath );
+
+    /* Note: we don't reopen the archive after applying the changes, since we already know its new content;
+     *       the archive will be opened again only if and when its items' data or properties are needed.
+     *       However, some formats (e.g., 7z) may reorder the items when updating the archive, so in such cases
+     *       the new indices of the items are known only after reopening it. */
+    const bool isOrderPreserved = compressionFormat() == BitFormat::Zip || compressionFormat() == BitFormat::Tar;
+    if ( isOrderPreserved ) {
+        (void)archivedItems(); // Reading the current items before the archive gets closed by the update.
+    }
+    bool isOrderChanged = false;
+    if ( !applyMetadataChanges( archivePath, isOrderChanged ) ) {
+        compressTo( archivePath );
+    }
+    /* Note: the in place edits of zip archives may move some entries after the other ones, and 7-Zip lists
+     *       the items of zip archives in the order of their local headers; hence, in such cases,
+     *       we let the archive be opened again to know the new order of the items. */
+    auto newArchivedItems = ( isOrderPreserved && !isOrderChanged ) ? committedItems()
+                                                                      : std::vector< ArchivedItemEntry >{};
+    const uint32_t newItemsCount = itemsCount();
+
     mEditedItems.clear();
-    setInputArchive( std::make_unique< BitInputArchive >( *this, archivePath ) );
+    mEditedItemsCount = 0;
+    mItemsIndex.clear();
+    mArchivedItems = std::move( newArchivedItems );
+    newItems() = BitItemsVector{};
+    setInputArchive( archivePath, newItemsCount );
+}
+
+auto BitArchiveEditor::committedItems() -> std::vector< ArchivedItemEntry > {
+    const auto& items = archivedItems();
+    std::vector< ArchivedItemEntry > result;
+    result.reserve( itemsCount() );
+    for ( uint32_t index = 0; index < items.size(); ++index ) {
+        if ( isDeletedIndex( index ) ) {
+            continue;
+        }
+        const auto* item = editedItem( index );
+        result.push_back( { item != nullptr ? item->inArchivePath().native() : items[ index ].path,
+                            items[ index ].isDir } );
+    }
+    for ( const auto& newItem : newItems() ) {
+        result.push_back( { newItem->inArchivePath().native(), newItem->isDir() } );
+    }
+    return result;
+}
+
+auto BitArchiveEditor::archivedItems() -> const std::vector< ArchivedItemEntry >& {
+    if ( mArchivedItems.size() != inputArchiveItemsCount() ) {
+        const BitInputArchive& archive = *inputArchive();
+        mArchivedItems.clear();
+        mArchivedItems.reserve( archive.itemsCount() );
+        for ( const auto& item : archive ) {
+            mArchivedItems.push_back( { item.nativePath(), item.isDir() } );
+        }
+        mItemsIndex.clear();
+    }
+    return mArchivedItems;
+}
+
+auto BitArchiveEditor::applyMetadataChanges( const tstring& archivePath, bool& isOrderChanged ) -> bool {
+    if ( hasNewItems() || hasDeletedIndexes() || volumeSize() > 0 || mEditedItemsCount == 0 ) {
+        return false;
+    }
+
+    const auto& items = archivedItems();
+    std::vector< InPlaceMetadataEdit > edits;
+    edits.reserve( mEditedItemsCount );
+    for ( uint32_t index = 0; index < mEditedItems.size(); ++index ) {
+        if ( mEditedItems[ index ] == nullptr ) {
+            continue;
+        }
+        const auto* renamedItem = dynamic_cast< const RenamedItem* >( mEditedItems[ index ].get() );
+        if ( renamedItem == nullptr ) {
+            return false; // The item has new data.
+        }
+        InPlaceMetadataEdit edit{};
+        edit.path = fs::path( items[ index ].path ).generic_u8string();
+        if ( renamedItem->isRenamed() ) {
+            edit.newPath = renamedItem->inArchivePath().generic_u8string();
+        }
+        edit.hasNewAttributes = renamedItem->hasNewAttributes();
+        edit.attributes = renamedItem->attributes();
+        edit.hasNewLastWriteTime = renamedItem->hasNewLastWriteTime();
+        edit.lastWriteTime = renamedItem->lastWriteTime();
+        edits.push_back( std::move( edit ) );
+    }
+
+    const fs::path archiveFile = tstring_to_path( archivePath );
+    InPlaceAppendPlan plan{};
+    if ( !plan_in_place_metadata_edit( compressionFormat(), archiveFile, edits, plan ) ) {
+        return false;
+    }
+
+    const auto closeResult = inputArchive()->close();
+    if ( closeResult != S_OK ) {
+        throw BitException( "Failed to close the archive", make_hresult_code( closeResult ), archivePath );
+    }
+    apply_in_place_append( plan );
+    isOrderChanged = !plan.relocations.empty();
+    return true;
+}
+
+auto BitArchiveEditor::metadataItem( uint32_t index ) -> RenamedItem& {
+    // Note: a pending update of the item's data is discarded, as when renaming it.
+    auto* renamedItem = dynamic_cast< RenamedItem* >( index < mEditedItems.size() ? mEditedItems[ index ].get()
+                                                                                  : nullptr );
+    if ( renamedItem == nullptr ) {
+        auto newItem = std::make_unique< RenamedItem >( *inputArchive(), index );
+        renamedItem = newItem.get();
+        setEditedItem( index, std::move( newItem ) );
+    }
+    return *renamedItem;
 }
 
 auto BitArchiveEditor::findItem( const tstring& itemPath ) -> uint32_t {
-    auto archiveItem = inputArchive()->find( itemPath );
-    if ( archiveItem == inputArchive()->cend() ) {
+    const auto& items = archivedItems();
+    if ( mItemsIndex.empty() ) {
+        mItemsIndex.reserve( items.size() );
+        for ( uint32_t index = 0; index < items.size(); ++index ) {
+            mItemsIndex.emplace( path_to_tstring( fs::path{ items[ index ].path } ), index );
+        }
+    }
+    const auto archiveItem = mItemsIndex.find( itemPath );
+    if ( archiveItem == mItemsIndex.cend() ) {
         throw BitException( "Could not find the file in the archive",
                             std::make_error_code( std::errc::no_such_file_or_directory ), itemPath );
     }
-    if ( isDeletedIndex( archiveItem->index() ) ) {
+    if ( isDeletedIndex( archiveItem->second ) ) {
         throw BitException( "Could not find item",
                             make_error_code( BitError::ItemMarkedAsDeleted ), itemPath );
     }
-    return archiveItem->index();
+    return archiveItem->second;
+}
+
+auto BitArchiveEditor::editedItem( uint32_t index ) const noexcept -> const GenericInputItem* {
+    return index < mEditedItems.size() ? mEditedItems[ index ].get() : nullptr;
+}
+
+void BitArchiveEditor::setEditedItem( uint32_t index, BitItemsVector::value_type item ) {
+    if ( index >= mEditedItems.size() ) {
+        if ( item == nullptr ) {
+            return;
+        }
+        mEditedItems.resize( ( std::max )( index + 1, inputArchiveItemsCount() ) );
+    }
+    auto& editedItem = mEditedItems[ index ];
+    if ( editedItem == nullptr && item != nullptr ) {
+        ++mEditedItemsCount;
+    } else if ( editedItem != nullptr && item == nullptr ) {
+        --mEditedItemsCount;
+    }
+    editedItem = std::move( item );
 }
 
 void BitArchiveEditor::checkIndex( uint32_t index ) {
@@ -228,9 +506,9 @@ void BitArchiveEditor::checkIndex( uint32_t index ) {
 auto BitArchiveEditor::itemProperty( InputIndex index, BitProperty property ) const -> BitPropVariant {
     const auto mappedIndex = static_cast< uint32_t >( index );
     if ( mappedIndex < inputArchiveItemsCount() ) {
-        auto res = mEditedItems.find( mappedIndex );
-        if ( res != mEditedItems.end() ) {
-            return res->second->itemProperty( property );
+        const auto* item = editedItem( mappedIndex );
+        if ( item != nullptr ) {
+            return item->itemProperty( property );
         }
         return inputArchive()->itemProperty( mappedIndex, property );
     }
@@ -240,9 +518,9 @@ auto BitArchiveEditor::itemProperty( InputIndex index, BitProperty property ) co
 auto BitArchiveEditor::itemStream( InputIndex index, ISequentialInStream** inStream ) const -> HRESULT {
     const auto mappedIndex = static_cast< uint32_t >( index );
     if ( mappedIndex < inputArchiveItemsCount() ) { //old item in the archive
-        auto res = mEditedItems.find( mappedIndex );
-        if ( res != mEditedItems.end() ) { //user wants to update the old item in the archive
-            return res->second->getStream( inStream );
+        const auto* item = editedItem( mappedIndex );
+        if ( item != nullptr ) { //user wants to update the old item in the archive
+            return item->getStream( inStream );
         }
         return S_OK;
     }
@@ -254,16 +532,16 @@ auto BitArchiveEditor::hasNewData( uint32_t index ) const noexcept -> bool {
     if ( mappedIndex >= inputArchiveItemsCount() ) {
         return true; //new item
     }
-    auto editedItem = mEditedItems.find( mappedIndex );
-    if ( editedItem != mEditedItems.end() ) {
-        return editedItem->second->hasNewData(); //renamed item -> false (no new data), updated item -> true
+    const auto* item = editedItem( mappedIndex );
+    if ( item != nullptr ) {
+        return item->hasNewData(); //renamed item -> false (no new data), updated item -> true
     }
     return false;
 }
 
 auto BitArchiveEditor::hasNewProperties( uint32_t index ) const noexcept -> bool {
     const auto mappedIndex = static_cast< uint32_t >( itemInputIndex( index ) );
-    const bool isEditedItem = mEditedItems.find( mappedIndex ) != mEditedItems.end();
+    const bool isEditedItem = editedItem( mappedIndex ) != nullptr;
     return mappedIndex >= inputArchiveItemsCount() || isEditedItem;
 }
 
@@ -0,0 +1,245 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "bitarchivemerger.hpp"
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "bitinputarchive.hpp"
+#include "bitoutputarchive.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/inplaceappend.hpp"
+#include "internal/stringutil.hpp"
+#include "internal/tempdirectory.hpp"
+
+namespace bit7z {
+
+// An item of an archive to be merged.
+struct MergedItem {
+    std::string path; // The path of the item, using '/' as separator.
+    bool isDir;
+};
+
+/* Selects the items to be kept in the merged archive, according to the given policy.
+ * The result has the same shape of archivesItems, i.e., one flag for each item of each archive. */
+auto select_merged_items( const std::vector< std::vector< MergedItem > >& archivesItems,
+                          MergePolicy policy ) -> std::vector< std::vector< bool > > {
+    // For each path, the archive and the index of the kept item.
+    std::unordered_map< std::string, std::pair< std::size_t, std::size_t > > keptItems;
+    std::vector< std::vector< bool > > selectedItems;
+    selectedItems.reserve( archivesItems.size() );
+    for ( std::size_t archive = 0; archive < archivesItems.size(); ++archive ) {
+        const auto& items = archivesItems[ archive ];
+        selectedItems.emplace_back( items.size(), false );
+        for ( std::size_t index = 0; index < items.size(); ++index ) {
+            const auto result = keptItems.emplace( items[ index ].path, std::make_pair( archive, index ) );
+            if ( result.second ) {
+                selectedItems[ archive ][ index ] = true;
+                continue;
+            }
+
+            auto& keptItem = result.first->second;
+            if ( items[ index ].isDir && archivesItems[ keptItem.first ][ keptItem.second ].isDir ) {
+                continue; // Folders are never conflicting.
+            }
+            if ( policy == MergePolicy::Fail ) {
+                throw BitException( "Cannot merge the archives",
+                                    std::make_error_code( std::errc::file_exists ),
+                                    path_to_tstring( fs::u8path( items[ index ].path ) ) );
+            }
+            if ( policy == MergePolicy::KeepLast ) {
+                selectedItems[ keptItem.first ][ keptItem.second ] = false;
+                selectedItems[ archive ][ index ] = true;
+                keptItem = std::make_pair( archive, index );
+            }
+        }
+    }
+    return selectedItems;
+}
+
+class MergeOutputArchive final : public BitOutputArchive {
+    public:
+        explicit MergeOutputArchive( const BitAbstractArchiveCreator& creator ) : BitOutputArchive( creator ) {}
+
+        // Sets the archive whose items are copied as they are, keeping only the selected ones.
+        void setBaseArchive( std::unique_ptr< BitInputArchive >&& baseArchive, const std::vector< bool >& keptItems ) {
+            setInputArchive( std::move( baseArchive ) );
+            for ( uint32_t index = 0; index < keptItems.size(); ++index ) {
+                if ( !keptItems[ index ] ) {
+                    setDeletedIndex( index );
+                }
+            }
+        }
+
+        // Adds the content of the given directory, containing the items extracted from one of the merged archives.
+        void addExtractedItems( const fs::path& directory ) {
+            IndexingOptions options{};
+            options.followSymlinks = !creator().storeSymbolicLinks();
+            newItems().indexDirectory( directory, BIT7Z_STRING( "" ), FilterPolicy::Include, options );
+        }
+
+        /* Removes the new folders whose path is already in the archive (e.g., the parent folders created
+         * when extracting the items of each merged archive). */
+        void removeDuplicateFolders( std::unordered_set< std::string > folders ) {
+            (void)newItems().extract( [ &folders ]( const GenericInputItem& newItem ) -> bool {
+                return newItem.isDir() && !folders.insert( newItem.inArchivePath().generic_u8string() ).second;
+            } );
+        }
+};
+
+BitArchiveMerger::BitArchiveMerger( const Bit7zLibrary& lib, const BitInOutFormat& format )
+    : BitAbstractArchiveCreator( lib, format ), mMergePolicy{ MergePolicy::KeepLast } {}
+
+void BitArchiveMerger::setMergePolicy( MergePolicy policy ) noexcept {
+    mMergePolicy = policy;
+}
+
+auto BitArchiveMerger::mergePolicy() const noexcept -> MergePolicy {
+    return mMergePolicy;
+}
+
+void BitArchiveMerger::merge( const std::vector< tstring >& inArchives, const tstring& outArchive ) const {
+    if ( !compressionFormat().hasFeature( FormatFeatures::MultipleFiles ) ) {
+        throw BitException( "Cannot merge the archives", make_error_code( BitError::FormatFeatureNotSupported ) );
+    }
+    if ( inArchives.empty() ) {
+        throw BitException( "Cannot merge the archives", make_error_code( BitError::InvalidArchivePath ) );
+    }
+
+    const fs::path outPath = tstring_to_path( outArchive );
+    std::error_code error;
+    if ( fs::exists( outPath, error ) ) {
+        for ( const auto& inArchive : inArchives ) {
+            if ( fs::equivalent( tstring_to_path( inArchive ), outPath, error ) ) {
+                throw BitException( "Cannot merge the archives",
+                                    std::make_error_code( std::errc::invalid_argument ), outArchive );
+            }
+        }
+        if ( overwriteMode() == OverwriteMode::Skip ) {
+            return;
+        }
+        if ( overwriteMode() == OverwriteMode::None ) {
+            throw BitException( "Cannot merge the archives",
+                                std::make_error_code( std::errc::file_exists ), outArchive );
+        }
+        if ( !fs::remove( outPath, error ) ) {
+            throw BitException( "Failed to delete the old archive file", error, outArchive );
+        }
+    }
+
+    if ( !mergeRawArchives( inArchives, outPath ) ) {
+        mergeArchives( inArchives, outPath );
+    }
+}
+
+auto BitArchiveMerger::mergeRawArchives( const std::vector< tstring >& inArchives,
+                                         const fs::path& outPath ) const -> bool {
+    std::vector< RawEntriesSource > sources;
+    std::vector< std::vector< MergedItem > > archivesItems;
+    sources.reserve( inArchives.size() );
+    archivesItems.reserve( inArchives.size() );
+    for ( const auto& inArchive : inArchives ) {
+        RawEntriesSource source{ tstring_to_path( inArchive ), {}, {} };
+        if ( !read_raw_entries( compressionFormat(), source ) ) {
+            return false;
+        }
+        std::vector< MergedItem > items;
+        items.reserve( source.entries.size() );
+        for ( const auto& entry : source.entries ) {
+            items.push_back( { entry.path, entry.isDir } );
+        }
+        archivesItems.push_back( std::move( items ) );
+        sources.push_back( std::move( source ) );
+    }
+
+    const auto selectedItems = select_merged_items( archivesItems, mMergePolicy );
+    for ( std::size_t archive = 0; archive < sources.size(); ++archive ) {
+        auto& entries = sources[ archive ].entries;
+        std::size_t keptCount = 0;
+        for ( std::size_t index = 0; index < entries.size(); ++index ) {
+            if ( selectedItems[ archive ][ index ] ) {
+                entries[ keptCount++ ] = std::move( entries[ index ] );
+            }
+        }
+        entries.resize( keptCount );
+    }
+    return write_raw_archive( compressionFormat(), sources, outPath );
+}
+
+void BitArchiveMerger::mergeArchives( const std::vector< tstring >& inArchives, const fs::path& outPath ) const {
+    std::vector< std::unique_ptr< BitInputArchive > > archives;
+    std::vector< std::vector< MergedItem > > archivesItems;
+    archives.reserve( inArchives.size() );
+    archivesItems.reserve( inArchives.size() );
+    for ( const auto& inArchive : inArchives ) {
+        archives.push_back( std::make_unique< BitInputArchive >( *this, inArchive ) );
+        std::vector< MergedItem > items;
+        items.reserve( archives.back()->itemsCount() );
+        for ( const auto& item : *archives.back() ) {
+            items.push_back( { fs::path( item.nativePath() ).generic_u8string(), item.isDir() } );
+        }
+        archivesItems.push_back( std::move( items ) );
+    }
+    const auto selectedItems = select_merged_items( archivesItems, mMergePolicy );
+
+    /* The items of the biggest archive are copied as they are (for 7z archives, 7-Zip copies whole solid blocks
+     * if all their items are kept), while the items of the other archives must be extracted and recompressed. */
+    std::size_t baseArchive = 0;
+    uint64_t baseArchiveSize = 0;
+    for ( std::size_t archive = 0; archive < inArchives.size(); ++archive ) {
+        std::error_code error;
+        const auto archiveSize = static_cast< uint64_t >( fs::file_size( tstring_to_path( inArchives[ archive ] ),
+                                                                         error ) );
+        if ( !error && archiveSize > baseArchiveSize ) {
+            baseArchive = archive;
+            baseArchiveSize = archiveSize;
+        }
+    }
+
+    std::unordered_set< std::string > baseFolders;
+    for ( std::size_t index = 0; index < archivesItems[ baseArchive ].size(); ++index ) {
+        if ( selectedItems[ baseArchive ][ index ] && archivesItems[ baseArchive ][ index ].isDir ) {
+            baseFolders.insert( archivesItems[ baseArchive ][ index ].path );
+        }
+    }
+
+    MergeOutputArchive outputArchive{ *this };
+    outputArchive.setBaseArchive( std::move( archives[ baseArchive ] ), selectedItems[ baseArchive ] );
+
+    // Note: the directory is next to the output archive, so that the extracted items are on the same volume.
+    const TempDirectory extractionDir{ outPath, ".merge" };
+    for ( std::size_t archive = 0; archive < archives.size(); ++archive ) {
+        if ( archive == baseArchive ) {
+            continue;
+        }
+        std::vector< uint32_t > indices;
+        for ( uint32_t index = 0; index < selectedItems[ archive ].size(); ++index ) {
+            if ( selectedItems[ archive ][ index ] ) {
+                indices.push_back( index );
+            }
+        }
+        if ( indices.empty() ) {
+            continue;
+        }
+        const fs::path archiveDir = extractionDir.path() / std::to_string( archive );
+        archives[ archive ]->extractTo( path_to_tstring( archiveDir ), indices );
+        outputArchive.addExtractedItems( archiveDir );
+    }
+    outputArchive.removeDuplicateFolders( std::move( baseFolders ) );
+    outputArchive.compressTo( path_to_tstring( outPath ) );
+}
+
+}  // namespace bit7z
@@ -0,0 +1,201 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <exception>
+#include <thread>
+
+#include "bitarchivereader.hpp"
+#include "bitarchiverepacker.hpp"
+#include "bitexception.hpp"
+#include "bitoutputarchive.hpp"
+#include "internal/dateutil.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/itempipeline.hpp"
+#include "internal/pipeextractcallback.hpp"
+#include "internal/stringutil.hpp"
+#include "internal/util.hpp"
+
+namespace bit7z {
+
+constexpr uint64_t kDefaultPipeCapacity = 4 * 1024 * 1024; // 4 MiB
+constexpr uint64_t kDefaultMemoryLimit = 64 * 1024 * 1024; // 64 MiB
+
+/* An item of the archive being repacked, whose content is read from the pipeline.
+ * Note: the properties of the item are read in advance, since the input archive is used by the extraction thread
+ *       while the item is being compressed. */
+class RepackItem final : public GenericInputItem {
+    public:
+        RepackItem( const BitInputArchive& archive, const BitArchiveItemOffset& item, ItemPipeline& pipeline )
+            : mPipeline{ pipeline },
+              mIndex{ item.index() },
+              mPath{ item.nativePath() },
+              mIsDir{ item.isDir() },
+              mIsSymLink{ item.isSymLink() },
+              mSize{ item.size() },
+              mAttributes{ item.attributes() },
+              mCreationTime{ itemTime( archive, BitProperty::CTime ) },
+              mLastAccessTime{ itemTime( archive, BitProperty::ATime ) },
+              mLastWriteTime{ itemTime( archive, BitProperty::MTime ) } {}
+
+        BIT7Z_NODISCARD auto name() const -> tstring override {
+            return path_to_tstring( mPath.filename() );
+        }
+
+        BIT7Z_NODISCARD auto path() const -> tstring override {
+            return path_to_tstring( mPath );
+        }
+
+        BIT7Z_NODISCARD auto inArchivePath() const -> fs::path override {
+            return mPath;
+        }
+
+        BIT7Z_NODISCARD auto isDir() const noexcept -> bool override {
+            return mIsDir;
+        }
+
+        BIT7Z_NODISCARD auto isSymLink() const -> bool override {
+            return mIsSymLink;
+        }
+
+        BIT7Z_NODISCARD auto size() const noexcept -> uint64_t override {
+            return mSize;
+        }
+
+        BIT7Z_NODISCARD auto attributes() const noexcept -> uint32_t override {
+            return mAttributes;
+        }
+
+        BIT7Z_NODISCARD auto creationTime() const noexcept -> FILETIME override {
+            return mCreationTime;
+        }
+
+        BIT7Z_NODISCARD auto lastAccessTime() const noexcept -> FILETIME override {
+            return mLastAccessTime;
+        }
+
+        BIT7Z_NODISCARD auto lastWriteTime() const noexcept -> FILETIME override {
+            return mLastWriteTime;
+        }
+
+        BIT7Z_NODISCARD auto getStream( ISequentialInStream** inStream ) const -> HRESULT override {
+            if ( mIsDir ) {
+                return E_FAIL;
+            }
+            *inStream = mPipeline.inStream( mIndex ).Detach();
+            return S_OK;
+        }
+
+    private:
+        ItemPipeline& mPipeline;
+        uint32_t mIndex;
+        fs::path mPath;
+        bool mIsDir;
+        bool mIsSymLink;
+        uint64_t mSize;
+        uint32_t mAttributes;
+        FILETIME mCreationTime;
+        FILETIME mLastAccessTime;
+        FILETIME mLastWriteTime;
+
+        auto itemTime( const BitInputArchive& archive, BitProperty property ) const -> FILETIME {
+            const auto time = archive.itemProperty( mIndex, property );
+            return time.isFileTime() ? time.getFileTime() : current_file_time();
+        }
+};
+
+class RepackOutputArchive final : public BitOutputArchive {
+    public:
+        explicit RepackOutputArchive( const BitAbstractArchiveCreator& creator ) : BitOutputArchive( creator ) {}
+
+        void addItem( const BitInputArchive& archive, const BitArchiveItemOffset& item, ItemPipeline& pipeline ) {
+            newItems().append( std::make_unique< RepackItem >( archive, item, pipeline ) );
+        }
+};
+
+BitArchiveRepacker::BitArchiveRepacker( const Bit7zLibrary& lib, const BitInOutFormat& format )
+    : BitAbstractArchiveCreator( lib, format ),
+      mPipeCapacity{ kDefaultPipeCapacity },
+      mMemoryLimit{ kDefaultMemoryLimit } {}
+
+void BitArchiveRepacker::setPipeCapacity( uint64_t capacity ) noexcept {
+    mPipeCapacity = capacity;
+}
+
+auto BitArchiveRepacker::pipeCapacity() const noexcept -> uint64_t {
+    return mPipeCapacity;
+}
+
+void BitArchiveRepacker::setMemoryLimit( uint64_t limit ) noexcept {
+    mMemoryLimit = limit;
+}
+
+auto BitArchiveRepacker::memoryLimit() const noexcept -> uint64_t {
+    return mMemoryLimit;
+}
+
+void BitArchiveRepacker::repack( const tstring& inArchive,
+                                 const tstring& outArchive,
+                                 const BitInFormat& inFormat,
+                                 const tstring& inPassword ) const {
+    std::error_code error;
+    if ( fs::equivalent( tstring_to_path( inArchive ), tstring_to_path( outArchive ), error ) ) {
+        throw BitException( "Cannot repack the archive",
+                            std::make_error_code( std::errc::invalid_argument ), outArchive );
+    }
+
+    const BitArchiveReader reader{ library(), inArchive, inFormat, inPassword };
+    const BitInputArchive& sourceArchive = reader;
+    ItemPipeline pipeline{ sourceArchive.itemsCount(), mPipeCapacity, mMemoryLimit, tstring_to_path( outArchive ) };
+
+    RepackOutputArchive outputArchive{ *this };
+    std::vector< uint32_t > fileIndices;
+    for ( const auto& item : sourceArchive ) {
+        outputArchive.addItem( sourceArchive, item, pipeline );
+        if ( !item.isDir() ) {
+            fileIndices.push_back( item.index() );
+        }
+    }
+    if ( fileIndices.empty() ) {
+        outputArchive.compressTo( outArchive );
+        return;
+    }
+
+    std::exception_ptr extractionError;
+    std::thread extractor{ [ & ]() {
+        try {
+            auto callback = bit7z::make_com< PipeExtractCallback, ExtractCallback >( sourceArchive, pipeline );
+            extract_arc( sourceArchive.mInArchive, fileIndices, callback );
+        } catch ( ... ) {
+            if ( !pipeline.isCancelled() ) { // Otherwise, the extraction was stopped by a compression failure.
+                extractionError = std::current_exception();
+            }
+        }
+        pipeline.finish();
+    } };
+
+    std::exception_ptr compressionError;
+    try {
+        outputArchive.compressTo( outArchive );
+    } catch ( ... ) {
+        compressionError = std::current_exception();
+    }
+    /* Note: if the compression succeeded, all the items were completely read, so the extraction has already ended
+     * (or it's ending); otherwise, we stop the extraction, which might be waiting for a full pipe to be read. */
+    pipeline.cancel();
+    extractor.join();
+    if ( compressionError ) {
+        // An extraction error (e.g., a wrong password) is the actual cause of the compression failure.
+        std::rethrow_exception( extractionError ? extractionError : compressionError );
+    }
+}
+
+}  // namespace bit7z
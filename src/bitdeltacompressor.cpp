@@ -0,0 +1,84 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+
+#include "bitdeltacompressor.hpp"
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "bitoutputarchive.hpp"
+#include "internal/archivechain.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/itemcomparison.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+class DeltaOutputArchive final : public BitOutputArchive {
+    public:
+        explicit DeltaOutputArchive( const BitAbstractArchiveCreator& creator ) : BitOutputArchive( creator ) {}
+
+        // Whether one of the new items has the path reserved to the manifest of delta archives.
+        auto hasManifestPath() -> bool {
+            const auto& items = newItems();
+            return std::any_of( items.cbegin(), items.cend(), []( const GenericInputItemPtr& item ) -> bool {
+                return path_to_tstring( item->inArchivePath() ) == kDeltaManifestName;
+            } );
+        }
+
+        // Removes the new items equal to the ones of the chain, and returns their paths.
+        auto extractUnchangedItems( const ArchiveChain& chain ) -> std::vector< tstring > {
+            const BitInFormat& format = creator().compressionFormat();
+            const SyncOptions& options = creator().syncOptions();
+
+            std::vector< tstring > unchangedPaths;
+            (void)newItems().extract( [ & ]( const GenericInputItem& newItem ) -> bool {
+                auto path = path_to_tstring( newItem.inArchivePath() );
+                const ChainedItem* chainedItem = chain.find( path );
+                if ( chainedItem == nullptr ||
+                     !is_unchanged_item( chain.archive( chainedItem->archive ), chainedItem->index,
+                                         newItem, format, options ) ) {
+                    return false;
+                }
+                unchangedPaths.push_back( std::move( path ) );
+                return true;
+            } );
+            return unchangedPaths;
+        }
+};
+
+BitDeltaCompressor::BitDeltaCompressor( const Bit7zLibrary& lib, const BitInOutFormat& format )
+    : BitAbstractArchiveCreator( lib, format ) {}
+
+void BitDeltaCompressor::compressDelta( const std::vector< tstring >& baseChain,
+                                        const std::vector< tstring >& inPaths,
+                                        const tstring& outFile ) const {
+    if ( !compressionFormat().hasFeature( FormatFeatures::MultipleFiles ) ) {
+        throw BitException( "Cannot create the delta archive",
+                            make_error_code( BitError::FormatFeatureNotSupported ) );
+    }
+
+    const ArchiveChain chain{ *this, baseChain };
+    DeltaOutputArchive outputArchive{ *this };
+    outputArchive.addItems( inPaths );
+    if ( outputArchive.hasManifestPath() ) {
+        throw BitException( "Cannot create the delta archive", std::make_error_code( std::errc::invalid_argument ),
+                            kDeltaManifestName );
+    }
+
+    // Note: the manifest is written even if empty, since it marks the archive as a delta archive.
+    const buffer_t manifest = make_delta_manifest( outputArchive.extractUnchangedItems( chain ) );
+    outputArchive.addFile( manifest, kDeltaManifestName );
+    outputArchive.compressTo( outFile );
+}
+
+}  // namespace bit7z
@@ -0,0 +1,88 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitdeltareader.hpp"
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "internal/archivechain.hpp"
+#include "internal/operationresult.hpp"
+
+namespace bit7z {
+
+BitDeltaReader::BitDeltaReader( const Bit7zLibrary& lib,
+                                const std::vector< tstring >& archiveChain,
+                                const BitInFormat& format,
+                                const tstring& password )
+    : BitAbstractArchiveOpener( lib, format, password ),
+      mChain{ std::make_unique< ArchiveChain >( *this, archiveChain ) } {}
+
+BitDeltaReader::~BitDeltaReader() = default;
+
+auto BitDeltaReader::items() const -> std::vector< BitArchiveItemInfo > {
+    std::vector< BitArchiveItemInfo > result;
+    result.reserve( mChain->items().size() );
+    uint32_t index = 0;
+    for ( const auto& chainedItem : mChain->items() ) {
+        const BitInputArchive& archive = mChain->archive( chainedItem.second.archive );
+        BitArchiveItemInfo item( index++ );
+        for ( uint32_t j = kpidNoProperty; j <= kpidCopyLink; ++j ) {
+            const auto property = static_cast< BitProperty >( j );
+            const auto propertyValue = archive.itemProperty( chainedItem.second.index, property );
+            if ( !propertyValue.isEmpty() ) {
+                item.setProperty( property, propertyValue );
+            }
+        }
+        result.push_back( std::move( item ) );
+    }
+    return result;
+}
+
+auto BitDeltaReader::itemsCount() const -> uint32_t {
+    return static_cast< uint32_t >( mChain->items().size() );
+}
+
+auto BitDeltaReader::contains( const tstring& path ) const -> bool {
+    return mChain->find( path ) != nullptr;
+}
+
+void BitDeltaReader::extractTo( const tstring& outDir ) const {
+    // Each archive of the chain extracts the items that are read from it.
+    std::vector< std::vector< uint32_t > > archivesIndices( mChain->archivesCount() );
+    for ( const auto& chainedItem : mChain->items() ) {
+        archivesIndices[ chainedItem.second.archive ].push_back( chainedItem.second.index );
+    }
+    for ( std::size_t archive = 0; archive < archivesIndices.size(); ++archive ) {
+        if ( !archivesIndices[ archive ].empty() ) {
+            mChain->archive( archive ).extractTo( outDir, archivesIndices[ archive ] );
+        }
+    }
+}
+
+void BitDeltaReader::extractTo( std::vector< byte_t >& outBuffer, uint32_t index ) const {
+    if ( index >= itemsCount() ) {
+        throw BitException( "Cannot extract item at the index " + std::to_string( index ),
+                            make_error_code( BitError::InvalidIndex ) );
+    }
+    const auto& chainedItem = mChain->items()[ index ].second;
+    mChain->archive( chainedItem.archive ).extractTo( outBuffer, chainedItem.index );
+}
+
+void BitDeltaReader::extractTo( std::map< tstring, std::vector< byte_t > >& outMap ) const {
+    for ( const auto& chainedItem : mChain->items() ) {
+        const BitInputArchive& archive = mChain->archive( chainedItem.second.archive );
+        if ( !archive.isItemFolder( chainedItem.second.index ) ) {
+            archive.extractTo( outMap[ chainedItem.first ], chainedItem.second.index );
+        }
+    }
+}
+
+}  // namespace bit7z
@@ -0,0 +1,163 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "bithasher.hpp"
+#include "bititemsvector.hpp"
+#include "internal/com.hpp"
+#include "internal/encodermemory.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/hasher.hpp"
+#include "internal/stringutil.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+BitHasher::BitHasher( const Bit7zLibrary& lib, std::vector< DigestType > types )
+    : mLibrary{ lib }, mDigestTypes{ std::move( types ) }, mThreadsCount{ 0 } {}
+
+auto BitHasher::library() const noexcept -> const Bit7zLibrary& {
+    return mLibrary;
+}
+
+auto BitHasher::digestTypes() const -> const std::vector< DigestType >& {
+    return mDigestTypes;
+}
+
+auto BitHasher::threadsCount() const noexcept -> uint32_t {
+    return mThreadsCount;
+}
+
+void BitHasher::setDigestTypes( const std::vector< DigestType >& types ) {
+    mDigestTypes = types;
+}
+
+void BitHasher::setThreadsCount( uint32_t threadsCount ) noexcept {
+    mThreadsCount = threadsCount;
+}
+
+auto hash_item( const GenericInputItem& item, ItemHasher& hasher ) -> HRESULT {
+    CMyComPtr< ISequentialInStream > inStream;
+    const HRESULT result = item.getStream( &inStream );
+    if ( result != S_OK ) {
+        return result;
+    }
+    return inStream == nullptr ? E_FAIL : hash_stream( inStream, hasher );
+}
+
+auto BitHasher::hashFile( const tstring& inFile ) const -> ItemDigests {
+    BitItemsVector items;
+    items.indexFile( inFile );
+    if ( items[ 0 ].isDir() ) {
+        throw BitException( "Cannot hash the file", make_error_code( BitError::ItemIsAFolder ), inFile );
+    }
+
+    ItemHasher hasher{ mLibrary, mDigestTypes };
+    const HRESULT result = hash_item( items[ 0 ], hasher );
+    if ( result != S_OK ) {
+        throw BitException( "Failed to hash the file", make_hresult_code( result ), inFile );
+    }
+    return hasher.finish();
+}
+
+auto BitHasher::hashBuffer( const std::vector< byte_t >& inBuffer ) const -> ItemDigests {
+    ItemHasher hasher{ mLibrary, mDigestTypes };
+    hasher.update( inBuffer.data(), inBuffer.size() );
+    return hasher.finish();
+}
+
+auto BitHasher::hashStream( std::istream& inStream ) const -> ItemDigests {
+    ItemHasher hasher{ mLibrary, mDigestTypes };
+    if ( !hash_stream( inStream, hasher ) ) {
+        throw BitException( "Failed to hash the stream", std::make_error_code( std::errc::io_error ) );
+    }
+    return hasher.finish();
+}
+
+auto BitHasher::hashFiles( const std::vector< tstring >& inPaths ) const -> HashedFiles {
+    BitItemsVector items;
+    IndexingOptions options{};
+    options.onlyFiles = true;
+    items.indexPaths( inPaths, options );
+    return hashItems( items );
+}
+
+auto BitHasher::hashDirectory( const tstring& inDir, const tstring& filter, bool recursive ) const -> HashedFiles {
+    BitItemsVector items;
+    IndexingOptions options{};
+    options.recursive = recursive;
+    options.onlyFiles = true;
+    items.indexDirectory( tstring_to_path( inDir ), filter, FilterPolicy::Include, options );
+    return hashItems( items );
+}
+
+auto BitHasher::hashItems( const BitItemsVector& items ) const -> HashedFiles {
+    // Looking up the hashers only once (this also checks that all the digest types are supported),
+    // before starting the hashing threads.
+    const ItemHasherFactory hasherFactory{ mLibrary, mDigestTypes };
+
+    std::vector< std::pair< tstring, ItemDigests > > results( items.size() );
+    FailedFiles failedFiles;
+    std::mutex failedFilesMutex;
+    std::atomic< std::size_t > nextItem{ 0 };
+    const auto hashNextItems = [ & ]() {
+        for ( auto index = nextItem++; index < items.size(); index = nextItem++ ) {
+            const auto& item = items[ index ];
+            if ( item.isDir() ) {
+                continue;
+            }
+            ItemHasher hasher{ hasherFactory };
+            const HRESULT result = hash_item( item, hasher );
+            if ( result != S_OK ) {
+                const std::lock_guard< std::mutex > lock{ failedFilesMutex };
+                failedFiles.emplace_back( item.path(), make_hresult_code( result ) );
+                continue;
+            }
+            results[ index ] = { item.path(), hasher.finish() };
+        }
+    };
+
+    const uint32_t threadsCount = mThreadsCount > 0 ? mThreadsCount : default_threads_count();
+    const auto workersCount = ( std::min )( static_cast< std::size_t >( threadsCount ), items.size() );
+    std::vector< std::thread > workers;
+    for ( std::size_t worker = 1; worker < workersCount; ++worker ) {
+        workers.emplace_back( hashNextItems );
+    }
+    hashNextItems();
+    for ( auto& worker : workers ) {
+        worker.join();
+    }
+
+    if ( !failedFiles.empty() ) {
+        throw BitException( "Failed to hash some files",
+                            make_hresult_code( E_FAIL ),
+                            std::move( failedFiles ) );
+    }
+
+    HashedFiles hashedFiles;
+    for ( auto& result : results ) {
+        if ( !result.first.empty() ) {
+            hashedFiles.emplace( std::move( result.first ), std::move( result.second ) );
+        }
+    }
+    return hashedFiles;
+}
+
+}  // namespace bit7z
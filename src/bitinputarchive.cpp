@@ -18,12 +18,15 @@
 
 #include "biterror.hpp"
 #include "bitexception.hpp"
+#include "bitresourcelimits.hpp"
 #include "internal/bufferextractcallback.hpp"
 #include "internal/cbufferinstream.hpp"
 #include "internal/cfileinstream.hpp"
 #include "internal/cmultivolumeinstream.hpp"
+#include "internal/deduplication.hpp"
 #include "internal/fileextractcallback.hpp"
 #include "internal/fixedbufferextractcallback.hpp"
+#include "internal/itemcomparison.hpp"
 #include "internal/streamextractcallback.hpp"
 #include "internal/opencallback.hpp"
 #include "internal/stringutil.hpp"
@@ -31,9 +34,12 @@
 
 #ifdef BIT7Z_AUTO_FORMAT
 #include "internal/formatdetect.hpp"
+#include "internal/guids.hpp"
 #endif
 
 #include <algorithm>
+#include <iterator>
+#include <numeric>
 
 using namespace NWindows;
 using namespace NArchive;
@@ -43,11 +49,12 @@ namespace bit7z {
 void extract_arc( IInArchive* inArchive,
                   const std::vector< uint32_t >& indices,
                   ExtractCallback* extractCallback,
-                  ExtractMode mode = ExtractMode::Extract ) {
+                  ExtractMode mode ) {
     const uint32_t* itemIndices = indices.empty() ? nullptr : indices.data();
     const uint32_t numItems = indices.empty() ?
                               std::numeric_limits< uint32_t >::max() : static_cast< uint32_t >( indices.size() );
 
+    extractCallback->prepareReadAhead( indices );
     const HRESULT res = inArchive->Extract( itemIndices, numItems, static_cast< Int32 >( mode ), extractCallback );
     if ( res != S_OK ) {
         const auto& errorException = extractCallback->errorException();
@@ -59,6 +66,30 @@ void extract_arc( IInArchive* inArchive,
     }
 }
 
+// Whether 7-Zip can use multiple threads to decompress archives of the given format.
+auto has_multithreaded_decoder( const BitInFormat& format ) noexcept -> bool {
+    return format == BitFormat::SevenZip || format == BitFormat::Xz || format == BitFormat::BZip2;
+}
+
+void set_decoder_threads( IInArchive* inArchive, const BitInFormat& format ) {
+    if ( !has_multithreaded_decoder( format ) ) {
+        return;
+    }
+    const uint32_t cpuLimit = default_resource_limits().cpuCount;
+    if ( cpuLimit == 0 ) {
+        return; // No CPU limit: the decoder uses 7-Zip's default number of threads.
+    }
+    CMyComPtr< ISetProperties > setProperties;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if ( inArchive->QueryInterface( ::IID_ISetProperties, reinterpret_cast< void** >( &setProperties ) ) != S_OK ) {
+        return; // The format's handler doesn't support setting properties.
+    }
+    const wchar_t* names[] = { L"mt" }; // NOLINT(*-avoid-c-arrays)
+    const BitPropVariant values[] = { BitPropVariant{ cpuLimit } }; // NOLINT(*-avoid-c-arrays)
+    // Note: the number of threads is only a hint, so we ignore any failure in setting it.
+    setProperties->SetProperties( names, values, 1 );
+}
+
 auto BitInputArchive::openArchiveStream( const fs::path& name, IInStream* inStream ) -> IInArchive* {
 #ifdef BIT7Z_AUTO_FORMAT
     bool detectedBySignature = false;
@@ -77,6 +108,12 @@ auto BitInputArchive::openArchiveStream( const fs::path& name, IInStream* inStre
     // Creating open callback for the file
     auto openCallback = bit7z::make_com< OpenCallback >( mArchiveHandler, name );
 
+#ifdef BIT7Z_AUTO_FORMAT
+    set_decoder_threads( inArchive, *mDetectedFormat );
+#else
+    set_decoder_threads( inArchive, mArchiveHandler.format() );
+#endif
+
     // Trying to open the file with the detected format
 #ifndef BIT7Z_AUTO_FORMAT
     const
@@ -97,6 +134,7 @@ auto BitInputArchive::openArchiveStream( const fs::path& name, IInStream* inStre
         inStream->Seek( 0, STREAM_SEEK_SET, nullptr );
         mDetectedFormat = &( detect_format_from_signature( inStream ) );
         inArchive = mArchiveHandler.library().initInArchive( *mDetectedFormat );
+        set_decoder_threads( inArchive, *mDetectedFormat );
         res = inArchive->Open( inStream, nullptr, openCallback );
     }
 #endif
@@ -221,9 +259,88 @@ auto BitInputArchive::handler() const noexcept -> const BitAbstractArchiveHandle
     return mArchiveHandler;
 }
 
+// The index of the item containing the data of the given item (i.e., its target, if the item is a hard link).
+auto data_index( const BitInputArchive& archive, uint32_t index ) -> uint32_t {
+    if ( !has_hard_links( archive ) ) {
+        return index;
+    }
+    const auto hardLinks = find_hard_links( archive, { index } );
+    return hardLinks.empty() ? index : hardLinks.front().front();
+}
+
+// Extracts the given items (or all the items, if no index is given) of the archive to the given directory.
+void extract_to_directory( IInArchive* inArchive,
+                           const BitInputArchive& archive,
+                           const tstring& outDir,
+                           const std::vector< uint32_t >& indices ) {
+    auto callback = bit7z::make_com< FileExtractCallback >( archive, outDir );
+    const auto& handler = archive.handler();
+    const bool isConditionalOverwrite = is_conditional_overwrite( handler.overwriteMode() );
+    const bool extractsDuplicates = handler.duplicateItemsMode() == DuplicateItemsMode::Extract;
+    const bool hasHardLinks = has_hard_links( archive );
+    if ( !isConditionalOverwrite && extractsDuplicates && !hasHardLinks ) {
+        extract_arc( inArchive, indices, callback );
+        callback->flushOutput();
+        return;
+    }
+
+    // The items whose output files are up to date are excluded in advance, so that 7-Zip can avoid decoding them.
+    std::vector< uint32_t > extractedIndices = isConditionalOverwrite ? callback->outdatedItems( indices ) : indices;
+    if ( isConditionalOverwrite && extractedIndices.empty() ) {
+        return;
+    }
+    if ( extractsDuplicates && !hasHardLinks ) {
+        extract_arc( inArchive, extractedIndices, callback );
+        callback->flushOutput();
+        return;
+    }
+
+    // Only the first item of each set of duplicates is extracted, and the others are then created from it.
+    if ( extractedIndices.empty() ) {
+        extractedIndices.resize( archive.itemsCount() );
+        std::iota( extractedIndices.begin(), extractedIndices.end(), 0 );
+    }
+    auto duplicateSets = extractsDuplicates ? std::vector< std::vector< uint32_t > >{} :
+                         find_archived_duplicates( archive, extractedIndices,
+                                                   handler.duplicateItemsMode() == DuplicateItemsMode::HardLink );
+    if ( hasHardLinks ) {
+        /* Note: the hard links are created after the other duplicates, as their target might be a duplicate itself;
+         *       the links whose target is not extracted (e.g., it was skipped) are extracted as they are stored,
+         *       i.e., as empty files. */
+        auto hardLinks = find_hard_links( archive, extractedIndices );
+        std::move( hardLinks.begin(), hardLinks.end(), std::back_inserter( duplicateSets ) );
+    }
+    std::vector< bool > isDuplicate( archive.itemsCount(), false );
+    for ( const auto& duplicateSet : duplicateSets ) {
+        for ( auto it = std::next( duplicateSet.cbegin() ); it != duplicateSet.cend(); ++it ) {
+            isDuplicate[ *it ] = true;
+        }
+    }
+    extractedIndices.erase( std::remove_if( extractedIndices.begin(), extractedIndices.end(),
+                                            [ &isDuplicate ]( uint32_t index ) -> bool {
+                                                return isDuplicate[ index ];
+                                            } ), extractedIndices.end() );
+    extract_arc( inArchive, extractedIndices, callback );
+    callback->flushOutput(); // The duplicates are created from the output files, which must be complete.
+
+    // The duplicates whose first item was not written (e.g., it was skipped) must be extracted on their own.
+    std::vector< uint32_t > remainingIndices;
+    for ( const auto& duplicateSet : duplicateSets ) {
+        for ( auto it = std::next( duplicateSet.cbegin() ); it != duplicateSet.cend(); ++it ) {
+            if ( !callback->extractDuplicate( duplicateSet.front(), *it ) ) {
+                remainingIndices.push_back( *it );
+            }
+        }
+    }
+    if ( !remainingIndices.empty() ) {
+        std::sort( remainingIndices.begin(), remainingIndices.end() );
+        extract_arc( inArchive, remainingIndices, callback );
+        callback->flushOutput();
+    }
+}
+
 void BitInputArchive::extractTo( const tstring& outDir ) const {
-    auto callback = bit7z::make_com< FileExtractCallback, ExtractCallback >( *this, outDir );
-    extract_arc( mInArchive, {}, callback );
+    extract_to_directory( mInArchive, *this, outDir, {} );
 }
 
 inline auto findInvalidIndex( const std::vector< uint32_t >& indices,
@@ -241,8 +358,7 @@ void BitInputArchive::extractTo( const tstring& outDir, const std::vector< uint3
                             make_error_code( BitError::InvalidIndex ) );
     }
 
-    auto callback = bit7z::make_com< FileExtractCallback, ExtractCallback >( *this, outDir );
-    extract_arc( mInArchive, indices, callback );
+    extract_to_directory( mInArchive, *this, outDir, indices );
 }
 
 void BitInputArchive::extractTo( std::vector< byte_t >& outBuffer, uint32_t index ) const {
@@ -257,7 +373,7 @@ void BitInputArchive::extractTo( std::vector< byte_t >& outBuffer, uint32_t inde
                             make_error_code( BitError::ItemIsAFolder ) );
     }
 
-    const vector< uint32_t > indices( 1, index );
+    const vector< uint32_t > indices( 1, data_index( *this, index ) );
     map< tstring, vector< byte_t > > buffersMap;
     auto extractCallback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, buffersMap );
     extract_arc( mInArchive, indices, extractCallback );
@@ -276,7 +392,7 @@ void BitInputArchive::extractTo( std::ostream& outStream, uint32_t index ) const
                             make_error_code( BitError::ItemIsAFolder ) );
     }
 
-    const vector< uint32_t > indices( 1, index );
+    const vector< uint32_t > indices( 1, data_index( *this, index ) );
     auto extractCallback = bit7z::make_com< StreamExtractCallback, ExtractCallback >( *this, outStream );
     extract_arc( mInArchive, indices, extractCallback );
 }
@@ -318,8 +434,40 @@ void BitInputArchive::extractTo( std::map< tstring, std::vector< byte_t > >& out
         }
     }
 
-    auto extractCallback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, outMap );
+    const auto hardLinks = has_hard_links( *this ) ? find_hard_links( *this, filesIndices )
+                                                   : std::vector< std::vector< uint32_t > >{};
+    if ( hardLinks.empty() ) {
+        auto extractCallback = bit7z::make_com< BufferExtractCallback, ExtractCallback >( *this, outMap );
+        extract_arc( mInArchive, filesIndices, extractCallback );
+        return;
+    }
+
+    // The hard links have no data, so their buffers are copied from the ones of their targets.
+    std::vector< bool > isLink( numberItems, false );
+    for ( const auto& linksSet : hardLinks ) {
+        for ( auto it = std::next( linksSet.cbegin() ); it != linksSet.cend(); ++it ) {
+            isLink[ *it ] = true;
+        }
+    }
+    filesIndices.erase( std::remove_if( filesIndices.begin(), filesIndices.end(),
+                                        [ &isLink ]( uint32_t index ) -> bool {
+                                            return isLink[ index ];
+                                        } ), filesIndices.end() );
+    auto extractCallback = bit7z::make_com< BufferExtractCallback >( *this, outMap );
     extract_arc( mInArchive, filesIndices, extractCallback );
+
+    std::vector< uint32_t > remainingIndices;
+    for ( const auto& linksSet : hardLinks ) {
+        for ( auto it = std::next( linksSet.cbegin() ); it != linksSet.cend(); ++it ) {
+            if ( !extractCallback->extractDuplicate( linksSet.front(), *it ) ) {
+                remainingIndices.push_back( *it );
+            }
+        }
+    }
+    if ( !remainingIndices.empty() ) {
+        std::sort( remainingIndices.begin(), remainingIndices.end() );
+        extract_arc( mInArchive, remainingIndices, extractCallback );
+    }
 }
 
 void BitInputArchive::test() const {
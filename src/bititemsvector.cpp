@@ -10,10 +10,18 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
 #include "bitexception.hpp"
 #include "bititemsvector.hpp"
 #include "internal/bufferitem.hpp"
+#include "internal/deduplication.hpp"
 #include "internal/fsindexer.hpp"
+#include "internal/fsitem.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/hardlinkitem.hpp"
 #include "internal/stdinputitem.hpp"
 #include "internal/stringutil.hpp"
 
@@ -88,6 +96,115 @@ void BitItemsVector::indexStream( std::istream& inStream, const tstring& name )
     mItems.emplace_back( std::make_unique< StdInputItem >( inStream, tstring_to_path( name ) ) );
 }
 
+void BitItemsVector::reorder( ItemsOrder order ) {
+    if ( order == ItemsOrder::Indexing || mItems.size() < 2 ) {
+        return;
+    }
+
+    if ( order == ItemsOrder::Extension ) {
+        reorderByExtension();
+        return;
+    }
+
+    /* Sorting key of each item: items with a known physical offset come first (rank 0),
+     * then items with a known file index (rank 1), and finally all the other items (rank 2). */
+    using SortKey = std::tuple< int, std::uint64_t, std::size_t >;
+    std::vector< SortKey > keys;
+    keys.reserve( mItems.size() );
+    for ( std::size_t index = 0; index < mItems.size(); ++index ) {
+        const auto* fsItem = dynamic_cast< const FilesystemItem* >( mItems[ index ].get() );
+        std::uint64_t location = 0;
+        int rank = 2;
+        if ( fsItem != nullptr ) {
+            if ( order == ItemsOrder::PhysicalOffset && !fsItem->isDir() &&
+                 filesystem::fsutil::get_file_physical_offset( fsItem->filesystemPath(), location ) ) {
+                rank = 0;
+            } else if ( filesystem::fsutil::get_file_index( fsItem->filesystemPath(), location ) ) {
+                rank = 1;
+            }
+        }
+        keys.emplace_back( rank, location, index );
+    }
+    std::sort( keys.begin(), keys.end() );
+
+    GenericInputItemVector sortedItems;
+    sortedItems.reserve( mItems.size() );
+    for ( const auto& key : keys ) {
+        sortedItems.push_back( std::move( mItems[ std::get< 2 >( key ) ] ) );
+    }
+    mItems = std::move( sortedItems );
+}
+
+void BitItemsVector::reorderByExtension() {
+    using SortKey = std::tuple< tstring, tstring, std::size_t >;
+    std::vector< SortKey > keys;
+    keys.reserve( mItems.size() );
+    for ( std::size_t index = 0; index < mItems.size(); ++index ) {
+        const fs::path itemPath = mItems[ index ]->inArchivePath();
+        keys.emplace_back( filesystem::fsutil::extension( itemPath ), path_to_tstring( itemPath ), index );
+    }
+    std::sort( keys.begin(), keys.end() );
+
+    GenericInputItemVector sortedItems;
+    sortedItems.reserve( mItems.size() );
+    for ( const auto& key : keys ) {
+        sortedItems.push_back( std::move( mItems[ std::get< 2 >( key ) ] ) );
+    }
+    mItems = std::move( sortedItems );
+}
+
+auto BitItemsVector::deduplicate( bool useHardLinks ) -> std::vector< DuplicateSet > {
+    const auto duplicates = find_duplicates( *this );
+    if ( duplicates.empty() ) {
+        return {};
+    }
+
+    std::vector< DuplicateSet > result;
+    result.reserve( duplicates.size() );
+    for ( const auto& setItems : duplicates ) {
+        DuplicateSet duplicateSet{ mItems[ setItems.front() ]->size(), {} };
+        for ( const auto index : setItems ) {
+            duplicateSet.paths.push_back( path_to_tstring( mItems[ index ]->inArchivePath() ) );
+        }
+        result.push_back( std::move( duplicateSet ) );
+    }
+
+    if ( useHardLinks ) {
+        // Note: the first item of each set precedes its duplicates, so each hard link follows its target.
+        for ( const auto& setItems : duplicates ) {
+            const fs::path target = mItems[ setItems.front() ]->inArchivePath();
+            for ( auto duplicate = std::next( setItems.begin() ); duplicate != setItems.end(); ++duplicate ) {
+                mItems[ *duplicate ] = std::make_unique< HardLinkItem >( std::move( mItems[ *duplicate ] ), target );
+            }
+        }
+    }
+    return result;
+}
+
+auto BitItemsVector::extract( const std::function< bool( const GenericInputItem& ) >& predicate ) -> BitItemsVector {
+    BitItemsVector result;
+    GenericInputItemVector remainingItems;
+    for ( auto& item : mItems ) {
+        if ( predicate( *item ) ) {
+            result.mItems.push_back( std::move( item ) );
+        } else {
+            remainingItems.push_back( std::move( item ) );
+        }
+    }
+    mItems = std::move( remainingItems );
+    return result;
+}
+
+void BitItemsVector::append( BitItemsVector&& other ) {
+    mItems.reserve( mItems.size() + other.mItems.size() );
+    std::move( other.mItems.begin(), other.mItems.end(), std::back_inserter( mItems ) );
+    other.mItems.clear();
+}
+
+void BitItemsVector::append( GenericInputItemPtr&& item ) {
+    mItems.push_back( std::move( item ) );
+}
+
 auto BitItemsVector::size() const -> size_t {
     return mItems.size();
 }
@@ -10,27 +10,49 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+
 #include "biterror.hpp"
 #include "bitexception.hpp"
 #include "bitoutputarchive.hpp"
 #include "internal/archiveproperties.hpp"
 #include "internal/cbufferoutstream.hpp"
 #include "internal/cmultivolumeoutstream.hpp"
+#include "internal/contentanalysis.hpp"
+#include "internal/cteeoutstream.hpp"
+#include "internal/encodermemory.hpp"
 #include "internal/genericinputitem.hpp"
+#include "internal/hasher.hpp"
+#include "internal/inplaceappend.hpp"
+#include "internal/itemcomparison.hpp"
+#include "internal/itemprefetcher.hpp"
 #include "internal/stringutil.hpp"
 #include "internal/updatecallback.hpp"
 #include "internal/util.hpp"
 
 namespace bit7z {
 
+// The first version of 7-Zip correctly storing the hard links of tar archives (i.e., 23.01).
+constexpr uint32_t kTarHardLinksMinVersion = ( 23u << 16u ) | 1u;
+
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator )
-    : mArchiveCreator{ creator }, mInputArchiveItemsCount{ 0 } {}
+    : mArchiveCreator{ creator },
+      mInputArchiveItemsCount{ 0 },
+      mDeletedItemsCount{ 0 },
+      mStoringItems{ false },
+      mItemsSynced{ false },
+      mArchiveDigestsPending{ false } {}
 
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator, const tstring& inFile )
     : BitOutputArchive( creator, tstring_to_path( inFile ) ) {}
 
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator, const fs::path& inArc )
-    : mArchiveCreator{ creator }, mInputArchiveItemsCount{ 0 } {
+    : mArchiveCreator{ creator },
+      mInputArchiveItemsCount{ 0 },
+      mDeletedItemsCount{ 0 },
+      mStoringItems{ false },
+      mItemsSynced{ false },
+      mArchiveDigestsPending{ false } {
     if ( mArchiveCreator.overwriteMode() != OverwriteMode::None ) {
         return;
     }
@@ -49,6 +71,9 @@ BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator, co
                             make_error_code( BitError::WrongUpdateMode ) );
     }
 
+    // Restoring the archive, if a previous in place append to it was interrupted.
+    recover_interrupted_append( inArc );
+
     if ( !mArchiveCreator.compressionFormat().hasFeature( FormatFeatures::MultipleFiles ) ) {
         //Update mode is set, but the format does not support adding more files.
         throw BitException( "Cannot update the existing archive",
@@ -61,7 +86,12 @@ BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator, co
 
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator,
                                     const std::vector< bit7z::byte_t >& inBuffer )
-    : mArchiveCreator{ creator }, mInputArchiveItemsCount{ 0 } {
+    : mArchiveCreator{ creator },
+      mInputArchiveItemsCount{ 0 },
+      mDeletedItemsCount{ 0 },
+      mStoringItems{ false },
+      mItemsSynced{ false },
+      mArchiveDigestsPending{ false } {
     if ( !inBuffer.empty() ) {
         mInputArchive = std::make_unique< BitInputArchive >( creator, inBuffer );
         mInputArchiveItemsCount = mInputArchive->itemsCount();
@@ -69,13 +99,20 @@ BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator,
 }
 
 BitOutputArchive::BitOutputArchive( const BitAbstractArchiveCreator& creator, std::istream& inStream )
-    : mArchiveCreator{ creator }, mInputArchiveItemsCount{ 0 } {
+    : mArchiveCreator{ creator },
+      mInputArchiveItemsCount{ 0 },
+      mDeletedItemsCount{ 0 },
+      mStoringItems{ false },
+      mItemsSynced{ false },
+      mArchiveDigestsPending{ false } {
     if ( inStream.good() ) {
         mInputArchive = std::make_unique< BitInputArchive >( creator, inStream );
         mInputArchiveItemsCount = mInputArchive->itemsCount();
     }
 }
 
+BitOutputArchive::~BitOutputArchive() = default;
+
 void BitOutputArchive::addItems( const std::vector< tstring >& inPaths ) {
     IndexingOptions options{};
     options.retainFolderStructure = mArchiveCreator.retainDirectories();
@@ -132,12 +169,35 @@ void BitOutputArchive::addDirectory( const tstring& inDir ) {
     mNewItemsVector.indexDirectory( tstring_to_path( inDir ), BIT7Z_STRING( "" ), FilterPolicy::Include, options );
 }
 
+namespace {
+// Returns the files containing the archive at the given path (i.e., the archive itself, or all its volumes).
+auto archive_files( const fs::path& outFile, bool isMultiVolume ) -> std::vector< fs::path > {
+    if ( !isMultiVolume ) {
+        return { outFile };
+    }
+    std::vector< fs::path > volumes;
+    std::error_code error;
+    for ( uint64_t volumeIndex = 1;; ++volumeIndex ) {
+        tstring name = to_tstring( volumeIndex );
+        if ( name.length() < 3 ) {
+            name.insert( 0, 3 - name.length(), BIT7Z_STRING( '0' ) );
+        }
+        fs::path volumePath = outFile;
+        volumePath += BIT7Z_STRING( "." ) + name;
+        if ( !fs::exists( volumePath, error ) ) {
+            return volumes;
+        }
+        volumes.push_back( std::move( volumePath ) );
+    }
+}
+} // namespace
+
 auto BitOutputArchive::initOutArchive() const -> CMyComPtr< IOutArchive > {
     CMyComPtr< IOutArchive > newArc;
-    if ( mInputArchive == nullptr ) {
+    if ( !hasInputArchive() ) {
         newArc = mArchiveCreator.library().initOutArchive( mArchiveCreator.compressionFormat() );
     } else {
-        (void)mInputArchive->initUpdatableArchive( &newArc ); // TODO: Handle errors
+        (void)inputArchive()->initUpdatableArchive( &newArc ); // TODO: Handle errors
     }
     setArchiveProperties( newArc );
     return newArc;
@@ -159,19 +219,51 @@ auto BitOutputArchive::initOutFileStream( const fs::path& outArchive,
 
 void BitOutputArchive::compressOut( IOutArchive* outArc,
                                     IOutStream* outStream,
-                                    UpdateCallback* updateCallback ) {
-    if ( mInputArchive != nullptr && mArchiveCreator.updateMode() == UpdateMode::Update ) {
-        for ( const auto& newItem : mNewItemsVector ) {
-            auto newItemPath = path_to_tstring( newItem->inArchivePath() );
-            auto updatedItem = mInputArchive->find( newItemPath );
-            if ( updatedItem != mInputArchive->cend() ) {
-                setDeletedIndex( updatedItem->index() );
-            }
-        }
+                                    UpdateCallback* updateCallback,
+                                    bool finalOutput ) {
+    if ( hasInputArchive() && effectiveUpdateMode() == UpdateMode::Update ) {
+        deleteUpdatedItems();
+    } else if ( hasInputArchive() && effectiveUpdateMode() == UpdateMode::Sync ) {
+        syncNewItems();
     }
     updateInputIndices();
 
-    const HRESULT result = outArc->UpdateItems( outStream, itemsCount(), updateCallback );
+    mNewItemsVector.reorder( mArchiveCreator.itemsOrder() );
+    if ( mArchiveCreator.deduplicateContent() && !mStoringItems ) {
+        /* Note: older versions of 7-Zip store the hard links of tar archives as empty files,
+         *       so in such cases the duplicates are only reported. */
+        const bool useHardLinks = mArchiveCreator.compressionFormat() == BitFormat::Tar &&
+                                  mArchiveCreator.library().version() >= kTarHardLinksMinVersion;
+        mDuplicateSets = mNewItemsVector.deduplicate( useHardLinks );
+    }
+
+    const uint64_t readAheadBudget = mArchiveCreator.readAheadBudget();
+    if ( readAheadBudget > 0 && mNewItemsVector.size() > 0 ) {
+        uint32_t readAheadThreads = mArchiveCreator.readAheadThreads();
+        if ( readAheadThreads == 0 ) {
+            constexpr auto kMaxDefaultReadAheadThreads = 4u;
+            readAheadThreads = ( std::min )( default_threads_count(), kMaxDefaultReadAheadThreads );
+        }
+        mPrefetcher = std::make_unique< ItemPrefetcher >( mNewItemsVector, readAheadBudget, readAheadThreads );
+    }
+
+    CMyComPtr< IOutStream > archiveStream{ outStream };
+    CMyComPtr< CTeeOutStream > teeStream;
+    if ( finalOutput ) {
+        mArchiveDigests.clear();
+        mArchiveDigestsPending = false;
+        if ( teesOutput() ) {
+            teeStream = bit7z::make_com< CTeeOutStream >( archiveStream,
+                                                          openOutputMirrors(),
+                                                          ItemHasher{ mArchiveCreator.library(),
+                                                                      mArchiveDigestTypes } );
+            archiveStream = teeStream;
+        }
+    }
+
+    const HRESULT result = outArc->UpdateItems( archiveStream, itemsCount(), updateCallback );
+    mPrefetcher.reset();
+    mItemsSynced = false;
 
     if ( result == E_NOTIMPL ) {
         throw BitException( "Unsupported operation", bit7z::make_hresult_code( result ) );
@@ -180,15 +272,34 @@ void BitOutputArchive::compressOut( IOutArchive* outArc,
     if ( result != S_OK ) {
         throw BitException( "Error while compressing files", make_hresult_code( result ), std::move( mFailedFiles ) );
     }
+
+    if ( teeStream && !mArchiveDigestTypes.empty() ) {
+        if ( teeStream->hasValidDigests() ) {
+            mArchiveDigests = teeStream->digests();
+        } else {
+            mArchiveDigestsPending = true; // The caller will compute the digests from the final output.
+        }
+    }
 }
 
-void BitOutputArchive::compressToFile( const fs::path& outFile, UpdateCallback* updateCallback ) {
-    // Note: if mInputArchive != nullptr, newArc will actually point to the same IInArchive object used by the old_arc
+void BitOutputArchive::compressToFile( const fs::path& outFile, UpdateCallback* updateCallback, bool finalOutput ) {
+    // Note: if there's an input archive, newArc will actually point to the same IInArchive object used by the old_arc
     // (see initUpdatableArchive function of BitInputArchive)!
-    const bool updatingArchive = mInputArchive != nullptr && tstring_to_path( mInputArchive->archivePath() ) == outFile;
+    const bool updatingArchive = hasInputArchive() && tstring_to_path( inputArchive()->archivePath() ) == outFile;
+    if ( updatingArchive && canAppendInPlace( outFile ) && appendInPlace( outFile, updateCallback ) ) {
+        return;
+    }
+    if ( updatingArchive && effectiveUpdateMode() == UpdateMode::Sync ) {
+        syncNewItems();
+        // Note: if the output is mirrored or hashed, the whole archive is written again anyway.
+        if ( !hasNewItems() && !hasDeletedIndexes() && !( finalOutput && teesOutput() ) ) { // Already in sync.
+            mItemsSynced = false;
+            return;
+        }
+    }
     const CMyComPtr< IOutArchive > newArc = initOutArchive();
     CMyComPtr< IOutStream > outStream = initOutFileStream( outFile, updatingArchive );
-    compressOut( newArc, outStream, updateCallback );
+    compressOut( newArc, outStream, updateCallback, finalOutput );
 
     if ( updatingArchive ) { //we updated the input archive
         auto closeResult = mInputArchive->close();
@@ -220,6 +331,73 @@ void BitOutputArchive::compressToFile( const fs::path& outFile, UpdateCallback*
     }
 }
 
+auto BitOutputArchive::canAppendInPlace( const fs::path& outFile ) const -> bool {
+    /* Note: appending in place is possible only if the existing items must be left untouched
+     *       (as it happens when storing the incompressible items after the first pass of a zip archive). */
+    const bool appendingItems = mStoringItems || effectiveUpdateMode() == UpdateMode::Append;
+    if ( !appendingItems || mArchiveCreator.volumeSize() > 0 ||
+         !hasNewItems() || hasDeletedIndexes() || teesOutput() ) {
+        return false;
+    }
+    for ( uint32_t index = 0; index < mInputArchiveItemsCount; ++index ) {
+        if ( hasNewData( index ) || hasNewProperties( index ) ) {
+            return false;
+        }
+    }
+    return supports_in_place_append( mArchiveCreator.compressionFormat(), outFile );
+}
+
+auto BitOutputArchive::appendInPlace( const fs::path& outFile, UpdateCallback* updateCallback ) -> bool {
+    fs::path appendedFile = outFile;
+    appendedFile += ".tmp";
+
+    // Compressing only the new items into a temporary archive...
+    unique_ptr< BitInputArchive > inputArchive = std::move( mInputArchive );
+    const uint32_t inputArchiveItemsCount = mInputArchiveItemsCount;
+    mInputArchiveItemsCount = 0;
+    InPlaceAppendPlan plan{};
+    bool canAppend = false;
+    try {
+        const CMyComPtr< IOutArchive > newArc = initOutArchive();
+        CMyComPtr< IOutStream > outStream = initOutFileStream( outFile, true );
+        compressOut( newArc, outStream, updateCallback, false );
+        outStream.Release();
+        canAppend = plan_in_place_append( mArchiveCreator.compressionFormat(), outFile, appendedFile, plan );
+    } catch ( ... ) {
+        mInputArchive = std::move( inputArchive );
+        mInputArchiveItemsCount = inputArchiveItemsCount;
+        std::error_code error;
+        fs::remove( appendedFile, error );
+        throw;
+    }
+    mInputArchive = std::move( inputArchive );
+    mInputArchiveItemsCount = inputArchiveItemsCount;
+
+    /* ...and then moving its entries at the end of the existing archive.
+     * Note: if the resulting archive would need zip64 records, we fall back to rewriting the whole archive
+     *       (this requires reading the new items again, so it will fail for items read from non-seekable streams). */
+    std::error_code error;
+    if ( !canAppend ) {
+        fs::remove( appendedFile, error );
+        return false;
+    }
+
+    const auto closeResult = mInputArchive->close();
+    if ( closeResult != S_OK ) {
+        fs::remove( appendedFile, error );
+        throw BitException( "Failed to close the archive", make_hresult_code( closeResult ),
+                            mInputArchive->archivePath() );
+    }
+    try {
+        apply_in_place_append( plan );
+    } catch ( ... ) {
+        fs::remove( appendedFile, error );
+        throw;
+    }
+    fs::remove( appendedFile, error );
+    return true;
+}
+
 void BitOutputArchive::compressTo( const tstring& outFile ) {
     using namespace bit7z::filesystem;
     const fs::path outPath = tstring_to_path( outFile );
@@ -229,15 +407,41 @@ void BitOutputArchive::compressTo( const tstring& outFile ) {
         if ( overwriteMode == OverwriteMode::Skip ) { // Skipping if the output file already exists
             return;
         }
-        if ( overwriteMode == OverwriteMode::Overwrite && !fs::remove( outPath, error ) ) {
+        if ( overwriteMode != OverwriteMode::None && !fs::remove( outPath, error ) ) {
             throw BitException( "Failed to delete the old archive file", error, outFile );
         }
         // Note: if overwriteMode is OverwriteMode::None, an exception will be thrown by the CFileOutStream constructor
         // called by the initOutFileStream function.
     }
 
-    auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
-    compressToFile( outPath, updateCallback );
+    BitItemsVector storedItems = detachIncompressibleItems();
+    if ( storedItems.size() == 0 ) {
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressToFile( outPath, updateCallback );
+        finishArchiveDigests( outPath );
+        return;
+    }
+
+    // First pass: compressing the compressible items (if any).
+    unique_ptr< BitInputArchive > firstPassArchive;
+    if ( mNewItemsVector.size() > 0 ) {
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressToFile( outPath, updateCallback, false );
+        firstPassArchive = std::make_unique< BitInputArchive >( mArchiveCreator, outPath );
+    }
+
+    /* Second pass: storing the incompressible items, copying the ones compressed by the first pass as they are.
+     * Note: in zip archive files, the stored items are appended in place, without rewriting the first pass' items. */
+    beginStoringItems( storedItems, std::move( firstPassArchive ) );
+    try {
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressToFile( outPath, updateCallback );
+    } catch ( ... ) {
+        endStoringItems( storedItems );
+        throw;
+    }
+    endStoringItems( storedItems );
+    finishArchiveDigests( outPath );
 }
 
 void BitOutputArchive::compressTo( std::vector< byte_t >& outBuffer ) {
@@ -246,28 +450,165 @@ void BitOutputArchive::compressTo( std::vector< byte_t >& outBuffer ) {
         if ( overwriteMode == OverwriteMode::Skip ) {
             return;
         }
-        if ( overwriteMode == OverwriteMode::Overwrite ) {
+        if ( overwriteMode != OverwriteMode::None ) {
             outBuffer.clear();
         } else {
             throw BitException( "Cannot compress to buffer", make_error_code( BitError::NonEmptyOutputBuffer ) );
         }
     }
 
-    const CMyComPtr< IOutArchive > newArc = initOutArchive();
-    auto outMemStream = bit7z::make_com< CBufferOutStream, IOutStream >( outBuffer );
-    auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
-    compressOut( newArc, outMemStream, updateCallback );
+    BitItemsVector storedItems = detachIncompressibleItems();
+    if ( storedItems.size() == 0 ) {
+        const CMyComPtr< IOutArchive > newArc = initOutArchive();
+        auto outMemStream = bit7z::make_com< CBufferOutStream, IOutStream >( outBuffer );
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressOut( newArc, outMemStream, updateCallback );
+        finishArchiveDigests( outBuffer );
+        return;
+    }
+
+    // First pass: compressing the compressible items (if any).
+    std::vector< byte_t > firstPassBuffer;
+    unique_ptr< BitInputArchive > firstPassArchive;
+    if ( mNewItemsVector.size() > 0 ) {
+        const CMyComPtr< IOutArchive > newArc = initOutArchive();
+        auto outMemStream = bit7z::make_com< CBufferOutStream, IOutStream >( firstPassBuffer );
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressOut( newArc, outMemStream, updateCallback, false );
+        firstPassArchive = std::make_unique< BitInputArchive >( mArchiveCreator, firstPassBuffer );
+    }
+
+    // Second pass: storing the incompressible items, copying the ones compressed by the first pass as they are.
+    beginStoringItems( storedItems, std::move( firstPassArchive ) );
+    try {
+        const CMyComPtr< IOutArchive > newArc = initOutArchive();
+        auto outMemStream = bit7z::make_com< CBufferOutStream, IOutStream >( outBuffer );
+        auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
+        compressOut( newArc, outMemStream, updateCallback );
+    } catch ( ... ) {
+        endStoringItems( storedItems );
+        throw;
+    }
+    endStoringItems( storedItems );
+    finishArchiveDigests( outBuffer );
 }
 
 void BitOutputArchive::compressTo( std::ostream& outStream ) {
     const CMyComPtr< IOutArchive > newArc = initOutArchive();
+    const auto startPosition = outStream.tellp();
     auto outStdStream = bit7z::make_com< CStdOutStream, IOutStream >( outStream );
     auto updateCallback = bit7z::make_com< UpdateCallback >( *this );
     compressOut( newArc, outStdStream, updateCallback );
+    outStdStream.Release();
+    finishArchiveDigests( outStream, startPosition );
+}
+
+void BitOutputArchive::addOutputMirror( std::vector< byte_t >& outBuffer ) {
+    mOutputMirrors.push_back( { &outBuffer, {} } );
+}
+
+void BitOutputArchive::addOutputMirror( const tstring& outFile ) {
+    mOutputMirrors.push_back( { nullptr, outFile } );
+}
+
+void BitOutputArchive::clearOutputMirrors() noexcept {
+    mOutputMirrors.clear();
+}
+
+void BitOutputArchive::setArchiveDigestTypes( const std::vector< DigestType >& types ) {
+    mArchiveDigestTypes = types;
+}
+
+auto BitOutputArchive::archiveDigests() const noexcept -> const ItemDigests& {
+    return mArchiveDigests;
+}
+
+auto BitOutputArchive::teesOutput() const noexcept -> bool {
+    return !mOutputMirrors.empty() || !mArchiveDigestTypes.empty();
+}
+
+auto BitOutputArchive::openOutputMirrors() const -> std::vector< CMyComPtr< IOutStream > > {
+    std::vector< CMyComPtr< IOutStream > > mirrorStreams;
+    mirrorStreams.reserve( mOutputMirrors.size() );
+    for ( const auto& mirror : mOutputMirrors ) {
+        if ( mirror.buffer != nullptr ) {
+            mirror.buffer->clear();
+            mirrorStreams.push_back( bit7z::make_com< CBufferOutStream, IOutStream >( *mirror.buffer ) );
+        } else {
+            mirrorStreams.push_back( bit7z::make_com< CFileOutStream, IOutStream >( tstring_to_path( mirror.path ),
+                                                                                    true ) );
+        }
+    }
+    return mirrorStreams;
+}
+
+auto BitOutputArchive::hashMirroredArchive() -> bool {
+    // Reading the archive from a mirror buffer, if any, costs no I/O.
+    const auto mirror = std::find_if( mOutputMirrors.cbegin(), mOutputMirrors.cend(),
+                                      []( const OutputMirror& outputMirror ) -> bool {
+                                          return outputMirror.buffer != nullptr;
+                                      } );
+    if ( mirror == mOutputMirrors.cend() ) {
+        return false;
+    }
+    finishArchiveDigests( *mirror->buffer );
+    return true;
+}
+
+void BitOutputArchive::finishArchiveDigests( const fs::path& outFile ) {
+    if ( !mArchiveDigestsPending || hashMirroredArchive() ) {
+        return;
+    }
+
+    ItemHasher hasher{ mArchiveCreator.library(), mArchiveDigestTypes };
+    for ( const auto& archiveFile : archive_files( outFile, mArchiveCreator.volumeSize() > 0 ) ) {
+        fs::ifstream archiveStream{ archiveFile, std::ios::binary };
+        if ( !archiveStream.is_open() || !hash_stream( archiveStream, hasher ) ) {
+            throw BitException( "Failed to compute the digests of the archive",
+                                std::make_error_code( std::errc::io_error ),
+                                path_to_tstring( archiveFile ) );
+        }
+    }
+    mArchiveDigests = hasher.finish();
+    mArchiveDigestsPending = false;
+}
+
+void BitOutputArchive::finishArchiveDigests( const std::vector< byte_t >& outBuffer ) {
+    if ( !mArchiveDigestsPending ) {
+        return;
+    }
+    ItemHasher hasher{ mArchiveCreator.library(), mArchiveDigestTypes };
+    hasher.update( outBuffer.data(), outBuffer.size() );
+    mArchiveDigests = hasher.finish();
+    mArchiveDigestsPending = false;
+}
+
+void BitOutputArchive::finishArchiveDigests( std::ostream& outStream, std::streampos startPosition ) {
+    if ( !mArchiveDigestsPending || hashMirroredArchive() ) {
+        return;
+    }
+
+    // The archive can be read back only if the output stream is also an input one (e.g., a std::fstream).
+    auto* archiveStream = dynamic_cast< std::istream* >( &outStream );
+    if ( archiveStream == nullptr ) {
+        throw BitException( "Failed to compute the digests of the archive",
+                            std::make_error_code( std::errc::operation_not_supported ) );
+    }
+    ItemHasher hasher{ mArchiveCreator.library(), mArchiveDigestTypes };
+    archiveStream->seekg( startPosition );
+    if ( !hash_stream( *archiveStream, hasher ) ) {
+        throw BitException( "Failed to compute the digests of the archive",
+                            std::make_error_code( std::errc::io_error ) );
+    }
+    archiveStream->clear();
+    mArchiveDigests = hasher.finish();
+    mArchiveDigestsPending = false;
 }
 
 void BitOutputArchive::setArchiveProperties( IOutArchive* outArchive ) const {
-    const ArchiveProperties properties = mArchiveCreator.archiveProperties();
+    const ArchiveProperties properties = mStoringItems ?
+                                         mArchiveCreator.archiveProperties( BitCompressionMethod::Copy ) :
+                                         mArchiveCreator.archiveProperties();
     if ( properties.empty() ) {
         return;
     }
@@ -286,26 +627,147 @@ void BitOutputArchive::setArchiveProperties( IOutArchive* outArchive ) const {
     }
 }
 
+auto BitOutputArchive::detachIncompressibleItems() -> BitItemsVector {
+    /* Note: 7-Zip doesn't allow setting the compression method of each item, so the incompressible items
+     *       are stored by a second update pass, which copies the items compressed by the first one as they are.
+     *       Hence, we do this only when creating new single-volume 7z/zip archives. */
+    const BitInOutFormat& format = mArchiveCreator.compressionFormat();
+    if ( mArchiveCreator.compressionPolicy() != CompressionPolicy::StoreIncompressible ||
+         mArchiveCreator.compressionMethod() == BitCompressionMethod::Copy ||
+         ( format != BitFormat::SevenZip && format != BitFormat::Zip ) ||
+         mArchiveCreator.volumeSize() > 0 ||
+         hasInputArchive() ) {
+        return {};
+    }
+
+    return mNewItemsVector.extract( is_incompressible );
+}
+
+void BitOutputArchive::beginStoringItems( BitItemsVector& storedItems,
+                                          unique_ptr< BitInputArchive >&& firstPassArchive ) {
+    // Note: firstPassArchive is null if all the new items are incompressible.
+    mInputArchive = std::move( firstPassArchive );
+    mInputArchiveItemsCount = mInputArchive != nullptr ? mInputArchive->itemsCount() : 0;
+    std::swap( mNewItemsVector, storedItems );
+    mStoringItems = true;
+}
+
+void BitOutputArchive::endStoringItems( BitItemsVector& storedItems ) noexcept {
+    mStoringItems = false;
+    mInputArchive.reset();
+    mInputArchiveItemsCount = 0;
+    std::swap( mNewItemsVector, storedItems );
+    mNewItemsVector.append( std::move( storedItems ) );
+}
+
+void BitOutputArchive::deleteUpdatedItems() {
+    const auto archivedPaths = index_archived_paths( *inputArchive() );
+    for ( const auto& newItem : mNewItemsVector ) {
+        const auto archivedPath = archivedPaths.find( path_to_tstring( newItem->inArchivePath() ) );
+        if ( archivedPath != archivedPaths.cend() ) {
+            setDeletedIndex( archivedPath->second );
+        }
+    }
+}
+
+void BitOutputArchive::syncNewItems() {
+    if ( mItemsSynced ) {
+        return;
+    }
+    mItemsSynced = true;
+
+    const auto archivedPaths = index_archived_paths( *inputArchive() );
+    const BitInOutFormat& format = mArchiveCreator.compressionFormat();
+    const SyncOptions& options = mArchiveCreator.syncOptions();
+    std::vector< bool > isAddedAgain( mInputArchiveItemsCount, false );
+
+    // The new items equal to the old ones are discarded, while the old items that changed are deleted.
+    (void)mNewItemsVector.extract( [ & ]( const GenericInputItem& newItem ) -> bool {
+        const auto archivedPath = archivedPaths.find( path_to_tstring( newItem.inArchivePath() ) );
+        if ( archivedPath == archivedPaths.cend() ) {
+            return false;
+        }
+        isAddedAgain[ archivedPath->second ] = true;
+        if ( is_unchanged_item( *mInputArchive, archivedPath->second, newItem, format, options ) ) {
+            return true;
+        }
+        setDeletedIndex( archivedPath->second );
+        return false;
+    } );
+
+    if ( options.removeMissing ) {
+        for ( uint32_t index = 0; index < isAddedAgain.size(); ++index ) {
+            if ( !isAddedAgain[ index ] ) {
+                setDeletedIndex( index );
+            }
+        }
+    }
+}
+
+void BitOutputArchive::setInputArchive( std::unique_ptr< BitInputArchive >&& inputArchive ) {
+    mInputArchive = std::move( inputArchive );
+    mDeferredArchivePath.clear();
+    mInputArchiveItemsCount = mInputArchive != nullptr ? mInputArchive->itemsCount() : 0;
+    mDeletedItems.clear();
+    mDeletedItemsCount = 0;
+    mInputIndices.clear();
+}
+
+void BitOutputArchive::setInputArchive( const tstring& archivePath, uint32_t itemsCount ) {
+    mInputArchive.reset();
+    mDeferredArchivePath = archivePath;
+    mInputArchiveItemsCount = itemsCount;
+    mDeletedItems.clear();
+    mDeletedItemsCount = 0;
+    mInputIndices.clear();
+}
+
+auto BitOutputArchive::inputArchive() const -> BitInputArchive* {
+    if ( mInputArchive == nullptr && !mDeferredArchivePath.empty() ) {
+        mInputArchive = std::make_unique< BitInputArchive >( mArchiveCreator, mDeferredArchivePath );
+        mDeferredArchivePath.clear();
+        // Note: the archive should contain exactly the expected items, but we trust what has been actually read.
+        mInputArchiveItemsCount = mInputArchive->itemsCount();
+    }
+    return mInputArchive.get();
+}
+
+void BitOutputArchive::setDeletedIndex( uint32_t index ) {
+    if ( index >= mDeletedItems.size() ) {
+        mDeletedItems.resize( ( std::max )( index + 1, mInputArchiveItemsCount ), false );
+    }
+    if ( !mDeletedItems[ index ] ) {
+        mDeletedItems[ index ] = true;
+        ++mDeletedItemsCount;
+    }
+}
+
 void BitOutputArchive::updateInputIndices() {
-    if ( mDeletedItems.empty() ) {
+    mInputIndices.clear();
+    if ( mDeletedItemsCount == 0 ) {
         return;
     }
 
-    uint32_t offset = 0;
-    for ( uint32_t newIndex = 0; newIndex < itemsCount(); ++newIndex ) {
-        for ( auto it = mDeletedItems.find( newIndex + offset );
-              it != mDeletedItems.end() && *it == newIndex + offset;
-              ++it ) {
-            ++offset;
+    mInputIndices.reserve( itemsCount() );
+    for ( uint32_t index = 0; index < mInputArchiveItemsCount; ++index ) {
+        if ( !isDeletedIndex( index ) ) {
+            mInputIndices.push_back( static_cast< InputIndex >( index ) );
         }
-        mInputIndices.push_back( static_cast< InputIndex >( newIndex + offset ) );
     }
+    const auto newItemsCount = static_cast< uint32_t >( mNewItemsVector.size() );
+    for ( uint32_t index = 0; index < newItemsCount; ++index ) {
+        mInputIndices.push_back( static_cast< InputIndex >( mInputArchiveItemsCount + index ) );
+    }
+}
+
+auto BitOutputArchive::effectiveUpdateMode() const noexcept -> UpdateMode {
+    return mArchiveCreator.updateMode();
 }
 
 auto BitOutputArchive::itemsCount() const -> uint32_t {
     auto result = static_cast< uint32_t >( mNewItemsVector.size() );
-    if ( mInputArchive != nullptr ) {
-        result += mInputArchive->itemsCount() - static_cast< uint32_t >( mDeletedItems.size() );
+    if ( hasInputArchive() ) {
+        result += mInputArchiveItemsCount - mDeletedItemsCount;
     }
     return result;
 }
@@ -320,6 +782,14 @@ auto BitOutputArchive::itemStream( InputIndex index, ISequentialInStream** inStr
     const auto newItemIndex = static_cast< size_t >( index ) - static_cast< size_t >( mInputArchiveItemsCount );
     const GenericInputItem& newItem = mNewItemsVector[ newItemIndex ];
 
+    if ( mPrefetcher != nullptr ) {
+        auto prefetchedStream = mPrefetcher->take( newItemIndex );
+        if ( prefetchedStream != nullptr ) {
+            *inStream = prefetchedStream.Detach();
+            return S_OK;
+        }
+    }
+
     const HRESULT res = newItem.getStream( inStream );
     if ( FAILED( res ) ) {
         auto path = tstring_to_path( newItem.path() );
@@ -371,6 +841,10 @@ auto BitOutputArchive::handler() const noexcept -> const BitAbstractArchiveHandl
     return mArchiveCreator;
 }
 
+auto BitOutputArchive::duplicateSets() const noexcept -> const std::vector< DuplicateSet >& {
+    return mDuplicateSets;
+}
+
 auto BitOutputArchive::creator() const noexcept -> const BitAbstractArchiveCreator& {
     return mArchiveCreator;
 }
@@ -0,0 +1,65 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <mutex>
+
+#include "bitresourcelimits.hpp"
+#include "internal/cgroups.hpp"
+
+namespace bit7z {
+
+struct ResourceLimitsOverride {
+    std::mutex mutex;
+    bool isSet = false;
+    ResourceLimits limits;
+};
+
+auto resource_limits_override() -> ResourceLimitsOverride& {
+    static ResourceLimitsOverride instance;
+    return instance;
+}
+
+auto detected_resource_limits() -> ResourceLimits {
+    static const ResourceLimits limits = []() -> ResourceLimits {
+        ResourceLimits result;
+        result.cpuCount = cgroups::detect_cpu_limit();
+        result.memoryLimit = cgroups::detect_memory_limit();
+        return result;
+    }();
+    return limits;
+}
+
+auto default_resource_limits() -> ResourceLimits {
+    auto& limitsOverride = resource_limits_override();
+    {
+        const std::lock_guard< std::mutex > lock{ limitsOverride.mutex };
+        if ( limitsOverride.isSet ) {
+            return limitsOverride.limits;
+        }
+    }
+    return detected_resource_limits();
+}
+
+void set_default_resource_limits( const ResourceLimits& limits ) {
+    auto& limitsOverride = resource_limits_override();
+    const std::lock_guard< std::mutex > lock{ limitsOverride.mutex };
+    limitsOverride.limits = limits;
+    limitsOverride.isSet = true;
+}
+
+void reset_default_resource_limits() {
+    auto& limitsOverride = resource_limits_override();
+    const std::lock_guard< std::mutex > lock{ limitsOverride.mutex };
+    limitsOverride.isSet = false;
+}
+
+}  // namespace bit7z
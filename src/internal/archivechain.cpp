@@ -0,0 +1,115 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <map>
+
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "internal/archivechain.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+auto make_delta_manifest( const std::vector< tstring >& unchangedPaths ) -> buffer_t {
+    buffer_t manifest;
+    for ( const auto& path : unchangedPaths ) {
+        const std::string utf8Path = tstring_to_path( path ).u8string();
+        manifest.insert( manifest.end(), utf8Path.cbegin(), utf8Path.cend() );
+        manifest.push_back( static_cast< byte_t >( '\n' ) );
+    }
+    return manifest;
+}
+
+auto parse_delta_manifest( const buffer_t& manifest ) -> std::vector< tstring > {
+    std::vector< tstring > unchangedPaths;
+    auto lineStart = manifest.cbegin();
+    while ( lineStart != manifest.cend() ) {
+        auto lineEnd = std::find( lineStart, manifest.cend(), static_cast< byte_t >( '\n' ) );
+        if ( lineEnd != lineStart ) {
+            const std::string utf8Path{ lineStart, lineEnd };
+            unchangedPaths.push_back( path_to_tstring( fs::u8path( utf8Path ) ) );
+        }
+        lineStart = lineEnd == manifest.cend() ? lineEnd : lineEnd + 1;
+    }
+    return unchangedPaths;
+}
+
+ArchiveChain::ArchiveChain( const BitAbstractArchiveHandler& handler, const std::vector< tstring >& archivePaths ) {
+    if ( archivePaths.empty() ) {
+        throw BitException( "Cannot open the chain of archives", make_error_code( BitError::InvalidDeltaChain ) );
+    }
+
+    std::map< tstring, ChainedItem > chainItems;
+    mArchives.reserve( archivePaths.size() );
+    for ( const auto& archivePath : archivePaths ) {
+        mArchives.push_back( std::make_unique< BitInputArchive >( handler, archivePath ) );
+        const std::size_t archiveIndex = mArchives.size() - 1;
+        const BitInputArchive& archive = *mArchives.back();
+
+        std::map< tstring, ChainedItem > items;
+        bool hasManifest = false;
+        uint32_t manifestIndex = 0;
+        for ( const auto& item : archive ) {
+            if ( item.path() == kDeltaManifestName ) {
+                hasManifest = true;
+                manifestIndex = item.index();
+                continue;
+            }
+            items.emplace( item.path(), ChainedItem{ archiveIndex, item.index() } );
+        }
+
+        // An archive without a manifest is a full archive, so it doesn't depend on the previous ones.
+        if ( hasManifest ) {
+            if ( archiveIndex == 0 ) {
+                throw BitException( "The base archive of the chain is a delta archive",
+                                    make_error_code( BitError::InvalidDeltaChain ), archivePath );
+            }
+            buffer_t manifest;
+            archive.extractTo( manifest, manifestIndex );
+            for ( const auto& unchangedPath : parse_delta_manifest( manifest ) ) {
+                const auto previousItem = chainItems.find( unchangedPath );
+                if ( previousItem == chainItems.cend() ) {
+                    throw BitException( "The delta archive refers to an item not found in the previous archives",
+                                        make_error_code( BitError::InvalidDeltaChain ), archivePath );
+                }
+                items.emplace( unchangedPath, previousItem->second );
+            }
+        }
+        chainItems = std::move( items );
+    }
+    // Note: the items are stored in a vector (sorted by path, like the map), so that they can be accessed by index.
+    mItems.assign( chainItems.cbegin(), chainItems.cend() );
+}
+
+auto ArchiveChain::archive( std::size_t index ) const -> const BitInputArchive& {
+    return *mArchives[ index ];
+}
+
+auto ArchiveChain::archivesCount() const noexcept -> std::size_t {
+    return mArchives.size();
+}
+
+auto ArchiveChain::items() const noexcept -> const std::vector< std::pair< tstring, ChainedItem > >& {
+    return mItems;
+}
+
+auto ArchiveChain::find( const tstring& path ) const -> const ChainedItem* {
+    const auto item = std::lower_bound( mItems.cbegin(), mItems.cend(), path,
+                                        []( const std::pair< tstring, ChainedItem >& chainedItem,
+                                            const tstring& itemPath ) -> bool {
+                                            return chainedItem.first < itemPath;
+                                        } );
+    return item != mItems.cend() && item->first == path ? &item->second : nullptr;
+}
+
+}  // namespace bit7z
@@ -0,0 +1,65 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ARCHIVECHAIN_HPP
+#define ARCHIVECHAIN_HPP
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "bitabstractarchivehandler.hpp"
+#include "bitinputarchive.hpp"
+
+namespace bit7z {
+
+/**
+ * The name of the item containing the manifest of a delta archive, i.e., the list of the paths of the items
+ * that are unchanged with respect to the previous archives in the chain (one UTF-8 path per line).
+ */
+constexpr auto kDeltaManifestName = BIT7Z_STRING( ".bit7z-delta" );
+
+auto make_delta_manifest( const std::vector< tstring >& unchangedPaths ) -> buffer_t;
+
+auto parse_delta_manifest( const buffer_t& manifest ) -> std::vector< tstring >;
+
+/**
+ * The location of an item of a chain of archives.
+ */
+struct ChainedItem {
+    std::size_t archive; // The index of the archive in the chain.
+    uint32_t index;      // The index of the item in the archive.
+};
+
+/**
+ * A chain of archives made of a base archive followed by zero or more delta archives,
+ * each containing only the items changed with respect to the previous ones (plus a manifest of the unchanged items).
+ */
+class ArchiveChain final {
+    public:
+        ArchiveChain( const BitAbstractArchiveHandler& handler, const std::vector< tstring >& archivePaths );
+
+        BIT7Z_NODISCARD auto archive( std::size_t index ) const -> const BitInputArchive&;
+
+        BIT7Z_NODISCARD auto archivesCount() const noexcept -> std::size_t;
+
+        /* The items of the chain as a whole (i.e., the items of the last archive plus the ones in its manifest),
+         * sorted by path. */
+        BIT7Z_NODISCARD auto items() const noexcept -> const std::vector< std::pair< tstring, ChainedItem > >&;
+
+        BIT7Z_NODISCARD auto find( const tstring& path ) const -> const ChainedItem*;
+
+    private:
+        std::vector< std::unique_ptr< BitInputArchive > > mArchives;
+        std::vector< std::pair< tstring, ChainedItem > > mItems;
+};
+
+}  // namespace bit7z
+
+#endif //ARCHIVECHAIN_HPP
@@ -10,8 +10,6 @@
 #ifndef ARCHIVEPROPERTIES_HPP
 #define ARCHIVEPROPERTIES_HPP
 
-#include <map>
-#include <string>
 #include <vector>
 
 #include "bitpropvariant.hpp"
@@ -34,13 +32,6 @@ class ArchiveProperties final {
             mValues.emplace_back( value );
         }
 
-        void addProperties( const std::map< std::wstring, BitPropVariant >& otherProperties ) {
-            for ( const auto& entry : otherProperties ) {
-                mNames.emplace_back( entry.first.c_str() );
-                mValues.emplace_back( entry.second );
-            }
-        }
-
         friend class BitAbstractArchiveCreator;
 
     public:
@@ -30,40 +30,36 @@ void BufferExtractCallback::releaseStream() {
     mOutMemStream.Release();
 }
 
-auto BufferExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT {
-    if ( isItemFolder( index ) ) {
-        return S_OK;
-    }
-
-    // Get Name
+auto BufferExtractCallback::bufferPath( uint32_t index, tstring& path ) const -> bool {
     const BitPropVariant prop = itemProperty( index, BitProperty::Path );
-    tstring fullPath;
-
     if ( prop.isEmpty() ) {
-        fullPath = kEmptyFileAlias;
+        path = kEmptyFileAlias;
     } else if ( prop.isString() ) {
         if ( !mHandler.retainDirectories() ) {
-            fullPath = path_to_tstring( fs::path{ prop.getNativeString() }.filename() );
+            path = path_to_tstring( fs::path{ prop.getNativeString() }.filename() );
         } else {
-            fullPath = prop.getString();
+            path = prop.getString();
         }
     } else {
-        return E_FAIL;
+        return false;
     }
+    return true;
+}
 
+auto BufferExtractCallback::outputBuffer( const tstring& path ) -> vector< byte_t >* {
     if ( mHandler.fileCallback() ) {
-        mHandler.fileCallback()( fullPath );
+        mHandler.fileCallback()( path );
     }
 
     //Note: using [] operator it creates the buffer if it does not already exist!
-    auto& outBuffer = mBuffersMap[ fullPath ];
+    auto& outBuffer = mBuffersMap[ path ];
     if ( !outBuffer.empty() ) {
         switch ( mHandler.overwriteMode() ) {
             case OverwriteMode::None: {
                 throw BitException( "Cannot erase output buffer", make_hresult_code( E_ABORT ) );
             }
             case OverwriteMode::Skip: {
-                return S_OK;
+                return nullptr;
             }
             case OverwriteMode::Overwrite:
             default: {
@@ -72,11 +68,47 @@ auto BufferExtractCallback::getOutStream( uint32_t index, ISequentialOutStream**
             }
         }
     }
+    return &outBuffer;
+}
 
-    auto outStreamLoc = bit7z::make_com< CBufferOutStream, ISequentialOutStream >( outBuffer );
+auto BufferExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT {
+    if ( isItemFolder( index ) ) {
+        return S_OK;
+    }
+
+    tstring fullPath;
+    if ( !bufferPath( index, fullPath ) ) {
+        return E_FAIL;
+    }
+    auto* outBuffer = outputBuffer( fullPath );
+    if ( outBuffer == nullptr ) {
+        return S_OK;
+    }
+
+    auto outStreamLoc = bit7z::make_com< CBufferOutStream, ISequentialOutStream >( *outBuffer );
     mOutMemStream = outStreamLoc;
     *outStream = outStreamLoc.Detach();
     return S_OK;
 }
 
+auto BufferExtractCallback::extractDuplicate( uint32_t sourceIndex, uint32_t index ) -> bool {
+    tstring sourcePath;
+    tstring path;
+    if ( !bufferPath( sourceIndex, sourcePath ) || !bufferPath( index, path ) ) {
+        return false;
+    }
+    const auto source = mBuffersMap.find( sourcePath );
+    if ( source == mBuffersMap.cend() ) {
+        return false;
+    }
+    if ( path == sourcePath ) { // E.g., when not retaining the directories of the items.
+        return true;
+    }
+    auto* outBuffer = outputBuffer( path );
+    if ( outBuffer != nullptr ) {
+        *outBuffer = source->second; // Note: the elements of a std::map are never moved by an insertion.
+    }
+    return true;
+}
+
 } // namespace bit7z
\ No newline at end of file
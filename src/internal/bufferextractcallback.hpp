@@ -35,12 +35,26 @@ class BufferExtractCallback final : public ExtractCallback {
 
         ~BufferExtractCallback() override = default;
 
+        /**
+         * Copies the buffer of an already extracted item to the buffer of another item having the same content
+         * (e.g., a hard link to it).
+         *
+         * @return false if the source item was not extracted (so the item must be extracted on its own).
+         */
+        auto extractDuplicate( uint32_t sourceIndex, uint32_t index ) -> bool;
+
     private:
         map< tstring, vector< byte_t > >& mBuffersMap;
         CMyComPtr< ISequentialOutStream > mOutMemStream;
 
         void releaseStream() override;
 
+        // The key of the given item in the map of buffers.
+        auto bufferPath( uint32_t index, tstring& path ) const -> bool;
+
+        // The buffer where the item with the given path must be extracted (nullptr if it must be skipped).
+        auto outputBuffer( const tstring& path ) -> vector< byte_t >*;
+
         auto getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT override;
 };
 
@@ -0,0 +1,246 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "internal/cgroups.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace cgroups {
+
+// Memory limits greater than this value are the way cgroups v1 represent the absence of a limit.
+constexpr uint64_t kUnlimitedMemoryThreshold = static_cast< uint64_t >( 1 ) << 62u;
+
+auto parse_cpu_max( const std::string& content ) -> uint32_t {
+    std::istringstream stream{ content };
+    std::string quota;
+    int64_t period = 0;
+    if ( !( stream >> quota ) || quota == "max" || !( stream >> period ) ) {
+        return 0;
+    }
+    try {
+        return cpu_quota_to_count( std::stoll( quota ), period );
+    } catch ( const std::exception& ) {
+        return 0;
+    }
+}
+
+auto cpu_quota_to_count( int64_t quota, int64_t period ) noexcept -> uint32_t {
+    if ( quota <= 0 || period <= 0 ) { // cgroups v1 use -1 to represent the absence of a quota.
+        return 0;
+    }
+    const int64_t count = ( quota + period - 1 ) / period;
+    return static_cast< uint32_t >( ( std::min )( count,
+                                                  static_cast< int64_t >( std::numeric_limits< uint32_t >::max() ) ) );
+}
+
+auto parse_memory_limit( const std::string& content ) -> uint64_t {
+    std::istringstream stream{ content };
+    std::string limit;
+    if ( !( stream >> limit ) || limit == "max" ) {
+        return 0;
+    }
+    try {
+        const uint64_t value = std::stoull( limit );
+        return value >= kUnlimitedMemoryThreshold ? 0 : value;
+    } catch ( const std::exception& ) {
+        return 0;
+    }
+}
+
+auto cgroup_path( const std::string& procSelfCgroup, const std::string& controller ) -> std::string {
+    // Each line has the format "hierarchy-ID:controller-list:cgroup-path"; the unified (v2) hierarchy has ID 0.
+    std::istringstream stream{ procSelfCgroup };
+    std::string line;
+    while ( std::getline( stream, line ) ) {
+        const auto firstColon = line.find( ':' );
+        const auto secondColon = firstColon == std::string::npos ? firstColon : line.find( ':', firstColon + 1 );
+        if ( secondColon == std::string::npos ) {
+            continue;
+        }
+        const std::string hierarchyId = line.substr( 0, firstColon );
+        const std::string controllers = line.substr( firstColon + 1, secondColon - firstColon - 1 );
+        if ( controller.empty() ) {
+            if ( hierarchyId == "0" && controllers.empty() ) {
+                return line.substr( secondColon + 1 );
+            }
+            continue;
+        }
+        std::istringstream controllersStream{ controllers };
+        std::string name;
+        while ( std::getline( controllersStream, name, ',' ) ) {
+            if ( name == controller ) {
+                return line.substr( secondColon + 1 );
+            }
+        }
+    }
+    return {};
+}
+
+template< typename T >
+inline auto min_limit( T first, T second ) -> T {
+    // Note: 0 means "no limit".
+    if ( first == 0 ) {
+        return second;
+    }
+    return second == 0 ? first : ( std::min )( first, second );
+}
+
+auto effective_cpu_limit( uint32_t cgroupLimit, uint32_t affinityCount, uint32_t hardwareConcurrency ) noexcept
+    -> uint32_t {
+    const uint32_t limit = min_limit( cgroupLimit, affinityCount );
+    // Note: a limit that is not below the number of CPUs of the system doesn't restrict the process in any way.
+    return ( hardwareConcurrency != 0 && limit >= hardwareConcurrency ) ? 0 : limit;
+}
+
+#ifdef __linux__
+constexpr auto kCgroupRoot = "/sys/fs/cgroup";
+
+auto read_file( const std::string& path, std::string& content ) -> bool {
+    std::ifstream file{ path };
+    if ( !file ) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+    return true;
+}
+
+auto proc_self_cgroup() -> const std::string& {
+    static const std::string content = []() -> std::string {
+        std::string result;
+        read_file( "/proc/self/cgroup", result );
+        return result;
+    }();
+    return content;
+}
+
+/* Visits the directories of the cgroup v2 of the process, from its own up to the root one,
+ * since the limits of the ancestors apply to their descendants. */
+template< typename Visitor >
+void visit_unified_hierarchy( Visitor visitor ) {
+    std::string path = cgroup_path( proc_self_cgroup(), "" );
+    if ( path.empty() ) {
+        return;
+    }
+    while ( true ) {
+        visitor( kCgroupRoot + ( path == "/" ? std::string{} : path ) );
+        if ( path.empty() || path == "/" ) {
+            return;
+        }
+        const auto lastSlash = path.find_last_of( '/' );
+        path = lastSlash == 0 || lastSlash == std::string::npos ? "/" : path.substr( 0, lastSlash );
+    }
+}
+
+/* Returns the candidate directories of the cgroup v1 of the process for the given controller:
+ * depending on the container runtime, the controller's hierarchy is mounted either at the cgroup's path
+ * or directly at the cgroup (i.e., the root of the mount point is the cgroup itself). */
+auto v1_directories( const std::string& controller ) -> std::vector< std::string > {
+    const std::string path = cgroup_path( proc_self_cgroup(), controller );
+    if ( path.empty() ) {
+        return {};
+    }
+    std::vector< std::string > directories;
+    // Note: the CPU controller is usually co-mounted with the cpuacct one.
+    for ( const auto& mountName : { controller, controller + ",cpuacct" } ) {
+        const std::string mountPoint = std::string{ kCgroupRoot } + "/" + mountName;
+        if ( path != "/" ) {
+            directories.push_back( mountPoint + path );
+        }
+        directories.push_back( mountPoint );
+    }
+    return directories;
+}
+
+auto cgroup_cpu_limit() -> uint32_t {
+    uint32_t limit = 0;
+    visit_unified_hierarchy( [ &limit ]( const std::string& directory ) {
+        std::string content;
+        if ( read_file( directory + "/cpu.max", content ) ) {
+            limit = min_limit( limit, parse_cpu_max( content ) );
+        }
+    } );
+    if ( limit != 0 ) {
+        return limit;
+    }
+
+    for ( const auto& directory : v1_directories( "cpu" ) ) {
+        std::string quota;
+        std::string period;
+        if ( read_file( directory + "/cpu.cfs_quota_us", quota ) &&
+             read_file( directory + "/cpu.cfs_period_us", period ) ) {
+            try {
+                return cpu_quota_to_count( std::stoll( quota ), std::stoll( period ) );
+            } catch ( const std::exception& ) {
+                return 0;
+            }
+        }
+    }
+    return 0;
+}
+
+auto affinity_cpu_count() -> uint32_t {
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    if ( sched_getaffinity( 0, sizeof( cpu_set_t ), &cpuSet ) != 0 ) {
+        return 0;
+    }
+    return static_cast< uint32_t >( CPU_COUNT( &cpuSet ) );
+}
+#endif
+
+auto detect_cpu_limit() -> uint32_t {
+#ifdef __linux__
+    return effective_cpu_limit( cgroup_cpu_limit(), affinity_cpu_count(), std::thread::hardware_concurrency() );
+#else
+    return 0;
+#endif
+}
+
+auto detect_memory_limit() -> uint64_t {
+#ifdef __linux__
+    uint64_t limit = 0;
+    visit_unified_hierarchy( [ &limit ]( const std::string& directory ) {
+        std::string content;
+        if ( read_file( directory + "/memory.max", content ) ) {
+            limit = min_limit( limit, parse_memory_limit( content ) );
+        }
+    } );
+    if ( limit != 0 ) {
+        return limit;
+    }
+
+    for ( const auto& directory : v1_directories( "memory" ) ) {
+        std::string content;
+        if ( read_file( directory + "/memory.limit_in_bytes", content ) ) {
+            return parse_memory_limit( content );
+        }
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace cgroups
+}  // namespace bit7z
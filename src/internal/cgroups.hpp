@@ -0,0 +1,74 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CGROUPS_HPP
+#define CGROUPS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "bitdefines.hpp"
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace cgroups {
+
+/**
+ * Parses the content of a cgroup v2 "cpu.max" file (e.g., "200000 100000" or "max 100000").
+ *
+ * @return the number of CPUs allowed by the quota (rounded up), or 0 if there is no quota.
+ */
+BIT7Z_NODISCARD auto parse_cpu_max( const std::string& content ) -> uint32_t;
+
+/**
+ * Computes the number of CPUs allowed by a cgroup v1 CFS quota and period.
+ *
+ * @return the number of CPUs allowed by the quota (rounded up), or 0 if there is no quota.
+ */
+BIT7Z_NODISCARD auto cpu_quota_to_count( int64_t quota, int64_t period ) noexcept -> uint32_t;
+
+/**
+ * Parses the content of a cgroup "memory.max" (v2) or "memory.limit_in_bytes" (v1) file.
+ *
+ * @return the memory limit in bytes, or 0 if there is no limit.
+ */
+BIT7Z_NODISCARD auto parse_memory_limit( const std::string& content ) -> uint64_t;
+
+/**
+ * Extracts the path of the cgroup of the given controller (or of the unified v2 hierarchy, if the controller
+ * is empty) from the content of the "/proc/self/cgroup" file.
+ *
+ * @return the cgroup path, or an empty string if not found.
+ */
+BIT7Z_NODISCARD auto cgroup_path( const std::string& procSelfCgroup, const std::string& controller ) -> std::string;
+
+/**
+ * Combines the CPU limit of the cgroups of the process with the number of CPUs in its affinity mask.
+ *
+ * @return the lowest of the two limits, or 0 if neither is below the number of CPUs of the system
+ *         (i.e., if the process is not actually restricted).
+ */
+BIT7Z_NODISCARD auto effective_cpu_limit( uint32_t cgroupLimit,
+                                          uint32_t affinityCount,
+                                          uint32_t hardwareConcurrency ) noexcept -> uint32_t;
+
+/**
+ * @return the number of CPUs the process can use according to its cgroups and affinity mask
+ *         (0 if unknown, or if they don't restrict the process to fewer CPUs than the ones of the system).
+ */
+BIT7Z_NODISCARD auto detect_cpu_limit() -> uint32_t;
+
+/**
+ * @return the amount of memory (in bytes) the process can use according to its cgroups (0 if unknown).
+ */
+BIT7Z_NODISCARD auto detect_memory_limit() -> uint64_t;
+
+}  // namespace cgroups
+}  // namespace bit7z
+
+#endif //CGROUPS_HPP
@@ -0,0 +1,43 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <utility>
+
+#include "internal/chashingoutstream.hpp"
+
+namespace bit7z {
+
+CHashingOutStream::CHashingOutStream( CMyComPtr< ISequentialOutStream > innerStream,
+                                      const Bit7zLibrary& lib,
+                                      const std::vector< DigestType >& types )
+    : mInnerStream{ std::move( innerStream ) }, mHasher{ lib, types } {}
+
+auto CHashingOutStream::digests() -> ItemDigests {
+    return mHasher.finish();
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CHashingOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) noexcept {
+    UInt32 writtenSize = size;
+    HRESULT result = S_OK;
+    if ( mInnerStream ) {
+        result = mInnerStream->Write( data, size, &writtenSize );
+    }
+    // Only the data actually written to the inner stream is hashed, as the rest will be written again by the caller.
+    mHasher.update( static_cast< const byte_t* >( data ), writtenSize );
+    if ( processedSize != nullptr ) {
+        *processedSize = writtenSize;
+    }
+    return result;
+}
+
+} // namespace bit7z
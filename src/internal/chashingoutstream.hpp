@@ -0,0 +1,61 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHASHINGOUTSTREAM_HPP
+#define CHASHINGOUTSTREAM_HPP
+
+#include <vector>
+
+#include "bitdigest.hpp"
+#include "internal/com.hpp"
+#include "internal/guids.hpp"
+#include "internal/hasher.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+/**
+ * An output stream computing the digests of the data written to it, and forwarding the data to an inner stream.
+ * If no inner stream is given, the data is only hashed and then discarded (e.g., when testing an archive).
+ */
+class CHashingOutStream final : public ISequentialOutStream, public CMyUnknownImp {
+    public:
+        CHashingOutStream( CMyComPtr< ISequentialOutStream > innerStream,
+                           const Bit7zLibrary& lib,
+                           const std::vector< DigestType >& types );
+
+        CHashingOutStream( const CHashingOutStream& ) = delete;
+
+        CHashingOutStream( CHashingOutStream&& ) = delete;
+
+        auto operator=( const CHashingOutStream& ) -> CHashingOutStream& = delete;
+
+        auto operator=( CHashingOutStream&& ) -> CHashingOutStream& = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CHashingOutStream() ) = default;
+
+        // Returns the digests of the data written so far (the stream must not be written anymore).
+        auto digests() -> ItemDigests;
+
+        // ISequentialOutStream
+        BIT7Z_STDMETHOD( Write, const void* data, UInt32 size, UInt32* processedSize );
+
+        // NOLINTNEXTLINE(modernize-use-noexcept, modernize-use-trailing-return-type, readability-identifier-length)
+        MY_UNKNOWN_IMP1( ISequentialOutStream ) //-V2507 //-V2511 //-V835
+
+    private:
+        CMyComPtr< ISequentialOutStream > mInnerStream;
+        ItemHasher mHasher;
+};
+
+}  // namespace bit7z
+
+#endif // CHASHINGOUTSTREAM_HPP
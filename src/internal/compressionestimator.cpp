@@ -0,0 +1,178 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "bitoutputarchive.hpp"
+#include "internal/bufferitem.hpp"
+#include "internal/com.hpp"
+#include "internal/compressionestimator.hpp"
+#include "internal/fsitem.hpp"
+#include "internal/guids.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+using filesystem::FilesystemItem;
+
+// Size of each block of data sampled from the input items.
+constexpr uint64_t kSampleBlockSize = 256 * 1024; // 256 KiB
+
+// Maximum amount of data read at once from the input items.
+constexpr std::size_t kReadChunkSize = 1024 * 1024; // 1 MiB
+
+struct SampledItem {
+    const GenericInputItem* item;
+    uint64_t size;
+};
+
+auto is_sampleable( const GenericInputItem& item ) -> bool {
+    // Note: we cannot sample stream items, since reading them would consume the data to be compressed.
+    if ( item.isDir() ) {
+        return false;
+    }
+    const auto* fsItem = dynamic_cast< const FilesystemItem* >( &item );
+    if ( fsItem != nullptr ) {
+        return !fsItem->isSymLink();
+    }
+    return dynamic_cast< const BufferItem* >( &item ) != nullptr;
+}
+
+auto read_block( const GenericInputItem& item, uint64_t offset, uint64_t size, buffer_t& block ) -> bool {
+    CMyComPtr< ISequentialInStream > sequentialStream;
+    if ( item.getStream( &sequentialStream ) != S_OK || sequentialStream == nullptr ) {
+        return false;
+    }
+
+    CMyComPtr< IInStream > inStream;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if ( sequentialStream->QueryInterface( ::IID_IInStream, reinterpret_cast< void** >( &inStream ) ) != S_OK ||
+         inStream->Seek( static_cast< Int64 >( offset ), STREAM_SEEK_SET, nullptr ) != S_OK ) {
+        return false;
+    }
+
+    block.resize( static_cast< std::size_t >( size ) );
+    std::size_t totalRead = 0;
+    while ( totalRead < block.size() ) {
+        UInt32 processedSize = 0;
+        const auto readSize = static_cast< UInt32 >( ( std::min )( block.size() - totalRead, kReadChunkSize ) );
+        if ( inStream->Read( &block[ totalRead ], readSize, &processedSize ) != S_OK ) {
+            return false;
+        }
+        if ( processedSize == 0 ) {
+            break;
+        }
+        totalRead += processedSize;
+    }
+    block.resize( totalRead );
+    return totalRead > 0;
+}
+
+auto estimate_compression( const BitAbstractArchiveCreator& creator,
+                           const BitItemsVector& items,
+                           uint64_t sampleSize ) -> CompressionEstimate {
+    CompressionEstimate estimate{};
+    estimate.peakMemory = creator.estimatedMemoryUsage();
+
+    std::vector< SampledItem > sampleableItems;
+    uint64_t sampleableSize = 0;
+    for ( const auto& item : items ) {
+        if ( item->isDir() ) {
+            continue;
+        }
+        estimate.inputSize += item->size();
+        if ( is_sampleable( *item ) && item->size() > 0 ) {
+            sampleableItems.push_back( { item.get(), item->size() } );
+            sampleableSize += item->size();
+        }
+    }
+    if ( sampleableSize == 0 || sampleSize == 0 ) {
+        return estimate;
+    }
+
+    /* Choosing the blocks to be compressed: if the items are small enough, we compress all of them;
+     * otherwise, we take the blocks evenly spaced over the items' content (as if the items were concatenated). */
+    std::vector< buffer_t > blocks;
+    std::vector< tstring > blockNames;
+    if ( sampleableSize <= sampleSize ) {
+        for ( const auto& sampledItem : sampleableItems ) {
+            buffer_t block;
+            if ( read_block( *sampledItem.item, 0, sampledItem.size, block ) ) {
+                blocks.push_back( std::move( block ) );
+                blockNames.push_back( sampledItem.item->name() );
+            }
+        }
+    } else {
+        const uint64_t blockSize = ( std::min )( kSampleBlockSize, sampleSize );
+        const uint64_t blocksCount = ( std::max )( sampleSize / blockSize, static_cast< uint64_t >( 1 ) );
+        const uint64_t stride = sampleableSize / blocksCount;
+
+        std::size_t itemIndex = 0;
+        uint64_t itemStart = 0; // The offset of the current item's content within the concatenated content.
+        for ( uint64_t blockIndex = 0; blockIndex < blocksCount; ++blockIndex ) {
+            const uint64_t blockStart = ( blockIndex * stride ) + ( ( stride - ( std::min )( blockSize, stride ) ) / 2 );
+            while ( itemIndex < sampleableItems.size() &&
+                    itemStart + sampleableItems[ itemIndex ].size <= blockStart ) {
+                itemStart += sampleableItems[ itemIndex ].size;
+                ++itemIndex;
+            }
+            if ( itemIndex >= sampleableItems.size() ) {
+                break;
+            }
+
+            const auto& sampledItem = sampleableItems[ itemIndex ];
+            const uint64_t offset = blockStart - itemStart;
+            buffer_t block;
+            if ( read_block( *sampledItem.item, offset, ( std::min )( blockSize, sampledItem.size - offset ), block ) ) {
+                blocks.push_back( std::move( block ) );
+                blockNames.push_back( sampledItem.item->name() );
+            }
+        }
+    }
+
+    BitOutputArchive sampleArchive{ creator };
+    if ( creator.compressionFormat().hasFeature( FormatFeatures::MultipleFiles ) ) {
+        for ( std::size_t i = 0; i < blocks.size(); ++i ) {
+            sampleArchive.addFile( blocks[ i ], blockNames[ i ] );
+            estimate.sampledSize += blocks[ i ].size();
+        }
+    } else if ( !blocks.empty() ) {
+        // Single-file formats (e.g., gzip, xz) compress the concatenation of the blocks as a single item.
+        for ( std::size_t i = 1; i < blocks.size(); ++i ) {
+            blocks.front().insert( blocks.front().end(), blocks[ i ].cbegin(), blocks[ i ].cend() );
+            blocks[ i ] = buffer_t{};
+        }
+        sampleArchive.addFile( blocks.front(), blockNames.front() );
+        estimate.sampledSize = blocks.front().size();
+    }
+    if ( estimate.sampledSize == 0 ) {
+        return estimate;
+    }
+
+    buffer_t compressedSample;
+    const auto startTime = std::chrono::steady_clock::now();
+    sampleArchive.compressTo( compressedSample );
+    const std::chrono::duration< double > elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+    estimate.ratio = static_cast< double >( compressedSample.size() ) / static_cast< double >( estimate.sampledSize );
+    estimate.estimatedSize = static_cast< uint64_t >( estimate.ratio * static_cast< double >( estimate.inputSize ) );
+    if ( elapsedTime.count() > 0 ) {
+        estimate.throughput = static_cast< double >( estimate.sampledSize ) / elapsedTime.count();
+        const double estimatedSeconds = static_cast< double >( estimate.inputSize ) / estimate.throughput;
+        estimate.estimatedTime = std::chrono::milliseconds{ static_cast< int64_t >( estimatedSeconds * 1000.0 ) };
+    }
+    return estimate;
+}
+
+}  // namespace bit7z
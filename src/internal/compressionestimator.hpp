@@ -0,0 +1,38 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef COMPRESSIONESTIMATOR_HPP
+#define COMPRESSIONESTIMATOR_HPP
+
+#include <cstdint>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bititemsvector.hpp"
+
+namespace bit7z {
+
+/**
+ * Estimates the outcome of compressing the given items with the settings of the given creator.
+ *
+ * The estimate is computed by compressing in memory, with the real encoder, a sample of blocks evenly spread
+ * over the content of the items (as if they were concatenated), and by extrapolating the results.
+ *
+ * @param creator    the creator whose settings must be used for the compression.
+ * @param items      the items to be compressed.
+ * @param sampleSize the maximum amount of data (in bytes) to be actually compressed.
+ *
+ * @return the estimated outcome of the compression.
+ */
+auto estimate_compression( const BitAbstractArchiveCreator& creator,
+                           const BitItemsVector& items,
+                           uint64_t sampleSize ) -> CompressionEstimate;
+
+}  // namespace bit7z
+
+#endif //COMPRESSIONESTIMATOR_HPP
@@ -0,0 +1,178 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "internal/com.hpp"
+#include "internal/contentanalysis.hpp"
+#include "internal/fsitem.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/stringutil.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+using filesystem::FilesystemItem;
+
+// Items smaller than this size are always considered compressible: analyzing them is not worth the effort.
+constexpr std::size_t kMinAnalyzedSize = 4 * 1024; // 4 KiB
+
+// Size of the prefix of the item's content that is analyzed.
+constexpr std::size_t kAnalyzedPrefixSize = 64 * 1024; // 64 KiB
+
+// Data with an entropy greater than this threshold (in bits per byte) is considered incompressible.
+constexpr double kIncompressibleEntropy = 7.9;
+
+auto is_compressed_extension( const tstring& extension ) -> bool {
+    static const std::array< const tchar*, 56 > kCompressedExtensions = { {
+        BIT7Z_STRING( "7z" ), BIT7Z_STRING( "aac" ), BIT7Z_STRING( "apk" ), BIT7Z_STRING( "avi" ),
+        BIT7Z_STRING( "avif" ), BIT7Z_STRING( "br" ), BIT7Z_STRING( "bz2" ), BIT7Z_STRING( "cab" ),
+        BIT7Z_STRING( "deb" ), BIT7Z_STRING( "dmg" ), BIT7Z_STRING( "docx" ), BIT7Z_STRING( "epub" ),
+        BIT7Z_STRING( "flac" ), BIT7Z_STRING( "flv" ), BIT7Z_STRING( "gif" ), BIT7Z_STRING( "gz" ),
+        BIT7Z_STRING( "heic" ), BIT7Z_STRING( "jar" ), BIT7Z_STRING( "jpeg" ), BIT7Z_STRING( "jpg" ),
+        BIT7Z_STRING( "jxl" ), BIT7Z_STRING( "lz4" ), BIT7Z_STRING( "lzma" ), BIT7Z_STRING( "m4a" ),
+        BIT7Z_STRING( "m4v" ), BIT7Z_STRING( "mkv" ), BIT7Z_STRING( "mov" ), BIT7Z_STRING( "mp3" ),
+        BIT7Z_STRING( "mp4" ), BIT7Z_STRING( "mpeg" ), BIT7Z_STRING( "mpg" ), BIT7Z_STRING( "odp" ),
+        BIT7Z_STRING( "ods" ), BIT7Z_STRING( "odt" ), BIT7Z_STRING( "ogg" ), BIT7Z_STRING( "opus" ),
+        BIT7Z_STRING( "png" ), BIT7Z_STRING( "pptx" ), BIT7Z_STRING( "rar" ), BIT7Z_STRING( "rpm" ),
+        BIT7Z_STRING( "tbz2" ), BIT7Z_STRING( "tgz" ), BIT7Z_STRING( "txz" ), BIT7Z_STRING( "webm" ),
+        BIT7Z_STRING( "webp" ), BIT7Z_STRING( "whl" ), BIT7Z_STRING( "wma" ), BIT7Z_STRING( "wmv" ),
+        BIT7Z_STRING( "xlsx" ), BIT7Z_STRING( "xpi" ), BIT7Z_STRING( "xz" ), BIT7Z_STRING( "zip" ),
+        BIT7Z_STRING( "zipx" ), BIT7Z_STRING( "zst" ), BIT7Z_STRING( "tzst" ), BIT7Z_STRING( "lz" )
+    } };
+
+    if ( extension.empty() ) {
+        return false;
+    }
+    const tstring lowerExtension = to_lower( extension );
+    return std::any_of( kCompressedExtensions.cbegin(), kCompressedExtensions.cend(),
+                        [ &lowerExtension ]( const tchar* compressedExtension ) -> bool {
+                            return lowerExtension == compressedExtension;
+                        } );
+}
+
+struct FormatSignature {
+    std::size_t offset;
+    const char* bytes;
+    std::size_t size;
+};
+
+auto has_compressed_signature( const byte_t* data, std::size_t size ) noexcept -> bool {
+    static const std::array< FormatSignature, 20 > kCompressedSignatures = { {
+        { 0, "\xFF\xD8\xFF", 3 },                          // JPEG
+        { 0, "\x89PNG\r\n\x1A\n", 8 },                     // PNG
+        { 0, "GIF8", 4 },                                  // GIF
+        { 0, "PK\x03\x04", 4 },                            // Zip (and Zip-based formats, e.g., docx, jar, apk)
+        { 0, "\x1F\x8B", 2 },                              // GZip
+        { 0, "BZh", 3 },                                   // BZip2
+        { 0, "\xFD" "7zXZ\x00", 6 },                       // Xz
+        { 0, "7z\xBC\xAF\x27\x1C", 6 },                    // 7z
+        { 0, "\x28\xB5\x2F\xFD", 4 },                      // Zstandard
+        { 0, "Rar!\x1A\x07", 6 },                          // RAR
+        { 0, "\x04\x22\x4D\x18", 4 },                      // LZ4
+        { 0, "\x1A\x45\xDF\xA3", 4 },                      // Matroska/WebM
+        { 0, "ID3", 3 },                                   // MP3 (with ID3 tag)
+        { 0, "OggS", 4 },                                  // Ogg
+        { 0, "fLaC", 4 },                                  // FLAC
+        { 0, "FLV\x01", 4 },                               // Flash video
+        { 0, "\x00\x00\x00\x0CjXL ", 8 },                  // JPEG XL
+        { 0, "\xFF\x0A", 2 },                              // JPEG XL (codestream)
+        { 4, "ftyp", 4 },                                  // ISO base media (e.g., MP4, MOV, HEIC, AVIF)
+        { 8, "WEBP", 4 }                                   // WebP
+    } };
+
+    return std::any_of( kCompressedSignatures.cbegin(), kCompressedSignatures.cend(),
+                        [ data, size ]( const FormatSignature& signature ) -> bool {
+                            return size >= signature.offset + signature.size &&
+                                   std::memcmp( data + signature.offset, //-V2563
+                                                signature.bytes,
+                                                signature.size ) == 0;
+                        } );
+}
+
+auto shannon_entropy( const byte_t* data, std::size_t size ) noexcept -> double {
+    if ( size == 0 ) {
+        return 0.0;
+    }
+
+    constexpr auto kByteValues = 256;
+    std::array< std::size_t, kByteValues > frequencies{};
+    for ( std::size_t i = 0; i < size; ++i ) {
+        ++frequencies[ static_cast< std::size_t >( data[ i ] ) ]; //-V2563
+    }
+
+    double entropy = 0.0;
+    const auto totalSize = static_cast< double >( size );
+    for ( const auto frequency : frequencies ) {
+        if ( frequency != 0 ) {
+            const double probability = static_cast< double >( frequency ) / totalSize;
+            entropy -= probability * std::log2( probability );
+        }
+    }
+    return entropy;
+}
+
+auto read_prefix( const GenericInputItem& item, buffer_t& prefix ) -> bool {
+    CMyComPtr< ISequentialInStream > inStream;
+    if ( item.getStream( &inStream ) != S_OK || inStream == nullptr ) {
+        return false;
+    }
+
+    prefix.resize( kAnalyzedPrefixSize );
+    std::size_t totalRead = 0;
+    while ( totalRead < prefix.size() ) {
+        UInt32 processedSize = 0;
+        const auto readSize = static_cast< UInt32 >( prefix.size() - totalRead );
+        if ( inStream->Read( &prefix[ totalRead ], readSize, &processedSize ) != S_OK ) {
+            return false;
+        }
+        if ( processedSize == 0 ) {
+            break;
+        }
+        totalRead += processedSize;
+    }
+    prefix.resize( totalRead );
+    return true;
+}
+
+auto is_incompressible( const GenericInputItem& item ) -> bool {
+    if ( item.isDir() || item.size() < kMinAnalyzedSize ) {
+        return false;
+    }
+
+    if ( is_compressed_extension( filesystem::fsutil::extension( tstring_to_path( item.name() ) ) ) ) {
+        return true;
+    }
+
+    /* Note: we sniff only the content of filesystem files, since reading the prefix of stream items
+     *       would consume the data to be compressed. */
+    const auto* fsItem = dynamic_cast< const FilesystemItem* >( &item );
+    if ( fsItem == nullptr || fsItem->isSymLink() ) {
+        return false;
+    }
+
+    buffer_t prefix;
+    if ( !read_prefix( item, prefix ) ) {
+        return false; // We let the compression operation deal with the error.
+    }
+    if ( has_compressed_signature( prefix.data(), prefix.size() ) ) {
+        return true;
+    }
+    return prefix.size() >= kMinAnalyzedSize &&
+           shannon_entropy( prefix.data(), prefix.size() ) > kIncompressibleEntropy;
+}
+
+}  // namespace bit7z
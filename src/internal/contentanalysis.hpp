@@ -0,0 +1,67 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CONTENTANALYSIS_HPP
+#define CONTENTANALYSIS_HPP
+
+#include <cstddef>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+struct GenericInputItem;
+
+/**
+ * @brief Checks whether the given file extension is commonly used by already-compressed file formats
+ * (e.g., media files, archives, compressed documents).
+ *
+ * @param extension the file extension to be checked (without the leading dot; the check is case-insensitive).
+ *
+ * @return true if the extension belongs to an already-compressed file format, false otherwise.
+ */
+BIT7Z_NODISCARD auto is_compressed_extension( const tstring& extension ) -> bool;
+
+/**
+ * @brief Checks whether the given data starts with the signature of an already-compressed file format.
+ *
+ * @param data the data to be checked.
+ * @param size the size of the data.
+ *
+ * @return true if the data starts with a known signature of an already-compressed format, false otherwise.
+ */
+BIT7Z_NODISCARD auto has_compressed_signature( const byte_t* data, std::size_t size ) noexcept -> bool;
+
+/**
+ * @brief Computes the Shannon entropy (in bits per byte, i.e., a value in the range [0, 8]) of the given data.
+ *
+ * @param data the data whose entropy must be computed.
+ * @param size the size of the data.
+ *
+ * @return the entropy of the data.
+ */
+BIT7Z_NODISCARD auto shannon_entropy( const byte_t* data, std::size_t size ) noexcept -> double;
+
+/**
+ * @brief Guesses whether the content of the given item is already compressed, so that compressing it again
+ * would be just a waste of CPU time.
+ *
+ * The guess is based on the item's extension and, for filesystem files, on the signature and the entropy
+ * of a small prefix of the file's content.
+ *
+ * @param item the item to be analyzed.
+ *
+ * @return true if the item's content is likely incompressible, false otherwise.
+ */
+BIT7Z_NODISCARD auto is_incompressible( const GenericInputItem& item ) -> bool;
+
+}  // namespace bit7z
+
+#endif //CONTENTANALYSIS_HPP
@@ -0,0 +1,30 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/cpipeinstream.hpp"
+#include "internal/itempipeline.hpp"
+
+namespace bit7z {
+
+CPipeInStream::CPipeInStream( ItemPipeline& pipeline, std::size_t index ) : mPipeline{ pipeline }, mIndex{ index } {}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CPipeInStream::Read( void* data, UInt32 size, UInt32* processedSize ) noexcept {
+    uint32_t readSize = 0;
+    const HRESULT result = mPipeline.read( mIndex, data, size, readSize );
+    if ( processedSize != nullptr ) {
+        *processedSize = readSize;
+    }
+    return result;
+}
+
+} // namespace bit7z
@@ -0,0 +1,55 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CPIPEINSTREAM_HPP
+#define CPIPEINSTREAM_HPP
+
+#include <cstddef>
+
+#include "internal/com.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+class ItemPipeline;
+
+/**
+ * An input stream reading the content of an item of an ItemPipeline, as it is written by the producer.
+ */
+class CPipeInStream final : public ISequentialInStream, public CMyUnknownImp {
+    public:
+        CPipeInStream( ItemPipeline& pipeline, std::size_t index );
+
+        CPipeInStream( const CPipeInStream& ) = delete;
+
+        CPipeInStream( CPipeInStream&& ) = delete;
+
+        auto operator=( const CPipeInStream& ) -> CPipeInStream& = delete;
+
+        auto operator=( CPipeInStream&& ) -> CPipeInStream& = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CPipeInStream() ) = default;
+
+        // ISequentialInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        // NOLINTNEXTLINE(modernize-use-noexcept, modernize-use-trailing-return-type, readability-identifier-length)
+        MY_UNKNOWN_IMP1( ISequentialInStream ) //-V2507 //-V2511 //-V835
+
+    private:
+        ItemPipeline& mPipeline;
+        std::size_t mIndex;
+};
+
+}  // namespace bit7z
+
+#endif // CPIPEINSTREAM_HPP
@@ -0,0 +1,29 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/cpipeoutstream.hpp"
+#include "internal/itempipeline.hpp"
+
+namespace bit7z {
+
+CPipeOutStream::CPipeOutStream( ItemPipeline& pipeline, std::size_t index ) : mPipeline{ pipeline }, mIndex{ index } {}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CPipeOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) noexcept {
+    const HRESULT result = mPipeline.write( mIndex, data, size );
+    if ( processedSize != nullptr ) {
+        *processedSize = result == S_OK ? size : 0;
+    }
+    return result;
+}
+
+} // namespace bit7z
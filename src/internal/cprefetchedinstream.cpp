@@ -0,0 +1,33 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/cprefetchedinstream.hpp"
+#include "internal/cbufferinstream.hpp"
+#include "internal/util.hpp"
+
+namespace bit7z {
+
+CPrefetchedInStream::CPrefetchedInStream( buffer_t&& buffer )
+    : mBuffer{ std::move( buffer ) },
+      mBufferStream{ bit7z::make_com< CBufferInStream, IInStream >( mBuffer ) } {}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CPrefetchedInStream::Read( void* data, UInt32 size, UInt32* processedSize ) noexcept {
+    return mBufferStream->Read( data, size, processedSize );
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CPrefetchedInStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* newPosition ) noexcept {
+    return mBufferStream->Seek( offset, seekOrigin, newPosition );
+}
+
+} // namespace bit7z
@@ -0,0 +1,55 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CPREFETCHEDINSTREAM_HPP
+#define CPREFETCHEDINSTREAM_HPP
+
+#include "bittypes.hpp"
+#include "internal/com.hpp"
+#include "internal/guids.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+/**
+ * An input stream over a buffer that the stream itself owns
+ * (e.g., the content of a file that was read in advance by the ItemPrefetcher).
+ */
+class CPrefetchedInStream final : public IInStream, public CMyUnknownImp {
+    public:
+        explicit CPrefetchedInStream( buffer_t&& buffer );
+
+        CPrefetchedInStream( const CPrefetchedInStream& ) = delete;
+
+        CPrefetchedInStream( CPrefetchedInStream&& ) = delete;
+
+        auto operator=( const CPrefetchedInStream& ) -> CPrefetchedInStream& = delete;
+
+        auto operator=( CPrefetchedInStream&& ) -> CPrefetchedInStream& = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CPrefetchedInStream() ) = default;
+
+        // IInStream
+        BIT7Z_STDMETHOD( Read, void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+        // NOLINTNEXTLINE(modernize-use-noexcept, modernize-use-trailing-return-type, readability-identifier-length)
+        MY_UNKNOWN_IMP1( IInStream ) //-V2507 //-V2511 //-V835
+
+    private:
+        buffer_t mBuffer;
+        CMyComPtr< IInStream > mBufferStream;
+};
+
+}  // namespace bit7z
+
+#endif // CPREFETCHEDINSTREAM_HPP
@@ -0,0 +1,43 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <array>
+
+#include "internal/crc32.hpp"
+
+namespace bit7z {
+
+constexpr uint32_t kCrc32Polynomial = 0xEDB88320; // Reversed IEEE 802.3 polynomial.
+
+auto make_crc32_table() noexcept -> std::array< uint32_t, 256 > {
+    std::array< uint32_t, 256 > table{};
+    for ( uint32_t i = 0; i < table.size(); ++i ) {
+        uint32_t value = i;
+        for ( int bit = 0; bit < 8; ++bit ) {
+            value = ( value & 1u ) != 0 ? ( value >> 1u ) ^ kCrc32Polynomial : value >> 1u;
+        }
+        table[ i ] = value;
+    }
+    return table;
+}
+
+auto crc32_update( uint32_t crc, const byte_t* data, std::size_t size ) noexcept -> uint32_t {
+    static const auto kCrc32Table = make_crc32_table();
+
+    crc = ~crc;
+    for ( std::size_t i = 0; i < size; ++i ) {
+        crc = kCrc32Table[ ( crc ^ data[ i ] ) & 0xFFu ] ^ ( crc >> 8u ); //-V2563
+    }
+    return ~crc;
+}
+
+}  // namespace bit7z
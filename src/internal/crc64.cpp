@@ -0,0 +1,43 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <array>
+
+#include "internal/crc64.hpp"
+
+namespace bit7z {
+
+constexpr uint64_t kCrc64Polynomial = 0xC96C5795D7870F42; // Reversed ECMA-182 polynomial.
+
+auto make_crc64_table() noexcept -> std::array< uint64_t, 256 > {
+    std::array< uint64_t, 256 > table{};
+    for ( uint64_t i = 0; i < table.size(); ++i ) {
+        uint64_t value = i;
+        for ( int bit = 0; bit < 8; ++bit ) {
+            value = ( value & 1u ) != 0 ? ( value >> 1u ) ^ kCrc64Polynomial : value >> 1u;
+        }
+        table[ i ] = value;
+    }
+    return table;
+}
+
+auto crc64_update( uint64_t crc, const byte_t* data, std::size_t size ) noexcept -> uint64_t {
+    static const auto kCrc64Table = make_crc64_table();
+
+    crc = ~crc;
+    for ( std::size_t i = 0; i < size; ++i ) {
+        crc = kCrc64Table[ ( crc ^ data[ i ] ) & 0xFFu ] ^ ( crc >> 8u ); //-V2563
+    }
+    return ~crc;
+}
+
+}  // namespace bit7z
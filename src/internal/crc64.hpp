@@ -0,0 +1,34 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CRC64_HPP
+#define CRC64_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitdefines.hpp"
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+/**
+ * Updates the given CRC64 (the same used by xz archives, i.e., using the ECMA-182 polynomial) with the given data.
+ *
+ * @param crc  the CRC64 of the previous data (0 for the first chunk of data).
+ * @param data the data to be added to the CRC.
+ * @param size the size of the data.
+ *
+ * @return the updated CRC64.
+ */
+BIT7Z_NODISCARD auto crc64_update( uint64_t crc, const byte_t* data, std::size_t size ) noexcept -> uint64_t;
+
+}  // namespace bit7z
+
+#endif //CRC64_HPP
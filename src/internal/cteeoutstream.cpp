@@ -0,0 +1,135 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <utility>
+
+#include "internal/cteeoutstream.hpp"
+
+namespace bit7z {
+
+CTeeOutStream::CTeeOutStream( CMyComPtr< IOutStream > mainStream,
+                              std::vector< CMyComPtr< IOutStream > > mirrorStreams,
+                              ItemHasher&& hasher )
+    : mMainStream{ std::move( mainStream ) },
+      mMirrorStreams{ std::move( mirrorStreams ) },
+      mHasher{ std::move( hasher ) },
+      mBasePosition{ 0 },
+      mPosition{ 0 },
+      mHashedSize{ 0 },
+      mValidDigests{ true } {
+    if ( mMainStream->Seek( 0, STREAM_SEEK_CUR, &mBasePosition ) != S_OK ) {
+        mBasePosition = 0;
+    }
+}
+
+auto CTeeOutStream::hasValidDigests() const noexcept -> bool {
+    return mValidDigests;
+}
+
+auto CTeeOutStream::digests() -> ItemDigests {
+    return mHasher.finish();
+}
+
+namespace {
+auto write_all( IOutStream* stream, const byte_t* data, UInt32 size ) -> HRESULT {
+    while ( size > 0 ) {
+        UInt32 writtenSize = 0;
+        const HRESULT result = stream->Write( data, size, &writtenSize );
+        if ( result != S_OK ) {
+            return result;
+        }
+        if ( writtenSize == 0 ) {
+            return E_FAIL;
+        }
+        data += writtenSize; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size -= writtenSize;
+    }
+    return S_OK;
+}
+} // namespace
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CTeeOutStream::Write( const void* data, UInt32 size, UInt32* processedSize ) noexcept {
+    UInt32 writtenSize = 0;
+    HRESULT result = mMainStream->Write( data, size, &writtenSize );
+    if ( processedSize != nullptr ) {
+        *processedSize = writtenSize;
+    }
+    if ( writtenSize == 0 ) {
+        return result;
+    }
+
+    const auto* byteData = static_cast< const byte_t* >( data );
+    for ( auto& mirrorStream : mMirrorStreams ) {
+        const HRESULT mirrorResult = write_all( mirrorStream, byteData, writtenSize );
+        if ( mirrorResult != S_OK ) {
+            return mirrorResult;
+        }
+    }
+
+    if ( mValidDigests && mPosition == mHashedSize ) {
+        mHasher.update( byteData, writtenSize );
+        mHashedSize += writtenSize;
+    } else {
+        mValidDigests = false; // Overwriting data already hashed, or leaving a gap in the hashed data.
+    }
+    mPosition += writtenSize;
+    return result;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CTeeOutStream::Seek( Int64 offset, UInt32 seekOrigin, UInt64* newPosition ) noexcept {
+    UInt64 mainPosition = 0;
+    const HRESULT result = mMainStream->Seek( offset, seekOrigin, &mainPosition );
+    if ( result != S_OK ) {
+        return result;
+    }
+    if ( mainPosition < mBasePosition ) {
+        return E_INVALIDARG;
+    }
+
+    mPosition = mainPosition - mBasePosition;
+    for ( auto& mirrorStream : mMirrorStreams ) {
+        const HRESULT mirrorResult = mirrorStream->Seek( static_cast< Int64 >( mPosition ), STREAM_SEEK_SET, nullptr );
+        if ( mirrorResult != S_OK ) {
+            return mirrorResult;
+        }
+    }
+
+    if ( newPosition != nullptr ) {
+        *newPosition = mainPosition;
+    }
+    return S_OK;
+}
+
+COM_DECLSPEC_NOTHROW
+STDMETHODIMP CTeeOutStream::SetSize( UInt64 newSize ) noexcept {
+    const HRESULT result = mMainStream->SetSize( newSize );
+    if ( result != S_OK ) {
+        return result;
+    }
+
+    const UInt64 mirrorSize = newSize > mBasePosition ? newSize - mBasePosition : 0;
+    for ( auto& mirrorStream : mMirrorStreams ) {
+        const HRESULT mirrorResult = mirrorStream->SetSize( mirrorSize );
+        if ( mirrorResult != S_OK ) {
+            return mirrorResult;
+        }
+    }
+
+    if ( mirrorSize != mHashedSize ) {
+        mValidDigests = false; // The output was either truncated or extended with data we didn't hash.
+    }
+    return S_OK;
+}
+
+} // namespace bit7z
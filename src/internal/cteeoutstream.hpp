@@ -0,0 +1,85 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CTEEOUTSTREAM_HPP
+#define CTEEOUTSTREAM_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "bitdigest.hpp"
+#include "internal/com.hpp"
+#include "internal/guids.hpp"
+#include "internal/hasher.hpp"
+#include "internal/macros.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+/**
+ * An output stream forwarding all the writes, seeks, and resizes to a main stream and a set of mirror streams,
+ * while computing the digests of the written data.
+ *
+ * The digests are computed in a streaming way as long as the data is written sequentially; if the data
+ * is written anywhere else (e.g., when 7-Zip seeks back to patch the headers of the archive), the digests
+ * are no longer valid, and they must be computed from the final output.
+ */
+class CTeeOutStream final : public IOutStream, public CMyUnknownImp {
+    public:
+        CTeeOutStream( CMyComPtr< IOutStream > mainStream,
+                       std::vector< CMyComPtr< IOutStream > > mirrorStreams,
+                       ItemHasher&& hasher );
+
+        CTeeOutStream( const CTeeOutStream& ) = delete;
+
+        CTeeOutStream( CTeeOutStream&& ) = delete;
+
+        auto operator=( const CTeeOutStream& ) -> CTeeOutStream& = delete;
+
+        auto operator=( CTeeOutStream&& ) -> CTeeOutStream& = delete;
+
+        MY_UNKNOWN_DESTRUCTOR( ~CTeeOutStream() ) = default;
+
+        // Whether the digests computed while writing match the final output.
+        BIT7Z_NODISCARD auto hasValidDigests() const noexcept -> bool;
+
+        // Returns the digests of the written data (the stream must not be written anymore).
+        auto digests() -> ItemDigests;
+
+        // IOutStream
+        BIT7Z_STDMETHOD( Write, const void* data, UInt32 size, UInt32* processedSize );
+
+        BIT7Z_STDMETHOD( Seek, Int64 offset, UInt32 seekOrigin, UInt64* newPosition );
+
+        BIT7Z_STDMETHOD( SetSize, UInt64 newSize );
+
+        // NOLINTNEXTLINE(modernize-use-noexcept, modernize-use-trailing-return-type, readability-identifier-length)
+        MY_UNKNOWN_IMP1( IOutStream ) //-V2507 //-V2511 //-V835
+
+    private:
+        CMyComPtr< IOutStream > mMainStream;
+        std::vector< CMyComPtr< IOutStream > > mMirrorStreams;
+        ItemHasher mHasher;
+
+        // The position of the main stream when the tee was created (mirrors and digests are relative to it).
+        uint64_t mBasePosition;
+
+        // The current position, relative to the base position.
+        uint64_t mPosition;
+
+        // The size of the data hashed so far, relative to the base position.
+        uint64_t mHashedSize;
+
+        bool mValidDigests;
+};
+
+}  // namespace bit7z
+
+#endif // CTEEOUTSTREAM_HPP
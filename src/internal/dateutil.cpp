@@ -20,6 +20,10 @@ using FileTimeDuration = std::chrono::duration< int64_t, FileTimeTickRate >;
 // Seconds between 01/01/1601 (NT epoch) and 01/01/1970 (Unix epoch):
 constexpr std::chrono::seconds nt_to_unix_epoch{ -11644473600 };
 
+auto FILETIME_to_ticks( FILETIME fileTime ) noexcept -> uint64_t {
+    return ( static_cast< uint64_t >( fileTime.dwHighDateTime ) << 32u ) | fileTime.dwLowDateTime;
+}
+
 #ifndef _WIN32
 
 auto FILETIME_to_file_time_type( FILETIME fileTime ) -> fs::file_time_type {
@@ -51,6 +55,16 @@ auto FILETIME_to_time_type( FILETIME fileTime ) -> time_type {
     return time_type{ std::chrono::duration_cast< std::chrono::system_clock::duration >( unixEpoch ) };
 }
 
+auto time_type_to_FILETIME( const time_type& timePoint ) -> FILETIME {
+    const auto fileTimeDuration = std::chrono::duration_cast< FileTimeDuration >( timePoint.time_since_epoch() ) -
+                                  nt_to_unix_epoch;
+    const auto fileTimeTicks = static_cast< uint64_t >( fileTimeDuration.count() );
+    FILETIME fileTime{};
+    fileTime.dwLowDateTime = static_cast< DWORD >( fileTimeTicks );
+    fileTime.dwHighDateTime = static_cast< DWORD >( fileTimeTicks >> 32u );
+    return fileTime;
+}
+
 auto current_file_time() -> FILETIME {
 #ifdef _WIN32
     FILETIME fileTime{};
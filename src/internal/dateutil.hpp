@@ -11,6 +11,7 @@
 #define DATEUTIL_HPP
 
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 
 #include "bitgenericitem.hpp"
@@ -19,6 +20,11 @@
 
 namespace bit7z {
 
+// The FILETIME struct counts the 100-nanosecond intervals elapsed since 01/01/1601.
+constexpr uint64_t kFileTimeTicksPerSecond = 10000000;
+
+auto FILETIME_to_ticks( FILETIME fileTime ) noexcept -> uint64_t;
+
 #ifndef _WIN32
 
 auto FILETIME_to_file_time_type( FILETIME fileTime ) -> fs::file_time_type;
@@ -29,6 +35,8 @@ auto time_to_FILETIME( std::time_t timeValue ) -> FILETIME;
 
 auto FILETIME_to_time_type( FILETIME fileTime ) -> time_type;
 
+auto time_type_to_FILETIME( const time_type& timePoint ) -> FILETIME;
+
 auto current_file_time() -> FILETIME;
 
 }  // namespace bit7z
@@ -0,0 +1,222 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "bitformat.hpp"
+#include "internal/com.hpp"
+#include "internal/dateutil.hpp"
+#include "internal/deduplication.hpp"
+#include "internal/fsitem.hpp"
+#include "internal/itemcomparison.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+using filesystem::FilesystemItem;
+
+namespace {
+constexpr std::size_t kReadChunkSize = 1024 * 1024; // 1 MiB
+
+// Reads from the stream as many bytes as possible, up to the size of the buffer.
+auto read_chunk( ISequentialInStream* inStream, buffer_t& buffer, std::size_t& readSize ) -> bool {
+    readSize = 0;
+    while ( readSize < buffer.size() ) {
+        UInt32 processedSize = 0;
+        const auto size = static_cast< UInt32 >( buffer.size() - readSize );
+        if ( inStream->Read( &buffer[ readSize ], size, &processedSize ) != S_OK ) {
+            return false;
+        }
+        if ( processedSize == 0 ) {
+            break;
+        }
+        readSize += processedSize;
+    }
+    return true;
+}
+
+auto open_item( const GenericInputItem& item ) -> CMyComPtr< ISequentialInStream > {
+    CMyComPtr< ISequentialInStream > inStream;
+    if ( item.getStream( &inStream ) != S_OK ) {
+        return nullptr;
+    }
+    return inStream;
+}
+
+auto same_content( const GenericInputItem& first, const GenericInputItem& second ) -> bool {
+    const auto firstStream = open_item( first );
+    const auto secondStream = open_item( second );
+    if ( firstStream == nullptr || secondStream == nullptr ) {
+        return false;
+    }
+
+    buffer_t firstBuffer( kReadChunkSize );
+    buffer_t secondBuffer( kReadChunkSize );
+    std::size_t firstSize = 0;
+    std::size_t secondSize = 0;
+    do {
+        if ( !read_chunk( firstStream, firstBuffer, firstSize ) ||
+             !read_chunk( secondStream, secondBuffer, secondSize ) ||
+             firstSize != secondSize ||
+             std::memcmp( firstBuffer.data(), secondBuffer.data(), firstSize ) != 0 ) {
+            return false;
+        }
+    } while ( firstSize == firstBuffer.size() );
+    return true;
+}
+
+auto mtime_ticks( const BitPropVariant& time ) -> uint64_t {
+    return time.isFileTime() ? FILETIME_to_ticks( time.getFileTime() ) : 0;
+}
+
+// The path of the target of the given item, if it is a hard link (an empty string, otherwise).
+auto hard_link_target( const BitInputArchive& archive, uint32_t index ) -> std::string {
+    const BitPropVariant target = archive.itemProperty( index, BitProperty::HardLink );
+    if ( !target.isString() ) {
+        return {};
+    }
+    return fs::path{ target.getNativeString() }.lexically_normal().generic_u8string();
+}
+} // namespace
+
+auto find_duplicates( const BitItemsVector& items ) -> std::vector< std::vector< std::size_t > > {
+    // Note: we use an ordered map, so that the items are hashed following the order of their sizes.
+    std::map< uint64_t, std::vector< std::size_t > > sizeGroups;
+    for ( std::size_t index = 0; index < items.size(); ++index ) {
+        const auto* fsItem = dynamic_cast< const FilesystemItem* >( &items[ index ] );
+        if ( fsItem == nullptr || fsItem->isDir() || fsItem->isSymLink() ) {
+            continue;
+        }
+        const uint64_t size = fsItem->size();
+        if ( size > 0 ) {
+            sizeGroups[ size ].push_back( index );
+        }
+    }
+
+    std::vector< std::vector< std::size_t > > duplicates;
+    for ( const auto& sizeGroup : sizeGroups ) {
+        if ( sizeGroup.second.size() < 2 ) {
+            continue;
+        }
+
+        std::unordered_map< uint32_t, std::vector< std::size_t > > crcGroups;
+        for ( const auto index : sizeGroup.second ) {
+            uint32_t crc = 0;
+            if ( item_crc( items[ index ], crc ) ) {
+                crcGroups[ crc ].push_back( index );
+            }
+        }
+
+        for ( const auto& crcGroup : crcGroups ) {
+            // Each candidate joins the first set whose content is the same as the candidate's one.
+            std::vector< std::vector< std::size_t > > contentSets;
+            for ( const auto index : crcGroup.second ) {
+                auto contentSet = std::find_if( contentSets.begin(), contentSets.end(),
+                                                [ &items, index ]( const std::vector< std::size_t >& set ) -> bool {
+                                                    return same_content( items[ set.front() ], items[ index ] );
+                                                } );
+                if ( contentSet != contentSets.end() ) {
+                    contentSet->push_back( index );
+                } else {
+                    contentSets.push_back( { index } );
+                }
+            }
+            for ( auto& contentSet : contentSets ) {
+                if ( contentSet.size() > 1 ) {
+                    duplicates.push_back( std::move( contentSet ) );
+                }
+            }
+        }
+    }
+
+    std::sort( duplicates.begin(), duplicates.end(),
+               []( const std::vector< std::size_t >& first, const std::vector< std::size_t >& second ) -> bool {
+                   return first.front() < second.front();
+               } );
+    return duplicates;
+}
+
+auto find_archived_duplicates( const BitInputArchive& archive,
+                               const std::vector< uint32_t >& indices,
+                               bool sameMetadata ) -> std::vector< std::vector< uint32_t > > {
+    // The items are grouped by size, CRC32, and (if required) attributes and modification time.
+    using DuplicateKey = std::tuple< uint64_t, uint32_t, uint32_t, uint64_t >;
+    std::map< DuplicateKey, std::vector< uint32_t > > groups;
+    for ( const auto index : indices ) {
+        const BitArchiveItemOffset item = archive.itemAt( index );
+        const BitPropVariant crc = item.itemProperty( BitProperty::CRC );
+        if ( item.isDir() || item.isSymLink() || item.size() == 0 || crc.isEmpty() ) {
+            continue;
+        }
+        const uint32_t attributes = sameMetadata ? item.attributes() : 0;
+        const uint64_t modifiedTime = sameMetadata ? mtime_ticks( item.itemProperty( BitProperty::MTime ) ) : 0;
+        groups[ DuplicateKey{ item.size(), crc.getUInt32(), attributes, modifiedTime } ].push_back( index );
+    }
+
+    std::vector< std::vector< uint32_t > > duplicates;
+    for ( auto& group : groups ) {
+        if ( group.second.size() > 1 ) {
+            std::sort( group.second.begin(), group.second.end() );
+            duplicates.push_back( std::move( group.second ) );
+        }
+    }
+    std::sort( duplicates.begin(), duplicates.end(),
+               []( const std::vector< uint32_t >& first, const std::vector< uint32_t >& second ) -> bool {
+                   return first.front() < second.front();
+               } );
+    return duplicates;
+}
+
+auto has_hard_links( const BitInputArchive& archive ) -> bool {
+    return archive.detectedFormat() == BitFormat::Tar;
+}
+
+auto find_hard_links( const BitInputArchive& archive,
+                      const std::vector< uint32_t >& indices ) -> std::vector< std::vector< uint32_t > > {
+    std::map< uint32_t, std::vector< uint32_t > > targetsLinks;
+    std::unordered_map< std::string, uint32_t > filesIndex; // Lazily built, as most archives have no hard links.
+    for ( const auto index : indices ) {
+        const auto targetPath = hard_link_target( archive, index );
+        if ( targetPath.empty() ) {
+            continue;
+        }
+        if ( filesIndex.empty() ) {
+            for ( uint32_t fileIndex = 0; fileIndex < archive.itemsCount(); ++fileIndex ) {
+                const BitArchiveItemOffset item = archive.itemAt( fileIndex );
+                if ( !item.isDir() && hard_link_target( archive, fileIndex ).empty() ) {
+                    const auto filePath = fs::path{ item.nativePath() }.lexically_normal().generic_u8string();
+                    filesIndex.emplace( filePath, fileIndex ); // Note: the first item with the same path is kept.
+                }
+            }
+        }
+        const auto target = filesIndex.find( targetPath );
+        if ( target != filesIndex.cend() ) {
+            targetsLinks[ target->second ].push_back( index );
+        }
+    }
+
+    std::vector< std::vector< uint32_t > > result;
+    result.reserve( targetsLinks.size() );
+    for ( auto& targetLinks : targetsLinks ) {
+        std::vector< uint32_t > linksSet{ targetLinks.first };
+        linksSet.insert( linksSet.end(), targetLinks.second.cbegin(), targetLinks.second.cend() );
+        result.push_back( std::move( linksSet ) );
+    }
+    return result;
+}
+
+} // namespace bit7z
@@ -0,0 +1,79 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef DEDUPLICATION_HPP
+#define DEDUPLICATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitinputarchive.hpp"
+#include "bititemsvector.hpp"
+
+namespace bit7z {
+
+/**
+ * @brief Finds the sets of items having identical content in the given vector.
+ *
+ * The candidates are grouped by size, then by the CRC32 of their content; finally, the items having the same CRC32
+ * are compared byte by byte, so that hash collisions never produce false duplicates.
+ *
+ * @note Only non-empty filesystem files are considered: reading the content of stream items would consume it.
+ *
+ * @param items the items to be checked.
+ *
+ * @return the sets of duplicate items, each one containing (in increasing order) the indices of the items
+ *         in the vector; the sets are sorted by their first index.
+ */
+auto find_duplicates( const BitItemsVector& items ) -> std::vector< std::vector< std::size_t > >;
+
+/**
+ * @brief Finds the sets of items of an archive expected to have identical content, i.e., the non-empty files
+ * having the same size and the same CRC32 stored in the archive.
+ *
+ * @note Unlike find_duplicates, the content of the items is not compared (it would require decoding them),
+ *       and the items without a stored CRC32 are never considered duplicates.
+ *
+ * @param archive      the archive containing the items.
+ * @param indices      the indices of the items to be checked.
+ * @param sameMetadata whether the duplicates must also have the same attributes and modification time
+ *                     (e.g., when they will be hard links to the same file).
+ *
+ * @return the sets of duplicate items, each one containing (in increasing order) the indices of the items
+ *         in the archive; the sets are sorted by their first index.
+ */
+auto find_archived_duplicates( const BitInputArchive& archive,
+                               const std::vector< uint32_t >& indices,
+                               bool sameMetadata ) -> std::vector< std::vector< uint32_t > >;
+
+/**
+ * @return whether the given archive might contain hard links having no data on their own
+ *         (currently, only tar archives, whose hard links are reported by 7-Zip as empty files).
+ */
+auto has_hard_links( const BitInputArchive& archive ) -> bool;
+
+/**
+ * @brief Finds the hard links among the given items of an archive (e.g., the ones stored in tar archives),
+ * which have no data on their own, and must be extracted from the file they refer to.
+ *
+ * @note The links whose target is not a file of the archive are ignored.
+ *
+ * @param archive the archive containing the items.
+ * @param indices the indices of the items to be checked.
+ *
+ * @return the sets of linked items, each one containing the index of the target file followed by the indices
+ *         of its links (in the order they are given); the sets are sorted by the index of their target.
+ */
+auto find_hard_links( const BitInputArchive& archive,
+                      const std::vector< uint32_t >& indices ) -> std::vector< std::vector< uint32_t > >;
+
+}  // namespace bit7z
+
+#endif //DEDUPLICATION_HPP
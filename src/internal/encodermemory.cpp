@@ -0,0 +1,260 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "bitformat.hpp"
+#include "bitresourcelimits.hpp"
+#include "internal/encodermemory.hpp"
+
+namespace bit7z {
+
+constexpr uint64_t kMebibyte = 1024 * 1024;
+
+// The auto-tuning never scales the dictionary size below this value.
+constexpr uint64_t kMinTunedDictionarySize = kMebibyte;
+
+namespace {
+auto property_integer( const BitPropVariant& value, uint64_t& result ) -> bool {
+    if ( value.isUInt8() || value.isUInt16() || value.isUInt32() || value.isUInt64() ) {
+        result = value.getUInt64();
+        return true;
+    }
+    if ( value.isInt8() || value.isInt16() || value.isInt32() || value.isInt64() ) {
+        const int64_t signedValue = value.getInt64();
+        result = static_cast< uint64_t >( signedValue );
+        return signedValue >= 0;
+    }
+    return false;
+}
+
+// Parses the decimal number at the beginning of the given string, returning the position of the first non-digit.
+auto parse_number( const tstring& text, uint64_t& number ) -> std::size_t {
+    number = 0;
+    std::size_t position = 0;
+    for ( ; position < text.size() && text[ position ] >= '0' && text[ position ] <= '9'; ++position ) {
+        number = ( number * 10 ) + static_cast< uint64_t >( text[ position ] - '0' );
+    }
+    return position;
+}
+
+// Parses a dictionary size as 7-Zip does: numbers below 32 are powers of two, while strings can have a b/k/m/g suffix.
+auto dictionary_size_property( const BitPropVariant& value, uint64_t& size ) -> bool {
+    uint64_t number = 0;
+    if ( !value.isString() ) {
+        if ( !property_integer( value, number ) ) {
+            return false;
+        }
+        size = number < 32 ? ( uint64_t{ 1 } << number ) : number;
+        return true;
+    }
+
+    const tstring text = value.getString();
+    const std::size_t suffixPosition = parse_number( text, number );
+    if ( suffixPosition == 0 || suffixPosition + 1 < text.size() ) {
+        return false;
+    }
+    if ( suffixPosition == text.size() ) {
+        if ( number >= 64 ) {
+            return false;
+        }
+        size = uint64_t{ 1 } << number;
+        return true;
+    }
+    switch ( text[ suffixPosition ] ) {
+        case 'b':
+        case 'B':
+            size = number;
+            return true;
+        case 'k':
+        case 'K':
+            size = number * 1024;
+            return true;
+        case 'm':
+        case 'M':
+            size = number * kMebibyte;
+            return true;
+        case 'g':
+        case 'G':
+            size = number * 1024 * kMebibyte;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Parses the value of the "mt" property; "on" (or true) means the default number of threads.
+auto threads_property( const BitPropVariant& value, uint32_t defaultThreads, uint32_t& threads ) -> bool {
+    if ( value.isBool() ) {
+        threads = value.getBool() ? defaultThreads : 1;
+        return true;
+    }
+    uint64_t number = 0;
+    if ( value.isString() ) {
+        const tstring text = value.getString();
+        if ( text == BIT7Z_STRING( "on" ) ) {
+            threads = defaultThreads;
+            return true;
+        }
+        if ( text == BIT7Z_STRING( "off" ) ) {
+            threads = 1;
+            return true;
+        }
+        if ( text.empty() || parse_number( text, number ) != text.size() ) {
+            return false;
+        }
+    } else if ( !property_integer( value, number ) ) {
+        return false;
+    }
+    threads = number == 0 ? defaultThreads : static_cast< uint32_t >( ( std::min )( number, uint64_t{ 1024 } ) );
+    return true;
+}
+} // namespace
+
+auto default_threads_count() -> uint32_t {
+    const uint32_t cpuLimit = default_resource_limits().cpuCount;
+    return cpuLimit != 0 ? cpuLimit : ( std::max )( std::thread::hardware_concurrency(), 1u );
+}
+
+auto default_dictionary_size( BitCompressionMethod method, BitCompressionLevel level ) noexcept -> uint64_t {
+    const auto levelValue = static_cast< int >( level );
+    if ( method == BitCompressionMethod::Ppmd ) {
+        return ( levelValue >= 9 ? 192 : ( levelValue >= 7 ? 64 : 16 ) ) * kMebibyte;
+    }
+    // Default dictionary sizes used by 7-Zip for the LZMA and LZMA2 methods.
+    if ( levelValue >= 9 ) {
+        return 64 * kMebibyte;
+    }
+    if ( levelValue >= 7 ) {
+        return 32 * kMebibyte;
+    }
+    if ( levelValue >= 5 ) {
+        return 16 * kMebibyte;
+    }
+    return levelValue >= 3 ? 4 * kMebibyte : 256 * 1024;
+}
+
+auto encoder_memory_usage( const EncoderSettings& settings ) noexcept -> uint64_t {
+    const uint64_t threads = ( std::max )( settings.threads, 1u );
+
+    /* Note: these are rough approximations of the memory requirements reported by 7-Zip for each method.
+     *       The Deflate and PPMd encoders are single-threaded, so multiple threads are used only by formats
+     *       compressing multiple items in parallel (i.e., zip), each one with its own encoder. */
+    const uint64_t parallelEncoders = settings.parallelItems ? threads : 1;
+    switch ( settings.method ) {
+        case BitCompressionMethod::Copy:
+            return kMebibyte;
+        case BitCompressionMethod::Deflate:
+        case BitCompressionMethod::Deflate64:
+            return parallelEncoders * 2 * kMebibyte;
+        case BitCompressionMethod::BZip2:
+            return threads * 10 * kMebibyte;
+        case BitCompressionMethod::Ppmd:
+            return parallelEncoders * ( settings.dictionarySize + 2 * kMebibyte );
+        case BitCompressionMethod::Lzma:
+        case BitCompressionMethod::Lzma2:
+        default: {
+            // The binary-tree match finder (used from the normal level) needs more memory than the hash-chain one.
+            const uint64_t matchFinderFactor = static_cast< int >( settings.level ) >= 5 ? 23 : 15;
+            const uint64_t encoderMemory = ( ( settings.dictionarySize * matchFinderFactor ) / 2 ) + 4 * kMebibyte;
+
+            // Each LZMA encoder uses up to two threads.
+            const uint64_t encoders = ( std::max )( threads / 2, uint64_t{ 1 } );
+            if ( settings.method == BitCompressionMethod::Lzma ) {
+                return settings.parallelItems ? encoders * encoderMemory : encoderMemory;
+            }
+            if ( threads < 4 ) {
+                return encoderMemory; // A single LZMA2 encoder.
+            }
+
+            // Each LZMA2 encoder buffers its own block of input data, which is never bigger than a solid block.
+            uint64_t blockSize = ( std::min )( ( std::max )( settings.dictionarySize * 4, kMebibyte ),
+                                               256 * kMebibyte );
+            if ( settings.maxBlockSize > 0 ) {
+                blockSize = ( std::min )( blockSize, settings.maxBlockSize );
+            }
+            return encoders * ( encoderMemory + blockSize );
+        }
+    }
+}
+
+auto configured_encoder_settings( const BitAbstractArchiveCreator& creator,
+                                  BitCompressionMethod method ) -> EncoderSettings {
+    const BitCompressionLevel level = creator.compressionLevel();
+    if ( level == BitCompressionLevel::None ) {
+        method = BitCompressionMethod::Copy;
+    }
+
+    EncoderSettings settings{};
+    settings.method = method;
+    settings.level = level;
+    settings.threads = creator.threadsCount() != 0 ? creator.threadsCount() : default_threads_count();
+    settings.dictionarySize = ( creator.dictionarySize() != 0 && method == creator.compressionMethod() ) ?
+                              creator.dictionarySize() : default_dictionary_size( method, level );
+    settings.parallelItems = creator.compressionFormat() == BitFormat::Zip;
+    settings.maxBlockSize = creator.solidMode() ? creator.solidOptions().maxBlockSize : 0;
+    return settings;
+}
+
+void apply_format_properties( EncoderSettings& settings,
+                              const std::map< std::wstring, BitPropVariant >& properties,
+                              const wchar_t* dictionaryPropertyName ) {
+    if ( dictionaryPropertyName != nullptr ) {
+        const auto dictionaryProperty = properties.find( dictionaryPropertyName );
+        uint64_t dictionarySize = 0;
+        if ( dictionaryProperty != properties.end() &&
+             dictionary_size_property( dictionaryProperty->second, dictionarySize ) ) {
+            settings.dictionarySize = dictionarySize;
+        }
+    }
+
+    const auto threadsProperty = properties.find( L"mt" );
+    uint32_t threads = 0;
+    if ( threadsProperty != properties.end() &&
+         threads_property( threadsProperty->second, default_threads_count(), threads ) ) {
+        settings.threads = threads;
+    }
+}
+
+auto tune_encoder_settings( EncoderSettings settings, uint64_t budget ) noexcept -> EncoderSettings {
+    // First, we reduce the number of threads, since it affects only the compression speed...
+    uint64_t memoryUsage = encoder_memory_usage( settings );
+    while ( settings.threads > 1 && memoryUsage > budget ) {
+        /* Note: the memory usage of some encoders doesn't depend on the number of threads (e.g., Deflate or Copy),
+         *       or it changes only every few threads (e.g., LZMA2): we keep the threads that don't save any memory. */
+        EncoderSettings fewerThreads = settings;
+        uint64_t fewerThreadsUsage = memoryUsage;
+        while ( fewerThreads.threads > 1 && fewerThreadsUsage >= memoryUsage ) {
+            --fewerThreads.threads;
+            fewerThreadsUsage = encoder_memory_usage( fewerThreads );
+        }
+        if ( fewerThreadsUsage >= memoryUsage ) {
+            break;
+        }
+        settings.threads = fewerThreads.threads;
+        memoryUsage = fewerThreadsUsage;
+    }
+
+    // ...then, if needed, we reduce the dictionary size, which affects the compression ratio.
+    const bool hasDictionary = settings.method == BitCompressionMethod::Lzma ||
+                               settings.method == BitCompressionMethod::Lzma2 ||
+                               settings.method == BitCompressionMethod::Ppmd;
+    while ( hasDictionary &&
+            settings.dictionarySize / 2 >= kMinTunedDictionarySize &&
+            encoder_memory_usage( settings ) > budget ) {
+        settings.dictionarySize /= 2;
+    }
+    return settings;
+}
+
+}  // namespace bit7z
@@ -0,0 +1,87 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ENCODERMEMORY_HPP
+#define ENCODERMEMORY_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bitpropvariant.hpp"
+
+namespace bit7z {
+
+/**
+ * The settings of an encoder that affect its memory usage.
+ */
+struct EncoderSettings {
+    BitCompressionMethod method;
+    BitCompressionLevel level;
+    uint64_t dictionarySize; // For PPMd, the size of the model's memory.
+    uint32_t threads;
+    bool parallelItems;      // Whether each thread compresses a different item with its own encoder (zip archives).
+    uint64_t maxBlockSize;   // The maximum size of the data of each solid block (0 = unknown).
+};
+
+/**
+ * @return the number of threads used by default, i.e., the CPU limit of the process (if any),
+ *         or the number of hardware threads of the system.
+ */
+auto default_threads_count() -> uint32_t;
+
+/**
+ * @return the default dictionary size used by 7-Zip for the given compression method and level.
+ */
+auto default_dictionary_size( BitCompressionMethod method, BitCompressionLevel level ) noexcept -> uint64_t;
+
+/**
+ * @return an approximation of the memory (in bytes) needed by an encoder with the given settings.
+ *
+ * @note The word size (i.e., the number of fast bytes of LZMA, or the model order of PPMd) is not considered,
+ *       as its effect on the memory usage is negligible.
+ */
+auto encoder_memory_usage( const EncoderSettings& settings ) noexcept -> uint64_t;
+
+/**
+ * @return the settings of the encoder configured by the given creator for the given compression method
+ *         (unset values, i.e., the dictionary size and the number of threads, are replaced by 7-Zip's defaults).
+ */
+auto configured_encoder_settings( const BitAbstractArchiveCreator& creator,
+                                  BitCompressionMethod method ) -> EncoderSettings;
+
+/**
+ * Updates the given encoder settings with the dictionary size and the number of threads (if any)
+ * set by the given format properties, i.e., the ones set via BitAbstractArchiveCreator::setFormatProperty.
+ *
+ * @param settings               the encoder settings to be updated.
+ * @param properties             the format properties.
+ * @param dictionaryPropertyName the name of the property setting the encoder's dictionary size
+ *                               (nullptr, if the dictionary size of the encoder must not be updated).
+ */
+void apply_format_properties( EncoderSettings& settings,
+                              const std::map< std::wstring, BitPropVariant >& properties,
+                              const wchar_t* dictionaryPropertyName );
+
+/**
+ * Scales down the number of threads, and then the dictionary size, of the given encoder settings
+ * until the encoder's memory usage fits the given budget (or no further scaling is possible).
+ * The number of threads is reduced only when this lowers the memory usage of the encoder.
+ *
+ * @param settings the encoder settings to be tuned.
+ * @param budget   the maximum amount of memory (in bytes) the encoder should use.
+ *
+ * @return the tuned encoder settings.
+ */
+auto tune_encoder_settings( EncoderSettings settings, uint64_t budget ) noexcept -> EncoderSettings;
+
+}  // namespace bit7z
+
+#endif //ENCODERMEMORY_HPP
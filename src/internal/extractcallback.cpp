@@ -11,11 +11,13 @@
  */
 
 #include <exception>
+#include <utility>
 
 #include "bitexception.hpp"
 #include "internal/extractcallback.hpp"
 #include "internal/operationcategory.hpp"
 #include "internal/stringutil.hpp"
+#include "internal/util.hpp"
 
 namespace bit7z {
 
@@ -23,7 +25,17 @@ ExtractCallback::ExtractCallback( const BitInputArchive& inputArchive )
     : Callback( inputArchive.handler() ),
       mInputArchive( inputArchive ),
       mExtractMode( ExtractMode::Extract ),
-      mIsLastItemEncrypted{ false } {}
+      mIsLastItemEncrypted{ false },
+      mHashedIndex{ 0 } {}
+
+void ExtractCallback::prepareReadAhead( const std::vector< uint32_t >& indices ) {
+    const uint64_t window = mHandler.readAheadWindow();
+    if ( window == 0 || mInputArchive.archivePath().empty() ) {
+        mReadAheadAdvisor.reset();
+        return;
+    }
+    mReadAheadAdvisor = std::make_unique< ReadAheadAdvisor >( mInputArchive, indices, window );
+}
 
 auto ExtractCallback::finishOperation( OperationResult operationResult ) -> HRESULT {
     releaseStream();
@@ -66,18 +78,40 @@ COM_DECLSPEC_NOTHROW
 STDMETHODIMP ExtractCallback::GetStream( UInt32 index, ISequentialOutStream** outStream, Int32 askExtractMode ) noexcept
 try {
     *outStream = nullptr;
+    mHashingStream.Release();
     releaseStream();
 
+    if ( mReadAheadAdvisor ) {
+        mReadAheadAdvisor->advise( index );
+    }
+
     auto isEncrypted = itemProperty( index, BitProperty::Encrypted );
     if ( isEncrypted.isBool() ) {
         mIsLastItemEncrypted = isEncrypted.getBool();
     }
 
-    if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract ) {
+    const bool computeDigests = mHandler.digestCallback() && !isItemFolder( index );
+    if ( askExtractMode == NArchive::NExtract::NAskMode::kTest && computeDigests ) {
+        // Hash-only mode: the content of the tested item is hashed and then discarded.
+        mHashingStream = bit7z::make_com< CHashingOutStream >( nullptr, mHandler.library(), mHandler.digestTypes() );
+    } else if ( askExtractMode != NArchive::NExtract::NAskMode::kExtract ) {
         return S_OK;
+    } else {
+        const HRESULT result = getOutStream( index, outStream );
+        if ( result != S_OK || *outStream == nullptr || !computeDigests ) {
+            return result;
+        }
+        CMyComPtr< ISequentialOutStream > innerStream;
+        innerStream.Attach( *outStream );
+        *outStream = nullptr;
+        mHashingStream = bit7z::make_com< CHashingOutStream >( std::move( innerStream ),
+                                                               mHandler.library(),
+                                                               mHandler.digestTypes() );
     }
-
-    return getOutStream( index, outStream );
+    mHashedIndex = index;
+    CMyComPtr< ISequentialOutStream > hashingStream{ mHashingStream };
+    *outStream = hashingStream.Detach();
+    return S_OK;
 } catch ( const BitException& ex ) {
     mErrorException = std::make_exception_ptr( ex );
     return ex.hresultCode();
@@ -115,7 +149,26 @@ STDMETHODIMP ExtractCallback::SetOperationResult( Int32 operationResult ) noexce
         mErrorException = std::make_exception_ptr( BitException( msg, error ) );
     }
 
-    return finishOperation( result );
+    const HRESULT finishResult = finishOperation( result );
+    const HRESULT digestsResult = reportDigests( result );
+    return finishResult != S_OK ? finishResult : digestsResult;
+}
+
+auto ExtractCallback::reportDigests( OperationResult operationResult ) noexcept -> HRESULT {
+    if ( !mHashingStream ) {
+        return S_OK;
+    }
+    HRESULT result = S_OK;
+    if ( operationResult == OperationResult::Success ) {
+        try {
+            mHandler.digestCallback()( mHashedIndex, mHashingStream->digests() );
+        } catch ( ... ) {
+            mErrorException = std::current_exception();
+            result = E_ABORT;
+        }
+    }
+    mHashingStream.Release();
+    return result;
 }
 
 COM_DECLSPEC_NOTHROW
@@ -10,12 +10,16 @@
 #ifndef EXTRACTCALLBACK_HPP
 #define EXTRACTCALLBACK_HPP
 
+#include <memory>
 #include <system_error>
+#include <vector>
 
 #include "bitinputarchive.hpp"
 #include "internal/callback.hpp"
+#include "internal/chashingoutstream.hpp"
 #include "internal/macros.hpp"
 #include "internal/operationresult.hpp"
+#include "internal/readaheadadvisor.hpp"
 
 #include <7zip/Archive/IArchive.h>
 #include <7zip/ICoder.h>
@@ -73,6 +77,13 @@ class ExtractCallback : public Callback,
             return mErrorException;
         }
 
+        /**
+         * Prepares the read-ahead hints for the extraction of the given items (if enabled by the handler).
+         *
+         * @param indices   the indices of the items to be extracted (all the items, if empty).
+         */
+        void prepareReadAhead( const std::vector< uint32_t >& indices );
+
         // NOLINTNEXTLINE(modernize-use-noexcept, modernize-use-trailing-return-type, readability-identifier-length)
         MY_UNKNOWN_IMP3( IArchiveExtractCallback, ICompressProgressInfo, ICryptoGetTextPassword ) //-V2507 //-V2511 //-V835
 
@@ -110,8 +121,22 @@ class ExtractCallback : public Callback,
         ExtractMode mExtractMode;
         bool mIsLastItemEncrypted;
         std::exception_ptr mErrorException;
+        CMyComPtr< CHashingOutStream > mHashingStream;
+        uint32_t mHashedIndex;
+        std::unique_ptr< ReadAheadAdvisor > mReadAheadAdvisor;
+
+        auto reportDigests( OperationResult operationResult ) noexcept -> HRESULT;
 };
 
+/**
+ * Extracts (or tests) the items at the given indices (all the items, if no index is given) of the archive,
+ * throwing a BitException if the operation fails.
+ */
+void extract_arc( IInArchive* inArchive,
+                  const std::vector< uint32_t >& indices,
+                  ExtractCallback* extractCallback,
+                  ExtractMode mode = ExtractMode::Extract );
+
 }  // namespace bit7z
 
 #endif // EXTRACTCALLBACK_HPP
@@ -10,9 +10,18 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <numeric>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 #include "bitexception.hpp"
+#include "internal/cbufferoutstream.hpp"
+#include "internal/deduplication.hpp"
 #include "internal/fileextractcallback.hpp"
 #include "internal/fsutil.hpp"
+#include "internal/itemcomparison.hpp"
 #include "internal/stringutil.hpp"
 #include "internal/util.hpp"
 
@@ -21,18 +30,78 @@ using namespace NWindows;
 
 namespace bit7z {
 
+constexpr auto kNoOutputSlot = UringFileWriter::kSlotsCount;
+
+/* Gets the permissions to be used when creating the output file of the given item (the same ones set
+ * by fsutil::set_file_attributes); returns false if the item cannot be written asynchronously. */
+auto output_file_mode( const ProcessedItem& item, uint32_t& mode ) -> bool {
+#ifdef _WIN32
+    (void)item;
+    (void)mode;
+    return false;
+#else
+    mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH;
+    if ( !item.areAttributesDefined() ) {
+        return true;
+    }
+
+    const uint32_t attributes = item.attributes();
+    if ( ( attributes & FILE_ATTRIBUTE_UNIX_EXTENSION ) != 0 ) {
+        const auto unixMode = static_cast< mode_t >( attributes >> 16U );
+        if ( S_ISLNK( unixMode ) ) { // Symbolic links are restored from the content of their extracted file.
+            return false;
+        }
+        if ( S_ISREG( unixMode ) ) {
+            mode = unixMode & static_cast< mode_t >( fs::perms::mask );
+        }
+    } else if ( ( attributes & FILE_ATTRIBUTE_READONLY ) != 0 ) {
+        mode &= static_cast< mode_t >( ~( S_IWUSR | S_IWGRP | S_IWOTH ) );
+    }
+    return true;
+#endif
+}
+
 FileExtractCallback::FileExtractCallback( const BitInputArchive& inputArchive, const tstring& directoryPath )
     : ExtractCallback( inputArchive ),
       mInFilePath( tstring_to_path( inputArchive.archivePath() ) ),
       mDirectoryPath( tstring_to_path( directoryPath ) ),
-      mRetainDirectories( inputArchive.handler().retainDirectories() ) {}
+      mRetainDirectories( inputArchive.handler().retainDirectories() ),
+      mCurrentIndex{ 0 },
+      mOutputSlot{ kNoOutputSlot } {
+    if ( inputArchive.handler().duplicateItemsMode() != DuplicateItemsMode::Extract ||
+         has_hard_links( inputArchive ) ) {
+        mWrittenItems.resize( inputArchive.itemsCount(), false );
+    }
+
+    // Note: when the digests of the items are required, their data must pass through the extraction callback.
+    const auto storedCopyMode = inputArchive.handler().storedCopyMode();
+    if ( storedCopyMode != StoredCopyMode::Disabled && !inputArchive.handler().digestCallback() ) {
+        mStoredItemsCopier = std::make_unique< StoredItemsCopier >( inputArchive, storedCopyMode );
+    }
+
+    if ( inputArchive.handler().asyncFileOutput() ) {
+        auto uringFileWriter = std::make_unique< UringFileWriter >();
+        if ( uringFileWriter->isAvailable() ) { // Otherwise, the files are written as usual.
+            mUringFileWriter = std::move( uringFileWriter );
+        }
+    }
+}
+
+constexpr auto kCannotDeleteOutput = "Cannot delete output file";
 
 void FileExtractCallback::releaseStream() {
     mFileOutStream.Release(); // We need to release the file to change its modified time!
+    if ( mOutputSlot != kNoOutputSlot ) { // The previous item was not completed.
+        mUringFileWriter->releaseSlot( mOutputSlot );
+        mOutputSlot = kNoOutputSlot;
+    }
 }
 
 auto FileExtractCallback::finishOperation( OperationResult operationResult ) -> HRESULT {
     const HRESULT result = operationResult != OperationResult::Success ? E_FAIL : S_OK;
+    if ( mOutputSlot != kNoOutputSlot ) {
+        return finishAsyncOutput( result );
+    }
     if ( mFileOutStream == nullptr ) {
         return result;
     }
@@ -47,6 +116,48 @@ auto FileExtractCallback::finishOperation( OperationResult operationResult ) ->
         return result;
     }
 
+    setFileMetadata();
+    if ( result == S_OK ) {
+        markWrittenItem( mCurrentIndex );
+    }
+    return result;
+}
+
+auto FileExtractCallback::finishAsyncOutput( HRESULT result ) -> HRESULT {
+    const uint32_t slot = mOutputSlot;
+    mOutputSlot = kNoOutputSlot;
+
+    uint32_t mode = 0;
+    if ( result != S_OK || extractMode() != ExtractMode::Extract || !output_file_mode( mCurrentItem, mode ) ) {
+        mUringFileWriter->releaseSlot( slot );
+        return result;
+    }
+
+    try {
+        const FILETIME modifiedTime = mCurrentItem.hasModifiedTime() ? mCurrentItem.modifiedTime() : FILETIME{};
+        mUringFileWriter->writeFile( slot, mFilePathOnDisk, mode,
+                                     mCurrentItem.hasModifiedTime() ? &modifiedTime : nullptr );
+    } catch ( const std::bad_alloc& ) {
+        mUringFileWriter->releaseSlot( slot );
+        return E_OUTOFMEMORY;
+    }
+    markWrittenItem( mCurrentIndex ); // Note: the file is available only after flushOutput().
+    return result;
+}
+
+void FileExtractCallback::flushOutput() {
+    if ( mUringFileWriter != nullptr ) {
+        mUringFileWriter->flush();
+    }
+}
+
+void FileExtractCallback::markWrittenItem( uint32_t index ) {
+    if ( index < mWrittenItems.size() ) {
+        mWrittenItems[ index ] = true;
+    }
+}
+
+void FileExtractCallback::setFileMetadata() const {
 #ifdef _WIN32
     const auto creationTime = mCurrentItem.hasCreationTime() ? mCurrentItem.creationTime() : FILETIME{};
     const auto accessTime = mCurrentItem.hasAccessTime() ? mCurrentItem.accessTime() : FILETIME{};
@@ -61,11 +172,9 @@ auto FileExtractCallback::finishOperation( OperationResult operationResult ) ->
     if ( mCurrentItem.areAttributesDefined() ) {
         filesystem::fsutil::set_file_attributes( mFilePathOnDisk, mCurrentItem.attributes() );
     }
-    return result;
 }
 
-auto FileExtractCallback::getCurrentItemPath() const -> fs::path {
-    fs::path filePath = mCurrentItem.path();
+auto FileExtractCallback::getItemPath( fs::path filePath ) const -> fs::path {
     if ( filePath.empty() ) {
         filePath = !mInFilePath.empty() ? mInFilePath.stem() : fs::path{ kEmptyFileAlias };
     } else if ( !mRetainDirectories ) {
@@ -76,65 +185,178 @@ auto FileExtractCallback::getCurrentItemPath() const -> fs::path {
     return filePath;
 }
 
-constexpr auto kCannotDeleteOutput = "Cannot delete output file";
-
-auto FileExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT {
-    mCurrentItem.loadItemInfo( inputArchive(), index );
-
-    auto filePath = getCurrentItemPath();
+auto FileExtractCallback::getPathOnDisk( const fs::path& filePath ) const -> fs::path {
 #if defined( _WIN32 ) && defined( BIT7Z_PATH_SANITIZATION )
-    mFilePathOnDisk = mDirectoryPath / filesystem::fsutil::sanitize_path( filePath );
+    fs::path pathOnDisk = mDirectoryPath / filesystem::fsutil::sanitize_path( filePath );
 #else
-    mFilePathOnDisk = mDirectoryPath / filePath;
+    fs::path pathOnDisk = mDirectoryPath / filePath;
 #endif
 
 #if defined( _WIN32 ) && defined( BIT7Z_AUTO_PREFIX_LONG_PATHS )
-    if ( filesystem::fsutil::should_format_long_path( mFilePathOnDisk ) ) {
-        mFilePathOnDisk = filesystem::fsutil::format_long_path( mFilePathOnDisk );
+    if ( filesystem::fsutil::should_format_long_path( pathOnDisk ) ) {
+        pathOnDisk = filesystem::fsutil::format_long_path( pathOnDisk );
     }
 #endif
+    return pathOnDisk;
+}
 
-    if ( !isItemFolder( index ) ) { // File
-        if ( mHandler.fileCallback() ) {
-            // Here we don't use the path_to_tstring function to avoid allocating a string object
-            // when using BIT7Z_USE_NATIVE_STRING.
+auto FileExtractCallback::outdatedItems( const std::vector< uint32_t >& indices ) const -> std::vector< uint32_t > {
+    std::vector< uint32_t > allIndices;
+    if ( indices.empty() ) {
+        allIndices.resize( inputArchive().itemsCount() );
+        std::iota( allIndices.begin(), allIndices.end(), 0 );
+    }
+
+    const OverwriteMode overwriteMode = mHandler.overwriteMode();
+    std::vector< uint32_t > result;
+    for ( const auto index : indices.empty() ? allIndices : indices ) {
+        // Note: folders are always extracted, as it costs nothing to (re)create them.
+        if ( isItemFolder( index ) ) {
+            result.push_back( index );
+            continue;
+        }
+        const BitPropVariant itemPath = inputArchive().itemProperty( index, BitProperty::Path );
+        const fs::path filePath = itemPath.isString() ? fs::path{ itemPath.getNativeString() } : fs::path{};
+        const fs::path pathOnDisk = getPathOnDisk( getItemPath( filePath ) );
+        if ( !is_extracted_item_current( inputArchive(), index, pathOnDisk, overwriteMode ) ) {
+            result.push_back( index );
+        }
+    }
+    return result;
+}
+
+auto FileExtractCallback::extractDuplicate( uint32_t sourceIndex, uint32_t index ) -> bool {
+    if ( sourceIndex >= mWrittenItems.size() || !mWrittenItems[ sourceIndex ] ) {
+        return false;
+    }
+
+    mCurrentItem.loadItemInfo( inputArchive(), sourceIndex );
+    const fs::path sourcePath = getPathOnDisk( getItemPath( mCurrentItem.path() ) );
+
+    mCurrentItem.loadItemInfo( inputArchive(), index );
+    mCurrentIndex = index;
+    const fs::path filePath = getItemPath( mCurrentItem.path() );
+    mFilePathOnDisk = getPathOnDisk( filePath );
+    if ( mFilePathOnDisk == sourcePath ) { // E.g., when not retaining the directories of the items.
+        return true;
+    }
+    if ( !prepareOutputFile( filePath ) ) {
+        return true;
+    }
+
+    std::error_code error;
+    const bool useHardLink = mHandler.duplicateItemsMode() == DuplicateItemsMode::HardLink;
+    bool isLinked = false;
+    if ( useHardLink ) {
+        fs::create_hard_link( sourcePath, mFilePathOnDisk, error );
+        isLinked = !error;
+    } else {
+        isLinked = filesystem::fsutil::clone_file( sourcePath, mFilePathOnDisk );
+    }
+    if ( !isLinked ) { // E.g., the filesystem doesn't support hard links or reflinks.
+        fs::copy_file( sourcePath, mFilePathOnDisk, error );
+        if ( error ) {
+            throw BitException( "Failed to extract the duplicate item", error, path_to_tstring( mFilePathOnDisk ) );
+        }
+    }
+    if ( !useHardLink || !isLinked ) { // Hard links share the (same) metadata of the source file.
+        setFileMetadata();
+    }
+    markWrittenItem( index );
+    return true;
+}
+
+auto FileExtractCallback::prepareOutputFile( const fs::path& filePath ) -> bool {
+    if ( mHandler.fileCallback() ) {
+        // Here we don't use the path_to_tstring function to avoid allocating a string object
+        // when using BIT7Z_USE_NATIVE_STRING.
 #if defined( BIT7Z_USE_NATIVE_STRING )
-            const auto& filePathString = filePath.native();
+        const auto& filePathString = filePath.native();
 #elif !defined( BIT7Z_USE_SYSTEM_CODEPAGE )
-            const auto filePathString = filePath.u8string();
+        const auto filePathString = filePath.u8string();
 #else
-            const auto& nativePath = filePath.native();
-            const auto filePathString = narrow( nativePath.c_str(), nativePath.size() );
+        const auto& nativePath = filePath.native();
+        const auto filePathString = narrow( nativePath.c_str(), nativePath.size() );
 #endif
-            mHandler.fileCallback()( filePathString );
-        }
+        mHandler.fileCallback()( filePathString );
+    }
 
-        std::error_code error;
-        fs::create_directories( mFilePathOnDisk.parent_path(), error );
+    if ( mUringFileWriter != nullptr ) {
+        // A previous item with the same path might still be queued: it must be written before checking the path.
+        mUringFileWriter->waitFile( mFilePathOnDisk );
+    }
+
+    std::error_code error;
+    fs::create_directories( mFilePathOnDisk.parent_path(), error );
 
-        if ( fs::exists( mFilePathOnDisk, error ) ) {
-            const OverwriteMode overwriteMode = mHandler.overwriteMode();
+    if ( fs::exists( mFilePathOnDisk, error ) ) {
+        const OverwriteMode overwriteMode = mHandler.overwriteMode();
 
-            switch ( overwriteMode ) {
-                case OverwriteMode::None: {
+        switch ( overwriteMode ) {
+            case OverwriteMode::None: {
+                throw BitException( kCannotDeleteOutput,
+                                    make_hresult_code( E_ABORT ),
+                                    path_to_tstring( mFilePathOnDisk ) );
+            }
+            case OverwriteMode::Skip: {
+                return false;
+            }
+            case OverwriteMode::Overwrite:
+            default: {
+                if ( !fs::remove( mFilePathOnDisk, error ) ) {
                     throw BitException( kCannotDeleteOutput,
                                         make_hresult_code( E_ABORT ),
                                         path_to_tstring( mFilePathOnDisk ) );
                 }
-                case OverwriteMode::Skip: {
-                    return S_OK;
-                }
-                case OverwriteMode::Overwrite:
-                default: {
-                    if ( !fs::remove( mFilePathOnDisk, error ) ) {
-                        throw BitException( kCannotDeleteOutput,
-                                            make_hresult_code( E_ABORT ),
-                                            path_to_tstring( mFilePathOnDisk ) );
-                    }
-                    break;
-                }
+                break;
             }
         }
+    }
+    return true;
+}
+
+auto FileExtractCallback::getAsyncOutStream( uint32_t index, ISequentialOutStream** outStream ) -> bool {
+    uint32_t mode = 0;
+    if ( mUringFileWriter == nullptr || !output_file_mode( mCurrentItem, mode ) ) {
+        return false;
+    }
+
+    // Note: empty files are not worth an asynchronous write, while bigger files are written as usual.
+    const BitPropVariant itemSize = inputArchive().itemProperty( index, BitProperty::Size );
+    if ( itemSize.isEmpty() || itemSize.getUInt64() == 0 || itemSize.getUInt64() > UringFileWriter::kMaxFileSize ) {
+        return false;
+    }
+
+    mOutputSlot = mUringFileWriter->acquireSlot();
+    auto outStreamLoc = bit7z::make_com< CBufferOutStream, ISequentialOutStream >(
+        mUringFileWriter->slotBuffer( mOutputSlot ) );
+    *outStream = outStreamLoc.Detach();
+    return true;
+}
+
+auto FileExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT {
+    mCurrentItem.loadItemInfo( inputArchive(), index );
+    mCurrentIndex = index;
+
+    auto filePath = getItemPath( mCurrentItem.path() );
+    mFilePathOnDisk = getPathOnDisk( filePath );
+
+    if ( !isItemFolder( index ) ) { // File
+        if ( !prepareOutputFile( filePath ) ) {
+            return S_OK;
+        }
+
+        if ( mStoredItemsCopier != nullptr && mStoredItemsCopier->canCopy( index ) ) {
+            // The data is copied directly from the archive file, so 7-Zip will skip the item (no output stream).
+            mStoredItemsCopier->copy( index, mFilePathOnDisk );
+            setFileMetadata();
+            markWrittenItem( index );
+            return S_OK;
+        }
+
+        if ( getAsyncOutStream( index, outStream ) ) {
+            return S_OK;
+        }
 
         auto outStreamLoc = bit7z::make_com< CFileOutStream >( mFilePathOnDisk, true );
         mFileOutStream = outStreamLoc;
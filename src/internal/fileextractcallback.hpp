@@ -10,11 +10,15 @@
 #ifndef FILEEXTRACTCALLBACK_HPP
 #define FILEEXTRACTCALLBACK_HPP
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "internal/cfileoutstream.hpp"
 #include "internal/extractcallback.hpp"
 #include "internal/processeditem.hpp"
+#include "internal/storeditemscopier.hpp"
+#include "internal/uringfilewriter.hpp"
 
 namespace bit7z {
 
@@ -34,6 +38,28 @@ class FileExtractCallback final : public ExtractCallback {
 
         ~FileExtractCallback() override = default;
 
+        /**
+         * @return the indices of the given items (or of all the items in the archive, if no index is given)
+         *         whose output files are not up to date according to the handler's (conditional) overwrite mode.
+         */
+        BIT7Z_NODISCARD
+        auto outdatedItems( const std::vector< uint32_t >& indices ) const -> std::vector< uint32_t >;
+
+        /**
+         * Creates the output file of the item at the given index from the output file of the source item,
+         * which must have identical content, according to the handler's DuplicateItemsMode.
+         *
+         * @return false if the source item was not written by this callback (so the item must be extracted).
+         */
+        auto extractDuplicate( uint32_t sourceIndex, uint32_t index ) -> bool;
+
+        /**
+         * Waits for the output files being written asynchronously (if any).
+         *
+         * @note If some file could not be written, a BitException is thrown.
+         */
+        void flushOutput();
+
     private:
         fs::path mInFilePath;     // Input file path
         fs::path mDirectoryPath;  // Output directory
@@ -41,15 +67,36 @@ class FileExtractCallback final : public ExtractCallback {
         bool mRetainDirectories;
 
         ProcessedItem mCurrentItem;
+        uint32_t mCurrentIndex;
+        // The items written to disk (tracked only when extracting duplicates or hard links).
+        std::vector< bool > mWrittenItems;
 
         CMyComPtr< CFileOutStream > mFileOutStream;
 
+        std::unique_ptr< StoredItemsCopier > mStoredItemsCopier;
+
+        std::unique_ptr< UringFileWriter > mUringFileWriter;
+        uint32_t mOutputSlot; // The slot of the UringFileWriter receiving the current item (if any).
+
         auto finishOperation( OperationResult operationResult ) -> HRESULT override;
 
+        auto finishAsyncOutput( HRESULT result ) -> HRESULT;
+
+        void setFileMetadata() const;
+
+        void markWrittenItem( uint32_t index );
+
+        auto prepareOutputFile( const fs::path& filePath ) -> bool;
+
         void releaseStream() override;
 
         BIT7Z_NODISCARD
-        auto getCurrentItemPath() const -> fs::path;
+        auto getItemPath( fs::path filePath ) const -> fs::path;
+
+        BIT7Z_NODISCARD
+        auto getPathOnDisk( const fs::path& filePath ) const -> fs::path;
+
+        auto getAsyncOutStream( uint32_t index, ISequentialOutStream** outStream ) -> bool;
 
         auto getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT override;
 };
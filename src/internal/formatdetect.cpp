@@ -16,8 +16,6 @@
 // flag might be manually specified in the bitdefines.hpp header (included by formatdetect.hpp).
 #ifdef BIT7Z_AUTO_FORMAT
 
-#include <algorithm>
-
 #if defined(BIT7Z_USE_NATIVE_STRING) && defined(_WIN32)
 #include <cwctype> // for std::iswdigit
 #else
@@ -27,6 +25,7 @@
 #include "biterror.hpp"
 #include "bitexception.hpp"
 #include "internal/fsutil.hpp"
+#include "internal/stringutil.hpp"
 #ifndef _WIN32
 #include "internal/guiddef.hpp"
 #endif
@@ -447,23 +446,17 @@ auto detect_format_from_signature( IInStream* stream ) -> const BitInFormat& {
 
 #if defined( BIT7Z_USE_NATIVE_STRING ) && defined( _WIN32 )
 #   define is_digit(ch) std::iswdigit(ch) != 0
-const auto to_lower = std::towlower;
 #else
 inline auto is_digit( char character ) -> bool {
     return std::isdigit( character ) != 0;
 }
-
-inline auto to_lower( unsigned char character ) -> char {
-    return static_cast< char >( std::tolower( character ) );
-}
 #endif
 
 auto detect_format_from_extension( const fs::path& inFile ) -> const BitInFormat& {
-    tstring ext = filesystem::fsutil::extension( inFile );
+    const tstring ext = to_lower( filesystem::fsutil::extension( inFile ) );
     if ( ext.empty() ) {
         return BitFormat::Auto;
     }
-    std::transform( ext.cbegin(), ext.cend(), ext.begin(), to_lower );
 
     // Detecting archives with common file extensions
     const BitInFormat* format = find_format_by_extension( ext );
@@ -11,8 +11,19 @@
  */
 
 #include <algorithm> //for std::adjacent_find
+#include <array>
+
+#ifdef __linux__
+#include <fcntl.h> // for open
+#include <linux/fiemap.h> // for fiemap, fiemap_extent
+#include <linux/fs.h> // for FS_IOC_FIEMAP
+#include <sys/ioctl.h> // for ioctl
+#elif defined( __APPLE__ )
+#include <sys/clonefile.h> // for clonefile
+#endif
 
 #ifndef _WIN32
+#include <fcntl.h> // for open
 #include <sys/resource.h> // for rlimit, getrlimit, and setrlimit
 #include <sys/stat.h>
 #include <unistd.h>
@@ -299,6 +310,127 @@ auto fsutil::get_file_attributes_ex( const fs::path& filePath,
 #endif
 }
 
+auto fsutil::get_file_index( const fs::path& filePath, std::uint64_t& fileIndex ) noexcept -> bool {
+    if ( filePath.empty() ) {
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE hFile = ::CreateFile( filePath.c_str(),
+                                 0,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_FLAG_BACKUP_SEMANTICS, // Needed for opening directories.
+                                 nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE ) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION fileInfo{};
+    const bool res = ::GetFileInformationByHandle( hFile, &fileInfo ) != FALSE;
+    CloseHandle( hFile );
+    if ( res ) {
+        constexpr auto kDWordBits = 32u;
+        fileIndex = ( static_cast< std::uint64_t >( fileInfo.nFileIndexHigh ) << kDWordBits ) | fileInfo.nFileIndexLow;
+    }
+    return res;
+#else
+    stat_t statInfo{};
+    if ( os_lstat( filePath.c_str(), &statInfo ) != 0 ) {
+        return false;
+    }
+    fileIndex = static_cast< std::uint64_t >( statInfo.st_ino );
+    return true;
+#endif
+}
+
+auto fsutil::get_file_physical_offset( const fs::path& filePath, std::uint64_t& physicalOffset ) noexcept -> bool {
+#ifdef __linux__
+    const int fileDescriptor = open( filePath.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg)
+    if ( fileDescriptor < 0 ) {
+        return false;
+    }
+
+    // We only need the first extent of the file, so we allocate the space for a single fiemap_extent.
+    alignas( fiemap ) std::array< char, sizeof( fiemap ) + sizeof( fiemap_extent ) > request{};
+    auto* extentsMap = reinterpret_cast< fiemap* >( request.data() ); // NOLINT(*-reinterpret-cast)
+    extentsMap->fm_start = 0;
+    extentsMap->fm_length = FIEMAP_MAX_OFFSET;
+    extentsMap->fm_extent_count = 1;
+
+    const int res = ioctl( fileDescriptor, FS_IOC_FIEMAP, extentsMap ); // NOLINT(*-vararg)
+    close( fileDescriptor );
+    if ( res != 0 || extentsMap->fm_mapped_extents == 0 ) {
+        return false;
+    }
+    physicalOffset = extentsMap->fm_extents[ 0 ].fe_physical; // NOLINT(*-pro-bounds-constant-array-index)
+    return true;
+#else
+    (void)filePath;
+    (void)physicalOffset;
+    return false;
+#endif
+}
+
+auto fsutil::clone_file( const fs::path& sourcePath, const fs::path& targetPath ) noexcept -> bool {
+#ifdef __linux__
+    const int sourceDescriptor = open( sourcePath.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg)
+    if ( sourceDescriptor < 0 ) {
+        return false;
+    }
+    // NOLINTNEXTLINE(*-vararg)
+    const int targetDescriptor = open( targetPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+    if ( targetDescriptor < 0 ) {
+        close( sourceDescriptor );
+        return false;
+    }
+    const int res = ioctl( targetDescriptor, FICLONE, sourceDescriptor ); // NOLINT(*-vararg)
+    close( sourceDescriptor );
+    close( targetDescriptor );
+    if ( res != 0 ) {
+        unlink( targetPath.c_str() );
+        return false;
+    }
+    return true;
+#elif defined( __APPLE__ )
+    return clonefile( sourcePath.c_str(), targetPath.c_str(), 0 ) == 0;
+#else
+    (void)sourcePath;
+    (void)targetPath;
+    return false;
+#endif
+}
+
+auto fsutil::sync_file( const fs::path& filePath ) noexcept -> bool {
+#ifdef _WIN32
+    std::error_code error;
+    if ( fs::is_directory( filePath, error ) ) {
+        return true; // Directories cannot be flushed on Windows (nor they need to be).
+    }
+    HANDLE hFile = ::CreateFile( filePath.c_str(),
+                                 GENERIC_WRITE,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL,
+                                 nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE ) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+        return false;
+    }
+    const bool res = ::FlushFileBuffers( hFile ) != FALSE;
+    CloseHandle( hFile );
+    return res;
+#else
+    const int fileDescriptor = open( filePath.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg)
+    if ( fileDescriptor < 0 ) {
+        return false;
+    }
+    const bool res = fsync( fileDescriptor ) == 0;
+    close( fileDescriptor );
+    return res;
+#endif
+}
+
 #if defined( _WIN32 ) && defined( BIT7Z_AUTO_PREFIX_LONG_PATHS )
 
 constexpr auto kLongPathPrefix = BIT7Z_NATIVE_STRING( R"(\\?\)" );
@@ -10,6 +10,7 @@
 #ifndef FSUTIL_HPP
 #define FSUTIL_HPP
 
+#include <cstdint>
 #include <string>
 
 #include "bitdefines.hpp"
@@ -47,6 +48,59 @@ auto set_file_modified_time( const fs::path& filePath, FILETIME ftModified ) noe
 
 auto set_file_attributes( const fs::path& filePath, DWORD attributes ) noexcept -> bool;
 
+/**
+ * @brief Retrieves the index uniquely identifying the given file within its filesystem
+ * (i.e., the inode number on Unix systems, or the file index on Windows).
+ *
+ * @note On most filesystems, files with close indices are stored close to each other on the physical storage.
+ *
+ * @param filePath  the path to the file.
+ * @param fileIndex the variable where to store the file index.
+ *
+ * @return true if the file index could be retrieved, false otherwise.
+ */
+BIT7Z_NODISCARD auto get_file_index( const fs::path& filePath, std::uint64_t& fileIndex ) noexcept -> bool;
+
+/**
+ * @brief Retrieves the physical offset, on the underlying storage device, of the first extent of the given file.
+ *
+ * @note Currently, this is supported only on Linux (via the FIEMAP ioctl); on other systems, it always fails.
+ *
+ * @param filePath       the path to the file.
+ * @param physicalOffset the variable where to store the physical offset of the first extent of the file.
+ *
+ * @return true if the physical offset could be retrieved, false otherwise (e.g., the file is empty,
+ *         or the filesystem doesn't support the FIEMAP ioctl).
+ */
+BIT7Z_NODISCARD auto get_file_physical_offset( const fs::path& filePath,
+                                               std::uint64_t& physicalOffset ) noexcept -> bool;
+
+/**
+ * @brief Creates a new file sharing the physical storage of the given file (i.e., a reflink), if supported
+ * by the filesystem; the two files are independent, as the shared data is copied only when modified.
+ *
+ * @note Currently, this is supported only on Linux (via the FICLONE ioctl, e.g., on Btrfs and XFS)
+ *       and macOS (via clonefile, on APFS); on other systems, it always fails.
+ *
+ * @param sourcePath the path to the file to be cloned.
+ * @param targetPath the path to the new file (which must not exist).
+ *
+ * @return true if the file could be cloned, false otherwise (in which case, no new file is left on disk).
+ */
+BIT7Z_NODISCARD auto clone_file( const fs::path& sourcePath, const fs::path& targetPath ) noexcept -> bool;
+
+/**
+ * @brief Flushes the content and the metadata of the given file (or directory) to the underlying storage device.
+ *
+ * @note Syncing a directory makes the creation and deletion of the files it contains durable;
+ *       on Windows, this is not needed, and it always succeeds.
+ *
+ * @param filePath the path to the file or directory to be synced.
+ *
+ * @return true if the file could be synced, false otherwise.
+ */
+BIT7Z_NODISCARD auto sync_file( const fs::path& filePath ) noexcept -> bool;
+
 BIT7Z_NODISCARD auto in_archive_path( const fs::path& filePath,
                                       const fs::path& searchPath = fs::path{} ) -> fs::path;
 
@@ -0,0 +1,74 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <utility>
+
+#include "internal/cprefetchedinstream.hpp"
+#include "internal/hardlinkitem.hpp"
+#include "internal/stringutil.hpp"
+#include "internal/util.hpp"
+
+namespace bit7z {
+
+HardLinkItem::HardLinkItem( GenericInputItemPtr&& item, fs::path target )
+    : mItem{ std::move( item ) }, mTarget{ std::move( target ) } {}
+
+auto HardLinkItem::name() const -> tstring {
+    return mItem->name();
+}
+
+auto HardLinkItem::isDir() const -> bool {
+    return false;
+}
+
+auto HardLinkItem::size() const noexcept -> uint64_t {
+    return 0;
+}
+
+auto HardLinkItem::creationTime() const -> FILETIME {
+    return mItem->creationTime();
+}
+
+auto HardLinkItem::lastAccessTime() const -> FILETIME {
+    return mItem->lastAccessTime();
+}
+
+auto HardLinkItem::lastWriteTime() const -> FILETIME {
+    return mItem->lastWriteTime();
+}
+
+auto HardLinkItem::attributes() const -> uint32_t {
+    return mItem->attributes();
+}
+
+auto HardLinkItem::path() const -> tstring {
+    return mItem->path();
+}
+
+auto HardLinkItem::inArchivePath() const -> fs::path {
+    return mItem->inArchivePath();
+}
+
+auto HardLinkItem::getStream( ISequentialInStream** inStream ) const -> HRESULT {
+    // The link has no data: in case it is requested anyway, we provide an empty stream.
+    *inStream = bit7z::make_com< CPrefetchedInStream, ISequentialInStream >( buffer_t{} ).Detach();
+    return S_OK;
+}
+
+auto HardLinkItem::itemProperty( BitProperty property ) const -> BitPropVariant {
+    if ( property == BitProperty::HardLink ) {
+        return BitPropVariant{ path_to_wide_string( mTarget ) };
+    }
+    return GenericInputItem::itemProperty( property );
+}
+
+} // namespace bit7z
@@ -0,0 +1,55 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HARDLINKITEM_HPP
+#define HARDLINKITEM_HPP
+
+#include "bititemsvector.hpp"
+#include "internal/genericinputitem.hpp"
+
+namespace bit7z {
+
+/**
+ * A new item stored as a hard link to another item of the archive (e.g., a duplicate of the item's content),
+ * i.e., without data; all the other properties are the ones of the wrapped item.
+ */
+class HardLinkItem final : public GenericInputItem {
+    public:
+        HardLinkItem( GenericInputItemPtr&& item, fs::path target );
+
+        BIT7Z_NODISCARD auto name() const -> tstring override;
+
+        BIT7Z_NODISCARD auto isDir() const -> bool override;
+
+        BIT7Z_NODISCARD auto size() const noexcept -> uint64_t override;
+
+        BIT7Z_NODISCARD auto creationTime() const -> FILETIME override;
+
+        BIT7Z_NODISCARD auto lastAccessTime() const -> FILETIME override;
+
+        BIT7Z_NODISCARD auto lastWriteTime() const -> FILETIME override;
+
+        BIT7Z_NODISCARD auto attributes() const -> uint32_t override;
+
+        BIT7Z_NODISCARD auto path() const -> tstring override;
+
+        BIT7Z_NODISCARD auto inArchivePath() const -> fs::path override;
+
+        BIT7Z_NODISCARD auto getStream( ISequentialInStream** inStream ) const -> HRESULT override;
+
+        BIT7Z_NODISCARD auto itemProperty( BitProperty property ) const -> BitPropVariant override;
+
+    private:
+        GenericInputItemPtr mItem;
+        fs::path mTarget;
+};
+
+}  // namespace bit7z
+
+#endif //HARDLINKITEM_HPP
@@ -0,0 +1,260 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "bit7zlibrary.hpp"
+#include "biterror.hpp"
+#include "bitexception.hpp"
+#include "bitpropvariant.hpp"
+#include "internal/com.hpp"
+#include "internal/crc32.hpp"
+#include "internal/crc64.hpp"
+#include "internal/hasher.hpp"
+#include "internal/sha.hpp"
+
+#include <7zip/ICoder.h>
+
+namespace bit7z {
+
+// Converts the given value to its big-endian bytes.
+template< typename T >
+auto to_digest( T value ) -> Digest {
+    Digest result( sizeof( T ) );
+    for ( std::size_t i = 0; i < sizeof( T ); ++i ) {
+        result[ sizeof( T ) - 1 - i ] = static_cast< byte_t >( value >> ( 8u * i ) );
+    }
+    return result;
+}
+
+class Crc32Hasher final : public Hasher {
+    public:
+        void update( const byte_t* data, std::size_t size ) noexcept override {
+            mCrc = crc32_update( mCrc, data, size );
+        }
+
+        auto finish() -> Digest override {
+            return to_digest( mCrc );
+        }
+
+    private:
+        uint32_t mCrc{ 0 };
+};
+
+class Crc64Hasher final : public Hasher {
+    public:
+        void update( const byte_t* data, std::size_t size ) noexcept override {
+            mCrc = crc64_update( mCrc, data, size );
+        }
+
+        auto finish() -> Digest override {
+            return to_digest( mCrc );
+        }
+
+    private:
+        uint64_t mCrc{ 0 };
+};
+
+template< typename Sha >
+class ShaHasher final : public Hasher {
+    public:
+        void update( const byte_t* data, std::size_t size ) noexcept override {
+            mSha.update( data, size );
+        }
+
+        auto finish() -> Digest override {
+            const auto hash = mSha.finish();
+            return Digest( hash.cbegin(), hash.cend() );
+        }
+
+    private:
+        Sha mSha;
+};
+
+// Wraps a hasher provided by the 7-Zip library.
+class SevenZipHasher final : public Hasher {
+    public:
+        explicit SevenZipHasher( CMyComPtr< IHasher > hasher ) : mHasher{ std::move( hasher ) } {
+            mHasher->Init();
+        }
+
+        void update( const byte_t* data, std::size_t size ) noexcept override {
+            while ( size > 0 ) {
+                const auto chunkSize = static_cast< UInt32 >(
+                    ( std::min )( size, static_cast< std::size_t >( std::numeric_limits< UInt32 >::max() ) ) );
+                mHasher->Update( data, chunkSize );
+                data += chunkSize; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                size -= chunkSize;
+            }
+        }
+
+        auto finish() -> Digest override {
+            Digest digest( mHasher->GetDigestSize() );
+            mHasher->Final( digest.data() );
+            // 7-Zip stores the checksums (i.e., digests up to 64 bits) as little-endian numbers.
+            constexpr std::size_t kMaxChecksumSize = 8;
+            if ( digest.size() <= kMaxChecksumSize ) {
+                std::reverse( digest.begin(), digest.end() );
+            }
+            return digest;
+        }
+
+    private:
+        CMyComPtr< IHasher > mHasher;
+};
+
+auto make_hasher( DigestType type ) -> std::unique_ptr< Hasher > {
+    switch ( type ) {
+        case DigestType::Crc32:
+            return std::make_unique< Crc32Hasher >();
+        case DigestType::Crc64:
+            return std::make_unique< Crc64Hasher >();
+        case DigestType::Sha1:
+            return std::make_unique< ShaHasher< Sha1 > >();
+        case DigestType::Sha256:
+            return std::make_unique< ShaHasher< Sha256 > >();
+        default:
+            return nullptr;
+    }
+}
+
+auto make_supported_hasher( DigestType type ) -> std::unique_ptr< Hasher > {
+    auto hasher = make_hasher( type );
+    if ( hasher == nullptr ) {
+        throw BitException( "Unsupported digest type", make_error_code( BitError::UnsupportedOperation ) );
+    }
+    return hasher;
+}
+
+ItemHasher::ItemHasher( const std::vector< DigestType >& types ) {
+    mHashers.reserve( types.size() );
+    for ( const auto type : types ) {
+        mHashers.emplace_back( type, make_supported_hasher( type ) );
+    }
+}
+
+namespace {
+// The names of the 7-Zip hashers computing each type of digest.
+auto hasher_name( DigestType type ) -> const tchar* {
+    switch ( type ) {
+        case DigestType::Crc64:
+            return BIT7Z_STRING( "CRC64" );
+        case DigestType::Sha1:
+            return BIT7Z_STRING( "SHA1" );
+        case DigestType::Sha256:
+            return BIT7Z_STRING( "SHA256" );
+        case DigestType::Xxh64:
+            return BIT7Z_STRING( "XXH64" );
+        case DigestType::Blake2sp:
+            return BIT7Z_STRING( "BLAKE2sp" );
+        case DigestType::Crc32:
+        default:
+            return BIT7Z_STRING( "CRC32" );
+    }
+}
+
+constexpr auto kNoHasher = ( std::numeric_limits< UInt32 >::max )();
+} // namespace
+
+auto find_hasher( IHashers* hashers, DigestType type ) -> UInt32 {
+    const tstring name = hasher_name( type );
+    const UInt32 hashersCount = hashers->GetNumHashers();
+    for ( UInt32 index = 0; index < hashersCount; ++index ) {
+        BitPropVariant hasherName;
+        if ( hashers->GetHasherProp( index, NMethodPropID::kName, &hasherName ) == S_OK &&
+             hasherName.isString() && hasherName.getString() == name ) {
+            return index;
+        }
+    }
+    return hashersCount;
+}
+
+ItemHasherFactory::ItemHasherFactory( const Bit7zLibrary& lib, const std::vector< DigestType >& types )
+    : mHashers{ lib.initHashers() } {
+    const UInt32 hashersCount = mHashers != nullptr ? mHashers->GetNumHashers() : 0;
+    mHasherIndices.reserve( types.size() );
+    for ( const auto type : types ) {
+        const UInt32 index = mHashers != nullptr ? find_hasher( mHashers, type ) : hashersCount;
+        if ( index < hashersCount ) {
+            mHasherIndices.emplace_back( type, index );
+        } else if ( make_hasher( type ) != nullptr ) {
+            mHasherIndices.emplace_back( type, kNoHasher );
+        } else {
+            throw BitException( "Unsupported digest type", make_error_code( BitError::UnsupportedOperation ) );
+        }
+    }
+}
+
+ItemHasherFactory::~ItemHasherFactory() = default;
+
+auto ItemHasherFactory::makeHashers() const -> std::vector< std::pair< DigestType, std::unique_ptr< Hasher > > > {
+    std::vector< std::pair< DigestType, std::unique_ptr< Hasher > > > hashers;
+    hashers.reserve( mHasherIndices.size() );
+    for ( const auto& hasherIndex : mHasherIndices ) {
+        CMyComPtr< IHasher > hasher;
+        if ( hasherIndex.second != kNoHasher && mHashers->CreateHasher( hasherIndex.second, &hasher ) == S_OK ) {
+            hashers.emplace_back( hasherIndex.first, std::make_unique< SevenZipHasher >( std::move( hasher ) ) );
+        } else {
+            hashers.emplace_back( hasherIndex.first, make_supported_hasher( hasherIndex.first ) );
+        }
+    }
+    return hashers;
+}
+
+ItemHasher::ItemHasher( const Bit7zLibrary& lib, const std::vector< DigestType >& types )
+    : ItemHasher{ ItemHasherFactory{ lib, types } } {}
+
+ItemHasher::ItemHasher( const ItemHasherFactory& factory ) : mHashers{ factory.makeHashers() } {}
+
+void ItemHasher::update( const byte_t* data, std::size_t size ) noexcept {
+    for ( auto& hasher : mHashers ) {
+        hasher.second->update( data, size );
+    }
+}
+
+auto ItemHasher::finish() -> ItemDigests {
+    ItemDigests digests;
+    for ( auto& hasher : mHashers ) {
+        digests[ hasher.first ] = hasher.second->finish();
+    }
+    return digests;
+}
+
+constexpr std::size_t kHashChunkSize = 1024 * 1024; // 1 MiB
+
+auto hash_stream( std::istream& stream, ItemHasher& hasher ) -> bool {
+    buffer_t chunk( kHashChunkSize );
+    while ( stream ) {
+        stream.read( reinterpret_cast< char* >( chunk.data() ), static_cast< std::streamsize >( chunk.size() ) ); // NOLINT
+        hasher.update( chunk.data(), static_cast< std::size_t >( stream.gcount() ) );
+    }
+    return stream.eof() && !stream.bad();
+}
+
+auto hash_stream( ISequentialInStream* stream, ItemHasher& hasher ) -> HRESULT {
+    buffer_t chunk( kHashChunkSize );
+    while ( true ) {
+        UInt32 readSize = 0;
+        const HRESULT result = stream->Read( chunk.data(), static_cast< UInt32 >( chunk.size() ), &readSize );
+        if ( result != S_OK ) {
+            return result;
+        }
+        if ( readSize == 0 ) {
+            return S_OK;
+        }
+        hasher.update( chunk.data(), readSize );
+    }
+}
+
+}  // namespace bit7z
@@ -0,0 +1,128 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef HASHER_HPP
+#define HASHER_HPP
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "bitdigest.hpp"
+#include "bitwindows.hpp"
+#include "internal/com.hpp"
+
+struct IHashers;
+struct ISequentialInStream;
+
+namespace bit7z {
+
+class Bit7zLibrary;
+
+/**
+ * Computes a digest over a sequence of data chunks.
+ */
+class Hasher {
+    public:
+        Hasher() = default;
+
+        Hasher( const Hasher& ) = delete;
+
+        Hasher( Hasher&& ) = delete;
+
+        auto operator=( const Hasher& ) -> Hasher& = delete;
+
+        auto operator=( Hasher&& ) -> Hasher& = delete;
+
+        virtual ~Hasher() = default;
+
+        virtual void update( const byte_t* data, std::size_t size ) noexcept = 0;
+
+        // Returns the digest of all the data passed to update (the hasher must not be updated anymore).
+        virtual auto finish() -> Digest = 0;
+};
+
+/**
+ * Creates a hasher computing the given type of digest using bit7z's own implementations
+ * (nullptr, if the type of digest is not supported by them).
+ */
+auto make_hasher( DigestType type ) -> std::unique_ptr< Hasher >;
+
+/**
+ * Returns the index of the 7-Zip hasher computing the given type of digest
+ * (the number of hashers, if none of them computes it).
+ */
+auto find_hasher( IHashers* hashers, DigestType type ) -> UInt32;
+
+/**
+ * Looks up once the 7-Zip hashers computing the given types of digests,
+ * so that each item to be hashed only needs to create its own hasher instances.
+ */
+class ItemHasherFactory final {
+    public:
+        // Uses the hashers provided by the given 7-Zip library, falling back to bit7z's own ones if not available.
+        ItemHasherFactory( const Bit7zLibrary& lib, const std::vector< DigestType >& types );
+
+        ItemHasherFactory( const ItemHasherFactory& ) = delete;
+
+        ItemHasherFactory( ItemHasherFactory&& ) = delete;
+
+        auto operator=( const ItemHasherFactory& ) -> ItemHasherFactory& = delete;
+
+        auto operator=( ItemHasherFactory&& ) -> ItemHasherFactory& = delete;
+
+        ~ItemHasherFactory();
+
+        auto makeHashers() const -> std::vector< std::pair< DigestType, std::unique_ptr< Hasher > > >;
+
+    private:
+        CMyComPtr< IHashers > mHashers;
+
+        // For each type of digest, the index of the 7-Zip hasher computing it (kNoHasher, if not available).
+        std::vector< std::pair< DigestType, UInt32 > > mHasherIndices;
+};
+
+/**
+ * Computes several types of digests at once over the same data (e.g., the content of an item).
+ */
+class ItemHasher final {
+    public:
+        // Uses only bit7z's own hashers.
+        explicit ItemHasher( const std::vector< DigestType >& types );
+
+        // Uses the hashers provided by the given 7-Zip library, falling back to bit7z's own ones if not available.
+        ItemHasher( const Bit7zLibrary& lib, const std::vector< DigestType >& types );
+
+        explicit ItemHasher( const ItemHasherFactory& factory );
+
+        void update( const byte_t* data, std::size_t size ) noexcept;
+
+        auto finish() -> ItemDigests;
+
+    private:
+        std::vector< std::pair< DigestType, std::unique_ptr< Hasher > > > mHashers;
+};
+
+/**
+ * Updates the given hasher with the content of the input stream, from its current position to its end.
+ *
+ * @return whether the whole content of the stream could be read.
+ */
+auto hash_stream( std::istream& stream, ItemHasher& hasher ) -> bool;
+
+/**
+ * Updates the given hasher with the whole content of the input stream.
+ */
+auto hash_stream( ISequentialInStream* stream, ItemHasher& hasher ) -> HRESULT;
+
+}  // namespace bit7z
+
+#endif //HASHER_HPP
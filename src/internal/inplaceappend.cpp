@@ -0,0 +1,1291 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+
+#include "bitexception.hpp"
+#include "bitinputarchive.hpp"
+#include "internal/crc32.hpp"
+#include "internal/dateutil.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/inplaceappend.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+constexpr std::size_t kTarBlockSize = 512;
+constexpr std::size_t kTarEndMarkerSize = 2 * kTarBlockSize;
+
+constexpr uint32_t kZipCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kZipEndOfCentralDirSignature = 0x06054b50;
+constexpr uint32_t kZip64EndOfCentralDirLocatorSignature = 0x07064b50;
+constexpr uint32_t kZipLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kZipDataDescriptorSignature = 0x08074b50;
+constexpr std::size_t kZipCentralHeaderSize = 46;
+constexpr std::size_t kZipLocalHeaderSize = 30;
+constexpr std::size_t kZipEndOfCentralDirSize = 22;
+constexpr std::size_t kZip64LocatorSize = 20;
+constexpr std::size_t kZipMaxCommentSize = 0xFFFF;
+constexpr std::size_t kZipMaxFieldSize = 0xFFFF;
+constexpr uint64_t kZipMaxEntries = 0xFFFF;    // Greater values require zip64 records.
+constexpr uint64_t kZipMaxOffset = 0xFFFFFFFF; // Greater values require zip64 records.
+
+constexpr uint64_t kZipEncryptedFlag = 0x0001;
+constexpr uint64_t kZipDataDescriptorFlag = 0x0008;
+constexpr uint64_t kZipStoredMethod = 0;
+constexpr uint64_t kZipUtf8Flag = 0x0800;
+constexpr uint8_t kZipHostFat = 0;
+constexpr uint8_t kZipHostUnix = 3;
+constexpr uint32_t kUnixAttributesExtension = 0x8000; // Attributes containing the Unix mode in the high 16 bits.
+
+constexpr std::size_t kZipExtraHeaderSize = 4;
+constexpr uint64_t kZipNtfsExtraId = 0x000A;
+constexpr uint64_t kZipExtendedTimeExtraId = 0x5455;
+constexpr uint64_t kZipUnicodePathExtraId = 0x7075;
+constexpr uint64_t kZipPaddingExtraId = 0xD935; // The padding extra field used by Android's zipalign.
+
+constexpr std::array< char, 8 > kJournalMagic = { { 'B', 'I', 'T', '7', 'Z', 'J', 'N', 'L' } };
+constexpr std::size_t kJournalOriginalSizeOffset = kJournalMagic.size();
+constexpr std::size_t kJournalTailOffsetOffset = kJournalOriginalSizeOffset + sizeof( uint64_t );
+constexpr std::size_t kJournalFileIndexOffset = kJournalTailOffsetOffset + sizeof( uint64_t );
+constexpr std::size_t kJournalWindowCrcOffset = kJournalFileIndexOffset + sizeof( uint64_t );
+constexpr std::size_t kJournalHeaderSize = kJournalWindowCrcOffset + sizeof( uint32_t );
+constexpr std::size_t kJournalPatchHeaderSize = 2 * sizeof( uint64_t );
+constexpr std::size_t kJournalChecksumSize = sizeof( uint32_t );
+constexpr uint64_t kJournalIdentityWindowSize = 64 * 1024; // The size of the data before the tail checked on recovery.
+
+constexpr std::size_t kCopyBufferSize = 1024 * 1024; // 1 MiB
+
+auto journal_path( const fs::path& archivePath ) -> fs::path {
+    fs::path journalPath = archivePath;
+    journalPath += ".journal";
+    return journalPath;
+}
+
+auto read_le( const byte_t* data, std::size_t size ) noexcept -> uint64_t {
+    uint64_t value = 0;
+    for ( std::size_t i = size; i > 0; --i ) {
+        value = ( value << 8u ) | static_cast< uint64_t >( data[ i - 1 ] ); //-V2563
+    }
+    return value;
+}
+
+void write_le( byte_t* data, std::size_t size, uint64_t value ) noexcept {
+    for ( std::size_t i = 0; i < size; ++i ) {
+        data[ i ] = static_cast< byte_t >( value & 0xFFu ); //-V2563
+        value >>= 8u;
+    }
+}
+
+auto read_at( fs::ifstream& stream, uint64_t offset, byte_t* data, std::size_t size ) -> bool {
+    stream.clear();
+    stream.seekg( static_cast< std::streamoff >( offset ) );
+    stream.read( reinterpret_cast< char* >( data ), static_cast< std::streamsize >( size ) ); //-V2571
+    return stream.good() || ( stream.eof() && static_cast< std::size_t >( stream.gcount() ) == size );
+}
+
+auto file_size( const fs::path& path, uint64_t& size ) -> bool {
+    std::error_code error;
+    size = static_cast< uint64_t >( fs::file_size( path, error ) );
+    return !error;
+}
+
+/* Tar archives */
+
+auto parse_tar_number( const byte_t* field, std::size_t size, uint64_t& value ) -> bool {
+    if ( ( field[ 0 ] & 0x80u ) != 0 ) { // GNU base-256 encoding
+        value = 0;
+        for ( std::size_t i = 1; i < size; ++i ) {
+            value = ( value << 8u ) | field[ i ]; //-V2563
+        }
+        return true;
+    }
+    value = 0;
+    std::size_t i = 0;
+    while ( i < size && field[ i ] == ' ' ) { //-V2563
+        ++i;
+    }
+    for ( ; i < size && field[ i ] >= '0' && field[ i ] <= '7'; ++i ) { //-V2563
+        value = ( value << 3u ) | static_cast< uint64_t >( field[ i ] - '0' ); //-V2563
+    }
+    return i == size || field[ i ] == ' ' || field[ i ] == '\0'; //-V2563
+}
+
+auto is_valid_tar_header( const std::array< byte_t, kTarBlockSize >& header ) -> bool {
+    constexpr std::size_t kChecksumOffset = 148;
+    constexpr std::size_t kChecksumSize = 8;
+
+    uint64_t storedChecksum = 0;
+    if ( !parse_tar_number( &header[ kChecksumOffset ], kChecksumSize, storedChecksum ) ) {
+        return false;
+    }
+    uint64_t checksum = 0;
+    int64_t signedChecksum = 0; // Some old tar implementations used signed chars for computing the checksum.
+    for ( std::size_t i = 0; i < header.size(); ++i ) {
+        const bool isChecksumField = i >= kChecksumOffset && i < kChecksumOffset + kChecksumSize;
+        const byte_t value = isChecksumField ? static_cast< byte_t >( ' ' ) : header[ i ];
+        checksum += value;
+        signedChecksum += static_cast< signed char >( value );
+    }
+    return storedChecksum == checksum || static_cast< int64_t >( storedChecksum ) == signedChecksum;
+}
+
+// Finds the offset of the end-of-archive marker of a tar archive (i.e., the end of its last entry).
+auto find_tar_end( const fs::path& path, uint64_t& endOffset ) -> bool {
+    constexpr std::size_t kSizeOffset = 124;
+    constexpr std::size_t kSizeFieldSize = 12;
+
+    uint64_t archiveSize = 0;
+    fs::ifstream stream{ path, std::ios::binary };
+    if ( !stream.is_open() || !file_size( path, archiveSize ) ) {
+        return false;
+    }
+
+    uint64_t offset = 0;
+    std::array< byte_t, kTarBlockSize > header{};
+    while ( offset + kTarBlockSize <= archiveSize ) {
+        if ( !read_at( stream, offset, header.data(), header.size() ) ) {
+            return false;
+        }
+        if ( std::all_of( header.cbegin(), header.cend(), []( byte_t value ) -> bool { return value == 0; } ) ) {
+            break;
+        }
+        uint64_t entrySize = 0;
+        if ( !is_valid_tar_header( header ) ||
+             !parse_tar_number( &header[ kSizeOffset ], kSizeFieldSize, entrySize ) ) {
+            return false;
+        }
+        const uint64_t paddedSize = ( ( entrySize + kTarBlockSize - 1 ) / kTarBlockSize ) * kTarBlockSize;
+        offset += kTarBlockSize + paddedSize;
+    }
+    if ( offset > archiveSize ) {
+        return false; // Truncated archive.
+    }
+    endOffset = offset;
+    return true;
+}
+
+auto plan_tar_append( InPlaceAppendPlan& plan ) -> bool {
+    if ( !find_tar_end( plan.archivePath, plan.tailOffset ) ||
+         !find_tar_end( plan.appendedPath, plan.appendedDataSize ) ) {
+        return false;
+    }
+    plan.trailer.assign( kTarEndMarkerSize, 0 );
+    return true;
+}
+
+/* Zip archives */
+
+struct ZipLayout {
+    uint64_t entriesCount;
+    uint64_t centralDirOffset;
+    uint64_t centralDirSize;
+    buffer_t comment;
+};
+
+auto read_zip_layout( const fs::path& path, ZipLayout& layout ) -> bool {
+    uint64_t archiveSize = 0;
+    fs::ifstream stream{ path, std::ios::binary };
+    if ( !stream.is_open() || !file_size( path, archiveSize ) || archiveSize < kZipEndOfCentralDirSize ) {
+        return false;
+    }
+
+    // Searching the end of central directory record, which is followed only by the archive's comment.
+    const uint64_t searchSize = ( std::min )( archiveSize,
+                                              static_cast< uint64_t >( kZipEndOfCentralDirSize + kZipMaxCommentSize ) );
+    const uint64_t searchOffset = archiveSize - searchSize;
+    buffer_t searchBuffer( static_cast< std::size_t >( searchSize ) );
+    if ( !read_at( stream, searchOffset, searchBuffer.data(), searchBuffer.size() ) ) {
+        return false;
+    }
+    std::size_t recordPosition = searchBuffer.size() - kZipEndOfCentralDirSize + 1;
+    const byte_t* record = nullptr;
+    while ( recordPosition > 0 ) {
+        --recordPosition;
+        const byte_t* candidate = &searchBuffer[ recordPosition ];
+        if ( read_le( candidate, 4 ) == kZipEndOfCentralDirSignature &&
+             recordPosition + kZipEndOfCentralDirSize + read_le( candidate + 20, 2 ) == searchBuffer.size() ) {
+            record = candidate;
+            break;
+        }
+    }
+    if ( record == nullptr ) {
+        return false;
+    }
+
+    const uint64_t recordOffset = searchOffset + recordPosition;
+    std::array< byte_t, 4 > locatorSignature{};
+    if ( recordOffset >= kZip64LocatorSize &&
+         read_at( stream, recordOffset - kZip64LocatorSize, locatorSignature.data(), locatorSignature.size() ) &&
+         read_le( locatorSignature.data(), locatorSignature.size() ) == kZip64EndOfCentralDirLocatorSignature ) {
+        return false; // Zip64 archive.
+    }
+
+    const uint64_t diskNumber = read_le( record + 4, 2 );
+    const uint64_t centralDirDisk = read_le( record + 6, 2 );
+    const uint64_t diskEntriesCount = read_le( record + 8, 2 );
+    layout.entriesCount = read_le( record + 10, 2 );
+    layout.centralDirSize = read_le( record + 12, 4 );
+    layout.centralDirOffset = read_le( record + 16, 4 );
+    if ( diskNumber != 0 || centralDirDisk != 0 || diskEntriesCount != layout.entriesCount ||
+         layout.entriesCount == kZipMaxEntries || layout.centralDirOffset == kZipMaxOffset ||
+         layout.centralDirOffset + layout.centralDirSize != recordOffset ) {
+        return false; // Multi-volume archive, zip64 archive, or archive prefixed by other data (e.g., an SFX).
+    }
+    const auto commentOffset = static_cast< std::ptrdiff_t >( recordPosition + kZipEndOfCentralDirSize );
+    layout.comment.assign( searchBuffer.cbegin() + commentOffset, searchBuffer.cend() );
+    return true;
+}
+
+auto read_central_directory( const fs::path& path, const ZipLayout& layout, buffer_t& centralDir ) -> bool {
+    fs::ifstream stream{ path, std::ios::binary };
+    centralDir.resize( static_cast< std::size_t >( layout.centralDirSize ) );
+    return stream.is_open() && read_at( stream, layout.centralDirOffset, centralDir.data(), centralDir.size() );
+}
+
+// Moves the local header offsets of the central directory's entries by the given amount.
+auto relocate_central_directory( buffer_t& centralDir, uint64_t entriesCount, uint64_t delta ) -> bool {
+    std::size_t position = 0;
+    for ( uint64_t entry = 0; entry < entriesCount; ++entry ) {
+        if ( position + kZipCentralHeaderSize > centralDir.size() ) {
+            return false;
+        }
+        byte_t* header = &centralDir[ position ];
+        if ( read_le( header, 4 ) != kZipCentralHeaderSignature ) {
+            return false;
+        }
+        const uint64_t packSize = read_le( header + 20, 4 );
+        const uint64_t size = read_le( header + 24, 4 );
+        const uint64_t localHeaderOffset = read_le( header + 42, 4 );
+        if ( packSize == kZipMaxOffset || size == kZipMaxOffset || localHeaderOffset == kZipMaxOffset ||
+             localHeaderOffset + delta >= kZipMaxOffset ) {
+            return false; // The entry needs zip64 extra fields.
+        }
+        write_le( header + 42, 4, localHeaderOffset + delta );
+        position += kZipCentralHeaderSize + read_le( header + 28, 2 ) + read_le( header + 30, 2 ) +
+                    read_le( header + 32, 2 );
+    }
+    return position == centralDir.size();
+}
+
+void append_zip_end_record( buffer_t& trailer,
+                            uint64_t entriesCount,
+                            uint64_t centralDirSize,
+                            uint64_t centralDirOffset,
+                            const buffer_t& comment ) {
+    std::array< byte_t, kZipEndOfCentralDirSize > record{};
+    write_le( &record[ 0 ], 4, kZipEndOfCentralDirSignature );
+    write_le( &record[ 8 ], 2, entriesCount );
+    write_le( &record[ 10 ], 2, entriesCount );
+    write_le( &record[ 12 ], 4, centralDirSize );
+    write_le( &record[ 16 ], 4, centralDirOffset );
+    write_le( &record[ 20 ], 2, comment.size() );
+    trailer.insert( trailer.end(), record.cbegin(), record.cend() );
+    trailer.insert( trailer.end(), comment.cbegin(), comment.cend() );
+}
+
+auto plan_zip_append( InPlaceAppendPlan& plan ) -> bool {
+    ZipLayout archiveLayout{};
+    ZipLayout appendedLayout{};
+    if ( !read_zip_layout( plan.archivePath, archiveLayout ) ||
+         !read_zip_layout( plan.appendedPath, appendedLayout ) ) {
+        return false;
+    }
+
+    const uint64_t entriesCount = archiveLayout.entriesCount + appendedLayout.entriesCount;
+    const uint64_t centralDirOffset = archiveLayout.centralDirOffset + appendedLayout.centralDirOffset;
+    const uint64_t centralDirSize = archiveLayout.centralDirSize + appendedLayout.centralDirSize;
+    if ( entriesCount >= kZipMaxEntries || centralDirOffset >= kZipMaxOffset || centralDirSize >= kZipMaxOffset ) {
+        return false;
+    }
+
+    buffer_t appendedCentralDir;
+    if ( !read_central_directory( plan.archivePath, archiveLayout, plan.trailer ) ||
+         !read_central_directory( plan.appendedPath, appendedLayout, appendedCentralDir ) ||
+         !relocate_central_directory( appendedCentralDir,
+                                      appendedLayout.entriesCount,
+                                      archiveLayout.centralDirOffset ) ) {
+        return false;
+    }
+
+    plan.tailOffset = archiveLayout.centralDirOffset;
+    plan.appendedDataSize = appendedLayout.centralDirOffset;
+    plan.trailer.insert( plan.trailer.end(), appendedCentralDir.cbegin(), appendedCentralDir.cend() );
+    append_zip_end_record( plan.trailer, entriesCount, centralDirSize, centralDirOffset, archiveLayout.comment );
+    return true;
+}
+
+/* Zip archives: metadata edits */
+
+struct ZipCentralEntry {
+    std::size_t position; // The position of the entry's header in the central directory.
+    std::size_t size;     // The size of the entry's header, including its name, extra field, and comment.
+};
+
+auto parse_central_directory( const buffer_t& centralDir,
+                              uint64_t entriesCount,
+                              std::vector< ZipCentralEntry >& entries ) -> bool {
+    std::size_t position = 0;
+    for ( uint64_t entry = 0; entry < entriesCount; ++entry ) {
+        if ( position + kZipCentralHeaderSize > centralDir.size() ||
+             read_le( &centralDir[ position ], 4 ) != kZipCentralHeaderSignature ) {
+            return false;
+        }
+        const byte_t* header = &centralDir[ position ];
+        const std::size_t size = kZipCentralHeaderSize + read_le( header + 28, 2 ) + read_le( header + 30, 2 ) +
+                                 read_le( header + 32, 2 );
+        if ( position + size > centralDir.size() ) {
+            return false;
+        }
+        entries.push_back( { position, size } );
+        position += size;
+    }
+    return position == centralDir.size();
+}
+
+// Removes the trailing separator of the paths of folders, as done by 7-Zip when listing the items.
+auto zip_entry_path( std::string name ) -> std::string {
+    if ( !name.empty() && name.back() == '/' ) {
+        name.pop_back();
+    }
+    return name;
+}
+
+auto has_zip_extra( const byte_t* extra, std::size_t extraSize, uint64_t id ) -> bool {
+    std::size_t position = 0;
+    while ( position + kZipExtraHeaderSize <= extraSize ) {
+        if ( read_le( extra + position, 2 ) == id ) { //-V2563
+            return true;
+        }
+        position += kZipExtraHeaderSize + read_le( extra + position + 2, 2 ); //-V2563
+    }
+    return false;
+}
+
+auto filetime_to_unix_time( FILETIME fileTime ) noexcept -> std::time_t {
+    constexpr uint64_t kUnixEpochSeconds = 11644473600; // Seconds between 01/01/1601 and 01/01/1970.
+    const uint64_t seconds = FILETIME_to_ticks( fileTime ) / kFileTimeTicksPerSecond;
+    return seconds > kUnixEpochSeconds ? static_cast< std::time_t >( seconds - kUnixEpochSeconds ) : 0;
+}
+
+// Converts the given time to the MS-DOS date and time format (in local time) used by zip headers.
+auto filetime_to_dos_time( FILETIME fileTime ) noexcept -> uint32_t {
+    constexpr uint32_t kMinDosTime = ( ( 1u << 5u ) | 1u ) << 16u; // 01/01/1980 00:00:00
+    constexpr uint32_t kMaxDosTime = 0xFF9FBF7D;                    // 31/12/2107 23:59:58
+
+    const std::time_t unixTime = filetime_to_unix_time( fileTime );
+    std::tm localTime{};
+#ifdef _WIN32
+    if ( localtime_s( &localTime, &unixTime ) != 0 ) {
+#else
+    if ( localtime_r( &unixTime, &localTime ) == nullptr ) {
+#endif
+        return kMinDosTime;
+    }
+    if ( localTime.tm_year < 80 ) { // NOLINT(*-magic-numbers)
+        return kMinDosTime;
+    }
+    if ( localTime.tm_year > 207 ) { // NOLINT(*-magic-numbers)
+        return kMaxDosTime;
+    }
+    const auto dosDate = ( static_cast< uint32_t >( localTime.tm_year - 80 ) << 9u ) | // NOLINT(*-magic-numbers)
+                         ( static_cast< uint32_t >( localTime.tm_mon + 1 ) << 5u ) |
+                         static_cast< uint32_t >( localTime.tm_mday );
+    const auto dosTime = ( static_cast< uint32_t >( localTime.tm_hour ) << 11u ) | // NOLINT(*-magic-numbers)
+                         ( static_cast< uint32_t >( localTime.tm_min ) << 5u ) |
+                         static_cast< uint32_t >( localTime.tm_sec / 2 );
+    return ( dosDate << 16u ) | dosTime;
+}
+
+// Updates the last write time stored in the NTFS and extended timestamp extra fields (if any).
+void patch_zip_extra_times( byte_t* extra, std::size_t extraSize, FILETIME lastWriteTime ) {
+    std::size_t position = 0;
+    while ( position + kZipExtraHeaderSize <= extraSize ) {
+        const uint64_t id = read_le( extra + position, 2 ); //-V2563
+        const auto size = static_cast< std::size_t >( read_le( extra + position + 2, 2 ) ); //-V2563
+        byte_t* data = extra + position + kZipExtraHeaderSize; //-V2563
+        if ( position + kZipExtraHeaderSize + size > extraSize ) {
+            return;
+        }
+        if ( id == kZipNtfsExtraId ) {
+            // A reserved field, followed by tagged attributes; tag 1 contains the modification, access,
+            // and creation times.
+            std::size_t tagPosition = 4;
+            while ( tagPosition + kZipExtraHeaderSize <= size ) {
+                const uint64_t tag = read_le( data + tagPosition, 2 ); //-V2563
+                const auto tagSize = static_cast< std::size_t >( read_le( data + tagPosition + 2, 2 ) ); //-V2563
+                if ( tag == 1 && tagSize >= sizeof( uint64_t ) &&
+                     tagPosition + kZipExtraHeaderSize + sizeof( uint64_t ) <= size ) {
+                    write_le( data + tagPosition + kZipExtraHeaderSize, //-V2563
+                              sizeof( uint64_t ),
+                              FILETIME_to_ticks( lastWriteTime ) );
+                }
+                tagPosition += kZipExtraHeaderSize + tagSize;
+            }
+        } else if ( id == kZipExtendedTimeExtraId && size >= 5 && ( data[ 0 ] & 1u ) != 0 ) { //-V2563
+            // A flags byte, followed by the modification time (if the flag bit 0 is set) as a Unix timestamp.
+            write_le( data + 1, 4, static_cast< uint64_t >( filetime_to_unix_time( lastWriteTime ) ) ); //-V2563
+        }
+        position += kZipExtraHeaderSize + size;
+    }
+}
+
+auto is_ascii( const std::string& text ) -> bool {
+    return std::all_of( text.cbegin(), text.cend(), []( char character ) -> bool {
+        return ( static_cast< unsigned char >( character ) & 0x80u ) == 0;
+    } );
+}
+
+// Computes the size of the data of a zip entry, including its data descriptor (if any).
+auto zip_entry_data_size( fs::ifstream& archive,
+                          const byte_t* centralHeader,
+                          uint64_t localFlags,
+                          uint64_t dataOffset,
+                          uint64_t& dataSize ) -> bool {
+    const uint64_t packSize = read_le( centralHeader + 20, 4 ); //-V2563
+    dataSize = packSize;
+    if ( ( localFlags & kZipDataDescriptorFlag ) == 0 ) {
+        return true;
+    }
+
+    // The data descriptor contains the CRC and the sizes of the entry, optionally preceded by a signature.
+    const uint64_t crc = read_le( centralHeader + 16, 4 ); //-V2563
+    std::array< byte_t, 8 > descriptor{};
+    if ( !read_at( archive, dataOffset + packSize, descriptor.data(), descriptor.size() ) ) {
+        return false;
+    }
+    if ( read_le( descriptor.data(), 4 ) == kZipDataDescriptorSignature && read_le( &descriptor[ 4 ], 4 ) == crc ) {
+        dataSize += 16; // NOLINT(*-magic-numbers)
+        return true;
+    }
+    if ( read_le( descriptor.data(), 4 ) == crc ) {
+        dataSize += 12; // NOLINT(*-magic-numbers)
+        return true;
+    }
+    return false;
+}
+
+/* Applies the given edit to the central header of a zip entry and plans the update of its local header,
+ * which is patched in place if the new header fits in the space of the old one; otherwise, the entry is
+ * moved to the given relocation offset. */
+auto edit_zip_entry( fs::ifstream& archive,
+                     const InPlaceMetadataEdit& edit,
+                     uint64_t relocationOffset,
+                     buffer_t& centralHeader,
+                     InPlaceAppendPlan& plan ) -> bool {
+    const auto nameSize = static_cast< std::size_t >( read_le( &centralHeader[ 28 ], 2 ) );
+    const auto extraSize = static_cast< std::size_t >( read_le( &centralHeader[ 30 ], 2 ) );
+    const uint64_t localOffset = read_le( &centralHeader[ 42 ], 4 );
+    if ( read_le( &centralHeader[ 20 ], 4 ) == kZipMaxOffset || localOffset == kZipMaxOffset ) {
+        return false; // The entry needs zip64 extra fields.
+    }
+
+    std::array< byte_t, kZipLocalHeaderSize > localFixedHeader{};
+    if ( !read_at( archive, localOffset, localFixedHeader.data(), localFixedHeader.size() ) ||
+         read_le( localFixedHeader.data(), 4 ) != kZipLocalHeaderSignature ) {
+        return false;
+    }
+    const auto localNameSize = static_cast< std::size_t >( read_le( &localFixedHeader[ 26 ], 2 ) );
+    const auto localExtraSize = static_cast< std::size_t >( read_le( &localFixedHeader[ 28 ], 2 ) );
+    const uint64_t oldLocalHeaderSize = kZipLocalHeaderSize + localNameSize + localExtraSize;
+    buffer_t localExtra( localExtraSize );
+    if ( localOffset + oldLocalHeaderSize > plan.tailOffset ||
+         !read_at( archive,
+                   localOffset + kZipLocalHeaderSize + localNameSize,
+                   localExtra.data(),
+                   localExtra.size() ) ) {
+        return false;
+    }
+    buffer_t localHeader( localFixedHeader.cbegin(), localFixedHeader.cend() );
+
+    const auto nameBegin = centralHeader.cbegin() + kZipCentralHeaderSize;
+    std::string name( nameBegin, nameBegin + static_cast< std::ptrdiff_t >( nameSize ) );
+    if ( !edit.newPath.empty() ) {
+        const byte_t* centralExtra = centralHeader.data() + kZipCentralHeaderSize + nameSize;
+        if ( has_zip_extra( centralExtra, extraSize, kZipUnicodePathExtraId ) ||
+             has_zip_extra( localExtra.data(), localExtra.size(), kZipUnicodePathExtraId ) ) {
+            return false; // The Unicode path extra field would override the new name.
+        }
+        name = !name.empty() && name.back() == '/' ? edit.newPath + '/' : edit.newPath;
+        if ( name.size() > kZipMaxFieldSize ) {
+            return false;
+        }
+        if ( !is_ascii( name ) ) {
+            write_le( &centralHeader[ 8 ], 2, read_le( &centralHeader[ 8 ], 2 ) | kZipUtf8Flag );
+            write_le( &localHeader[ 6 ], 2, read_le( &localHeader[ 6 ], 2 ) | kZipUtf8Flag );
+        }
+    }
+
+    if ( edit.hasNewLastWriteTime ) {
+        const uint32_t dosTime = filetime_to_dos_time( edit.lastWriteTime );
+        write_le( &centralHeader[ 12 ], 4, dosTime );
+        write_le( &localHeader[ 10 ], 4, dosTime );
+        patch_zip_extra_times( centralHeader.data() + kZipCentralHeaderSize + nameSize, extraSize, edit.lastWriteTime );
+        patch_zip_extra_times( localExtra.data(), localExtra.size(), edit.lastWriteTime );
+    }
+
+    if ( edit.hasNewAttributes ) {
+        const bool hasUnixMode = ( edit.attributes & kUnixAttributesExtension ) != 0;
+        const bool isUnixHost = centralHeader[ 5 ] == kZipHostUnix;
+        if ( hasUnixMode != isUnixHost ) {
+            centralHeader[ 5 ] = hasUnixMode ? kZipHostUnix : kZipHostFat;
+        }
+        write_le( &centralHeader[ 38 ], 4, edit.attributes );
+    }
+
+    if ( !edit.newPath.empty() ) {
+        const auto oldNameEnd = nameBegin + static_cast< std::ptrdiff_t >( nameSize );
+        const auto namePosition = centralHeader.erase( nameBegin, oldNameEnd );
+        centralHeader.insert( namePosition, name.cbegin(), name.cend() );
+        write_le( &centralHeader[ 28 ], 2, name.size() );
+    }
+
+    if ( edit.newPath.empty() && !edit.hasNewLastWriteTime ) {
+        return true; // Only the central directory stores the attributes.
+    }
+
+    write_le( &localHeader[ 26 ], 2, name.size() );
+    localHeader.insert( localHeader.end(), name.cbegin(), name.cend() );
+    localHeader.insert( localHeader.end(), localExtra.cbegin(), localExtra.cend() );
+    if ( localHeader.size() + kZipExtraHeaderSize <= oldLocalHeaderSize &&
+         localExtraSize + ( oldLocalHeaderSize - localHeader.size() ) <= kZipMaxFieldSize ) {
+        // The new local header is smaller than the old one: the remaining space is filled with a padding extra field.
+        const std::size_t paddingSize = oldLocalHeaderSize - localHeader.size() - kZipExtraHeaderSize;
+        const std::size_t paddingPosition = localHeader.size();
+        localHeader.resize( static_cast< std::size_t >( oldLocalHeaderSize ), 0 );
+        write_le( &localHeader[ paddingPosition ], 2, kZipPaddingExtraId );
+        write_le( &localHeader[ paddingPosition + 2 ], 2, paddingSize );
+        write_le( &localHeader[ 28 ], 2, localExtraSize + kZipExtraHeaderSize + paddingSize );
+    }
+    if ( localHeader.size() == oldLocalHeaderSize ) {
+        plan.patches.push_back( { localOffset, std::move( localHeader ) } );
+        return true;
+    }
+
+    // The new local header doesn't fit in the old one: the entry is moved at the end of the entries.
+    const uint64_t dataOffset = localOffset + oldLocalHeaderSize;
+    uint64_t dataSize = 0;
+    if ( !zip_entry_data_size( archive, centralHeader.data(), read_le( &localHeader[ 6 ], 2 ), dataOffset, dataSize ) ||
+         dataOffset + dataSize > plan.tailOffset ) {
+        return false;
+    }
+    write_le( &centralHeader[ 42 ], 4, relocationOffset );
+    plan.relocations.push_back( { std::move( localHeader ), dataOffset, dataSize } );
+    return true;
+}
+
+auto plan_zip_metadata_edit( InPlaceAppendPlan& plan, const std::vector< InPlaceMetadataEdit >& edits ) -> bool {
+    ZipLayout layout{};
+    buffer_t centralDir;
+    std::vector< ZipCentralEntry > entries;
+    if ( !read_zip_layout( plan.archivePath, layout ) ||
+         !read_central_directory( plan.archivePath, layout, centralDir ) ||
+         !parse_central_directory( centralDir, layout.entriesCount, entries ) ) {
+        return false;
+    }
+    plan.tailOffset = layout.centralDirOffset;
+
+    // Matching the edits with the entries of the archive, which must be unambiguous.
+    constexpr auto kAmbiguousEntry = static_cast< std::size_t >( -1 );
+    std::unordered_map< std::string, std::size_t > entriesIndex;
+    entriesIndex.reserve( entries.size() );
+    for ( std::size_t index = 0; index < entries.size(); ++index ) {
+        const auto nameBegin = centralDir.cbegin() + static_cast< std::ptrdiff_t >( entries[ index ].position +
+                                                                                    kZipCentralHeaderSize );
+        const auto nameSize = static_cast< std::ptrdiff_t >( read_le( &centralDir[ entries[ index ].position + 28 ],
+                                                                      2 ) );
+        const auto result = entriesIndex.emplace( zip_entry_path( { nameBegin, nameBegin + nameSize } ), index );
+        if ( !result.second ) {
+            result.first->second = kAmbiguousEntry;
+        }
+    }
+    std::vector< const InPlaceMetadataEdit* > entriesEdits( entries.size(), nullptr );
+    for ( const auto& edit : edits ) {
+        const auto entry = entriesIndex.find( zip_entry_path( edit.path ) );
+        if ( entry == entriesIndex.cend() || entry->second == kAmbiguousEntry ) {
+            return false;
+        }
+        entriesEdits[ entry->second ] = &edit;
+    }
+
+    fs::ifstream archive{ plan.archivePath, std::ios::binary };
+    if ( !archive.is_open() ) {
+        return false;
+    }
+    buffer_t newCentralDir;
+    newCentralDir.reserve( centralDir.size() );
+    uint64_t relocationOffset = layout.centralDirOffset;
+    for ( std::size_t index = 0; index < entries.size(); ++index ) {
+        const auto headerBegin = centralDir.cbegin() + static_cast< std::ptrdiff_t >( entries[ index ].position );
+        buffer_t centralHeader( headerBegin, headerBegin + static_cast< std::ptrdiff_t >( entries[ index ].size ) );
+        if ( entriesEdits[ index ] != nullptr ) {
+            const std::size_t relocationsCount = plan.relocations.size();
+            if ( !edit_zip_entry( archive, *entriesEdits[ index ], relocationOffset, centralHeader, plan ) ) {
+                return false;
+            }
+            if ( plan.relocations.size() > relocationsCount ) {
+                relocationOffset += plan.relocations.back().header.size() + plan.relocations.back().dataSize;
+            }
+        }
+        newCentralDir.insert( newCentralDir.end(), centralHeader.cbegin(), centralHeader.cend() );
+    }
+    if ( relocationOffset >= kZipMaxOffset || newCentralDir.size() >= kZipMaxOffset ) {
+        return false;
+    }
+
+    plan.appendedDataSize = 0;
+    plan.trailer = std::move( newCentralDir );
+    append_zip_end_record( plan.trailer, layout.entriesCount, plan.trailer.size(), relocationOffset, layout.comment );
+    return true;
+}
+
+/* Raw entries */
+
+constexpr std::size_t kMaxTarExtendedHeaderSize = 1024 * 1024; // 1 MiB
+constexpr uint32_t kDirectoryAttribute = 0x10; // FILE_ATTRIBUTE_DIRECTORY
+
+auto read_zip_raw_entries( const fs::path& archivePath,
+                           std::vector< RawArchiveEntry >& entries,
+                           buffer_t& comment ) -> bool {
+    ZipLayout layout{};
+    buffer_t centralDir;
+    std::vector< ZipCentralEntry > centralEntries;
+    if ( !read_zip_layout( archivePath, layout ) ||
+         !read_central_directory( archivePath, layout, centralDir ) ||
+         !parse_central_directory( centralDir, layout.entriesCount, centralEntries ) ) {
+        return false;
+    }
+    comment = std::move( layout.comment );
+
+    fs::ifstream archive{ archivePath, std::ios::binary };
+    if ( !archive.is_open() ) {
+        return false;
+    }
+    entries.reserve( centralEntries.size() );
+    for ( const auto& centralEntry : centralEntries ) {
+        const byte_t* centralHeader = &centralDir[ centralEntry.position ];
+        const uint64_t localHeaderOffset = read_le( centralHeader + 42, 4 ); //-V2563
+        if ( read_le( centralHeader + 20, 4 ) == kZipMaxOffset || read_le( centralHeader + 24, 4 ) == kZipMaxOffset ||
+             localHeaderOffset == kZipMaxOffset ) {
+            return false; // The entry needs zip64 extra fields.
+        }
+
+        std::array< byte_t, kZipLocalHeaderSize > localHeader{};
+        if ( !read_at( archive, localHeaderOffset, localHeader.data(), localHeader.size() ) ||
+             read_le( localHeader.data(), 4 ) != kZipLocalHeaderSignature ) {
+            return false;
+        }
+        const uint64_t dataOffset = localHeaderOffset + kZipLocalHeaderSize + read_le( &localHeader[ 26 ], 2 ) +
+                                    read_le( &localHeader[ 28 ], 2 );
+        uint64_t dataSize = 0;
+        if ( !zip_entry_data_size( archive, centralHeader, read_le( &localHeader[ 6 ], 2 ), dataOffset, dataSize ) ) {
+            return false;
+        }
+
+        const auto* nameBegin = reinterpret_cast< const char* >( centralHeader + kZipCentralHeaderSize ); //-V2571
+        RawArchiveEntry entry{};
+        entry.path.assign( nameBegin, static_cast< std::size_t >( read_le( centralHeader + 28, 2 ) ) ); //-V2563
+        entry.isDir = ( !entry.path.empty() && entry.path.back() == '/' ) ||
+                      ( read_le( centralHeader + 38, 4 ) & kDirectoryAttribute ) != 0; //-V2563
+        entry.path = zip_entry_path( std::move( entry.path ) );
+        entry.offset = localHeaderOffset;
+        entry.size = dataOffset + dataSize - localHeaderOffset;
+        entry.dataOffset = dataOffset;
+        entry.dataSize = read_le( centralHeader + 20, 4 ); //-V2563
+        entry.isStored = !entry.isDir && read_le( centralHeader + 10, 2 ) == kZipStoredMethod && //-V2563
+                         ( read_le( centralHeader + 8, 2 ) & kZipEncryptedFlag ) == 0 && //-V2563
+                         entry.dataSize == read_le( centralHeader + 24, 4 ); //-V2563
+        entry.crc = static_cast< uint32_t >( read_le( centralHeader + 16, 4 ) ); //-V2563
+        entry.centralHeader.assign( centralHeader, centralHeader + centralEntry.size ); //-V2563
+        entries.push_back( std::move( entry ) );
+    }
+    return true;
+}
+
+// Gets the value of the path record of a pax extended header (if any).
+void parse_pax_path( const std::string& records, std::string& path ) {
+    std::size_t position = 0;
+    while ( position < records.size() ) {
+        // Each record has the form "<length> <keyword>=<value>\n", where length includes the whole record.
+        std::size_t length = 0;
+        std::size_t cursor = position;
+        for ( ; cursor < records.size() && records[ cursor ] >= '0' && records[ cursor ] <= '9'; ++cursor ) {
+            length = ( length * 10 ) + static_cast< std::size_t >( records[ cursor ] - '0' ); // NOLINT(*-magic-numbers)
+        }
+        if ( cursor == position || cursor >= records.size() || records[ cursor ] != ' ' ||
+             position + length > records.size() || position + length < cursor + 2 ) {
+            return;
+        }
+        const std::string record = records.substr( cursor + 1, position + length - cursor - 2 );
+        constexpr auto kPathKeyword = "path=";
+        if ( record.compare( 0, std::strlen( kPathKeyword ), kPathKeyword ) == 0 ) {
+            path = record.substr( std::strlen( kPathKeyword ) );
+        }
+        position += length;
+    }
+}
+
+/* Reads the entries of a tar archive; the extended headers (e.g., GNU long names and pax headers) are considered
+ * part of the entry they precede. */
+auto read_tar_raw_entries( const fs::path& archivePath, std::vector< RawArchiveEntry >& entries ) -> bool {
+    constexpr std::size_t kNameSize = 100;
+    constexpr std::size_t kSizeOffset = 124;
+    constexpr std::size_t kSizeFieldSize = 12;
+    constexpr std::size_t kTypeFlagOffset = 156;
+    constexpr std::size_t kMagicOffset = 257;
+    constexpr std::size_t kPrefixOffset = 345;
+    constexpr std::size_t kPrefixSize = 155;
+
+    uint64_t archiveSize = 0;
+    fs::ifstream stream{ archivePath, std::ios::binary };
+    if ( !stream.is_open() || !file_size( archivePath, archiveSize ) ) {
+        return false;
+    }
+
+    const auto headerField = []( const std::array< byte_t, kTarBlockSize >& header,
+                                 std::size_t offset,
+                                 std::size_t size ) -> std::string {
+        const auto* field = reinterpret_cast< const char* >( &header[ offset ] ); //-V2571
+        return { field, static_cast< std::size_t >( std::find( field, field + size, '\0' ) - field ) }; //-V2563
+    };
+
+    uint64_t offset = 0;
+    uint64_t entryOffset = 0;
+    std::string extendedPath;
+    bool isSparse = false;
+    std::array< byte_t, kTarBlockSize > header{};
+    while ( offset + kTarBlockSize <= archiveSize ) {
+        if ( !read_at( stream, offset, header.data(), header.size() ) ) {
+            return false;
+        }
+        if ( std::all_of( header.cbegin(), header.cend(), []( byte_t value ) -> bool { return value == 0; } ) ) {
+            break;
+        }
+        uint64_t dataSize = 0;
+        if ( !is_valid_tar_header( header ) ||
+             !parse_tar_number( &header[ kSizeOffset ], kSizeFieldSize, dataSize ) ) {
+            return false;
+        }
+        const uint64_t paddedSize = ( ( dataSize + kTarBlockSize - 1 ) / kTarBlockSize ) * kTarBlockSize;
+        if ( offset + kTarBlockSize + paddedSize > archiveSize ) {
+            return false; // Truncated archive.
+        }
+
+        const auto typeFlag = static_cast< char >( header[ kTypeFlagOffset ] );
+        if ( typeFlag == 'g' ) {
+            return false; // Global extended headers apply to all the following entries.
+        }
+        if ( typeFlag == 'L' || typeFlag == 'K' || typeFlag == 'x' ) {
+            if ( typeFlag != 'K' ) {
+                if ( dataSize > kMaxTarExtendedHeaderSize ) {
+                    return false;
+                }
+                std::string data( static_cast< std::size_t >( dataSize ), '\0' );
+                if ( !read_at( stream, offset + kTarBlockSize, reinterpret_cast< byte_t* >( &data[ 0 ] ), //-V2571
+                               data.size() ) ) {
+                    return false;
+                }
+                if ( typeFlag == 'L' ) {
+                    extendedPath = data.substr( 0, data.find( '\0' ) );
+                } else {
+                    parse_pax_path( data, extendedPath );
+                    isSparse = isSparse || data.find( "GNU.sparse." ) != std::string::npos;
+                }
+            }
+            offset += kTarBlockSize + paddedSize;
+            continue;
+        }
+
+        RawArchiveEntry entry{};
+        entry.path = extendedPath;
+        if ( entry.path.empty() ) {
+            entry.path = headerField( header, 0, kNameSize );
+            const std::string prefix = headerField( header, kPrefixOffset, kPrefixSize );
+            if ( headerField( header, kMagicOffset, 5 ) == "ustar" && !prefix.empty() ) {
+                entry.path = prefix + '/' + entry.path;
+            }
+        }
+        entry.isDir = typeFlag == '5' || ( !entry.path.empty() && entry.path.back() == '/' );
+        entry.path = zip_entry_path( std::move( entry.path ) );
+        entry.offset = entryOffset;
+        entry.dataOffset = offset + kTarBlockSize;
+        entry.dataSize = dataSize;
+        // Note: the data of GNU sparse files (both old and pax formats) doesn't match the content of the file.
+        entry.isStored = !entry.isDir && !isSparse && ( typeFlag == '0' || typeFlag == '\0' || typeFlag == '7' );
+        offset += kTarBlockSize + paddedSize;
+        entry.size = offset - entryOffset;
+        entries.push_back( std::move( entry ) );
+        entryOffset = offset;
+        extendedPath.clear();
+        isSparse = false;
+    }
+    return entryOffset == offset; // The archive must not end with extended headers.
+}
+
+/* Journal */
+
+/* The journal starts with a header identifying the archive it belongs to (its original size, its file index,
+ * and the CRC of the data preceding its tail), and it ends with the CRC of all its previous content. */
+auto journal_archive_window( fs::ifstream& archive,
+                             uint64_t tailOffset,
+                             const std::vector< InPlacePatch >& originalPatches,
+                             uint32_t& windowCrc ) -> bool {
+    const uint64_t windowOffset = tailOffset - ( std::min )( tailOffset, kJournalIdentityWindowSize );
+    buffer_t window( static_cast< std::size_t >( tailOffset - windowOffset ) );
+    if ( !read_at( archive, windowOffset, window.data(), window.size() ) ) {
+        return false;
+    }
+
+    // The patched parts of the archive are replaced with their original content.
+    for ( const auto& patch : originalPatches ) {
+        const uint64_t patchEnd = patch.offset + patch.data.size();
+        if ( patchEnd <= windowOffset || patch.offset >= tailOffset ) {
+            continue;
+        }
+        const uint64_t copyOffset = ( std::max )( patch.offset, windowOffset );
+        const uint64_t copyEnd = ( std::min )( patchEnd, tailOffset );
+        std::copy_n( patch.data.cbegin() + static_cast< std::ptrdiff_t >( copyOffset - patch.offset ),
+                     static_cast< std::ptrdiff_t >( copyEnd - copyOffset ),
+                     window.begin() + static_cast< std::ptrdiff_t >( copyOffset - windowOffset ) );
+    }
+    windowCrc = crc32_update( 0, window.data(), window.size() );
+    return true;
+}
+
+auto archive_file_index( const fs::path& archivePath ) -> uint64_t {
+    uint64_t fileIndex = 0;
+    return filesystem::fsutil::get_file_index( archivePath, fileIndex ) ? fileIndex : 0;
+}
+
+// Makes the creation or the deletion of the given file durable.
+auto sync_parent_directory( const fs::path& filePath ) -> bool {
+    const fs::path parentPath = filePath.parent_path();
+    return filesystem::fsutil::sync_file( parentPath.empty() ? fs::path{ "." } : parentPath );
+}
+
+void write_journal( const InPlaceAppendPlan& plan ) {
+    const auto tailSize = static_cast< std::size_t >( plan.originalSize - plan.tailOffset );
+    std::size_t journalSize = kJournalHeaderSize + tailSize + kJournalChecksumSize;
+    for ( const auto& patch : plan.patches ) {
+        journalSize += kJournalPatchHeaderSize + patch.data.size();
+    }
+    buffer_t journal( journalSize );
+    std::copy( kJournalMagic.cbegin(), kJournalMagic.cend(), journal.begin() );
+    write_le( &journal[ kJournalOriginalSizeOffset ], sizeof( uint64_t ), plan.originalSize );
+    write_le( &journal[ kJournalTailOffsetOffset ], sizeof( uint64_t ), plan.tailOffset );
+    write_le( &journal[ kJournalFileIndexOffset ], sizeof( uint64_t ), archive_file_index( plan.archivePath ) );
+
+    // The journal contains the original tail, followed by the original content of the patched parts.
+    fs::ifstream archive{ plan.archivePath, std::ios::binary };
+    uint32_t windowCrc = 0;
+    bool isArchiveRead = archive.is_open() &&
+                         journal_archive_window( archive, plan.tailOffset, {}, windowCrc ) &&
+                         read_at( archive, plan.tailOffset, journal.data() + kJournalHeaderSize, tailSize );
+    write_le( &journal[ kJournalWindowCrcOffset ], sizeof( uint32_t ), windowCrc );
+    std::size_t position = kJournalHeaderSize + tailSize;
+    for ( const auto& patch : plan.patches ) {
+        write_le( journal.data() + position, sizeof( uint64_t ), patch.offset );
+        write_le( journal.data() + position + sizeof( uint64_t ), sizeof( uint64_t ), patch.data.size() );
+        position += kJournalPatchHeaderSize;
+        isArchiveRead = isArchiveRead && read_at( archive, patch.offset, journal.data() + position, patch.data.size() );
+        position += patch.data.size();
+    }
+    if ( !isArchiveRead ) {
+        throw BitException( "Failed to read the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( plan.archivePath ) );
+    }
+    write_le( journal.data() + position, sizeof( uint32_t ), crc32_update( 0, journal.data(), position ) );
+
+    /* Note: the journal must be on the storage device before the archive is modified; otherwise, a crash
+     *       might leave a modified archive without a (complete) journal for restoring it. */
+    const fs::path journalPath = journal_path( plan.archivePath );
+    fs::ofstream journalFile{ journalPath, std::ios::binary | std::ios::trunc };
+    journalFile.write( reinterpret_cast< const char* >( journal.data() ), //-V2571
+                       static_cast< std::streamsize >( journal.size() ) );
+    journalFile.flush();
+    const bool isJournalWritten = journalFile.good();
+    journalFile.close();
+    if ( !isJournalWritten || !filesystem::fsutil::sync_file( journalPath ) || !sync_parent_directory( journalPath ) ) {
+        std::error_code error;
+        fs::remove( journalPath, error );
+        throw BitException( "Failed to write the journal of the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( journalPath ) );
+    }
+}
+
+enum struct JournalState : std::uint8_t {
+    Restored, // The archive was restored using the journal.
+    Invalid,  // The journal was not completely written, hence the archive was not modified.
+    Stale     // The journal doesn't belong to the archive (e.g., the archive was replaced after the interruption).
+};
+
+// Restores the archive's parts saved in the journal, if the journal is valid and it belongs to the archive.
+auto restore_from_journal( const fs::path& archivePath ) -> JournalState {
+    const fs::path journalPath = journal_path( archivePath );
+    uint64_t journalSize = 0;
+    fs::ifstream journalFile{ journalPath, std::ios::binary };
+    if ( !journalFile.is_open() || !file_size( journalPath, journalSize ) ||
+         journalSize < kJournalHeaderSize + kJournalChecksumSize ) {
+        return JournalState::Invalid;
+    }
+
+    buffer_t journal( static_cast< std::size_t >( journalSize ) );
+    if ( !read_at( journalFile, 0, journal.data(), journal.size() ) ||
+         !std::equal( kJournalMagic.cbegin(), kJournalMagic.cend(), journal.cbegin() ) ) {
+        return JournalState::Invalid;
+    }
+    const std::size_t checksumOffset = journal.size() - kJournalChecksumSize;
+    if ( read_le( journal.data() + checksumOffset, sizeof( uint32_t ) ) !=
+         crc32_update( 0, journal.data(), checksumOffset ) ) {
+        return JournalState::Invalid;
+    }
+    const uint64_t originalSize = read_le( &journal[ kJournalOriginalSizeOffset ], sizeof( uint64_t ) );
+    const uint64_t tailOffset = read_le( &journal[ kJournalTailOffsetOffset ], sizeof( uint64_t ) );
+    if ( tailOffset > originalSize || originalSize - tailOffset > checksumOffset - kJournalHeaderSize ) {
+        return JournalState::Invalid;
+    }
+
+    const auto tailSize = static_cast< std::size_t >( originalSize - tailOffset );
+    std::vector< InPlacePatch > patches;
+    std::size_t position = kJournalHeaderSize + tailSize;
+    while ( position < checksumOffset ) {
+        if ( checksumOffset - position < kJournalPatchHeaderSize ) {
+            return JournalState::Invalid;
+        }
+        const uint64_t patchOffset = read_le( journal.data() + position, sizeof( uint64_t ) );
+        const uint64_t patchSize = read_le( journal.data() + position + sizeof( uint64_t ), sizeof( uint64_t ) );
+        position += kJournalPatchHeaderSize;
+        if ( patchSize > checksumOffset - position || patchOffset > tailOffset ||
+             patchSize > tailOffset - patchOffset ) {
+            return JournalState::Invalid;
+        }
+        const auto patchBegin = journal.cbegin() + static_cast< std::ptrdiff_t >( position );
+        const auto patchEnd = patchBegin + static_cast< std::ptrdiff_t >( patchSize );
+        patches.push_back( { patchOffset, buffer_t( patchBegin, patchEnd ) } );
+        position += static_cast< std::size_t >( patchSize );
+    }
+
+    // Checking that the journal belongs to the archive, i.e., that the data preceding the tail was not changed.
+    const uint64_t fileIndex = read_le( &journal[ kJournalFileIndexOffset ], sizeof( uint64_t ) );
+    const uint64_t currentFileIndex = archive_file_index( archivePath );
+    if ( fileIndex != 0 && currentFileIndex != 0 && fileIndex != currentFileIndex ) {
+        return JournalState::Stale;
+    }
+    {
+        uint64_t archiveSize = 0;
+        uint32_t windowCrc = 0;
+        fs::ifstream archive{ archivePath, std::ios::binary };
+        if ( !archive.is_open() || !file_size( archivePath, archiveSize ) || archiveSize < tailOffset ||
+             !journal_archive_window( archive, tailOffset, patches, windowCrc ) ||
+             windowCrc != read_le( &journal[ kJournalWindowCrcOffset ], sizeof( uint32_t ) ) ) {
+            return JournalState::Stale;
+        }
+    }
+
+    fs::fstream archive{ archivePath, std::ios::in | std::ios::out | std::ios::binary };
+    archive.seekp( static_cast< std::streamoff >( tailOffset ) );
+    archive.write( reinterpret_cast< const char* >( journal.data() + kJournalHeaderSize ), //-V2571
+                   static_cast< std::streamsize >( tailSize ) );
+    for ( const auto& patch : patches ) {
+        archive.seekp( static_cast< std::streamoff >( patch.offset ) );
+        archive.write( reinterpret_cast< const char* >( patch.data.data() ), //-V2571
+                       static_cast< std::streamsize >( patch.data.size() ) );
+    }
+    archive.flush();
+    if ( !archive.good() ) {
+        throw BitException( "Failed to restore the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( archivePath ) );
+    }
+    archive.close();
+
+    std::error_code error;
+    fs::resize_file( archivePath, originalSize, error );
+    if ( error ) {
+        throw BitException( "Failed to restore the archive", error, path_to_tstring( archivePath ) );
+    }
+    // The journal can be deleted only once the restored archive is on the storage device.
+    if ( !filesystem::fsutil::sync_file( archivePath ) ) {
+        throw BitException( "Failed to restore the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( archivePath ) );
+    }
+    return JournalState::Restored;
+}
+
+void remove_journal( const fs::path& archivePath ) {
+    const fs::path journalPath = journal_path( archivePath );
+    std::error_code error;
+    if ( fs::remove( journalPath, error ) ) {
+        (void)sync_parent_directory( journalPath );
+    }
+}
+
+auto copy_data( std::istream& input, std::ostream& output, uint64_t size, buffer_t& buffer ) -> bool {
+    while ( size > 0 && output.good() ) {
+        const auto chunkSize = static_cast< std::size_t >( ( std::min )( size,
+                                                                           static_cast< uint64_t >( buffer.size() ) ) );
+        if ( !input.read( reinterpret_cast< char* >( buffer.data() ), //-V2571
+                          static_cast< std::streamsize >( chunkSize ) ) ) {
+            return false;
+        }
+        output.write( reinterpret_cast< const char* >( buffer.data() ), //-V2571
+                      static_cast< std::streamsize >( chunkSize ) );
+        size -= chunkSize;
+    }
+    return size == 0;
+}
+
+void write_appended_data( const InPlaceAppendPlan& plan ) {
+    fs::fstream archive{ plan.archivePath, std::ios::in | std::ios::out | std::ios::binary };
+    fs::ifstream appended;
+    if ( plan.appendedDataSize > 0 ) {
+        appended.open( plan.appendedPath, std::ios::binary );
+    }
+    if ( !archive.is_open() || ( plan.appendedDataSize > 0 && !appended.is_open() ) ) {
+        throw BitException( "Failed to open the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( plan.archivePath ) );
+    }
+
+    archive.seekp( static_cast< std::streamoff >( plan.tailOffset ) );
+    buffer_t buffer( kCopyBufferSize );
+    bool isDataCopied = copy_data( appended, archive, plan.appendedDataSize, buffer );
+    uint64_t newSize = plan.tailOffset + plan.appendedDataSize;
+    if ( !plan.relocations.empty() ) {
+        // Note: the relocated data always precedes the tail, so it is never overwritten while being copied.
+        fs::ifstream relocated{ plan.archivePath, std::ios::binary };
+        for ( const auto& relocation : plan.relocations ) {
+            archive.write( reinterpret_cast< const char* >( relocation.header.data() ), //-V2571
+                           static_cast< std::streamsize >( relocation.header.size() ) );
+            relocated.seekg( static_cast< std::streamoff >( relocation.dataOffset ) );
+            isDataCopied = isDataCopied && copy_data( relocated, archive, relocation.dataSize, buffer );
+            newSize += relocation.header.size() + relocation.dataSize;
+        }
+    }
+    archive.write( reinterpret_cast< const char* >( plan.trailer.data() ), //-V2571
+                   static_cast< std::streamsize >( plan.trailer.size() ) );
+    newSize += plan.trailer.size();
+    for ( const auto& patch : plan.patches ) {
+        archive.seekp( static_cast< std::streamoff >( patch.offset ) );
+        archive.write( reinterpret_cast< const char* >( patch.data.data() ), //-V2571
+                       static_cast< std::streamsize >( patch.data.size() ) );
+    }
+    archive.flush();
+    if ( !isDataCopied || !archive.good() ) {
+        throw BitException( "Failed to append to the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( plan.archivePath ) );
+    }
+    archive.close();
+
+    if ( newSize < plan.originalSize ) { // E.g., a tar archive whose tail had a large record padding.
+        std::error_code error;
+        fs::resize_file( plan.archivePath, newSize, error );
+        if ( error ) {
+            throw BitException( "Failed to append to the archive", error, path_to_tstring( plan.archivePath ) );
+        }
+    }
+}
+
+void write_raw_entries( const BitInOutFormat& format,
+                        const std::vector< RawEntriesSource >& sources,
+                        const fs::path& outPath ) {
+    fs::ofstream output{ outPath, std::ios::binary | std::ios::trunc };
+    if ( !output.is_open() ) {
+        throw BitException( "Failed to create the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( outPath ) );
+    }
+
+    const bool isZip = format == BitFormat::Zip;
+    const buffer_t* comment = nullptr;
+    buffer_t buffer( kCopyBufferSize );
+    buffer_t trailer;
+    uint64_t outOffset = 0;
+    uint64_t entriesCount = 0;
+    bool isDataCopied = true;
+    for ( const auto& source : sources ) {
+        fs::ifstream input{ source.archivePath, std::ios::binary };
+        isDataCopied = isDataCopied && input.is_open();
+        if ( comment == nullptr && !source.comment.empty() ) {
+            comment = &source.comment;
+        }
+        for ( const auto& entry : source.entries ) {
+            if ( !isDataCopied ) {
+                break;
+            }
+            input.clear();
+            input.seekg( static_cast< std::streamoff >( entry.offset ) );
+            isDataCopied = copy_data( input, output, entry.size, buffer );
+            if ( isZip ) {
+                const auto headerPosition = static_cast< std::ptrdiff_t >( trailer.size() );
+                trailer.insert( trailer.end(), entry.centralHeader.cbegin(), entry.centralHeader.cend() );
+                write_le( &trailer[ static_cast< std::size_t >( headerPosition + 42 ) ], 4, outOffset );
+            }
+            outOffset += entry.size;
+            ++entriesCount;
+        }
+    }
+    if ( isZip ) {
+        const uint64_t centralDirSize = trailer.size();
+        append_zip_end_record( trailer, entriesCount, centralDirSize, outOffset,
+                               comment != nullptr ? *comment : buffer_t{} );
+    } else {
+        trailer.assign( kTarEndMarkerSize, 0 );
+    }
+    output.write( reinterpret_cast< const char* >( trailer.data() ), //-V2571
+                  static_cast< std::streamsize >( trailer.size() ) );
+    output.flush();
+    if ( !isDataCopied || !output.good() ) {
+        throw BitException( "Failed to write the archive", std::make_error_code( std::errc::io_error ),
+                            path_to_tstring( outPath ) );
+    }
+}
+
+auto supports_in_place_append( const BitInOutFormat& format, const fs::path& archivePath ) -> bool {
+    if ( format == BitFormat::Zip ) {
+        ZipLayout layout{};
+        return read_zip_layout( archivePath, layout );
+    }
+    if ( format == BitFormat::Tar ) {
+        uint64_t endOffset = 0;
+        return find_tar_end( archivePath, endOffset );
+    }
+    return false;
+}
+
+auto plan_in_place_append( const BitInOutFormat& format,
+                           const fs::path& archivePath,
+                           const fs::path& appendedPath,
+                           InPlaceAppendPlan& plan ) -> bool {
+    plan = InPlaceAppendPlan{};
+    plan.archivePath = archivePath;
+    plan.appendedPath = appendedPath;
+    if ( !file_size( archivePath, plan.originalSize ) ) {
+        return false;
+    }
+    if ( format == BitFormat::Zip ) {
+        return plan_zip_append( plan );
+    }
+    if ( format == BitFormat::Tar ) {
+        return plan_tar_append( plan );
+    }
+    return false;
+}
+
+auto plan_in_place_metadata_edit( const BitInOutFormat& format,
+                                  const fs::path& archivePath,
+                                  const std::vector< InPlaceMetadataEdit >& edits,
+                                  InPlaceAppendPlan& plan ) -> bool {
+    plan = InPlaceAppendPlan{};
+    plan.archivePath = archivePath;
+    if ( format != BitFormat::Zip || edits.empty() || !file_size( archivePath, plan.originalSize ) ) {
+        return false;
+    }
+    return plan_zip_metadata_edit( plan, edits );
+}
+
+auto read_raw_entries( const BitInOutFormat& format,
+                       const fs::path& archivePath,
+                       std::vector< RawArchiveEntry >& entries ) -> bool {
+    entries.clear();
+    if ( format == BitFormat::Zip ) {
+        buffer_t comment;
+        return read_zip_raw_entries( archivePath, entries, comment );
+    }
+    if ( format == BitFormat::Tar ) {
+        return read_tar_raw_entries( archivePath, entries );
+    }
+    return false;
+}
+
+auto read_raw_entries( const BitInOutFormat& format, RawEntriesSource& source ) -> bool {
+    source.entries.clear();
+    source.comment.clear();
+    if ( format == BitFormat::Zip ) {
+        return read_zip_raw_entries( source.archivePath, source.entries, source.comment );
+    }
+    return read_raw_entries( format, source.archivePath, source.entries );
+}
+
+auto read_raw_entries( const BitInputArchive& inputArchive, std::vector< RawArchiveEntry >& entries ) -> bool {
+    const BitInFormat& format = inputArchive.detectedFormat();
+    if ( inputArchive.archivePath().empty() || ( format != BitFormat::Zip && format != BitFormat::Tar ) ) {
+        return false;
+    }
+    const BitInOutFormat& layoutFormat = format == BitFormat::Zip ? BitFormat::Zip : BitFormat::Tar;
+    return read_raw_entries( layoutFormat, tstring_to_path( inputArchive.archivePath() ), entries ) &&
+           entries.size() == inputArchive.itemsCount();
+}
+
+auto write_raw_archive( const BitInOutFormat& format,
+                        const std::vector< RawEntriesSource >& sources,
+                        const fs::path& outPath ) -> bool {
+    if ( format == BitFormat::Zip ) {
+        uint64_t entriesCount = 0;
+        uint64_t dataSize = 0;
+        uint64_t centralDirSize = 0;
+        for ( const auto& source : sources ) {
+            for ( const auto& entry : source.entries ) {
+                ++entriesCount;
+                dataSize += entry.size;
+                centralDirSize += entry.centralHeader.size();
+            }
+        }
+        if ( entriesCount >= kZipMaxEntries || dataSize >= kZipMaxOffset || centralDirSize >= kZipMaxOffset ) {
+            return false; // The archive would need zip64 records.
+        }
+    } else if ( format != BitFormat::Tar ) {
+        return false;
+    }
+
+    try {
+        write_raw_entries( format, sources, outPath );
+    } catch ( const BitException& ) {
+        std::error_code error;
+        fs::remove( outPath, error );
+        throw;
+    }
+    return true;
+}
+
+void apply_in_place_append( const InPlaceAppendPlan& plan ) {
+    write_journal( plan );
+    try {
+        write_appended_data( plan );
+        // The journal can be deleted only once the modified archive is on the storage device.
+        if ( !filesystem::fsutil::sync_file( plan.archivePath ) ) {
+            throw BitException( "Failed to append to the archive", std::make_error_code( std::errc::io_error ),
+                                path_to_tstring( plan.archivePath ) );
+        }
+    } catch ( const BitException& ) {
+        if ( restore_from_journal( plan.archivePath ) == JournalState::Restored ) {
+            remove_journal( plan.archivePath );
+        }
+        throw;
+    }
+    remove_journal( plan.archivePath );
+}
+
+void recover_interrupted_append( const fs::path& archivePath ) {
+    const fs::path journalPath = journal_path( archivePath );
+    std::error_code error;
+    if ( !fs::exists( journalPath, error ) ) {
+        return;
+    }
+    // Note: a stale journal is left untouched, as it might be needed for restoring another copy of the archive.
+    if ( restore_from_journal( archivePath ) != JournalState::Stale ) {
+        remove_journal( archivePath );
+    }
+}
+
+}  // namespace bit7z
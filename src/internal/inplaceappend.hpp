@@ -0,0 +1,220 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INPLACEAPPEND_HPP
+#define INPLACEAPPEND_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bitformat.hpp"
+#include "bittypes.hpp"
+#include "bitwindows.hpp"
+#include "internal/fs.hpp"
+
+namespace bit7z {
+
+class BitInputArchive;
+
+/**
+ * An overwrite of some bytes of an existing archive before its tail (e.g., a local header of a zip entry).
+ */
+struct InPlacePatch {
+    uint64_t offset;
+    buffer_t data;
+};
+
+/**
+ * An existing entry of an archive that must be moved after the appended data,
+ * e.g., a zip entry whose new local header doesn't fit in the space of the old one.
+ */
+struct InPlaceRelocation {
+    buffer_t header;     // The new header of the entry.
+    uint64_t dataOffset; // The offset in the existing archive of the entry's data (i.e., after its old header).
+    uint64_t dataSize;
+};
+
+/**
+ * The description of how the entries of an archive can be appended to an existing archive
+ * without rewriting the existing entries.
+ *
+ * The existing archive is modified by overwriting its tail (i.e., the part starting at tailOffset,
+ * e.g., the central directory of a zip archive) with the entries of the appended archive
+ * and the relocated entries, followed by the trailer (e.g., the updated central directory).
+ * Finally, the patches are applied to the part of the archive before the tail.
+ */
+struct InPlaceAppendPlan {
+    fs::path archivePath;
+    fs::path appendedPath;
+    uint64_t originalSize;
+    uint64_t tailOffset;
+    uint64_t appendedDataSize; // The size of the entries' data at the beginning of the appended archive.
+    std::vector< InPlaceRelocation > relocations;
+    std::vector< InPlacePatch > patches;
+    buffer_t trailer;
+};
+
+/**
+ * A metadata-only change of an existing entry of an archive.
+ */
+struct InPlaceMetadataEdit {
+    std::string path;    // The current path of the entry (UTF-8, using '/' as separator).
+    std::string newPath; // The new path of the entry (UTF-8, using '/' as separator), or empty if not renamed.
+    bool hasNewAttributes;
+    uint32_t attributes;
+    bool hasNewLastWriteTime;
+    FILETIME lastWriteTime;
+};
+
+/**
+ * An entry of a zip or tar archive, as stored in the archive file.
+ */
+struct RawArchiveEntry {
+    std::string path;       // The path of the entry as stored in the archive, without the trailing separator.
+    bool isDir;
+    uint64_t offset;        // The offset of the entry in the archive (i.e., of its first header).
+    uint64_t size;          // The size of the entry in the archive, including its headers, data, and padding.
+    uint64_t dataOffset;    // The offset of the entry's data in the archive.
+    uint64_t dataSize;      // The size of the entry's data, excluding any data descriptor or padding.
+    bool isStored;          // Whether the entry is a regular file whose data is stored as it is (no compression).
+    uint32_t crc;           // The CRC32 of the entry's data (zip archives only).
+    buffer_t centralHeader; // The central directory header of the entry (zip archives only).
+};
+
+/**
+ * Some entries of an archive, to be copied as they are into another archive.
+ */
+struct RawEntriesSource {
+    fs::path archivePath;
+    std::vector< RawArchiveEntry > entries;
+    buffer_t comment; // The comment of the archive (zip archives only).
+};
+
+/**
+ * @return whether the layout of the given existing archive allows appending new entries in place.
+ */
+auto supports_in_place_append( const BitInOutFormat& format, const fs::path& archivePath ) -> bool;
+
+/**
+ * Plans the in place append of the entries of the appended archive to the existing one; the archives are not modified.
+ *
+ * @param format        the format of both archives (only zip and tar archives are supported).
+ * @param archivePath   the path of the existing archive.
+ * @param appendedPath  the path of the archive containing the entries to be appended.
+ * @param plan          the resulting plan.
+ *
+ * @return true if the in place append is possible, false otherwise
+ *         (e.g., the archives use zip64 records, or the existing archive is prefixed by other data).
+ */
+auto plan_in_place_append( const BitInOutFormat& format,
+                           const fs::path& archivePath,
+                           const fs::path& appendedPath,
+                           InPlaceAppendPlan& plan ) -> bool;
+
+/**
+ * Plans the in place commit of the given metadata-only changes to the existing archive;
+ * the archive is not modified.
+ *
+ * Only the metadata (e.g., the central directory and the local headers of the edited entries of a zip archive)
+ * is rewritten; the entries' data is moved only when strictly needed (e.g., for a zip entry being renamed
+ * to a path longer than the space available in its local header).
+ *
+ * @param format        the format of the archive (only zip archives are supported).
+ * @param archivePath   the path of the existing archive.
+ * @param edits         the metadata changes to be committed.
+ * @param plan          the resulting plan.
+ *
+ * @return true if the in place commit is possible, false otherwise
+ *         (e.g., the archive uses zip64 records, or some edited entry could not be matched unambiguously).
+ */
+auto plan_in_place_metadata_edit( const BitInOutFormat& format,
+                                  const fs::path& archivePath,
+                                  const std::vector< InPlaceMetadataEdit >& edits,
+                                  InPlaceAppendPlan& plan ) -> bool;
+
+/**
+ * Reads the list of the entries of the given archive, as stored in the archive file.
+ *
+ * @param format        the format of the archive (only zip and tar archives are supported).
+ * @param archivePath   the path of the archive.
+ * @param entries       the resulting list of entries.
+ *
+ * @return true if the entries could be read, false otherwise
+ *         (e.g., the archive uses zip64 records, or tar global extended headers).
+ */
+auto read_raw_entries( const BitInOutFormat& format,
+                       const fs::path& archivePath,
+                       std::vector< RawArchiveEntry >& entries ) -> bool;
+
+/**
+ * Reads the list of the entries and the comment of the archive at the path of the given source.
+ *
+ * @param format        the format of the archive (only zip and tar archives are supported).
+ * @param source        the source whose entries and comment are read.
+ *
+ * @return true if the entries could be read, false otherwise.
+ */
+auto read_raw_entries( const BitInOutFormat& format, RawEntriesSource& source ) -> bool;
+
+/**
+ * Reads the list of the entries of the given input archive, as stored in the archive file.
+ *
+ * @param inputArchive  the input archive (only zip and tar archive files are supported).
+ * @param entries       the resulting list of entries, one for each item of the input archive.
+ *
+ * @return true if the entries could be read, and they match the items of the input archive; false otherwise.
+ */
+auto read_raw_entries( const BitInputArchive& inputArchive, std::vector< RawArchiveEntry >& entries ) -> bool;
+
+/**
+ * Creates a new archive containing the given entries, which are copied as they are (i.e., without recompressing
+ * them); only the archive's structures (e.g., the central directory of a zip archive) are rebuilt.
+ * A new zip archive keeps the comment of the first source having one.
+ *
+ * @param format    the format of the archives (only zip and tar archives are supported).
+ * @param sources   the entries to be copied, grouped by archive, in the order they must have in the new archive.
+ * @param outPath   the path of the new archive.
+ *
+ * @return true if the archive was created, false if it cannot be created by copying the entries
+ *         (e.g., the new zip archive would need zip64 records); in the latter case, no file is created.
+ */
+auto write_raw_archive( const BitInOutFormat& format,
+                        const std::vector< RawEntriesSource >& sources,
+                        const fs::path& outPath ) -> bool;
+
+/**
+ * Executes the given in place append plan.
+ *
+ * Before modifying the archive, its tail and the parts to be patched are saved into a journal file,
+ * which is used for restoring the archive in case of errors, and deleted once the archive has been
+ * successfully modified.
+ * The journal is flushed to the storage device before modifying the archive, and the archive is flushed
+ * before deleting the journal: if the process (or the system) is interrupted while modifying the archive,
+ * the journal is left on disk, and it is used by recover_interrupted_append to restore the archive.
+ *
+ * @param plan the plan to be executed.
+ */
+void apply_in_place_append( const InPlaceAppendPlan& plan );
+
+/**
+ * Restores the given archive if a previous in place append was interrupted (i.e., if its journal file exists).
+ *
+ * The journal is replayed only if it was completely written (as checked by its checksum) and it belongs
+ * to the archive, i.e., the archive has the same file index and the same data before the appended part
+ * as when the journal was written; stale journals (e.g., of an archive replaced after the interruption)
+ * are ignored and left on disk, while incomplete ones are deleted, as the archive was not modified.
+ *
+ * @param archivePath the path of the archive to be restored.
+ */
+void recover_interrupted_append( const fs::path& archivePath );
+
+}  // namespace bit7z
+
+#endif //INPLACEAPPEND_HPP
@@ -63,6 +63,10 @@ auto InternalCategory::message( int errorValue ) const -> std::string {
             return "Wrong update mode.";
         case BitError::InvalidZipPassword:
             return "7-Zip only supports printable ASCII characters for passwords when creating Zip archives.";
+        case BitError::MemoryBudgetExceeded:
+            return "The estimated memory usage of the encoder exceeds the memory budget.";
+        case BitError::InvalidDeltaChain:
+            return "The archives do not form a valid chain of delta archives.";
         default:
             return "Unknown error.";
     }
@@ -83,9 +87,12 @@ auto InternalCategory::default_error_condition( int errorValue ) const noexcept
         case BitError::NonEmptyOutputBuffer:
         case BitError::NullOutputBuffer:
         case BitError::InvalidZipPassword:
+        case BitError::InvalidDeltaChain:
             return std::make_error_condition( std::errc::invalid_argument );
         case BitError::NoMatchingItems:
             return std::make_error_condition( std::errc::no_such_file_or_directory );
+        case BitError::MemoryBudgetExceeded:
+            return std::make_error_condition( std::errc::not_enough_memory );
         case BitError::RequestedWrongVariantType:
         case BitError::UnsupportedOperation:
         case BitError::UnsupportedVariantType:
@@ -0,0 +1,161 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/com.hpp"
+#include "internal/crc32.hpp"
+#include "internal/dateutil.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/itemcomparison.hpp"
+#include "internal/stdinputitem.hpp"
+
+#include <7zip/IStream.h>
+
+namespace bit7z {
+
+auto index_archived_paths( const BitInputArchive& archive ) -> std::unordered_map< tstring, uint32_t > {
+    std::unordered_map< tstring, uint32_t > archivedPaths;
+    archivedPaths.reserve( archive.itemsCount() );
+    for ( const auto& archivedItem : archive ) {
+        archivedPaths.emplace( archivedItem.path(), archivedItem.index() );
+    }
+    return archivedPaths;
+}
+
+namespace {
+constexpr std::size_t kCrcChunkSize = 1024 * 1024; // 1 MiB
+
+auto file_crc( const fs::path& filePath, uint32_t& crc ) -> bool {
+    fs::ifstream stream{ filePath, std::ios::binary };
+    if ( !stream.is_open() ) {
+        return false;
+    }
+    buffer_t chunk( kCrcChunkSize );
+    crc = 0;
+    while ( stream ) {
+        stream.read( reinterpret_cast< char* >( chunk.data() ), //-V2571
+                     static_cast< std::streamsize >( chunk.size() ) );
+        crc = crc32_update( crc, chunk.data(), static_cast< std::size_t >( stream.gcount() ) );
+    }
+    return stream.eof();
+}
+
+/* The maximum difference between the modification times of an archived item and of a file considered equal.
+ * Note: most formats (e.g., zip and tar) store the modification times with a precision of one or two seconds,
+ *       while on POSIX systems we read the files' modification times with a precision of one second. */
+auto mtime_tolerance( const BitInFormat& format ) -> uint64_t {
+    return format == BitFormat::SevenZip ? kFileTimeTicksPerSecond : 2 * kFileTimeTicksPerSecond;
+}
+} // namespace
+
+auto item_crc( const GenericInputItem& item, uint32_t& crc ) -> bool {
+    CMyComPtr< ISequentialInStream > inStream;
+    if ( item.getStream( &inStream ) != S_OK || inStream == nullptr ) {
+        return false;
+    }
+    buffer_t chunk( kCrcChunkSize );
+    crc = 0;
+    while ( true ) {
+        UInt32 processedSize = 0;
+        if ( inStream->Read( chunk.data(), static_cast< UInt32 >( chunk.size() ), &processedSize ) != S_OK ) {
+            return false;
+        }
+        if ( processedSize == 0 ) {
+            return true;
+        }
+        crc = crc32_update( crc, chunk.data(), processedSize );
+    }
+}
+
+auto is_unchanged_item( const BitInputArchive& archive,
+                        uint32_t index,
+                        const GenericInputItem& newItem,
+                        const BitInFormat& format,
+                        const SyncOptions& options ) -> bool {
+    if ( newItem.isDir() || archive.isItemFolder( index ) ) {
+        return newItem.isDir() && archive.isItemFolder( index );
+    }
+
+    const BitPropVariant oldSize = archive.itemProperty( index, BitProperty::Size );
+    if ( oldSize.isEmpty() || oldSize.getUInt64() != newItem.size() ) {
+        return false;
+    }
+
+    if ( options.compareContent ) {
+        // Note: the modification time is not reliable, e.g., it might not change when a file is edited.
+        const BitPropVariant oldCrc = archive.itemProperty( index, BitProperty::CRC );
+        uint32_t newCrc = 0;
+        // Note: we don't read the content of stream items, since it would consume the data to be compressed.
+        if ( !oldCrc.isEmpty() && dynamic_cast< const StdInputItem* >( &newItem ) == nullptr &&
+             item_crc( newItem, newCrc ) ) {
+            return oldCrc.getUInt32() == newCrc;
+        }
+    }
+
+    const uint64_t tolerance = mtime_tolerance( format );
+    const BitPropVariant oldTime = archive.itemProperty( index, BitProperty::MTime );
+    if ( !oldTime.isFileTime() ) {
+        return false;
+    }
+    const uint64_t oldTicks = FILETIME_to_ticks( oldTime.getFileTime() );
+    const uint64_t newTicks = FILETIME_to_ticks( newItem.lastWriteTime() );
+    return ( oldTicks > newTicks ? oldTicks - newTicks : newTicks - oldTicks ) <= tolerance;
+}
+
+auto is_conditional_overwrite( OverwriteMode mode ) noexcept -> bool {
+    return mode == OverwriteMode::IfNewer || mode == OverwriteMode::IfDifferent ||
+           mode == OverwriteMode::IfDifferentContent;
+}
+
+auto is_extracted_item_current( const BitInputArchive& archive,
+                                uint32_t index,
+                                const fs::path& filePath,
+                                OverwriteMode mode ) -> bool {
+    using filesystem::fsutil::get_file_attributes_ex;
+    using filesystem::SymlinkPolicy;
+
+    WIN32_FILE_ATTRIBUTE_DATA fileMetadata{};
+    if ( !is_conditional_overwrite( mode ) ||
+         !get_file_attributes_ex( filePath, SymlinkPolicy::DoNotFollow, fileMetadata ) ||
+         ( fileMetadata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0 ) {
+        return false;
+    }
+
+    const uint64_t tolerance = mtime_tolerance( archive.detectedFormat() );
+    const BitPropVariant itemTime = archive.itemProperty( index, BitProperty::MTime );
+    const uint64_t fileTicks = FILETIME_to_ticks( fileMetadata.ftLastWriteTime );
+    const uint64_t itemTicks = itemTime.isFileTime() ? FILETIME_to_ticks( itemTime.getFileTime() ) : 0;
+    if ( mode == OverwriteMode::IfNewer ) {
+        return itemTime.isFileTime() && itemTicks <= fileTicks + tolerance;
+    }
+
+    std::error_code error;
+    const auto fileSize = static_cast< uint64_t >( fs::file_size( filePath, error ) );
+    const BitPropVariant itemSize = archive.itemProperty( index, BitProperty::Size );
+    if ( error || itemSize.isEmpty() || itemSize.getUInt64() != fileSize ) {
+        return false;
+    }
+    const uint64_t timeDifference = itemTicks > fileTicks ? itemTicks - fileTicks : fileTicks - itemTicks;
+    if ( itemTime.isFileTime() && timeDifference <= tolerance ) {
+        return true;
+    }
+
+    // Same size, but different (or unknown) modification time: the content might still be the same.
+    if ( mode != OverwriteMode::IfDifferentContent ) {
+        return false;
+    }
+    const BitPropVariant itemCrc = archive.itemProperty( index, BitProperty::CRC );
+    uint32_t fileCrc = 0;
+    return !itemCrc.isEmpty() && file_crc( filePath, fileCrc ) && itemCrc.getUInt32() == fileCrc;
+}
+
+}  // namespace bit7z
@@ -0,0 +1,88 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ITEMCOMPARISON_HPP
+#define ITEMCOMPARISON_HPP
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bitinputarchive.hpp"
+#include "internal/fs.hpp"
+
+namespace bit7z {
+
+struct GenericInputItem;
+
+/**
+ * Computes the CRC32 of the whole content of the given item.
+ *
+ * @note The content of stream items can be read only once, so it must not be used on them.
+ *
+ * @param item the item whose content must be read.
+ * @param crc  the computed CRC32.
+ *
+ * @return whether the content of the item could be read.
+ */
+auto item_crc( const GenericInputItem& item, uint32_t& crc ) -> bool;
+
+/**
+ * @return a map from the paths of the items in the given archive to their indices.
+ */
+auto index_archived_paths( const BitInputArchive& archive ) -> std::unordered_map< tstring, uint32_t >;
+
+/**
+ * Checks whether the given new item is equal to an item of an existing archive, i.e., whether they have the same
+ * size and modification time or, if requested by the options, the same size and CRC32
+ * (the modification times are compared only if the CRC32 of the items is not available).
+ *
+ * @param archive the existing archive.
+ * @param index   the index of the existing item in the archive.
+ * @param newItem the new item to be compared.
+ * @param format  the format of the archive (determining the precision of the stored modification times).
+ * @param options the options controlling the comparison.
+ *
+ * @return true if the new item is equal to the existing one, false otherwise.
+ */
+auto is_unchanged_item( const BitInputArchive& archive,
+                        uint32_t index,
+                        const GenericInputItem& newItem,
+                        const BitInFormat& format,
+                        const SyncOptions& options ) -> bool;
+
+/**
+ * @return whether the given overwrite mode overwrites the existing files depending on their content or metadata
+ *         (i.e., OverwriteMode::IfNewer, OverwriteMode::IfDifferent, or OverwriteMode::IfDifferentContent).
+ */
+auto is_conditional_overwrite( OverwriteMode mode ) noexcept -> bool;
+
+/**
+ * Checks whether the existing file at the given path is up to date with respect to an item of an archive,
+ * i.e., whether it doesn't need to be overwritten when extracting the item according to the given overwrite mode:
+ *  - OverwriteMode::IfNewer: the file is not older than the item;
+ *  - OverwriteMode::IfDifferent: the file has the same size and modification time of the item;
+ *  - OverwriteMode::IfDifferentContent: the file has the same size of the item, and the same modification time
+ *    or, if the modification times differ, the same CRC32.
+ *
+ * @param archive  the archive containing the item.
+ * @param index    the index of the item in the archive.
+ * @param filePath the path of the existing file.
+ * @param mode     the overwrite mode.
+ *
+ * @return true if the file is up to date, false otherwise (e.g., if the file doesn't exist).
+ */
+auto is_extracted_item_current( const BitInputArchive& archive,
+                                uint32_t index,
+                                const fs::path& filePath,
+                                OverwriteMode mode ) -> bool;
+
+}  // namespace bit7z
+
+#endif //ITEMCOMPARISON_HPP
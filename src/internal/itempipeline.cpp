@@ -0,0 +1,223 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "bitexception.hpp"
+#include "internal/cpipeinstream.hpp"
+#include "internal/cpipeoutstream.hpp"
+#include "internal/itempipeline.hpp"
+#include "internal/tempdirectory.hpp"
+#include "internal/util.hpp"
+
+namespace bit7z {
+
+ItemPipeline::ItemPipeline( std::size_t itemsCount,
+                            uint64_t pipeCapacity,
+                            uint64_t memoryLimit,
+                            fs::path spillBasePath )
+    : mPipeCapacity{ pipeCapacity },
+      mMemoryLimit{ memoryLimit },
+      mSpillBasePath{ std::move( spillBasePath ) },
+      mPipes( itemsCount, Pipe{ PipeState::Open, {}, 0, 0 } ),
+      mBufferedMemory{ 0 },
+      mSpilledSize{ 0 },
+      mRequestsEnd{ 0 },
+      mCancelled{ false } {}
+
+ItemPipeline::~ItemPipeline() = default;
+
+auto ItemPipeline::inStream( std::size_t index ) -> CMyComPtr< ISequentialInStream > {
+    return bit7z::make_com< CPipeInStream, ISequentialInStream >( *this, index );
+}
+
+auto ItemPipeline::outStream( std::size_t index ) -> CMyComPtr< ISequentialOutStream > {
+    return bit7z::make_com< CPipeOutStream, ISequentialOutStream >( *this, index );
+}
+
+auto ItemPipeline::read( std::size_t index, void* data, uint32_t size, uint32_t& processedSize ) -> HRESULT {
+    processedSize = 0;
+    std::unique_lock< std::mutex > lock{ mMutex };
+    if ( index >= mPipes.size() ) {
+        return E_INVALIDARG;
+    }
+    if ( index >= mRequestsEnd ) {
+        mRequestsEnd = index + 1;
+        mStateChanged.notify_all(); // The producer might be waiting on a full pipe of a preceding item.
+    }
+
+    auto& pipe = mPipes[ index ];
+    mStateChanged.wait( lock, [ this, &pipe ]() -> bool {
+        return mCancelled || !pipe.chunks.empty() || pipe.state != PipeState::Open;
+    } );
+    if ( mCancelled ) {
+        return E_ABORT;
+    }
+    if ( pipe.chunks.empty() ) {
+        // The item was completely read, or the producer failed writing it.
+        return pipe.state == PipeState::Finished ? S_OK : E_FAIL;
+    }
+
+    auto* output = static_cast< byte_t* >( data );
+    while ( processedSize < size && !pipe.chunks.empty() ) {
+        const auto& chunk = pipe.chunks.front();
+        const auto copySize = ( std::min )( static_cast< std::size_t >( size - processedSize ),
+                                            chunk.size - pipe.chunkOffset );
+        if ( !chunk.isSpilled ) {
+            std::memcpy( output + processedSize, chunk.data.data() + pipe.chunkOffset, copySize );
+            mBufferedMemory -= copySize;
+        } else if ( !readSpilled( chunk, pipe.chunkOffset, output + processedSize, copySize ) ) {
+            return E_FAIL;
+        }
+        processedSize += static_cast< uint32_t >( copySize );
+        pipe.chunkOffset += copySize;
+        pipe.bufferedSize -= copySize;
+        if ( pipe.chunkOffset == chunk.size ) {
+            pipe.chunks.pop_front();
+            pipe.chunkOffset = 0;
+        }
+    }
+    lock.unlock();
+    mStateChanged.notify_all();
+    return S_OK;
+}
+
+auto ItemPipeline::write( std::size_t index, const void* data, uint32_t size ) -> HRESULT try {
+    if ( size == 0 ) {
+        return S_OK;
+    }
+
+    const auto* input = static_cast< const byte_t* >( data );
+    buffer_t chunk( input, input + size );
+
+    std::unique_lock< std::mutex > lock{ mMutex };
+    if ( index >= mPipes.size() ) {
+        return E_INVALIDARG;
+    }
+    auto& pipe = mPipes[ index ];
+    mStateChanged.wait( lock, [ this, &pipe, index ]() -> bool {
+        return mCancelled || pipe.bufferedSize < mPipeCapacity || mRequestsEnd > index + 1;
+    } );
+    if ( mCancelled ) {
+        return E_ABORT;
+    }
+    if ( mRequestsEnd > index + 1 && mBufferedMemory + size > mMemoryLimit ) {
+        // The item is not being read, and the memory is full: the chunk will be read back from the temporary file.
+        const uint64_t spillOffset = mSpilledSize;
+        if ( !spill( chunk ) ) {
+            return E_FAIL;
+        }
+        pipe.chunks.push_back( Chunk{ {}, spillOffset, size, true } );
+    } else {
+        mBufferedMemory += size;
+        pipe.chunks.push_back( Chunk{ std::move( chunk ), 0, size, false } );
+    }
+    pipe.bufferedSize += size;
+    lock.unlock();
+    mStateChanged.notify_all();
+    return S_OK;
+} catch ( const std::bad_alloc& ) {
+    return E_OUTOFMEMORY;
+}
+
+void ItemPipeline::finishItem( std::size_t index, bool succeeded ) {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        if ( index >= mPipes.size() || mPipes[ index ].state != PipeState::Open ) {
+            return;
+        }
+        auto& pipe = mPipes[ index ];
+        pipe.state = succeeded ? PipeState::Finished : PipeState::Failed;
+        if ( !succeeded ) {
+            clear( pipe );
+        }
+    }
+    mStateChanged.notify_all();
+}
+
+void ItemPipeline::finish() {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        for ( auto& pipe : mPipes ) {
+            if ( pipe.state == PipeState::Open ) {
+                pipe.state = PipeState::Failed;
+                clear( pipe );
+            }
+        }
+    }
+    mStateChanged.notify_all();
+}
+
+void ItemPipeline::cancel() {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        mCancelled = true;
+    }
+    mStateChanged.notify_all();
+}
+
+auto ItemPipeline::isCancelled() const -> bool {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mCancelled;
+}
+
+auto ItemPipeline::spilledSize() const -> uint64_t {
+    const std::lock_guard< std::mutex > lock{ mMutex };
+    return mSpilledSize;
+}
+
+auto ItemPipeline::spill( const buffer_t& chunk ) -> bool {
+    if ( !mSpillFile.is_open() ) {
+        try {
+            // Note: the directory is next to the base path (e.g., the output archive), hence on the same volume.
+            mSpillDirectory = std::make_unique< TempDirectory >( mSpillBasePath, ".spill" );
+        } catch ( const BitException& ) {
+            return false;
+        }
+        mSpillFile.open( mSpillDirectory->path() / "pipeline", std::ios::in | std::ios::out |
+                                                                std::ios::trunc | std::ios::binary );
+        if ( !mSpillFile.is_open() ) {
+            return false;
+        }
+    }
+    mSpillFile.seekp( static_cast< std::streamoff >( mSpilledSize ) );
+    mSpillFile.write( reinterpret_cast< const char* >( chunk.data() ), //-V2571
+                      static_cast< std::streamsize >( chunk.size() ) );
+    if ( !mSpillFile ) {
+        return false;
+    }
+    mSpilledSize += chunk.size();
+    return true;
+}
+
+auto ItemPipeline::readSpilled( const Chunk& chunk, std::size_t offset, byte_t* output, std::size_t size ) -> bool {
+    mSpillFile.seekg( static_cast< std::streamoff >( chunk.spillOffset + offset ) );
+    mSpillFile.read( reinterpret_cast< char* >( output ), static_cast< std::streamsize >( size ) ); //-V2571
+    return static_cast< bool >( mSpillFile );
+}
+
+void ItemPipeline::clear( Pipe& pipe ) {
+    for ( const auto& chunk : pipe.chunks ) {
+        if ( !chunk.isSpilled ) {
+            mBufferedMemory -= chunk.size;
+        }
+    }
+    if ( !pipe.chunks.empty() && !pipe.chunks.front().isSpilled ) {
+        mBufferedMemory += pipe.chunkOffset; // The already read part of the first chunk was already accounted for.
+    }
+    pipe.chunks.clear();
+    pipe.chunkOffset = 0;
+    pipe.bufferedSize = 0;
+}
+
+} // namespace bit7z
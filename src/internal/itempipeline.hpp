@@ -0,0 +1,150 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ITEMPIPELINE_HPP
+#define ITEMPIPELINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bittypes.hpp"
+#include "internal/com.hpp"
+#include "internal/fs.hpp"
+
+struct ISequentialInStream;
+struct ISequentialOutStream;
+
+namespace bit7z {
+
+class TempDirectory;
+
+/**
+ * A set of bounded in-memory pipes, one for each item of an archive, connecting the thread extracting the items
+ * (the producer) with the consumers of their content (e.g., 7-Zip's encoders compressing them in a new archive).
+ *
+ * The producer is expected to write the items one at a time; the data of each item is buffered until read,
+ * and the producer waits whenever the buffered data of the item being written reaches the capacity of the pipe.
+ * However, if some consumer has already requested an item following the one being written, the latter is buffered
+ * without waiting: the consumers can request the items in any order (e.g., 7z archives sort the items by name)
+ * without deadlocking the producer. Once the data buffered in memory by all the pipes reaches the memory limit,
+ * the data of such items is spilled to a temporary file, created next to the given base path.
+ */
+class ItemPipeline final {
+    public:
+        ItemPipeline( std::size_t itemsCount, uint64_t pipeCapacity, uint64_t memoryLimit, fs::path spillBasePath );
+
+        ItemPipeline( const ItemPipeline& ) = delete;
+
+        ItemPipeline( ItemPipeline&& ) = delete;
+
+        auto operator=( const ItemPipeline& ) -> ItemPipeline& = delete;
+
+        auto operator=( ItemPipeline&& ) -> ItemPipeline& = delete;
+
+        ~ItemPipeline();
+
+        /**
+         * @return a stream reading the content of the item at the given index, as it is written by the producer.
+         */
+        auto inStream( std::size_t index ) -> CMyComPtr< ISequentialInStream >;
+
+        /**
+         * @return a stream writing the content of the item at the given index.
+         */
+        auto outStream( std::size_t index ) -> CMyComPtr< ISequentialOutStream >;
+
+        /**
+         * Reads the next chunk of data of the given item, waiting for the producer if no data is buffered.
+         *
+         * @return S_OK (with a zero processed size at the end of the item), or E_FAIL if the item
+         *         could not be written by the producer.
+         */
+        auto read( std::size_t index, void* data, uint32_t size, uint32_t& processedSize ) -> HRESULT;
+
+        /**
+         * Writes the given data to the pipe of the given item, waiting for the consumers if the pipe is full.
+         *
+         * @return S_OK, or E_ABORT if the pipeline was cancelled.
+         */
+        auto write( std::size_t index, const void* data, uint32_t size ) -> HRESULT;
+
+        /**
+         * Marks the given item as completely written (or failed, if succeeded is false).
+         */
+        void finishItem( std::size_t index, bool succeeded );
+
+        /**
+         * Marks all the items that were not completely written as failed (e.g., when the producer stops).
+         */
+        void finish();
+
+        /**
+         * Makes the producer stop at its next write, and the consumers fail at their next read.
+         */
+        void cancel();
+
+        BIT7Z_NODISCARD auto isCancelled() const -> bool;
+
+        /**
+         * @return the total amount of data (in bytes) spilled to the temporary file.
+         */
+        BIT7Z_NODISCARD auto spilledSize() const -> uint64_t;
+
+    private:
+        enum struct PipeState : std::uint8_t {
+            Open,     // The item is being (or has still to be) written.
+            Finished, // The item was completely written.
+            Failed    // The item could not be written.
+        };
+
+        // A chunk of data of an item, either kept in memory or spilled to the temporary file.
+        struct Chunk {
+            buffer_t data;
+            uint64_t spillOffset;
+            std::size_t size;
+            bool isSpilled;
+        };
+
+        struct Pipe {
+            PipeState state;
+            std::deque< Chunk > chunks;
+            std::size_t chunkOffset;
+            uint64_t bufferedSize;
+        };
+
+        const uint64_t mPipeCapacity;
+        const uint64_t mMemoryLimit;
+        const fs::path mSpillBasePath;
+        std::vector< Pipe > mPipes;
+        uint64_t mBufferedMemory; // The data buffered in memory by all the pipes.
+        // Note: the directory is declared before the file, so that it's removed after closing the file.
+        std::unique_ptr< TempDirectory > mSpillDirectory;
+        fs::fstream mSpillFile;
+        uint64_t mSpilledSize;
+        std::size_t mRequestsEnd; // One past the furthest item requested by the consumers.
+        bool mCancelled;
+        mutable std::mutex mMutex;
+        std::condition_variable mStateChanged;
+
+        // Appends the given chunk to the temporary file (created on the first call).
+        auto spill( const buffer_t& chunk ) -> bool;
+
+        // Copies the data of the given spilled chunk, starting from the given offset, from the temporary file.
+        auto readSpilled( const Chunk& chunk, std::size_t offset, byte_t* output, std::size_t size ) -> bool;
+
+        void clear( Pipe& pipe );
+};
+
+}  // namespace bit7z
+
+#endif //ITEMPIPELINE_HPP
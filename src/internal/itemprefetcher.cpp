@@ -0,0 +1,177 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+
+#include "internal/cprefetchedinstream.hpp"
+#include "internal/fsitem.hpp"
+#include "internal/itemprefetcher.hpp"
+#include "internal/util.hpp"
+
+namespace bit7z {
+
+constexpr std::size_t kReadChunkSize = 1024 * 1024; // 1 MiB
+
+ItemPrefetcher::ItemPrefetcher( const BitItemsVector& items, uint64_t budget, uint32_t threadsCount )
+    : mItems{ items }, mBudget{ budget }, mUsedBudget{ 0 }, mNextSlot{ 0 }, mStopping{ false } {
+    const uint64_t maxItemSize = mBudget / 4;
+
+    mSlots.reserve( mItems.size() );
+    for ( const auto& item : mItems ) {
+        /* Only regular filesystem files are worth prefetching: buffer and stream items are already in memory
+         * or must be read sequentially by their owner. */
+        const auto* fsItem = dynamic_cast< const FilesystemItem* >( item.get() );
+        const bool canPrefetch = fsItem != nullptr && !fsItem->isDir() && !fsItem->isSymLink();
+        const uint64_t size = canPrefetch ? fsItem->size() : 0;
+        const auto state = ( canPrefetch && size <= maxItemSize ) ? SlotState::Pending : SlotState::Done;
+        mSlots.push_back( { state, size, {} } );
+    }
+
+    mWorkers.reserve( threadsCount );
+    for ( uint32_t i = 0; i < threadsCount; ++i ) {
+        mWorkers.emplace_back( &ItemPrefetcher::prefetchItems, this );
+    }
+}
+
+ItemPrefetcher::~ItemPrefetcher() {
+    {
+        const std::lock_guard< std::mutex > lock{ mMutex };
+        mStopping = true;
+    }
+    mStateChanged.notify_all();
+    for ( auto& worker : mWorkers ) {
+        worker.join();
+    }
+}
+
+auto ItemPrefetcher::take( std::size_t index ) -> CMyComPtr< ISequentialInStream > {
+    std::unique_lock< std::mutex > lock{ mMutex };
+    if ( index >= mSlots.size() ) {
+        return nullptr;
+    }
+
+    auto& slot = mSlots[ index ];
+    mStateChanged.wait( lock, [ &slot ]() -> bool { return slot.state != SlotState::Reading; } );
+
+    CMyComPtr< ISequentialInStream > result;
+    if ( slot.state == SlotState::Ready ) {
+        mUsedBudget -= slot.size;
+        result = bit7z::make_com< CPrefetchedInStream, ISequentialInStream >( std::move( slot.data ) );
+    }
+    /* Note: if the item was Pending or Waiting for the budget, we prevent any thread from reading it,
+     * since the caller is going to read it by itself.
+     * Also, we don't skip the items following the requested one: some formats (e.g., 7z) request the items
+     * in their own order, so the items are still read in the items vector's order, and buffered until requested. */
+    slot.state = SlotState::Done;
+    slot.data = buffer_t{};
+    lock.unlock();
+    mStateChanged.notify_all();
+    return result;
+}
+
+void ItemPrefetcher::waitIdle() {
+    std::unique_lock< std::mutex > lock{ mMutex };
+    mStateChanged.wait( lock, [ this ]() -> bool { return isIdle(); } );
+}
+
+void ItemPrefetcher::prefetchItems() {
+    std::unique_lock< std::mutex > lock{ mMutex };
+    while ( !mStopping ) {
+        while ( mNextSlot < mSlots.size() && mSlots[ mNextSlot ].state != SlotState::Pending ) {
+            ++mNextSlot;
+        }
+        if ( mNextSlot >= mSlots.size() ) {
+            return; // Nothing left to prefetch.
+        }
+
+        const std::size_t index = mNextSlot++;
+        auto& slot = mSlots[ index ];
+        slot.state = SlotState::Waiting;
+        mStateChanged.notify_all(); // The thread might be going to wait for the budget.
+        mStateChanged.wait( lock, [ this, &slot ]() -> bool {
+            return mStopping || slot.state != SlotState::Waiting || mUsedBudget + slot.size <= mBudget;
+        } );
+        if ( mStopping ) {
+            return;
+        }
+        if ( slot.state != SlotState::Waiting ) {
+            continue; // The item was taken while we were waiting for the budget.
+        }
+
+        mUsedBudget += slot.size;
+        slot.state = SlotState::Reading;
+        lock.unlock();
+
+        buffer_t data;
+        const bool success = readItem( index, data );
+
+        lock.lock();
+        if ( success ) {
+            slot.data = std::move( data );
+            slot.state = SlotState::Ready;
+        } else {
+            mUsedBudget -= slot.size;
+            slot.state = SlotState::Done;
+        }
+        mStateChanged.notify_all();
+    }
+}
+
+auto ItemPrefetcher::isIdle() const -> bool {
+    // Note: each slot in the Waiting state has a thread waiting for the budget, and vice versa.
+    std::size_t waitingCount = 0;
+    bool hasPendingSlots = false;
+    for ( const auto& slot : mSlots ) {
+        if ( slot.state == SlotState::Reading ||
+             ( slot.state == SlotState::Waiting && mUsedBudget + slot.size <= mBudget ) ) {
+            return false;
+        }
+        waitingCount += slot.state == SlotState::Waiting ? 1 : 0;
+        hasPendingSlots = hasPendingSlots || slot.state == SlotState::Pending;
+    }
+    return !hasPendingSlots || waitingCount == mWorkers.size();
+}
+
+auto ItemPrefetcher::readItem( std::size_t index, buffer_t& data ) const -> bool {
+    try {
+        CMyComPtr< ISequentialInStream > inStream;
+        if ( mItems[ index ].getStream( &inStream ) != S_OK || inStream == nullptr ) {
+            return false;
+        }
+
+        /* We read one more byte than the expected size: if we manage to read it, the file grew after being indexed,
+         * and we let the caller read it synchronously (so that the budget is never exceeded). */
+        const auto expectedSize = static_cast< std::size_t >( mSlots[ index ].size );
+        data.resize( expectedSize + 1 );
+        std::size_t totalRead = 0;
+        while ( totalRead < data.size() ) {
+            const auto readSize = static_cast< UInt32 >( ( std::min )( data.size() - totalRead, kReadChunkSize ) );
+            UInt32 processedSize = 0;
+            if ( inStream->Read( &data[ totalRead ], readSize, &processedSize ) != S_OK ) {
+                return false;
+            }
+            if ( processedSize == 0 ) {
+                break;
+            }
+            totalRead += processedSize;
+        }
+        if ( totalRead > expectedSize ) {
+            return false;
+        }
+        data.resize( totalRead );
+        return true;
+    } catch ( ... ) {
+        return false;
+    }
+}
+
+} // namespace bit7z
@@ -0,0 +1,102 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ITEMPREFETCHER_HPP
+#define ITEMPREFETCHER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bititemsvector.hpp"
+#include "bittypes.hpp"
+#include "internal/com.hpp"
+
+struct ISequentialInStream;
+
+namespace bit7z {
+
+/**
+ * Reads in advance, using a pool of background threads, the content of the (small) filesystem items
+ * that will be requested by 7-Zip during a compression operation.
+ *
+ * Items are read following their order in the items vector (i.e., the UpdateItems order),
+ * and the total amount of prefetched data that has not been consumed yet never exceeds the given memory budget.
+ * Items whose size is greater than a quarter of the budget are not prefetched and must be read synchronously.
+ */
+class ItemPrefetcher final {
+    public:
+        ItemPrefetcher( const BitItemsVector& items, uint64_t budget, uint32_t threadsCount );
+
+        ItemPrefetcher( const ItemPrefetcher& ) = delete;
+
+        ItemPrefetcher( ItemPrefetcher&& ) = delete;
+
+        auto operator=( const ItemPrefetcher& ) -> ItemPrefetcher& = delete;
+
+        auto operator=( ItemPrefetcher&& ) -> ItemPrefetcher& = delete;
+
+        ~ItemPrefetcher();
+
+        /**
+         * Takes the prefetched content of the item at the given index of the items vector.
+         *
+         * If the item is being read by a background thread, the function waits for it to be ready.
+         * If, instead, the item was not prefetched (and it is not being prefetched), a null stream is returned,
+         * and the caller must open the item's stream by itself.
+         *
+         * @param index the index of the item in the items vector.
+         *
+         * @return the stream over the prefetched content of the item, or a null stream.
+         */
+        auto take( std::size_t index ) -> CMyComPtr< ISequentialInStream >;
+
+        /**
+         * Waits until the background threads cannot prefetch any other item before some item is taken,
+         * i.e., until they have no item left to read, or all of them are waiting for enough free memory budget.
+         */
+        void waitIdle();
+
+    private:
+        enum struct SlotState : std::uint8_t {
+            Pending, // The item must be prefetched, but no thread has claimed it yet.
+            Waiting, // A thread claimed the item, and it is waiting for enough free memory budget.
+            Reading, // A thread is reading the item's content.
+            Ready,   // The item's content was read and is waiting to be taken.
+            Done     // The item was taken, or it will not be prefetched.
+        };
+
+        struct Slot {
+            SlotState state;
+            uint64_t size;
+            buffer_t data;
+        };
+
+        const BitItemsVector& mItems;
+        const uint64_t mBudget;
+        uint64_t mUsedBudget;
+        std::vector< Slot > mSlots;
+        std::size_t mNextSlot;
+        bool mStopping;
+        std::mutex mMutex;
+        std::condition_variable mStateChanged;
+        std::vector< std::thread > mWorkers;
+
+        void prefetchItems();
+
+        BIT7Z_NODISCARD auto isIdle() const -> bool;
+
+        auto readItem( std::size_t index, buffer_t& data ) const -> bool;
+};
+
+}  // namespace bit7z
+
+#endif //ITEMPREFETCHER_HPP
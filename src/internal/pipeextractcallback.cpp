@@ -0,0 +1,44 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/pipeextractcallback.hpp"
+
+namespace bit7z {
+
+PipeExtractCallback::PipeExtractCallback( const BitInputArchive& inputArchive, ItemPipeline& pipeline )
+    : ExtractCallback( inputArchive ),
+      mPipeline( pipeline ),
+      mCurrentIndex{ 0 } {}
+
+auto PipeExtractCallback::finishOperation( OperationResult operationResult ) -> HRESULT {
+    if ( mPipeStream != nullptr ) {
+        mPipeline.finishItem( mCurrentIndex, operationResult == OperationResult::Success );
+    }
+    return ExtractCallback::finishOperation( operationResult );
+}
+
+void PipeExtractCallback::releaseStream() {
+    mPipeStream.Release();
+}
+
+auto PipeExtractCallback::getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT {
+    if ( isItemFolder( index ) ) {
+        return S_OK;
+    }
+
+    mCurrentIndex = index;
+    mPipeStream = mPipeline.outStream( index );
+    *outStream = CMyComPtr< ISequentialOutStream >{ mPipeStream }.Detach();
+    return S_OK;
+}
+
+} // namespace bit7z
@@ -0,0 +1,50 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef PIPEEXTRACTCALLBACK_HPP
+#define PIPEEXTRACTCALLBACK_HPP
+
+#include "internal/extractcallback.hpp"
+#include "internal/itempipeline.hpp"
+
+namespace bit7z {
+
+/**
+ * Extracts the items of an archive to the pipes of an ItemPipeline (the index of each pipe being the index
+ * of the corresponding item in the archive).
+ */
+class PipeExtractCallback final : public ExtractCallback {
+    public:
+        PipeExtractCallback( const BitInputArchive& inputArchive, ItemPipeline& pipeline );
+
+        PipeExtractCallback( const PipeExtractCallback& ) = delete;
+
+        PipeExtractCallback( PipeExtractCallback&& ) = delete;
+
+        auto operator=( const PipeExtractCallback& ) -> PipeExtractCallback& = delete;
+
+        auto operator=( PipeExtractCallback&& ) -> PipeExtractCallback& = delete;
+
+        ~PipeExtractCallback() override = default;
+
+    private:
+        ItemPipeline& mPipeline;
+        CMyComPtr< ISequentialOutStream > mPipeStream;
+        uint32_t mCurrentIndex;
+
+        auto finishOperation( OperationResult operationResult ) -> HRESULT override;
+
+        void releaseStream() override;
+
+        auto getOutStream( uint32_t index, ISequentialOutStream** outStream ) -> HRESULT override;
+};
+
+}  // namespace bit7z
+
+#endif // PIPEEXTRACTCALLBACK_HPP
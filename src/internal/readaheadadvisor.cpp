@@ -0,0 +1,270 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef POSIX_FADV_WILLNEED // e.g., not available on macOS.
+#define BIT7Z_USE_FADVISE
+#endif
+#endif
+
+#include "internal/inplaceappend.hpp"
+#include "internal/readaheadadvisor.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+constexpr int kInvalidFile = -1;
+
+auto coalesce_data_ranges( const std::vector< DataRange >& ranges,
+                           uint64_t window,
+                           std::vector< std::size_t >& rangeIndices ) -> std::vector< DataRange > {
+    std::vector< std::size_t > order( ranges.size() );
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(), [ &ranges ]( std::size_t first, std::size_t second ) -> bool {
+        return ranges[ first ].offset < ranges[ second ].offset;
+    } );
+
+    std::vector< DataRange > result;
+    rangeIndices.assign( ranges.size(), kNoDataRange );
+    for ( const auto index : order ) {
+        const auto& range = ranges[ index ];
+        if ( range.size == 0 ) {
+            continue;
+        }
+        if ( result.empty() || range.offset > result.back().offset + result.back().size + window ) {
+            result.push_back( range );
+        } else {
+            auto& lastRange = result.back();
+            const uint64_t rangeEnd = ( std::max )( lastRange.offset + lastRange.size, range.offset + range.size );
+            lastRange.size = rangeEnd - lastRange.offset;
+        }
+        rangeIndices[ index ] = result.size() - 1;
+    }
+    return result;
+}
+
+#ifdef BIT7Z_USE_FADVISE
+// The amount of data read ahead, starting from the beginning of the range being extracted.
+constexpr uint64_t kReadAheadDistance = 64 * 1024 * 1024; // 64 MiB
+
+// The size of the signature header of 7z archives, which is followed by the packed streams of the blocks.
+constexpr uint64_t kSevenZipSignatureHeaderSize = 32;
+
+namespace {
+auto item_uint64_property( const BitInputArchive& inputArchive,
+                           uint32_t index,
+                           BitProperty property,
+                           uint64_t& value ) -> bool {
+    const BitPropVariant propValue = inputArchive.itemProperty( index, property );
+    if ( !propValue.isUInt64() ) {
+        return false;
+    }
+    value = propValue.getUInt64();
+    return true;
+}
+
+// The packed streams of 7z archives are stored after the signature header, in the order of the blocks using them.
+auto blocks_data_ranges( const BitInputArchive& inputArchive, std::vector< DataRange >& itemsRanges ) -> bool {
+    std::vector< uint64_t > itemsBlocks( itemsRanges.size(), 0 );
+    std::vector< bool > hasBlock( itemsRanges.size(), false );
+    std::vector< uint64_t > blocksSizes;
+    for ( uint32_t index = 0; index < itemsRanges.size(); ++index ) {
+        uint64_t block = 0;
+        if ( !item_uint64_property( inputArchive, index, BitProperty::Block, block ) ) {
+            continue; // E.g., folders and empty files.
+        }
+        if ( block >= itemsRanges.size() ) { // There cannot be more blocks than items.
+            return false;
+        }
+        itemsBlocks[ index ] = block;
+        hasBlock[ index ] = true;
+        if ( block >= blocksSizes.size() ) {
+            blocksSizes.resize( block + 1, 0 );
+        }
+        // Note: the size of the packed streams of a block is reported only by its first item.
+        uint64_t packSize = 0;
+        if ( item_uint64_property( inputArchive, index, BitProperty::PackSize, packSize ) ) {
+            blocksSizes[ block ] = ( std::max )( blocksSizes[ block ], packSize );
+        }
+    }
+    if ( blocksSizes.empty() ) {
+        return false;
+    }
+
+    std::vector< uint64_t > blocksOffsets( blocksSizes.size() );
+    uint64_t offset = kSevenZipSignatureHeaderSize;
+    for ( std::size_t block = 0; block < blocksSizes.size(); ++block ) {
+        blocksOffsets[ block ] = offset;
+        offset += blocksSizes[ block ];
+    }
+    for ( std::size_t index = 0; index < itemsRanges.size(); ++index ) {
+        if ( hasBlock[ index ] ) {
+            const auto block = itemsBlocks[ index ];
+            itemsRanges[ index ] = DataRange{ blocksOffsets[ block ], blocksSizes[ block ] };
+        }
+    }
+    return true;
+}
+
+// Locates the data of each item in the archive file (an empty range means that the position of the data is unknown).
+auto items_data_ranges( const BitInputArchive& inputArchive ) -> std::vector< DataRange > {
+    std::vector< DataRange > result( inputArchive.itemsCount(), DataRange{ 0, 0 } );
+
+    std::vector< RawArchiveEntry > entries;
+    if ( read_raw_entries( inputArchive, entries ) ) {
+        for ( uint32_t index = 0; index < entries.size() && index < result.size(); ++index ) {
+            // Note: the entries are expected to be in the same order of the items; otherwise, the range is unknown.
+            const BitPropVariant itemPath = inputArchive.itemProperty( index, BitProperty::Path );
+            if ( !itemPath.isString() ||
+                 entries[ index ].path != fs::path( itemPath.getNativeString() ).generic_u8string() ) {
+                continue;
+            }
+            // Note: the range includes the headers of the entry, which are read by 7-Zip too.
+            result[ index ] = DataRange{ entries[ index ].offset, entries[ index ].size };
+        }
+        return result;
+    }
+
+    if ( inputArchive.detectedFormat() == BitFormat::SevenZip ) {
+        if ( !blocks_data_ranges( inputArchive, result ) ) {
+            result.assign( result.size(), DataRange{ 0, 0 } );
+        }
+        return result;
+    }
+
+    // Some formats report the offsets of the data of their items (e.g., iso and wim archives).
+    for ( uint32_t index = 0; index < result.size(); ++index ) {
+        uint64_t offset = 0;
+        uint64_t packSize = 0;
+        if ( item_uint64_property( inputArchive, index, BitProperty::Offset, offset ) &&
+             item_uint64_property( inputArchive, index, BitProperty::PackSize, packSize ) ) {
+            result[ index ] = DataRange{ offset, packSize };
+        }
+    }
+    return result;
+}
+} // namespace
+
+ReadAheadAdvisor::ReadAheadAdvisor( const BitInputArchive& inputArchive,
+                                    const std::vector< uint32_t >& indices,
+                                    uint64_t window )
+    : mFile{ kInvalidFile }, mCurrentRange{ kNoDataRange }, mAdvisedEnd{ 0 }, mReleasedEnd{ 0 } {
+    if ( window == 0 || inputArchive.archivePath().empty() ) {
+        return;
+    }
+
+    const fs::path archivePath = tstring_to_path( inputArchive.archivePath() );
+    const int file = ::open( archivePath.c_str(), O_RDONLY | O_CLOEXEC ); // NOLINT(*-vararg)
+    if ( file == kInvalidFile ) {
+        return;
+    }
+    struct stat fileStat{};
+    if ( ::fstat( file, &fileStat ) != 0 ) {
+        ::close( file );
+        return;
+    }
+
+    std::vector< DataRange > itemsRanges = items_data_ranges( inputArchive );
+    std::vector< bool > isRequested( itemsRanges.size(), indices.empty() );
+    for ( const auto index : indices ) {
+        if ( index < isRequested.size() ) {
+            isRequested[ index ] = true;
+        }
+    }
+    const auto fileSize = static_cast< uint64_t >( fileStat.st_size );
+    for ( std::size_t index = 0; index < itemsRanges.size(); ++index ) {
+        auto& range = itemsRanges[ index ];
+        // Note: the ranges past the end of the file are unreliable (e.g., for multi-volume archives).
+        if ( !isRequested[ index ] || range.offset >= fileSize || range.size > fileSize - range.offset ) {
+            range = DataRange{ 0, 0 };
+        }
+    }
+    mRanges = coalesce_data_ranges( itemsRanges, window, mItemRanges );
+    if ( mRanges.empty() ) {
+        ::close( file );
+        return;
+    }
+    mFile = file;
+}
+
+ReadAheadAdvisor::~ReadAheadAdvisor() {
+    if ( mFile == kInvalidFile ) {
+        return;
+    }
+    if ( mCurrentRange != kNoDataRange ) {
+        for ( ; mReleasedEnd <= mCurrentRange; ++mReleasedEnd ) {
+            adviseRange( mReleasedEnd, false );
+        }
+    }
+    ::close( mFile );
+}
+
+void ReadAheadAdvisor::advise( uint32_t index ) noexcept {
+    if ( mFile == kInvalidFile || index >= mItemRanges.size() || mItemRanges[ index ] == kNoDataRange ) {
+        return;
+    }
+    const std::size_t rangeIndex = mItemRanges[ index ];
+    if ( rangeIndex == mCurrentRange ) {
+        return;
+    }
+    mCurrentRange = rangeIndex;
+
+    // Note: 7-Zip reads the items in the order of their data, so the preceding ranges will not be read again.
+    for ( ; mReleasedEnd < rangeIndex; ++mReleasedEnd ) {
+        adviseRange( mReleasedEnd, false );
+    }
+
+    // The current and the next ranges are always read ahead (the next one might be far, e.g., on another disk track),
+    // as well as the following ranges starting within the read-ahead distance.
+    const uint64_t readAheadEnd = mRanges[ rangeIndex ].offset + kReadAheadDistance;
+    mAdvisedEnd = ( std::max )( mAdvisedEnd, rangeIndex );
+    while ( mAdvisedEnd < mRanges.size() &&
+            ( mAdvisedEnd <= rangeIndex + 1 || mRanges[ mAdvisedEnd ].offset < readAheadEnd ) ) {
+        adviseRange( mAdvisedEnd, true );
+        ++mAdvisedEnd;
+    }
+}
+
+void ReadAheadAdvisor::adviseRange( std::size_t rangeIndex, bool willNeed ) const noexcept {
+    const auto& range = mRanges[ rangeIndex ];
+    /* Note: only the beginning of the big ranges is read ahead explicitly, as the OS read-ahead heuristics
+     *       work well once the range is being read sequentially; instead, the whole range is dropped from the cache. */
+    const uint64_t size = willNeed ? ( std::min )( range.size, kReadAheadDistance ) : range.size;
+    ::posix_fadvise( mFile,
+                     static_cast< off_t >( range.offset ),
+                     static_cast< off_t >( size ),
+                     willNeed ? POSIX_FADV_WILLNEED : POSIX_FADV_DONTNEED );
+}
+
+#else
+
+ReadAheadAdvisor::ReadAheadAdvisor( const BitInputArchive& /*inputArchive*/,
+                                    const std::vector< uint32_t >& /*indices*/,
+                                    uint64_t /*window*/ )
+    : mFile{ kInvalidFile }, mCurrentRange{ kNoDataRange }, mAdvisedEnd{ 0 }, mReleasedEnd{ 0 } {}
+
+ReadAheadAdvisor::~ReadAheadAdvisor() = default;
+
+void ReadAheadAdvisor::advise( uint32_t /*index*/ ) noexcept {}
+
+void ReadAheadAdvisor::adviseRange( std::size_t /*rangeIndex*/, bool /*willNeed*/ ) const noexcept {}
+
+#endif
+
+}  // namespace bit7z
@@ -0,0 +1,89 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef READAHEADADVISOR_HPP
+#define READAHEADADVISOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitinputarchive.hpp"
+
+namespace bit7z {
+
+/**
+ * A range of bytes of an archive file.
+ */
+struct DataRange {
+    uint64_t offset;
+    uint64_t size;
+};
+
+constexpr auto kNoDataRange = static_cast< std::size_t >( -1 );
+
+/**
+ * Sorts the given ranges by offset, and merges the ones overlapping or separated by a gap not bigger than the window.
+ *
+ * @param ranges        the ranges to be coalesced (empty ranges are ignored).
+ * @param window        the maximum gap between two merged ranges.
+ * @param rangeIndices  the index of the resulting range containing each of the input ranges
+ *                      (kNoDataRange for the empty ones).
+ *
+ * @return the coalesced ranges.
+ */
+auto coalesce_data_ranges( const std::vector< DataRange >& ranges,
+                           uint64_t window,
+                           std::vector< std::size_t >& rangeIndices ) -> std::vector< DataRange >;
+
+/**
+ * Gives the OS hints about the ranges of an archive file that will be read for extracting some of its items,
+ * so that it can read them ahead (and drop them from its cache once they are read), rather than relying
+ * on its sequential read-ahead heuristics, which work poorly when the extraction jumps between distant items.
+ *
+ * The hints are given through a separate file descriptor of the archive file: since they work on the page cache
+ * of the file, they benefit the streams used by 7-Zip to read the archive.
+ */
+class ReadAheadAdvisor final {
+    public:
+        ReadAheadAdvisor( const BitInputArchive& inputArchive,
+                          const std::vector< uint32_t >& indices,
+                          uint64_t window );
+
+        ReadAheadAdvisor( const ReadAheadAdvisor& ) = delete;
+
+        ReadAheadAdvisor( ReadAheadAdvisor&& ) = delete;
+
+        auto operator=( const ReadAheadAdvisor& ) -> ReadAheadAdvisor& = delete;
+
+        auto operator=( ReadAheadAdvisor&& ) -> ReadAheadAdvisor& = delete;
+
+        // Drops the ranges read so far from the OS cache.
+        ~ReadAheadAdvisor();
+
+        /**
+         * Notifies the advisor that the item at the given index is about to be extracted:
+         * the preceding ranges are dropped from the OS cache, while the upcoming ones are read ahead.
+         */
+        void advise( uint32_t index ) noexcept;
+
+    private:
+        int mFile;
+        std::vector< DataRange > mRanges;       // The coalesced ranges of the items to be extracted, sorted by offset.
+        std::vector< std::size_t > mItemRanges; // The index of the range containing each item of the archive.
+        std::size_t mCurrentRange;
+        std::size_t mAdvisedEnd;                // The ranges before this one were already read ahead.
+        std::size_t mReleasedEnd;               // The ranges before this one were already dropped from the cache.
+
+        void adviseRange( std::size_t rangeIndex, bool willNeed ) const noexcept;
+};
+
+}  // namespace bit7z
+
+#endif //READAHEADADVISOR_HPP
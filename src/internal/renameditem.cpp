@@ -17,8 +17,51 @@
 
 namespace bit7z {
 
+RenamedItem::RenamedItem( const BitInputArchive& inputArchive, uint32_t index )
+    : mInputArchive{ inputArchive },
+      mIndex{ index },
+      mNewPath{ inputArchive.itemProperty( index, BitProperty::Path ).getNativeString() },
+      mIsRenamed{ false },
+      mHasNewAttributes{ false },
+      mAttributes{ 0 },
+      mHasNewLastWriteTime{ false },
+      mLastWriteTime{} {}
+
 RenamedItem::RenamedItem( const BitInputArchive& inputArchive, uint32_t index, const tstring& newPath )
-    : mInputArchive{ inputArchive }, mIndex{ index }, mNewPath{ tstring_to_path( newPath ) } {}
+    : RenamedItem( inputArchive, index ) {
+    setPath( newPath );
+}
+
+void RenamedItem::setPath( const tstring& newPath ) {
+    mNewPath = tstring_to_path( newPath );
+    mIsRenamed = true;
+}
+
+void RenamedItem::setAttributes( uint32_t attributes ) {
+    mAttributes = attributes;
+    mHasNewAttributes = true;
+}
+
+void RenamedItem::setLastWriteTime( FILETIME lastWriteTime ) {
+    mLastWriteTime = lastWriteTime;
+    mHasNewLastWriteTime = true;
+}
+
+auto RenamedItem::index() const noexcept -> uint32_t {
+    return mIndex;
+}
+
+auto RenamedItem::isRenamed() const noexcept -> bool {
+    return mIsRenamed;
+}
+
+auto RenamedItem::hasNewAttributes() const noexcept -> bool {
+    return mHasNewAttributes;
+}
+
+auto RenamedItem::hasNewLastWriteTime() const noexcept -> bool {
+    return mHasNewLastWriteTime;
+}
 
 auto RenamedItem::name() const -> tstring {
     return path_to_tstring( mNewPath.filename() );
@@ -37,7 +80,7 @@ auto RenamedItem::getStream( ISequentialInStream** /*inStream*/ ) const noexcept
 }
 
 auto RenamedItem::hasNewData() const noexcept -> bool {
-    return false; //just a new property (i.e., path/name), no new data!
+    return false; //just new properties (e.g., path/name), no new data!
 }
 
 auto RenamedItem::isDir() const -> bool {
@@ -63,11 +106,17 @@ auto RenamedItem::lastAccessTime() const -> FILETIME {
 }
 
 auto RenamedItem::lastWriteTime() const -> FILETIME {
+    if ( mHasNewLastWriteTime ) {
+        return mLastWriteTime;
+    }
     const BitPropVariant writeTime = mInputArchive.itemProperty( mIndex, BitProperty::MTime );
     return writeTime.isFileTime() ? writeTime.getFileTime() : current_file_time();
 }
 
 auto RenamedItem::attributes() const -> uint32_t {
+    if ( mHasNewAttributes ) {
+        return mAttributes;
+    }
     return mInputArchive.itemProperty( mIndex, BitProperty::Attrib ).getUInt32();
 }
 
@@ -15,10 +15,30 @@
 
 namespace bit7z {
 
+/**
+ * An existing item of an archive whose metadata (i.e., path, attributes, and last write time) is changed,
+ * without new data.
+ */
 class RenamedItem final : public GenericInputItem {
     public:
+        explicit RenamedItem( const BitInputArchive& inputArchive, uint32_t index );
+
         explicit RenamedItem( const BitInputArchive& inputArchive, uint32_t index, const tstring& newPath );
 
+        void setPath( const tstring& newPath );
+
+        void setAttributes( uint32_t attributes );
+
+        void setLastWriteTime( FILETIME lastWriteTime );
+
+        BIT7Z_NODISCARD auto index() const noexcept -> uint32_t;
+
+        BIT7Z_NODISCARD auto isRenamed() const noexcept -> bool;
+
+        BIT7Z_NODISCARD auto hasNewAttributes() const noexcept -> bool;
+
+        BIT7Z_NODISCARD auto hasNewLastWriteTime() const noexcept -> bool;
+
         BIT7Z_NODISCARD auto name() const -> tstring override;
 
         BIT7Z_NODISCARD auto isDir() const -> bool override;
@@ -47,6 +67,11 @@ class RenamedItem final : public GenericInputItem {
         const BitInputArchive& mInputArchive;
         uint32_t mIndex;
         fs::path mNewPath;
+        bool mIsRenamed;
+        bool mHasNewAttributes;
+        uint32_t mAttributes;
+        bool mHasNewLastWriteTime;
+        FILETIME mLastWriteTime;
 };
 
 }  // namespace bit7z
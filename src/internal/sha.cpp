@@ -0,0 +1,191 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "internal/sha.hpp"
+
+namespace bit7z {
+
+inline auto rotate_left( uint32_t value, unsigned shift ) noexcept -> uint32_t {
+    return ( value << shift ) | ( value >> ( 32u - shift ) );
+}
+
+inline auto rotate_right( uint32_t value, unsigned shift ) noexcept -> uint32_t {
+    return ( value >> shift ) | ( value << ( 32u - shift ) );
+}
+
+inline auto load_be32( const byte_t* data ) noexcept -> uint32_t {
+    return ( static_cast< uint32_t >( data[ 0 ] ) << 24u ) | ( static_cast< uint32_t >( data[ 1 ] ) << 16u ) | //-V2563
+           ( static_cast< uint32_t >( data[ 2 ] ) << 8u ) | static_cast< uint32_t >( data[ 3 ] ); //-V2563
+}
+
+template< std::size_t N, std::size_t Words >
+inline auto store_be32( const std::array< uint32_t, Words >& words ) noexcept -> std::array< byte_t, N > {
+    static_assert( N <= Words * 4, "The digest is bigger than the state" );
+    std::array< byte_t, N > result{};
+    for ( std::size_t i = 0; i < N; ++i ) {
+        result[ i ] = static_cast< byte_t >( words[ i / 4 ] >> ( 24u - 8u * ( i % 4 ) ) );
+    }
+    return result;
+}
+
+ShaMessage::ShaMessage() noexcept : mBlock{}, mBlockSize{ 0 }, mMessageSize{ 0 } {}
+
+void ShaMessage::update( const byte_t* data, std::size_t size ) noexcept {
+    mMessageSize += size;
+    if ( mBlockSize > 0 ) {
+        const std::size_t copySize = ( std::min )( size, kShaBlockSize - mBlockSize );
+        std::memcpy( &mBlock[ mBlockSize ], data, copySize );
+        mBlockSize += copySize;
+        data += copySize; //-V2563
+        size -= copySize;
+        if ( mBlockSize < kShaBlockSize ) {
+            return;
+        }
+        processBlock( mBlock.data() );
+        mBlockSize = 0;
+    }
+    for ( ; size >= kShaBlockSize; size -= kShaBlockSize, data += kShaBlockSize ) { //-V2563
+        processBlock( data );
+    }
+    if ( size > 0 ) {
+        std::memcpy( mBlock.data(), data, size );
+        mBlockSize = size;
+    }
+}
+
+void ShaMessage::pad() noexcept {
+    const uint64_t messageBits = mMessageSize * 8;
+    mBlock[ mBlockSize++ ] = 0x80;
+    if ( mBlockSize > kShaBlockSize - 8 ) {
+        std::memset( &mBlock[ mBlockSize ], 0, kShaBlockSize - mBlockSize );
+        processBlock( mBlock.data() );
+        mBlockSize = 0;
+    }
+    std::memset( &mBlock[ mBlockSize ], 0, kShaBlockSize - 8 - mBlockSize );
+    for ( std::size_t i = 0; i < 8; ++i ) {
+        mBlock[ kShaBlockSize - 1 - i ] = static_cast< byte_t >( messageBits >> ( 8u * i ) );
+    }
+    processBlock( mBlock.data() );
+    mBlockSize = 0;
+}
+
+Sha1::Sha1() noexcept : mState{ { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 } } {}
+
+auto Sha1::finish() noexcept -> std::array< byte_t, 20 > {
+    pad();
+    return store_be32< 20 >( mState );
+}
+
+void Sha1::processBlock( const byte_t* block ) noexcept {
+    std::array< uint32_t, 80 > words{};
+    for ( std::size_t i = 0; i < 16; ++i ) {
+        words[ i ] = load_be32( block + 4 * i ); //-V2563
+    }
+    for ( std::size_t i = 16; i < words.size(); ++i ) {
+        words[ i ] = rotate_left( words[ i - 3 ] ^ words[ i - 8 ] ^ words[ i - 14 ] ^ words[ i - 16 ], 1 );
+    }
+
+    uint32_t a = mState[ 0 ]; // NOLINT(*-identifier-length)
+    uint32_t b = mState[ 1 ]; // NOLINT(*-identifier-length)
+    uint32_t c = mState[ 2 ]; // NOLINT(*-identifier-length)
+    uint32_t d = mState[ 3 ]; // NOLINT(*-identifier-length)
+    uint32_t e = mState[ 4 ]; // NOLINT(*-identifier-length)
+    for ( std::size_t i = 0; i < words.size(); ++i ) {
+        uint32_t f; // NOLINT(*-identifier-length, *-init-variables)
+        uint32_t k; // NOLINT(*-identifier-length, *-init-variables)
+        if ( i < 20 ) {
+            f = ( b & c ) | ( ~b & d );
+            k = 0x5A827999;
+        } else if ( i < 40 ) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if ( i < 60 ) {
+            f = ( b & c ) | ( b & d ) | ( c & d );
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        const uint32_t temp = rotate_left( a, 5 ) + f + e + k + words[ i ];
+        e = d;
+        d = c;
+        c = rotate_left( b, 30 );
+        b = a;
+        a = temp;
+    }
+    mState[ 0 ] += a;
+    mState[ 1 ] += b;
+    mState[ 2 ] += c;
+    mState[ 3 ] += d;
+    mState[ 4 ] += e;
+}
+
+constexpr std::array< uint32_t, 64 > kSha256RoundConstants = { {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+} };
+
+Sha256::Sha256() noexcept
+    : mState{ { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 } } {}
+
+auto Sha256::finish() noexcept -> std::array< byte_t, 32 > {
+    pad();
+    return store_be32< 32 >( mState );
+}
+
+void Sha256::processBlock( const byte_t* block ) noexcept {
+    std::array< uint32_t, 64 > words{};
+    for ( std::size_t i = 0; i < 16; ++i ) {
+        words[ i ] = load_be32( block + 4 * i ); //-V2563
+    }
+    for ( std::size_t i = 16; i < words.size(); ++i ) {
+        const uint32_t s0 = rotate_right( words[ i - 15 ], 7 ) ^ rotate_right( words[ i - 15 ], 18 ) ^
+                            ( words[ i - 15 ] >> 3u );
+        const uint32_t s1 = rotate_right( words[ i - 2 ], 17 ) ^ rotate_right( words[ i - 2 ], 19 ) ^
+                            ( words[ i - 2 ] >> 10u );
+        words[ i ] = words[ i - 16 ] + s0 + words[ i - 7 ] + s1;
+    }
+
+    std::array< uint32_t, 8 > state = mState;
+    for ( std::size_t i = 0; i < words.size(); ++i ) {
+        const uint32_t s1 = rotate_right( state[ 4 ], 6 ) ^ rotate_right( state[ 4 ], 11 ) ^
+                            rotate_right( state[ 4 ], 25 );
+        const uint32_t choice = ( state[ 4 ] & state[ 5 ] ) ^ ( ~state[ 4 ] & state[ 6 ] );
+        const uint32_t temp1 = state[ 7 ] + s1 + choice + kSha256RoundConstants[ i ] + words[ i ];
+        const uint32_t s0 = rotate_right( state[ 0 ], 2 ) ^ rotate_right( state[ 0 ], 13 ) ^
+                            rotate_right( state[ 0 ], 22 );
+        const uint32_t majority = ( state[ 0 ] & state[ 1 ] ) ^ ( state[ 0 ] & state[ 2 ] ) ^ ( state[ 1 ] & state[ 2 ] );
+        const uint32_t temp2 = s0 + majority;
+        state[ 7 ] = state[ 6 ];
+        state[ 6 ] = state[ 5 ];
+        state[ 5 ] = state[ 4 ];
+        state[ 4 ] = state[ 3 ] + temp1;
+        state[ 3 ] = state[ 2 ];
+        state[ 2 ] = state[ 1 ];
+        state[ 1 ] = state[ 0 ];
+        state[ 0 ] = temp1 + temp2;
+    }
+    for ( std::size_t i = 0; i < mState.size(); ++i ) {
+        mState[ i ] += state[ i ];
+    }
+}
+
+}  // namespace bit7z
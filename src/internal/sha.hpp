@@ -0,0 +1,86 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SHA_HPP
+#define SHA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "bittypes.hpp"
+
+namespace bit7z {
+
+constexpr std::size_t kShaBlockSize = 64;
+
+/**
+ * The message buffering and padding shared by SHA-1 and SHA-256 (both using 64-bytes blocks and big-endian words).
+ */
+class ShaMessage {
+    public:
+        ShaMessage( const ShaMessage& ) = delete;
+
+        ShaMessage( ShaMessage&& ) = delete;
+
+        auto operator=( const ShaMessage& ) -> ShaMessage& = delete;
+
+        auto operator=( ShaMessage&& ) -> ShaMessage& = delete;
+
+        void update( const byte_t* data, std::size_t size ) noexcept;
+
+    protected:
+        ShaMessage() noexcept;
+
+        ~ShaMessage() = default;
+
+        // Pads the message, processing the last block(s).
+        void pad() noexcept;
+
+        virtual void processBlock( const byte_t* block ) noexcept = 0;
+
+    private:
+        std::array< byte_t, kShaBlockSize > mBlock;
+        std::size_t mBlockSize;
+        uint64_t mMessageSize;
+};
+
+/**
+ * Computes the SHA-1 hash of a message.
+ */
+class Sha1 final : public ShaMessage {
+    public:
+        Sha1() noexcept;
+
+        auto finish() noexcept -> std::array< byte_t, 20 >;
+
+    private:
+        std::array< uint32_t, 5 > mState;
+
+        void processBlock( const byte_t* block ) noexcept override;
+};
+
+/**
+ * Computes the SHA-256 hash of a message.
+ */
+class Sha256 final : public ShaMessage {
+    public:
+        Sha256() noexcept;
+
+        auto finish() noexcept -> std::array< byte_t, 32 >;
+
+    private:
+        std::array< uint32_t, 8 > mState;
+
+        void processBlock( const byte_t* block ) noexcept override;
+};
+
+}  // namespace bit7z
+
+#endif //SHA_HPP
@@ -0,0 +1,107 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <tuple>
+
+#include "internal/fsutil.hpp"
+#include "internal/genericinputitem.hpp"
+#include "internal/solidplanner.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+constexpr uint64_t kMebibyte = 1024 * 1024;
+
+auto default_solid_block_size( BitCompressionLevel level ) noexcept -> uint64_t {
+    // Default solid block size limits documented by 7-Zip (-ms switch).
+    switch ( level ) {
+        case BitCompressionLevel::None:
+            return 0;
+        case BitCompressionLevel::Fastest:
+            return 16 * kMebibyte;
+        case BitCompressionLevel::Fast:
+            return 128 * kMebibyte;
+        case BitCompressionLevel::Normal:
+            return 2048 * kMebibyte;
+        case BitCompressionLevel::Max:
+        case BitCompressionLevel::Ultra:
+        default:
+            return 4096 * kMebibyte;
+    }
+}
+
+auto plan_solid_blocks( const BitAbstractArchiveCreator& creator,
+                        const BitItemsVector& items ) -> std::vector< SolidItemPlan > {
+    const SolidOptions& options = creator.solidOptions();
+    const bool isSolid = creator.solidMode() &&
+                         creator.compressionFormat().hasFeature( FormatFeatures::SolidArchive ) &&
+                         creator.compressionLevel() != BitCompressionLevel::None &&
+                         creator.compressionMethod() != BitCompressionMethod::Copy;
+
+    // Note: 7-Zip sorts by type the items of solid archives grouped by extension, or being deduplicated.
+    const bool sortByType = isSolid && ( options.groupByExtension || creator.deduplicateContent() );
+
+    /* Sorting key of each item with some data: extension and file name (only when sorting by type),
+     * path, and index. */
+    using SortKey = std::tuple< tstring, tstring, tstring, std::size_t >;
+    std::vector< SortKey > keys;
+    keys.reserve( items.size() );
+    for ( std::size_t index = 0; index < items.size(); ++index ) {
+        const GenericInputItem& item = items[ index ];
+        if ( item.isDir() || item.size() == 0 ) {
+            continue;
+        }
+        const fs::path itemPath = item.inArchivePath();
+        tstring extension = sortByType ? filesystem::fsutil::extension( itemPath ) : tstring{};
+        tstring fileName = sortByType ? path_to_tstring( itemPath.filename() ) : tstring{};
+        keys.emplace_back( std::move( extension ), std::move( fileName ), path_to_tstring( itemPath ), index );
+    }
+    if ( isSolid ) {
+        // Note: 7-Zip sorts the items of solid archives by path (first by extension and name, if sorting by type).
+        std::sort( keys.begin(), keys.end() );
+    }
+
+    const uint64_t maxBlockSize = options.maxBlockSize > 0 ?
+                                  options.maxBlockSize : default_solid_block_size( creator.compressionLevel() );
+    const uint64_t maxBlockFiles = options.maxBlockFiles;
+
+    std::vector< SolidItemPlan > plan;
+    plan.reserve( keys.size() );
+    uint32_t block = 0;
+    uint64_t blockSize = 0;
+    uint64_t blockFiles = 0;
+    const tstring* blockExtension = nullptr;
+    for ( const auto& key : keys ) {
+        const uint64_t itemSize = items[ std::get< 3 >( key ) ].size();
+        if ( blockFiles > 0 ) {
+            /* Like 7-Zip, we start a new block when the current one is full, when the item would make it exceed
+             * the maximum size, or when the extension changes (if grouping by extension). */
+            const bool startNewBlock = !isSolid ||
+                                       ( maxBlockFiles > 0 && blockFiles >= maxBlockFiles ) ||
+                                       blockSize + itemSize > maxBlockSize ||
+                                       ( options.groupByExtension && std::get< 0 >( key ) != *blockExtension );
+            if ( startNewBlock ) {
+                ++block;
+                blockSize = 0;
+                blockFiles = 0;
+            }
+        }
+        blockSize += itemSize;
+        ++blockFiles;
+        blockExtension = &std::get< 0 >( key );
+        plan.push_back( { std::get< 2 >( key ), itemSize, block, blockSize } );
+    }
+    return plan;
+}
+
+}  // namespace bit7z
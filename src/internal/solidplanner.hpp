@@ -0,0 +1,39 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef SOLIDPLANNER_HPP
+#define SOLIDPLANNER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "bitabstractarchivecreator.hpp"
+#include "bititemsvector.hpp"
+
+namespace bit7z {
+
+/**
+ * Computes the default maximum size of the solid blocks used by 7-Zip for the given compression level.
+ */
+auto default_solid_block_size( BitCompressionLevel level ) noexcept -> uint64_t;
+
+/**
+ * Plans how the given items would be grouped into solid blocks by 7-Zip using the settings of the given creator.
+ *
+ * @param creator the creator whose settings must be used.
+ * @param items   the items to be planned.
+ *
+ * @return the planned items (excluding directories and empty files), in the order they would be stored.
+ */
+auto plan_solid_blocks( const BitAbstractArchiveCreator& creator,
+                        const BitItemsVector& items ) -> std::vector< SolidItemPlan >;
+
+}  // namespace bit7z
+
+#endif //SOLIDPLANNER_HPP
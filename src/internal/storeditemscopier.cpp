@@ -0,0 +1,204 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "bitexception.hpp"
+#include "internal/crc32.hpp"
+#include "internal/operationresult.hpp"
+#include "internal/storeditemscopier.hpp"
+#include "internal/stringutil.hpp"
+
+namespace bit7z {
+
+constexpr int kInvalidFile = -1;
+
+#ifndef _WIN32
+constexpr uint64_t kCopyChunkSize = 8 * 1024 * 1024; // 8 MiB
+
+namespace {
+auto write_all( int file, const byte_t* data, std::size_t size ) -> bool {
+    while ( size > 0 ) {
+        const ssize_t written = ::write( file, data, size );
+        if ( written < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( written <= 0 ) {
+            return false;
+        }
+        data += written; //-V2563
+        size -= static_cast< std::size_t >( written );
+    }
+    return true;
+}
+
+auto read_all_at( int file, byte_t* data, std::size_t size, off_t offset ) -> bool {
+    while ( size > 0 ) {
+        const ssize_t readSize = ::pread( file, data, size, offset );
+        if ( readSize < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( readSize <= 0 ) {
+            return false;
+        }
+        data += readSize; //-V2563
+        size -= static_cast< std::size_t >( readSize );
+        offset += readSize;
+    }
+    return true;
+}
+
+#ifdef __linux__
+// Whether copy_file_range failed because the kernel or the filesystems don't support copying between the two files.
+auto is_copy_unsupported( int error ) noexcept -> bool {
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == EPERM;
+}
+#endif
+} // namespace
+#endif
+
+StoredItemsCopier::StoredItemsCopier( const BitInputArchive& inputArchive, StoredCopyMode mode )
+    : mInputArchive{ inputArchive },
+      mVerifyCrc{ mode == StoredCopyMode::Verify && inputArchive.detectedFormat() == BitFormat::Zip },
+      mArchiveFile{ kInvalidFile } {
+#ifndef _WIN32
+    if ( mode == StoredCopyMode::Disabled || !read_raw_entries( inputArchive, mEntries ) ) {
+        mEntries.clear();
+        return;
+    }
+    mArchiveFile = ::open( tstring_to_path( inputArchive.archivePath() ).c_str(), O_RDONLY | O_CLOEXEC );
+    if ( mArchiveFile == kInvalidFile ) {
+        mEntries.clear();
+    }
+#else
+    (void)mode;
+#endif
+}
+
+StoredItemsCopier::~StoredItemsCopier() {
+#ifndef _WIN32
+    if ( mArchiveFile != kInvalidFile ) {
+        ::close( mArchiveFile );
+    }
+#endif
+}
+
+auto StoredItemsCopier::canCopy( uint32_t index ) const -> bool {
+    if ( index >= mEntries.size() || !mEntries[ index ].isStored ) {
+        return false;
+    }
+    // Note: the entries are expected to be in the same order of the items; otherwise, we let 7-Zip extract the item.
+    const auto& entry = mEntries[ index ];
+    const BitPropVariant itemSize = mInputArchive.itemProperty( index, BitProperty::Size );
+    const BitPropVariant itemPath = mInputArchive.itemProperty( index, BitProperty::Path );
+    return !itemSize.isEmpty() && itemSize.getUInt64() == entry.dataSize && itemPath.isString() &&
+           entry.path == fs::path( itemPath.getNativeString() ).generic_u8string();
+}
+
+void StoredItemsCopier::copy( uint32_t index, const fs::path& outPath ) const {
+#ifndef _WIN32
+    const int outFile = ::open( outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666 ); // NOLINT
+    if ( outFile == kInvalidFile ) {
+        throw BitException( "Failed to open the output file", last_error_code(), path_to_tstring( outPath ) );
+    }
+    uint32_t crc = 0;
+    const bool isCopied = copyData( mEntries[ index ], outFile, crc );
+    const std::error_code copyError = isCopied ? std::error_code{} : last_error_code();
+    const bool isClosed = ::close( outFile ) == 0;
+    if ( isCopied && isClosed && ( !mVerifyCrc || crc == mEntries[ index ].crc ) ) {
+        return;
+    }
+
+    std::error_code error;
+    fs::remove( outPath, error );
+    if ( !isCopied || !isClosed ) {
+        throw BitException( "Failed to extract the archive",
+                            isCopied ? std::make_error_code( std::errc::io_error ) : copyError,
+                            path_to_tstring( outPath ) );
+    }
+    throw BitException( "Failed to extract the archive",
+                        make_error_code( OperationResult::CRCError ),
+                        path_to_tstring( outPath ) );
+#else
+    (void)index;
+    throw BitException( "Cannot copy the item", std::make_error_code( std::errc::not_supported ),
+                        path_to_tstring( outPath ) );
+#endif
+}
+
+auto StoredItemsCopier::copyData( const RawArchiveEntry& entry, int outFile, uint32_t& crc ) const -> bool {
+#ifndef _WIN32
+    auto inOffset = static_cast< off_t >( entry.dataOffset );
+    uint64_t remaining = entry.dataSize;
+    buffer_t buffer;
+#ifdef __linux__
+    bool useKernelCopy = true;
+#else
+    constexpr bool useKernelCopy = false;
+#endif
+    while ( remaining > 0 ) {
+        const auto chunkSize = static_cast< std::size_t >( ( std::min )( remaining, kCopyChunkSize ) );
+        const off_t chunkOffset = inOffset;
+        std::size_t copiedSize = 0;
+#ifdef __linux__
+        if ( useKernelCopy ) {
+            const ssize_t result = ::copy_file_range( mArchiveFile, &inOffset, outFile, nullptr, chunkSize, 0 );
+            if ( result < 0 && errno == EINTR ) {
+                continue;
+            }
+            if ( result < 0 && is_copy_unsupported( errno ) ) {
+                useKernelCopy = false; // Falling back to copying the data through user space.
+                continue;
+            }
+            if ( result <= 0 ) {
+                return false;
+            }
+            copiedSize = static_cast< std::size_t >( result );
+        }
+#endif
+        if ( !useKernelCopy || mVerifyCrc ) {
+            // Reading the data to be copied or, if already copied by the kernel, to be verified (from the page cache).
+            const std::size_t readSize = useKernelCopy ? copiedSize : chunkSize;
+            buffer.resize( ( std::max )( buffer.size(), readSize ) );
+            if ( !read_all_at( mArchiveFile, buffer.data(), readSize, chunkOffset ) ) {
+                return false;
+            }
+            if ( !useKernelCopy ) {
+                if ( !write_all( outFile, buffer.data(), readSize ) ) {
+                    return false;
+                }
+                inOffset += static_cast< off_t >( readSize );
+                copiedSize = readSize;
+            }
+            if ( mVerifyCrc ) {
+                crc = crc32_update( crc, buffer.data(), copiedSize );
+            }
+        }
+        remaining -= copiedSize;
+    }
+    return true;
+#else
+    (void)entry;
+    (void)outFile;
+    (void)crc;
+    return false;
+#endif
+}
+
+}  // namespace bit7z
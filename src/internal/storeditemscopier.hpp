@@ -0,0 +1,73 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef STOREDITEMSCOPIER_HPP
+#define STOREDITEMSCOPIER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "bitinputarchive.hpp"
+#include "internal/fs.hpp"
+#include "internal/inplaceappend.hpp"
+
+namespace bit7z {
+
+/**
+ * Extracts the items of a zip or tar archive file that are stored without compression (i.e., all the regular files
+ * of a tar archive, and the zip entries using the Copy method) by copying their data directly from the archive file
+ * to the output files, rather than passing it through 7-Zip's copy decoder and the output streams.
+ *
+ * On Linux, the data is copied by the kernel via copy_file_range (which might also share the extents
+ * of the archive file, e.g., on Btrfs and XFS); on other POSIX systems, or when the filesystems don't support it,
+ * the data is copied with a simple read/write loop. On Windows, no item is copied directly.
+ */
+class StoredItemsCopier final {
+    public:
+        /**
+         * Reads the layout of the given archive's file; if the archive is not a zip or tar file,
+         * or its layout doesn't match the items read by 7-Zip, no item can be copied directly.
+         */
+        StoredItemsCopier( const BitInputArchive& inputArchive, StoredCopyMode mode );
+
+        StoredItemsCopier( const StoredItemsCopier& ) = delete;
+
+        StoredItemsCopier( StoredItemsCopier&& ) = delete;
+
+        auto operator=( const StoredItemsCopier& ) -> StoredItemsCopier& = delete;
+
+        auto operator=( StoredItemsCopier&& ) -> StoredItemsCopier& = delete;
+
+        ~StoredItemsCopier();
+
+        /**
+         * @return whether the data of the item at the given index can be copied directly from the archive file.
+         */
+        BIT7Z_NODISCARD auto canCopy( uint32_t index ) const -> bool;
+
+        /**
+         * Copies the data of the item at the given index into a new file at the given path,
+         * verifying its CRC (if any) when required by the StoredCopyMode.
+         *
+         * @note In case of errors, a BitException is thrown, and the output file is removed.
+         */
+        void copy( uint32_t index, const fs::path& outPath ) const;
+
+    private:
+        const BitInputArchive& mInputArchive;
+        std::vector< RawArchiveEntry > mEntries; // Empty if no item can be copied directly.
+        bool mVerifyCrc;
+        int mArchiveFile;
+
+        auto copyData( const RawArchiveEntry& entry, int outFile, uint32_t& crc ) const -> bool;
+};
+
+}  // namespace bit7z
+
+#endif //STOREDITEMSCOPIER_HPP
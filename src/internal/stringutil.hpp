@@ -10,6 +10,13 @@
 #ifndef STRINGUTIL_HPP
 #define STRINGUTIL_HPP
 
+#include <algorithm>
+#if defined( BIT7Z_USE_NATIVE_STRING ) && defined( _WIN32 )
+#include <cwctype> // for std::towlower
+#else
+#include <cctype> // for std::tolower
+#endif
+
 #include "bittypes.hpp"
 #include "internal/fsutil.hpp"
 
@@ -78,6 +85,24 @@ inline auto starts_with( const native_string& str, const native_string& prefix )
     return str.rfind( prefix, 0 ) == 0;
 }
 
+/**
+ * @param str the string to be converted.
+ *
+ * @return a copy of the given string, with all the (ASCII) characters converted to lowercase.
+ */
+inline auto to_lower( tstring str ) -> tstring {
+#if defined( BIT7Z_USE_NATIVE_STRING ) && defined( _WIN32 )
+    std::transform( str.cbegin(), str.cend(), str.begin(), []( wchar_t character ) -> wchar_t {
+        return static_cast< wchar_t >( std::towlower( character ) );
+    } );
+#else
+    std::transform( str.cbegin(), str.cend(), str.begin(), []( unsigned char character ) -> char {
+        return static_cast< char >( std::tolower( character ) );
+    } );
+#endif
+    return str;
+}
+
 /**
  * Checks if the given character is a valid path separator on the target platform.
  *
@@ -0,0 +1,51 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <random>
+
+#include "bitexception.hpp"
+#include "internal/stringutil.hpp"
+#include "internal/tempdirectory.hpp"
+
+namespace bit7z {
+
+TempDirectory::TempDirectory( const fs::path& basePath, const std::string& suffix ) {
+    constexpr int kMaxAttempts = 16;
+    std::random_device randomDevice;
+    std::uniform_int_distribution< uint32_t > distribution;
+    for ( int attempt = 0; attempt < kMaxAttempts; ++attempt ) {
+        fs::path directory = basePath;
+        directory += suffix + "-" + std::to_string( distribution( randomDevice ) );
+
+        std::error_code error;
+        if ( fs::create_directory( directory, error ) ) {
+            mPath = std::move( directory );
+            return;
+        }
+        if ( error && error != std::errc::file_exists ) {
+            throw BitException( "Failed to create the temporary directory", error, path_to_tstring( directory ) );
+        }
+    }
+    throw BitException( "Failed to create the temporary directory",
+                        std::make_error_code( std::errc::file_exists ), path_to_tstring( basePath ) );
+}
+
+TempDirectory::~TempDirectory() {
+    std::error_code error;
+    fs::remove_all( mPath, error );
+}
+
+auto TempDirectory::path() const noexcept -> const fs::path& {
+    return mPath;
+}
+
+}  // namespace bit7z
@@ -0,0 +1,51 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TEMPDIRECTORY_HPP
+#define TEMPDIRECTORY_HPP
+
+#include <string>
+
+#include "bitdefines.hpp"
+#include "internal/fs.hpp"
+
+namespace bit7z {
+
+/**
+ * A new directory with a unique name, removed together with its content when the object is destroyed.
+ */
+class TempDirectory final {
+    public:
+        /**
+         * Creates a directory whose path is the given base path, followed by the given suffix and a random number
+         * (e.g., "archive.7z.merge-12345").
+         *
+         * @note An already existing path is never used (nor deleted), as it might belong to the user.
+         */
+        TempDirectory( const fs::path& basePath, const std::string& suffix );
+
+        TempDirectory( const TempDirectory& ) = delete;
+
+        TempDirectory( TempDirectory&& ) = delete;
+
+        auto operator=( const TempDirectory& ) -> TempDirectory& = delete;
+
+        auto operator=( TempDirectory&& ) -> TempDirectory& = delete;
+
+        ~TempDirectory();
+
+        BIT7Z_NODISCARD auto path() const noexcept -> const fs::path&;
+
+    private:
+        fs::path mPath;
+};
+
+}  // namespace bit7z
+
+#endif //TEMPDIRECTORY_HPP
@@ -0,0 +1,387 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "internal/uringfilewriter.hpp"
+
+#include "bitexception.hpp"
+#include "internal/fsutil.hpp"
+#include "internal/stringutil.hpp"
+
+#if defined( __linux__ ) && defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+#include <linux/io_uring.h>
+#ifdef IORING_RSRC_REGISTER_SPARSE // i.e., the kernel headers support direct descriptors (Linux 5.19+).
+#define BIT7Z_USE_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef BIT7Z_USE_IO_URING
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace bit7z {
+
+#ifdef BIT7Z_USE_IO_URING
+
+namespace {
+constexpr uint32_t kRingEntries = 256; // Enough for the linked operations of all the slots (3 entries per file).
+
+enum struct Operation : uint64_t {
+    Open = 0,
+    Write = 1,
+    Close = 2
+};
+
+constexpr auto make_user_data( uint32_t slot, Operation operation ) noexcept -> uint64_t {
+    return ( static_cast< uint64_t >( slot ) << 2u ) | static_cast< uint64_t >( operation );
+}
+
+auto ring_offset( void* memory, uint32_t offset ) noexcept -> uint32_t* {
+    return reinterpret_cast< uint32_t* >( static_cast< byte_t* >( memory ) + offset ); // NOLINT
+}
+} // namespace
+
+struct UringFileWriter::Ring {
+    int fd = -1;
+    void* memory = MAP_FAILED; // Both the submission and completion queues (IORING_FEAT_SINGLE_MMAP).
+    std::size_t memorySize = 0;
+    io_uring_sqe* entries = static_cast< io_uring_sqe* >( MAP_FAILED );
+    std::size_t entriesSize = 0;
+
+    uint32_t* sqHead = nullptr;
+    uint32_t* sqTail = nullptr;
+    uint32_t sqMask = 0;
+    uint32_t sqEntries = 0;
+    uint32_t* sqArray = nullptr;
+
+    uint32_t* cqHead = nullptr;
+    uint32_t* cqTail = nullptr;
+    uint32_t cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+UringFileWriter::UringFileWriter()
+    : mSlots( kSlotsCount ),
+      mHasRegisteredBuffers{ false },
+      mPendingEntries{ 0 },
+      mInFlightFiles{ 0 },
+      mFirstError{ 0 } {
+    setupRing();
+}
+
+UringFileWriter::~UringFileWriter() {
+    waitAll();
+    closeRing();
+}
+
+auto UringFileWriter::isAvailable() const noexcept -> bool {
+    return mRing != nullptr;
+}
+
+void UringFileWriter::setupRing() {
+    auto ring = std::make_unique< Ring >();
+    io_uring_params params{};
+    ring->fd = static_cast< int >( syscall( __NR_io_uring_setup, kRingEntries, &params ) );
+    if ( ring->fd < 0 ) {
+        return; // E.g., io_uring is not supported or disabled (kernel.io_uring_disabled).
+    }
+    mRing = std::move( ring );
+    if ( ( params.features & IORING_FEAT_SINGLE_MMAP ) == 0 || ( params.features & IORING_FEAT_NODROP ) == 0 ) {
+        closeRing();
+        return;
+    }
+
+    auto& rng = *mRing;
+    rng.memorySize = ( std::max )( params.sq_off.array + ( params.sq_entries * sizeof( uint32_t ) ),
+                                   params.cq_off.cqes + ( params.cq_entries * sizeof( io_uring_cqe ) ) );
+    rng.memory = mmap( nullptr, rng.memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       rng.fd, IORING_OFF_SQ_RING );
+    rng.entriesSize = params.sq_entries * sizeof( io_uring_sqe );
+    rng.entries = static_cast< io_uring_sqe* >( mmap( nullptr, rng.entriesSize, PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE, rng.fd, IORING_OFF_SQES ) );
+    if ( rng.memory == MAP_FAILED || rng.entries == MAP_FAILED ) {
+        closeRing();
+        return;
+    }
+    rng.sqHead = ring_offset( rng.memory, params.sq_off.head );
+    rng.sqTail = ring_offset( rng.memory, params.sq_off.tail );
+    rng.sqMask = *ring_offset( rng.memory, params.sq_off.ring_mask );
+    rng.sqEntries = params.sq_entries;
+    rng.sqArray = ring_offset( rng.memory, params.sq_off.array );
+    rng.cqHead = ring_offset( rng.memory, params.cq_off.head );
+    rng.cqTail = ring_offset( rng.memory, params.cq_off.tail );
+    rng.cqMask = *ring_offset( rng.memory, params.cq_off.ring_mask );
+    rng.cqes = reinterpret_cast< io_uring_cqe* >( ring_offset( rng.memory, params.cq_off.cqes ) ); // NOLINT
+
+    // Each slot uses the direct descriptor with the same index, so the files are never added to the process fd table.
+    io_uring_rsrc_register files{};
+    files.nr = kSlotsCount;
+    files.flags = IORING_RSRC_REGISTER_SPARSE;
+    if ( syscall( __NR_io_uring_register, rng.fd, IORING_REGISTER_FILES2, &files, sizeof( files ) ) < 0 ) {
+        closeRing();
+        return;
+    }
+
+    std::vector< iovec > buffers;
+    buffers.reserve( kSlotsCount );
+    for ( auto& slot : mSlots ) {
+        slot.buffer.reserve( kMaxFileSize );
+        buffers.push_back( iovec{ slot.buffer.data(), kMaxFileSize } );
+    }
+    /* Note: registering the buffers might fail because of the RLIMIT_MEMLOCK limit on older kernels;
+     *       in this case, the writer still works, using normal (non-fixed) writes. */
+    mHasRegisteredBuffers = syscall( __NR_io_uring_register, rng.fd, IORING_REGISTER_BUFFERS,
+                                     buffers.data(), kSlotsCount ) == 0;
+}
+
+void UringFileWriter::closeRing() noexcept {
+    if ( !mRing ) {
+        return;
+    }
+    auto& rng = *mRing;
+    if ( rng.entries != MAP_FAILED ) {
+        munmap( rng.entries, rng.entriesSize );
+    }
+    if ( rng.memory != MAP_FAILED ) {
+        munmap( rng.memory, rng.memorySize );
+    }
+    close( rng.fd );
+    mRing.reset();
+}
+
+auto UringFileWriter::acquireSlot() -> uint32_t {
+    while ( true ) {
+        for ( uint32_t slot = 0; slot < kSlotsCount; ++slot ) {
+            if ( !mSlots[ slot ].isBusy ) {
+                mSlots[ slot ].isBusy = true;
+                mSlots[ slot ].error = 0;
+                mSlots[ slot ].buffer.clear();
+                return slot;
+            }
+        }
+        waitCompletions();
+    }
+}
+
+auto UringFileWriter::slotBuffer( uint32_t slot ) -> buffer_t& {
+    return mSlots[ slot ].buffer;
+}
+
+void UringFileWriter::releaseSlot( uint32_t slot ) noexcept {
+    mSlots[ slot ].isBusy = false;
+}
+
+auto UringFileWriter::nextEntry( uint32_t offset ) noexcept -> void* {
+    auto& rng = *mRing;
+    const uint32_t index = ( *rng.sqTail + offset ) & rng.sqMask;
+    io_uring_sqe* entry = &rng.entries[ index ]; // NOLINT(*-pro-bounds-pointer-arithmetic)
+    std::memset( entry, 0, sizeof( io_uring_sqe ) );
+    rng.sqArray[ index ] = index; // NOLINT(*-pro-bounds-pointer-arithmetic)
+    return entry;
+}
+
+void UringFileWriter::commitEntries( uint32_t count ) noexcept {
+    // The entries must be fully written before the kernel can see the new tail.
+    __atomic_store_n( mRing->sqTail, *mRing->sqTail + count, __ATOMIC_RELEASE );
+    mPendingEntries += count;
+}
+
+void UringFileWriter::writeFile( uint32_t slot, const fs::path& filePath, uint32_t mode,
+                                 const FILETIME* modifiedTime ) {
+    auto& fileSlot = mSlots[ slot ];
+    fileSlot.filePath = filePath;
+    mInFlightPaths[ fileSlot.filePath.native() ] = slot; // Note: done before queuing the file, as it might throw.
+    fileSlot.hasModifiedTime = modifiedTime != nullptr;
+    fileSlot.modifiedTime = modifiedTime != nullptr ? *modifiedTime : FILETIME{};
+    fileSlot.writeSize = static_cast< uint32_t >( fileSlot.buffer.size() );
+
+    /* Note: since each slot has at most one file in flight, and kSlotsCount * 3 <= kRingEntries,
+     *       the submission queue always has room for the entries of a new file. */
+    auto* openEntry = static_cast< io_uring_sqe* >( nextEntry( 0 ) );
+    openEntry->opcode = IORING_OP_OPENAT;
+    openEntry->fd = AT_FDCWD;
+    openEntry->addr = reinterpret_cast< uint64_t >( fileSlot.filePath.c_str() ); // NOLINT
+    openEntry->len = mode;
+    openEntry->open_flags = O_WRONLY | O_CREAT | O_TRUNC; // Note: O_CLOEXEC is not allowed for direct descriptors.
+    openEntry->file_index = slot + 1;
+    openEntry->flags = IOSQE_IO_LINK;
+    openEntry->user_data = make_user_data( slot, Operation::Open );
+
+    auto* writeEntry = static_cast< io_uring_sqe* >( nextEntry( 1 ) );
+    const bool isFixedBuffer = mHasRegisteredBuffers && fileSlot.buffer.capacity() == kMaxFileSize;
+    writeEntry->opcode = isFixedBuffer ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    writeEntry->fd = static_cast< int >( slot );
+    writeEntry->addr = reinterpret_cast< uint64_t >( fileSlot.buffer.data() ); // NOLINT
+    writeEntry->len = fileSlot.writeSize;
+    writeEntry->off = 0;
+    writeEntry->buf_index = isFixedBuffer ? static_cast< uint16_t >( slot ) : 0;
+    writeEntry->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK; // The file must be closed even if the write fails.
+    writeEntry->user_data = make_user_data( slot, Operation::Write );
+
+    auto* closeEntry = static_cast< io_uring_sqe* >( nextEntry( 2 ) );
+    closeEntry->opcode = IORING_OP_CLOSE;
+    closeEntry->file_index = slot + 1;
+    closeEntry->user_data = make_user_data( slot, Operation::Close );
+
+    commitEntries( 3 );
+    ++mInFlightFiles;
+    if ( mPendingEntries >= kRingEntries / 2 ) {
+        submit( 0 ); // Note: a submission failure is reported when waiting for the files (e.g., by flush).
+    }
+}
+
+auto UringFileWriter::submit( uint32_t minCompletions ) noexcept -> bool {
+    do {
+        const auto result = syscall( __NR_io_uring_enter, mRing->fd, mPendingEntries, minCompletions,
+                                     minCompletions > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0 );
+        if ( result < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            return false;
+        }
+        mPendingEntries -= static_cast< uint32_t >( result );
+        minCompletions = 0; // The completions we were waiting for (if any) are now available.
+    } while ( mPendingEntries > 0 );
+    return true;
+}
+
+void UringFileWriter::reapCompletions() {
+    auto& rng = *mRing;
+    uint32_t head = *rng.cqHead;
+    const uint32_t tail = __atomic_load_n( rng.cqTail, __ATOMIC_ACQUIRE );
+    for ( ; head != tail; ++head ) {
+        const io_uring_cqe& completion = rng.cqes[ head & rng.cqMask ]; // NOLINT(*-pro-bounds-pointer-arithmetic)
+        const auto slot = static_cast< uint32_t >( completion.user_data >> 2u );
+        const auto operation = static_cast< Operation >( completion.user_data & 3u );
+        auto& fileSlot = mSlots[ slot ];
+        // Note: the operations following a failed one in a chain are cancelled, so we keep the first error.
+        if ( completion.res < 0 && completion.res != -ECANCELED && fileSlot.error == 0 ) {
+            fileSlot.error = -completion.res;
+        } else if ( operation == Operation::Write && completion.res >= 0 &&
+                    static_cast< uint32_t >( completion.res ) != fileSlot.writeSize && fileSlot.error == 0 ) {
+            fileSlot.error = EIO; // Short write (e.g., the disk is full).
+        }
+        if ( operation == Operation::Close ) { // The last operation of the chain.
+            finishSlot( slot );
+        }
+    }
+    __atomic_store_n( rng.cqHead, head, __ATOMIC_RELEASE );
+}
+
+void UringFileWriter::finishSlot( uint32_t slot ) {
+    auto& fileSlot = mSlots[ slot ];
+    if ( fileSlot.error == 0 ) {
+        if ( fileSlot.hasModifiedTime ) { // Note: as for the other extracted files, a failure here is not an error.
+            filesystem::fsutil::set_file_modified_time( fileSlot.filePath, fileSlot.modifiedTime );
+        }
+    } else {
+        if ( mFirstError == 0 ) {
+            mFirstError = fileSlot.error;
+            mFirstErrorPath = fileSlot.filePath;
+        }
+        std::error_code error;
+        fs::remove( fileSlot.filePath, error ); // Removing the partially written file (if any).
+    }
+    const auto inFlightPath = mInFlightPaths.find( fileSlot.filePath.native() );
+    if ( inFlightPath != mInFlightPaths.end() && inFlightPath->second == slot ) {
+        mInFlightPaths.erase( inFlightPath );
+    }
+    fileSlot.isBusy = false;
+    --mInFlightFiles;
+}
+
+void UringFileWriter::waitCompletions() {
+    if ( !submit( 1 ) ) {
+        throw BitException( "Failed to wait for the output files", last_error_code() );
+    }
+    reapCompletions();
+}
+
+void UringFileWriter::waitFile( const fs::path& filePath ) {
+    if ( mInFlightFiles == 0 ) {
+        return;
+    }
+    // Note: the file's entries might have not been submitted yet, and waitCompletions() submits them.
+    while ( mInFlightPaths.find( filePath.native() ) != mInFlightPaths.cend() ) {
+        waitCompletions();
+    }
+}
+
+void UringFileWriter::flush() {
+    while ( mInFlightFiles > 0 ) {
+        waitCompletions();
+    }
+    if ( mFirstError != 0 ) {
+        const std::error_code error{ mFirstError, std::generic_category() };
+        const auto filePath = path_to_tstring( mFirstErrorPath );
+        mFirstError = 0;
+        mFirstErrorPath.clear();
+        throw BitException( "Failed to write the output file", error, filePath );
+    }
+}
+
+void UringFileWriter::waitAll() noexcept {
+    try {
+        while ( mRing && mInFlightFiles > 0 ) {
+            waitCompletions();
+        }
+    } catch ( ... ) { // NOLINT(bugprone-empty-catch)
+        // Closing the ring will cancel the remaining operations.
+    }
+}
+
+#else
+
+struct UringFileWriter::Ring {};
+
+UringFileWriter::UringFileWriter()
+    : mHasRegisteredBuffers{ false }, mPendingEntries{ 0 }, mInFlightFiles{ 0 }, mFirstError{ 0 } {}
+
+UringFileWriter::~UringFileWriter() = default;
+
+auto UringFileWriter::isAvailable() const noexcept -> bool {
+    return false;
+}
+
+auto UringFileWriter::acquireSlot() -> uint32_t {
+    throw BitException( "Cannot write the output file", std::make_error_code( std::errc::function_not_supported ) );
+}
+
+auto UringFileWriter::slotBuffer( uint32_t slot ) -> buffer_t& {
+    return mSlots[ slot ].buffer;
+}
+
+void UringFileWriter::releaseSlot( uint32_t /*slot*/ ) noexcept {}
+
+void UringFileWriter::writeFile( uint32_t /*slot*/, const fs::path& filePath, uint32_t /*mode*/,
+                                 const FILETIME* /*modifiedTime*/ ) {
+    throw BitException( "Cannot write the output file",
+                        std::make_error_code( std::errc::function_not_supported ),
+                        path_to_tstring( filePath ) );
+}
+
+void UringFileWriter::waitFile( const fs::path& /*filePath*/ ) {}
+
+void UringFileWriter::flush() {}
+
+#endif
+
+}  // namespace bit7z
@@ -0,0 +1,137 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef URINGFILEWRITER_HPP
+#define URINGFILEWRITER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "bittypes.hpp"
+#include "bitwindows.hpp"
+#include "internal/fs.hpp"
+
+namespace bit7z {
+
+/**
+ * Writes small files asynchronously through a Linux io_uring instance, so that the cost of the system calls
+ * needed for creating each file (open, write, and close) is shared by a whole batch of files.
+ *
+ * The content of each file is first written to the buffer of a free slot (the buffers are registered to the ring);
+ * then, the file is queued as a chain of linked operations (openat to a direct descriptor, a fixed-buffer write,
+ * and close), and the chains are submitted in batches. Once a file is closed, its modification time is set,
+ * while its permissions are set on creation.
+ *
+ * On other systems, or when the kernel doesn't support the needed io_uring features, the writer is not available.
+ */
+class UringFileWriter final {
+    public:
+        static constexpr uint32_t kSlotsCount = 64;
+        static constexpr std::size_t kMaxFileSize = 128 * 1024; // 128 KiB
+
+        UringFileWriter();
+
+        UringFileWriter( const UringFileWriter& ) = delete;
+
+        UringFileWriter( UringFileWriter&& ) = delete;
+
+        auto operator=( const UringFileWriter& ) -> UringFileWriter& = delete;
+
+        auto operator=( UringFileWriter&& ) -> UringFileWriter& = delete;
+
+        // Waits for the completion of the queued files (without reporting their errors).
+        ~UringFileWriter();
+
+        BIT7Z_NODISCARD auto isAvailable() const noexcept -> bool;
+
+        /**
+         * Gets a free slot (waiting for some queued files to be written, if needed), whose buffer is emptied
+         * to receive the content of a new file.
+         */
+        auto acquireSlot() -> uint32_t;
+
+        BIT7Z_NODISCARD auto slotBuffer( uint32_t slot ) -> buffer_t&;
+
+        // Frees the given slot without writing its content (e.g., when the extraction of the item failed).
+        void releaseSlot( uint32_t slot ) noexcept;
+
+        /**
+         * Queues the creation of a new file at the given path, with the content of the buffer of the given slot.
+         *
+         * @param slot          the slot containing the content of the file.
+         * @param filePath      the path of the file to be created.
+         * @param mode          the permissions of the new file (subject to the process umask).
+         * @param modifiedTime  the modification time to be set on the file (if any).
+         *
+         * @note The errors are not reported by this function, but when waiting for the queued files.
+         *       If another queued file has the same path, waitFile() must be called before queuing the new one.
+         */
+        void writeFile( uint32_t slot, const fs::path& filePath, uint32_t mode, const FILETIME* modifiedTime );
+
+        /**
+         * Waits for the queued file at the given path (if any) to be written, so that the path can be safely checked
+         * or reused for another file (e.g., by a later item with the same path).
+         *
+         * @note As for the other queued files, a failure is reported only by the next flush().
+         */
+        void waitFile( const fs::path& filePath );
+
+        /**
+         * Submits the queued files and waits for them to be written.
+         *
+         * @note If some file could not be written, a BitException is thrown (reporting the first failure).
+         */
+        void flush();
+
+    private:
+        struct Slot {
+            buffer_t buffer;
+            fs::path filePath;
+            bool hasModifiedTime;
+            FILETIME modifiedTime;
+            uint32_t writeSize;
+            bool isBusy;
+            int error;
+        };
+
+        struct Ring; // The io_uring instance and its memory-mapped queues.
+
+        std::unique_ptr< Ring > mRing;
+        std::vector< Slot > mSlots;
+        bool mHasRegisteredBuffers;
+        uint32_t mPendingEntries; // The entries prepared but not yet submitted to the kernel.
+        uint32_t mInFlightFiles;
+        std::unordered_map< fs::path::string_type, uint32_t > mInFlightPaths; // The slots of the queued files.
+        int mFirstError;
+        fs::path mFirstErrorPath;
+
+        void setupRing();
+
+        void closeRing() noexcept;
+
+        auto nextEntry( uint32_t offset ) noexcept -> void*;
+
+        void commitEntries( uint32_t count ) noexcept;
+
+        auto submit( uint32_t minCompletions ) noexcept -> bool;
+
+        void reapCompletions();
+
+        void finishSlot( uint32_t slot );
+
+        void waitCompletions();
+
+        void waitAll() noexcept;
+};
+
+}  // namespace bit7z
+
+#endif //URINGFILEWRITER_HPP
@@ -0,0 +1,45 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/archivechain.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace bit7z;
+
+TEST_CASE( "archivechain: Delta manifest round-trip", "[archivechain]" ) {
+    SECTION( "Empty manifest" ) {
+        REQUIRE( make_delta_manifest( {} ).empty() );
+        REQUIRE( parse_delta_manifest( {} ).empty() );
+    }
+
+    SECTION( "Manifest with some paths" ) {
+        const std::vector< tstring > paths = {
+            BIT7Z_STRING( "file.txt" ),
+            BIT7Z_STRING( "folder/nested file.txt" ),
+            BIT7Z_STRING( "folder/sub/other.bin" )
+        };
+        const buffer_t manifest = make_delta_manifest( paths );
+        REQUIRE_FALSE( manifest.empty() );
+        REQUIRE( parse_delta_manifest( manifest ) == paths );
+    }
+
+    SECTION( "Manifest without the trailing newline" ) {
+        const std::string text = "first.txt\nsecond.txt";
+        const buffer_t manifest( text.cbegin(), text.cend() );
+        const std::vector< tstring > expected = { BIT7Z_STRING( "first.txt" ), BIT7Z_STRING( "second.txt" ) };
+        REQUIRE( parse_delta_manifest( manifest ) == expected );
+    }
+}
@@ -12,6 +12,7 @@
 #include <catch2/catch.hpp>
 
 #include <bit7z/bit7zlibrary.hpp>
+#include <bit7z/bithasher.hpp>
 
 #if !defined(__GNUC__) || __GNUC__ >= 5
 #include <bit7z/bitexception.hpp>
@@ -57,5 +58,24 @@ TEST_CASE( "Bit7zLibrary: Set 7-zip to use the large page mode", "[bit7zlibrary]
     REQUIRE_NOTHROW( lib.setLargePageMode() );
 }
 
+TEST_CASE( "Bit7zLibrary: Computing digests with the library hashers", "[bit7zlibrary][bithasher]" ) {
+    const auto libPath = sevenzip_lib_path();
+
+    const Bit7zLibrary lib{ libPath };
+    REQUIRE( lib.isDigestSupported( DigestType::Crc32 ) );
+    REQUIRE( lib.isDigestSupported( DigestType::Crc64 ) );
+    REQUIRE( lib.isDigestSupported( DigestType::Sha1 ) );
+    REQUIRE( lib.isDigestSupported( DigestType::Sha256 ) );
+
+    const BitHasher hasher{ lib, { DigestType::Crc32, DigestType::Sha256 } };
+    const std::vector< byte_t > input{ '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    const auto digests = hasher.hashBuffer( input );
+    REQUIRE( digests.at( DigestType::Crc32 ) == Digest{ 0xCB, 0xF4, 0x39, 0x26 } );
+    REQUIRE( digests.at( DigestType::Sha256 ) == Digest{ 0x15, 0xE2, 0xB0, 0xD3, 0xC3, 0x38, 0x91, 0xEB,
+                                                         0xB0, 0xF1, 0xEF, 0x60, 0x9E, 0xC4, 0x19, 0x42,
+                                                         0x0C, 0x20, 0xE3, 0x20, 0xCE, 0x94, 0xC6, 0x5F,
+                                                         0xBC, 0x8C, 0x33, 0x12, 0x44, 0x8E, 0xB2, 0x25 } );
+}
+
 } // namespace test
 } // namespace bit7z
\ No newline at end of file
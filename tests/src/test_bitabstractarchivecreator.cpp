@@ -12,10 +12,12 @@
 #include <catch2/catch.hpp>
 
 #include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/biterror.hpp>
 #include <bit7z/bitfilecompressor.hpp>
 #include <bit7z/bitmemcompressor.hpp>
 #include <bit7z/bitstreamcompressor.hpp>
 
+#include "utils/filesystem.hpp"
 #include "utils/shared_lib.hpp"
 
 using namespace bit7z;
@@ -26,6 +28,10 @@ using bit7z::BitMemCompressor;
 using bit7z::BitStreamCompressor;
 using bit7z::BitInOutFormat;
 
+#ifdef BIT7Z_TESTS_FILESYSTEM
+using namespace bit7z::test::filesystem;
+#endif
+
 struct TestOutputFormat {
     const char* name;
     const BitInOutFormat& format; // NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
@@ -332,6 +338,147 @@ TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setDictionarySize(...) / di
     }
 }
 
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setItemsOrder(...) / itemsOrder()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE( compressor.itemsOrder() == ItemsOrder::Indexing );
+
+    compressor.setItemsOrder( ItemsOrder::FileIndex );
+    REQUIRE( compressor.itemsOrder() == ItemsOrder::FileIndex );
+
+    compressor.setItemsOrder( ItemsOrder::PhysicalOffset );
+    REQUIRE( compressor.itemsOrder() == ItemsOrder::PhysicalOffset );
+
+    compressor.setItemsOrder( ItemsOrder::Indexing );
+    REQUIRE( compressor.itemsOrder() == ItemsOrder::Indexing );
+}
+
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setCompressionPolicy(...) / compressionPolicy()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE( compressor.compressionPolicy() == CompressionPolicy::CompressAll );
+
+    compressor.setCompressionPolicy( CompressionPolicy::StoreIncompressible );
+    REQUIRE( compressor.compressionPolicy() == CompressionPolicy::StoreIncompressible );
+
+    compressor.setCompressionPolicy( CompressionPolicy::CompressAll );
+    REQUIRE( compressor.compressionPolicy() == CompressionPolicy::CompressAll );
+}
+
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setSolidOptions(...) / solidOptions()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE_FALSE( compressor.solidOptions().groupByExtension );
+    REQUIRE( compressor.solidOptions().maxBlockSize == 0u );
+    REQUIRE( compressor.solidOptions().maxBlockFiles == 0u );
+
+    SolidOptions options;
+    options.groupByExtension = true;
+    options.maxBlockSize = 64u * 1024u * 1024u;
+    options.maxBlockFiles = 100u;
+    compressor.setSolidOptions( options );
+    REQUIRE( compressor.solidOptions().groupByExtension );
+    REQUIRE( compressor.solidOptions().maxBlockSize == 64u * 1024u * 1024u );
+    REQUIRE( compressor.solidOptions().maxBlockFiles == 100u );
+
+    compressor.setSolidOptions( {} );
+    REQUIRE_FALSE( compressor.solidOptions().groupByExtension );
+    REQUIRE( compressor.solidOptions().maxBlockSize == 0u );
+    REQUIRE( compressor.solidOptions().maxBlockFiles == 0u );
+}
+
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setMemoryBudget(...) / memoryBudget()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE( compressor.memoryBudget() == 0u );
+    REQUIRE( compressor.memoryBudgetPolicy() == MemoryBudgetPolicy::Fail );
+
+    compressor.setMemoryBudget( 256u * 1024u * 1024u );
+    REQUIRE( compressor.memoryBudget() == 256u * 1024u * 1024u );
+    REQUIRE( compressor.memoryBudgetPolicy() == MemoryBudgetPolicy::Fail );
+
+    compressor.setMemoryBudget( 128u * 1024u * 1024u, MemoryBudgetPolicy::AutoTune );
+    REQUIRE( compressor.memoryBudget() == 128u * 1024u * 1024u );
+    REQUIRE( compressor.memoryBudgetPolicy() == MemoryBudgetPolicy::AutoTune );
+
+    compressor.setMemoryBudget( 0u );
+    REQUIRE( compressor.memoryBudget() == 0u );
+    REQUIRE( compressor.memoryBudgetPolicy() == MemoryBudgetPolicy::Fail );
+}
+
+TEST_CASE( "BitAbstractArchiveCreator: Enforcing the memory budget", "[bitabstractarchivecreator]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    BitMemCompressor compressor( lib, BitFormat::SevenZip );
+    compressor.setCompressionLevel( BitCompressionLevel::Ultra );
+    compressor.setThreadsCount( 8 );
+
+    const auto unboundedMemoryUsage = compressor.estimatedMemoryUsage();
+    REQUIRE( unboundedMemoryUsage > 64u * 1024u * 1024u );
+
+    const std::vector< byte_t > input( 1024, 'a' );
+    std::vector< byte_t > output;
+
+    SECTION( "Failing when the budget is exceeded" ) {
+        compressor.setMemoryBudget( 64u * 1024u * 1024u );
+        REQUIRE( compressor.estimatedMemoryUsage() == unboundedMemoryUsage );
+        try {
+            compressor.compressFile( input, output, BIT7Z_STRING( "test.txt" ) );
+            FAIL( "The compression should have failed" );
+        } catch ( const BitException& ex ) {
+            REQUIRE( ex.code() == BitError::MemoryBudgetExceeded );
+        }
+    }
+
+    SECTION( "Auto-tuning the encoder to fit the budget" ) {
+        compressor.setMemoryBudget( 64u * 1024u * 1024u, MemoryBudgetPolicy::AutoTune );
+        REQUIRE( compressor.estimatedMemoryUsage() <= 64u * 1024u * 1024u );
+        REQUIRE_NOTHROW( compressor.compressFile( input, output, BIT7Z_STRING( "test.txt" ) ) );
+        REQUIRE_FALSE( output.empty() );
+    }
+
+    SECTION( "Failing when the budget is too small even after auto-tuning" ) {
+        compressor.setMemoryBudget( 1024u, MemoryBudgetPolicy::AutoTune );
+        REQUIRE( compressor.estimatedMemoryUsage() > 1024u );
+        REQUIRE_THROWS_AS( compressor.compressFile( input, output, BIT7Z_STRING( "test.txt" ) ), BitException );
+    }
+
+    SECTION( "Checking the budget against the dictionary size set as a format property" ) {
+        compressor.setFormatProperty( L"0d", L"1024m" );
+        REQUIRE( compressor.estimatedMemoryUsage() > unboundedMemoryUsage );
+
+        compressor.setMemoryBudget( 64u * 1024u * 1024u, MemoryBudgetPolicy::AutoTune );
+        REQUIRE( compressor.estimatedMemoryUsage() <= 64u * 1024u * 1024u );
+        REQUIRE_NOTHROW( compressor.compressFile( input, output, BIT7Z_STRING( "test.txt" ) ) );
+    }
+}
+
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setReadAheadBudget(...) / readAheadBudget()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE( compressor.readAheadBudget() == 0u );
+    REQUIRE( compressor.readAheadThreads() == 0u );
+
+    compressor.setReadAheadBudget( 64u * 1024u * 1024u );
+    REQUIRE( compressor.readAheadBudget() == 64u * 1024u * 1024u );
+
+    compressor.setReadAheadThreads( 2u );
+    REQUIRE( compressor.readAheadThreads() == 2u );
+
+    compressor.setReadAheadBudget( 0u );
+    REQUIRE( compressor.readAheadBudget() == 0u );
+}
+
 TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setSolidMode(...) / solidMode()",
                          "[bitabstractarchivecreator]", CreatorTypes ) {
     const Bit7zLibrary lib{ test::sevenzip_lib_path() };
@@ -391,11 +538,34 @@ TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setUpdateMode(...) / update
     compressor.setUpdateMode( UpdateMode::Update );
     REQUIRE( compressor.updateMode() == UpdateMode::Update );
 
+    compressor.setUpdateMode( UpdateMode::Sync );
+    REQUIRE( compressor.updateMode() == UpdateMode::Sync );
+
     compressor.setUpdateMode( UpdateMode::None );
     REQUIRE( compressor.updateMode() == UpdateMode::None );
 
 }
 
+TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setSyncOptions(...) / syncOptions()",
+                         "[bitabstractarchivecreator]", CreatorTypes ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    TestType compressor( lib, BitFormat::SevenZip );
+    REQUIRE_FALSE( compressor.syncOptions().compareContent );
+    REQUIRE_FALSE( compressor.syncOptions().removeMissing );
+
+    SyncOptions options;
+    options.compareContent = true;
+    options.removeMissing = true;
+    compressor.setSyncOptions( options );
+    REQUIRE( compressor.syncOptions().compareContent );
+    REQUIRE( compressor.syncOptions().removeMissing );
+
+    compressor.setSyncOptions( {} );
+    REQUIRE_FALSE( compressor.syncOptions().compareContent );
+    REQUIRE_FALSE( compressor.syncOptions().removeMissing );
+}
+
 TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setVolumeSize(...) / volumeSize()",
                          "[bitabstractarchivecreator]", CreatorTypes ) {
     const Bit7zLibrary lib{ test::sevenzip_lib_path() };
@@ -547,4 +717,89 @@ TEMPLATE_LIST_TEST_CASE( "BitAbstractArchiveCreator: setWordSize(...) / wordSize
         REQUIRE_NOTHROW( compressor.setWordSize( 0 ) );
         REQUIRE( compressor.wordSize() == 0 );
     }
-}
\ No newline at end of file
+}
+#ifdef BIT7Z_TESTS_FILESYSTEM
+TEST_CASE( "BitAbstractArchiveCreator: Planning the solid blocks of some files", "[bitabstractarchivecreator]" ) {
+    const TestDirectory testDir{ fs::path{ test_filesystem_dir } };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    BitFileCompressor compressor( lib, BitFormat::SevenZip );
+    const std::vector< tstring > inputPaths{ italy.name, lorem_ipsum.name };
+
+    SECTION( "Non-solid archive" ) {
+        const auto plan = compressor.planSolidBlocks( inputPaths );
+        REQUIRE( plan.size() == 2 );
+        REQUIRE( plan[ 0 ].block != plan[ 1 ].block );
+        for ( const auto& item : plan ) {
+            REQUIRE( item.decodeCost == item.size );
+        }
+    }
+
+    SECTION( "Solid archive" ) {
+        compressor.setSolidMode( true );
+        const auto plan = compressor.planSolidBlocks( inputPaths );
+        REQUIRE( plan.size() == 2 );
+        REQUIRE( plan[ 0 ].block == plan[ 1 ].block );
+        REQUIRE( plan[ 0 ].decodeCost == plan[ 0 ].size );
+        REQUIRE( plan[ 1 ].decodeCost == italy.size + lorem_ipsum.size );
+    }
+
+    SECTION( "Solid archive with one file per block" ) {
+        compressor.setSolidMode( true );
+        SolidOptions options;
+        options.maxBlockFiles = 1;
+        compressor.setSolidOptions( options );
+        const auto plan = compressor.planSolidBlocks( inputPaths );
+        REQUIRE( plan.size() == 2 );
+        REQUIRE( plan[ 0 ].block != plan[ 1 ].block );
+        for ( const auto& item : plan ) {
+            REQUIRE( item.decodeCost == item.size );
+        }
+    }
+
+    SECTION( "Solid archive grouped by extension" ) {
+        compressor.setSolidMode( true );
+        SolidOptions options;
+        options.groupByExtension = true;
+        compressor.setSolidOptions( options );
+        const auto plan = compressor.planSolidBlocks( inputPaths );
+        REQUIRE( plan.size() == 2 );
+        REQUIRE( plan[ 0 ].path == lorem_ipsum.name ); // pdf < svg
+        REQUIRE( plan[ 0 ].block != plan[ 1 ].block );
+    }
+}
+
+TEST_CASE( "BitAbstractArchiveCreator: Estimating the compression of some files", "[bitabstractarchivecreator]" ) {
+    const TestDirectory testDir{ fs::path{ test_filesystem_dir } };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    BitMemCompressor compressor( lib, BitFormat::SevenZip );
+
+    SECTION( "No files" ) {
+        const auto estimate = compressor.estimate( std::vector< tstring >{} );
+        REQUIRE( estimate.inputSize == 0 );
+        REQUIRE( estimate.sampledSize == 0 );
+        REQUIRE( estimate.estimatedSize == 0 );
+        REQUIRE( estimate.ratio == 0.0 );
+        REQUIRE( estimate.peakMemory > 0 );
+    }
+
+    SECTION( "Files smaller than the sample size" ) {
+        const auto estimate = compressor.estimate( { italy.name, lorem_ipsum.name } );
+        REQUIRE( estimate.inputSize == italy.size + lorem_ipsum.size );
+        REQUIRE( estimate.sampledSize == estimate.inputSize );
+        REQUIRE( estimate.ratio > 0.0 );
+        REQUIRE( estimate.estimatedSize > 0 );
+        REQUIRE( estimate.peakMemory > 0 );
+    }
+
+    SECTION( "Files bigger than the sample size" ) {
+        constexpr auto kSampleSize = 4096u;
+        const auto estimate = compressor.estimate( { lorem_ipsum.name }, kSampleSize );
+        REQUIRE( estimate.inputSize == lorem_ipsum.size );
+        REQUIRE( estimate.sampledSize > 0 );
+        REQUIRE( estimate.sampledSize <= kSampleSize );
+        REQUIRE( estimate.ratio > 0.0 );
+    }
+}
+#endif
@@ -16,4 +16,459 @@
 
 TEST_CASE( "BitArchiveEditor: TODO", "[bitarchiveeditor]" ) {
 
-}
\ No newline at end of file
+}
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitfilecompressor.hpp>
+#include <bit7z/bitformat.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <utility>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+
+namespace {
+// An archive in a temporary folder, containing the given items of the test filesystem.
+class TempArchive final {
+        TempDirectory mDirectory;
+        tstring mPath;
+
+    public:
+        TempArchive( const Bit7zLibrary& lib, const BitInOutFormat& format, const std::vector< tstring >& inPaths )
+            : mDirectory{ "bit7z_test_bitarchiveeditor" },
+              mPath{ path_to_tstring( mDirectory.path() /
+                                      ( tstring{ BIT7Z_STRING( "archive" ) } + format.extension() ) ) } {
+            BitFileCompressor compressor{ lib, format };
+            compressor.compress( inPaths, mPath );
+        }
+
+        TempArchive( const TempArchive& ) = delete;
+
+        TempArchive( TempArchive&& ) = delete;
+
+        auto operator=( const TempArchive& ) -> TempArchive& = delete;
+
+        auto operator=( TempArchive&& ) -> TempArchive& = delete;
+
+        ~TempArchive() = default;
+
+        BIT7Z_NODISCARD auto path() const -> const tstring& {
+            return mPath;
+        }
+
+        BIT7Z_NODISCARD auto directory() const -> const fs::path& {
+            return mDirectory.path();
+        }
+};
+
+/* Note: the paths in the archives are compared as fs::path objects,
+ *       so that they match regardless of the path separators used by 7-Zip on the current platform. */
+
+// The paths of the items of the given archive, in the order of their indices.
+auto archive_paths( const Bit7zLibrary& lib,
+                    const tstring& archivePath,
+                    const BitInFormat& format ) -> std::vector< fs::path > {
+    const BitArchiveReader reader{ lib, archivePath, format };
+    std::vector< fs::path > result;
+    for ( const auto& item : reader.items() ) {
+        result.push_back( tstring_to_path( item.path() ) );
+    }
+    return result;
+}
+
+// The content of the files in the given archive, by path.
+auto archive_content( const Bit7zLibrary& lib,
+                      const tstring& archivePath,
+                      const BitInFormat& format ) -> std::map< fs::path, buffer_t > {
+    const BitArchiveReader reader{ lib, archivePath, format };
+    std::map< tstring, buffer_t > content;
+    reader.extractTo( content );
+    std::map< fs::path, buffer_t > result;
+    for ( auto& file : content ) {
+        result.emplace( tstring_to_path( file.first ), std::move( file.second ) );
+    }
+    return result;
+}
+
+auto index_of( const std::vector< fs::path >& paths, const fs::path& path ) -> uint32_t {
+    const auto position = std::find( paths.cbegin(), paths.cend(), path );
+    REQUIRE( position != paths.cend() );
+    return static_cast< uint32_t >( position - paths.cbegin() );
+}
+
+// The paths in the given list, except the ones for which the predicate returns true.
+template< typename Predicate >
+auto paths_except( std::vector< fs::path > paths, Predicate predicate ) -> std::vector< fs::path > {
+    paths.erase( std::remove_if( paths.begin(), paths.end(), predicate ), paths.end() );
+    return paths;
+}
+
+auto is_in_folder( const fs::path& path, const fs::path& folder ) -> bool {
+    const auto mismatch = std::mismatch( folder.begin(), folder.end(), path.begin(), path.end() );
+    return mismatch.first == folder.end() && mismatch.second != path.end();
+}
+} // namespace
+
+TEST_CASE( "BitArchiveEditor: Renaming again the items relocated by an in-place edit", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempArchive archive{ lib, BitFormat::Zip, { italy.name, lorem_ipsum.name, noext.name } };
+    const auto expectedItaly = load_file( italy.name );
+    const auto expectedLoremIpsum = load_file( lorem_ipsum.name );
+    const auto expectedNoext = load_file( noext.name );
+
+    // The new path doesn't fit in the local header of the item, so its data is moved at the end of the archive.
+    const tstring longPath = BIT7Z_STRING( "italy with a much longer name, which cannot fit in the local header.svg" );
+    BitArchiveEditor editor{ lib, archive.path(), BitFormat::Zip };
+    editor.renameItem( index_of( archive_paths( lib, archive.path(), BitFormat::Zip ), italy.name ), longPath );
+    REQUIRE_NOTHROW( editor.applyChanges() );
+
+    const auto paths = archive_paths( lib, archive.path(), BitFormat::Zip );
+    REQUIRE( paths.size() == 3 );
+    REQUIRE( editor.itemsCount() == 3 );
+
+    SECTION( "Renaming the relocated item by index" ) {
+        editor.renameItem( index_of( paths, longPath ), BIT7Z_STRING( "italy2.svg" ) );
+    }
+
+    SECTION( "Renaming the relocated item by path" ) {
+        editor.renameItem( longPath, BIT7Z_STRING( "italy2.svg" ) );
+    }
+
+    // The other items are renamed by index, so that any mismatch with the new order of the items is detected.
+    editor.renameItem( index_of( paths, lorem_ipsum.name ), BIT7Z_STRING( "Lorem Ipsum 2.pdf" ) );
+    REQUIRE_NOTHROW( editor.applyChanges() );
+
+    const auto content = archive_content( lib, archive.path(), BitFormat::Zip );
+    REQUIRE( content == std::map< fs::path, buffer_t >{
+        { BIT7Z_STRING( "italy2.svg" ), expectedItaly },
+        { BIT7Z_STRING( "Lorem Ipsum 2.pdf" ), expectedLoremIpsum },
+        { noext.name, expectedNoext }
+    } );
+}
+
+TEST_CASE( "BitArchiveEditor: Editing again the archive after applying the changes", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const buffer_t updatedContent{ 'h', 'e', 'l', 'l', 'o' };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(),
+                                   &BitFormat::Zip, &BitFormat::Tar, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TempArchive archive{ lib, *format, { italy.name, lorem_ipsum.name, noext.name } };
+        BitArchiveEditor editor{ lib, archive.path(), *format };
+
+        // The content of the item with path "new.txt" after the first changes.
+        buffer_t newFileContent;
+
+        SECTION( "After rewriting the archive" ) {
+            newFileContent = { 'w', 'o', 'r', 'l', 'd' };
+            REQUIRE_NOTHROW( editor.deleteItem( noext.name ) );
+            REQUIRE_NOTHROW( editor.addFile( newFileContent, BIT7Z_STRING( "new.txt" ) ) );
+            REQUIRE_NOTHROW( editor.renameItem( italy.name, BIT7Z_STRING( "italy2.svg" ) ) );
+        }
+
+        SECTION( "After editing only the metadata of the items" ) {
+            // Note: zip archives are edited in place, as the new paths fit in the local headers of the items.
+            newFileContent = load_file( noext.name );
+            REQUIRE_NOTHROW( editor.renameItem( noext.name, BIT7Z_STRING( "new.txt" ) ) );
+            REQUIRE_NOTHROW( editor.renameItem( italy.name, BIT7Z_STRING( "italy2.svg" ) ) );
+        }
+
+        REQUIRE_NOTHROW( editor.applyChanges() );
+        REQUIRE( editor.itemsCount() == 3 );
+
+        /* The editor must know the new paths and indices of the items, whether they were derived
+         * from the applied changes, or read again from the archive. */
+        const auto paths = archive_paths( lib, archive.path(), *format );
+        REQUIRE_NOTHROW( editor.renameItem( BIT7Z_STRING( "new.txt" ), BIT7Z_STRING( "new2.txt" ) ) );
+        REQUIRE_NOTHROW( editor.deleteItem( BIT7Z_STRING( "italy2.svg" ) ) );
+        REQUIRE_NOTHROW( editor.updateItem( index_of( paths, lorem_ipsum.name ), updatedContent ) );
+        REQUIRE_THROWS_AS( editor.renameItem( italy.name, BIT7Z_STRING( "italy3.svg" ) ), BitException );
+        REQUIRE_NOTHROW( editor.applyChanges() );
+
+        REQUIRE( archive_content( lib, archive.path(), *format ) == std::map< fs::path, buffer_t >{
+            { BIT7Z_STRING( "new2.txt" ), newFileContent },
+            { lorem_ipsum.name, updatedContent }
+        } );
+    }
+}
+
+TEST_CASE( "BitArchiveEditor: Deleting several items at once", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TempArchive archive{ lib, *format, { italy.name, lorem_ipsum.name, noext.name, folder.name } };
+        // Note: 7-Zip might reorder the items of some formats (e.g., 7z) when updating the archive.
+        const auto sortedPaths = [ &lib, &archive, format ]() -> std::vector< fs::path > {
+            auto result = archive_paths( lib, archive.path(), *format );
+            std::sort( result.begin(), result.end() );
+            return result;
+        };
+        const auto paths = sortedPaths();
+        const fs::path folderPath{ folder.name };
+        REQUIRE( std::count_if( paths.cbegin(), paths.cend(), [ &folderPath ]( const fs::path& path ) -> bool {
+            return is_in_folder( path, folderPath );
+        } ) > 1 );
+
+        BitArchiveEditor editor{ lib, archive.path(), *format };
+
+        SECTION( "Deleting some files" ) {
+            REQUIRE_NOTHROW( editor.deleteItems( { italy.name, noext.name } ) );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() ==
+                     paths_except( paths, []( const fs::path& path ) -> bool {
+                         return path == italy.name || path == noext.name;
+                     } ) );
+        }
+
+        SECTION( "Deleting only the item of a folder" ) {
+            REQUIRE_NOTHROW( editor.deleteItems( { italy.name, folder.name } ) );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() ==
+                     paths_except( paths, [ &folderPath ]( const fs::path& path ) -> bool {
+                         return path == italy.name || path == folderPath;
+                     } ) );
+        }
+
+        const auto isDeletedRecursively = [ &folderPath ]( const fs::path& path ) -> bool {
+            return path == noext.name || path == folderPath || is_in_folder( path, folderPath );
+        };
+
+        SECTION( "Deleting a folder recursively" ) {
+            REQUIRE_NOTHROW( editor.deleteItems( { noext.name, folder.name }, DeletePolicy::RecurseDirs ) );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() == paths_except( paths, isDeletedRecursively ) );
+        }
+
+        SECTION( "Deleting a folder recursively, using a path with a trailing separator" ) {
+            const std::vector< tstring > deletedPaths{ noext.name, BIT7Z_STRING( "folder/" ) };
+            REQUIRE_NOTHROW( editor.deleteItems( deletedPaths, DeletePolicy::RecurseDirs ) );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() == paths_except( paths, isDeletedRecursively ) );
+        }
+
+        SECTION( "A path with a trailing separator matches nothing when not deleting recursively" ) {
+            REQUIRE_THROWS_AS( editor.deleteItems( { italy.name, BIT7Z_STRING( "folder/" ) } ), BitException );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() == paths );
+        }
+
+        SECTION( "No item is deleted if some path doesn't match any item" ) {
+            REQUIRE_THROWS_AS( editor.deleteItems( { italy.name, BIT7Z_STRING( "missing" ) } ), BitException );
+            REQUIRE_THROWS_AS( editor.deleteItems( { italy.name, BIT7Z_STRING( "/noext" ) } ), BitException );
+            REQUIRE_THROWS_AS( editor.deleteItems( { italy.name, BIT7Z_STRING( "" ) } ), BitException );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( sortedPaths() == paths );
+        }
+    }
+}
+
+TEST_CASE( "BitArchiveEditor: Finding the items by path", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TempArchive archive{ lib, *format, { italy.name, lorem_ipsum.name, noext.name, folder.name } };
+        const auto content = archive_content( lib, archive.path(), *format );
+        const fs::path cloudsPath = fs::path{ folder.name } / clouds.name;
+        REQUIRE( content.count( cloudsPath ) == 1 );
+
+        BitArchiveEditor editor{ lib, archive.path(), *format };
+
+        SECTION( "Editing the items found by path" ) {
+            const buffer_t newContent{ 'h', 'e', 'l', 'l', 'o' };
+            const std::map< tstring, tstring > renamedPaths{
+                { italy.name, BIT7Z_STRING( "italy2.svg" ) },
+                { path_to_tstring( cloudsPath ), BIT7Z_STRING( "clouds.jpg" ) }
+            };
+            REQUIRE_NOTHROW( editor.renameItems( renamedPaths ) );
+            REQUIRE_NOTHROW( editor.updateItem( noext.name, newContent ) );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+
+            auto expected = content;
+            expected[ BIT7Z_STRING( "italy2.svg" ) ] = expected.at( italy.name );
+            expected[ BIT7Z_STRING( "clouds.jpg" ) ] = expected.at( cloudsPath );
+            expected[ noext.name ] = newContent;
+            expected.erase( italy.name );
+            expected.erase( cloudsPath );
+            REQUIRE( archive_content( lib, archive.path(), *format ) == expected );
+        }
+
+        SECTION( "No item is renamed if some path doesn't match any item" ) {
+            REQUIRE_THROWS_AS( editor.renameItems( { { italy.name, BIT7Z_STRING( "italy2.svg" ) },
+                                                     { BIT7Z_STRING( "missing" ), BIT7Z_STRING( "found" ) } } ),
+                               BitException );
+            REQUIRE_NOTHROW( editor.applyChanges() );
+            REQUIRE( archive_content( lib, archive.path(), *format ) == content );
+        }
+
+        SECTION( "The items marked as deleted cannot be found" ) {
+            REQUIRE_NOTHROW( editor.deleteItem( italy.name ) );
+            REQUIRE_THROWS_AS( editor.renameItem( italy.name, BIT7Z_STRING( "italy2.svg" ) ), BitException );
+            REQUIRE_THROWS_AS( editor.updateItem( italy.name, lorem_ipsum.name ), BitException );
+        }
+
+        SECTION( "The paths are matched exactly" ) {
+            REQUIRE_THROWS_AS( editor.renameItem( BIT7Z_STRING( "ITALY.svg" ), BIT7Z_STRING( "x" ) ), BitException );
+            REQUIRE_THROWS_AS( editor.renameItem( clouds.name, BIT7Z_STRING( "x" ) ), BitException );
+        }
+    }
+}
+
+TEST_CASE( "BitArchiveEditor: Exporting some items to a new archive", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto expectedItaly = load_file( italy.name );
+    const auto expectedNoext = load_file( noext.name );
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(),
+                                   &BitFormat::Zip, &BitFormat::Tar, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TempArchive archive{ lib, *format, { italy.name, lorem_ipsum.name, noext.name } };
+        const auto content = archive_content( lib, archive.path(), *format );
+        const auto paths = archive_paths( lib, archive.path(), *format );
+        const tstring outFile = path_to_tstring( archive.directory() / BIT7Z_STRING( "exported" ) );
+
+        BitArchiveEditor editor{ lib, archive.path(), *format };
+
+        SECTION( "Exporting the items at the given indices" ) {
+            // Note: the pending changes are not applied to the exported items.
+            REQUIRE_NOTHROW( editor.renameItem( italy.name, BIT7Z_STRING( "italy2.svg" ) ) );
+            REQUIRE_NOTHROW( editor.deleteItem( noext.name ) );
+            REQUIRE_NOTHROW( editor.exportItems( { index_of( paths, noext.name ), index_of( paths, italy.name ) },
+                                                 outFile ) );
+            REQUIRE( archive_content( lib, outFile, *format ) == std::map< fs::path, buffer_t >{
+                { italy.name, expectedItaly },
+                { noext.name, expectedNoext }
+            } );
+            REQUIRE( archive_content( lib, archive.path(), *format ) == content );
+        }
+
+        SECTION( "Exporting an invalid index" ) {
+            REQUIRE_THROWS_AS( editor.exportItems( { 0, 3 }, outFile ), BitException );
+            REQUIRE_FALSE( fs::exists( tstring_to_path( outFile ) ) );
+        }
+
+        SECTION( "Exporting to the input archive" ) {
+            editor.setOverwriteMode( OverwriteMode::Overwrite );
+            REQUIRE_THROWS_AS( editor.exportItems( { 0 }, archive.path() ), BitException );
+            REQUIRE( archive_content( lib, archive.path(), *format ) == content );
+        }
+
+        SECTION( "Exporting to an existing file" ) {
+            const buffer_t oldContent{ 'o', 'l', 'd' };
+            {
+                fs::ofstream outStream{ tstring_to_path( outFile ), std::ios::binary };
+                outStream.write( reinterpret_cast< const char* >( oldContent.data() ), // NOLINT(*-reinterpret-cast)
+                                 static_cast< std::streamsize >( oldContent.size() ) );
+            }
+            const std::vector< uint32_t > indices{ index_of( paths, italy.name ) };
+
+            REQUIRE_THROWS_AS( editor.exportItems( indices, outFile ), BitException );
+            REQUIRE( load_file( tstring_to_path( outFile ) ) == oldContent );
+
+            editor.setOverwriteMode( OverwriteMode::Skip );
+            REQUIRE_NOTHROW( editor.exportItems( indices, outFile ) );
+            REQUIRE( load_file( tstring_to_path( outFile ) ) == oldContent );
+
+            editor.setOverwriteMode( OverwriteMode::Overwrite );
+            REQUIRE_NOTHROW( editor.exportItems( indices, outFile ) );
+            REQUIRE( archive_content( lib, outFile, *format ) == std::map< fs::path, buffer_t >{
+                { italy.name, expectedItaly }
+            } );
+        }
+    }
+}
+
+TEST_CASE( "BitArchiveEditor: Exporting the items of a zip archive edited in place", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempArchive archive{ lib, BitFormat::Zip, { italy.name, lorem_ipsum.name, noext.name } };
+    const tstring outFile = path_to_tstring( archive.directory() / BIT7Z_STRING( "exported.zip" ) );
+
+    /* The data of the renamed item is moved after the other items, so the order of the zip entries
+     * might not match the one of the items reported by 7-Zip anymore: the exported items must still be
+     * the ones at the given indices, whether they are copied as raw entries or through 7-Zip. */
+    const tstring longPath = BIT7Z_STRING( "italy with a much longer name, which cannot fit in the local header.svg" );
+    BitArchiveEditor editor{ lib, archive.path(), BitFormat::Zip };
+    REQUIRE_NOTHROW( editor.renameItem( italy.name, longPath ) );
+    REQUIRE_NOTHROW( editor.applyChanges() );
+
+    const auto paths = archive_paths( lib, archive.path(), BitFormat::Zip );
+    const auto* exportedFile = GENERATE( as< const FilesystemItemInfo* >(), &italy, &lorem_ipsum, &noext );
+    const tstring itemPath = exportedFile == &italy ? longPath : exportedFile->name;
+    REQUIRE_NOTHROW( editor.exportItems( { index_of( paths, itemPath ) }, outFile ) );
+    REQUIRE( archive_content( lib, outFile, BitFormat::Zip ) == std::map< fs::path, buffer_t >{
+        { itemPath, load_file( exportedFile->name ) }
+    } );
+}
+
+TEST_CASE( "BitArchiveEditor: Changing the attributes and the last write time of the items", "[bitarchiveeditor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    constexpr uint32_t kNewAttributes = 0x21; // FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_ARCHIVE
+    // Note: a time with an even number of seconds, so that it can be stored exactly in the zip headers.
+    const time_type newTime = std::chrono::system_clock::from_time_t( 1623760496 ); // 2021-06-15 12:34:56 UTC
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        // Note: zip archives are edited in place, while 7z archives are rewritten.
+        const TempArchive archive{ lib, *format, { italy.name, lorem_ipsum.name, noext.name } };
+        const auto paths = archive_paths( lib, archive.path(), *format );
+        const auto originalSize = load_file( archive.path() ).size();
+        const auto originalContent = archive_content( lib, archive.path(), *format );
+        std::map< fs::path, std::pair< uint32_t, time_type > > expectedMetadata;
+        {
+            const BitArchiveReader reader{ lib, archive.path(), *format };
+            for ( const auto& item : reader.items() ) {
+                expectedMetadata[ tstring_to_path( item.path() ) ] = { item.attributes(), item.lastWriteTime() };
+            }
+        }
+        REQUIRE( expectedMetadata.at( italy.name ).first != kNewAttributes );
+        REQUIRE( expectedMetadata.at( noext.name ).second != newTime );
+        expectedMetadata[ italy.name ].first = kNewAttributes;
+        expectedMetadata[ noext.name ].second = newTime;
+
+        BitArchiveEditor editor{ lib, archive.path(), *format };
+        REQUIRE_NOTHROW( editor.setItemAttributes( italy.name, kNewAttributes ) );
+        REQUIRE_NOTHROW( editor.setItemLastWriteTime( index_of( paths, noext.name ), newTime ) );
+        REQUIRE_THROWS_AS( editor.setItemAttributes( BIT7Z_STRING( "missing.txt" ), kNewAttributes ), BitException );
+        REQUIRE_NOTHROW( editor.applyChanges() );
+
+        if ( *format == BitFormat::Zip ) {
+            // Only the headers of the entries were patched.
+            REQUIRE( load_file( archive.path() ).size() == originalSize );
+        }
+
+        const BitArchiveReader reader{ lib, archive.path(), *format };
+        REQUIRE( reader.itemsCount() == 3 );
+        for ( const auto& item : reader.items() ) {
+            const auto& expected = expectedMetadata.at( tstring_to_path( item.path() ) );
+            REQUIRE( item.attributes() == expected.first );
+            REQUIRE( item.lastWriteTime() == expected.second );
+        }
+        REQUIRE( archive_content( lib, archive.path(), *format ) == originalContent );
+    }
+}
+
+#endif
@@ -0,0 +1,249 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <bit7z/bitarchivemerger.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitformat.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <algorithm>
+#include <map>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+using bit7z::test::append_le;
+using bit7z::test::kTarBlockSize;
+using bit7z::test::make_tar;
+using bit7z::test::make_zip;
+using bit7z::test::read_le;
+using bit7z::test::to_buffer;
+using bit7z::test::write_file;
+using bit7z::test::ZipEntry;
+
+namespace {
+using FilesContent = std::map< tstring, buffer_t >;
+
+void create_archive( const Bit7zLibrary& lib,
+                     const BitInOutFormat& format,
+                     const fs::path& archivePath,
+                     const FilesContent& content ) {
+    BitArchiveWriter writer{ lib, format };
+    for ( const auto& file : content ) {
+        writer.addFile( file.second, file.first );
+    }
+    writer.compressTo( path_to_tstring( archivePath ) );
+}
+
+auto archive_content( const Bit7zLibrary& lib,
+                      const fs::path& archivePath,
+                      const BitInFormat& format ) -> FilesContent {
+    const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), format };
+    FilesContent result;
+    reader.extractTo( result );
+    return result;
+}
+
+// Whether the given archive contains the given bytes starting at the given offset.
+auto contains_at( const buffer_t& archive, std::size_t offset, const buffer_t& data ) -> bool {
+    return offset + data.size() <= archive.size() &&
+           std::equal( data.cbegin(), data.cend(), archive.cbegin() + static_cast< std::ptrdiff_t >( offset ) );
+}
+} // namespace
+
+TEST_CASE( "BitArchiveMerger: Merging archives with the merge policies", "[bitarchivemerger]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempDirectory tempDir{ "bit7z_test_bitarchivemerger" };
+
+    // Note: zip and tar archives are merged without recompression, while 7z archives are recompressed.
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::Tar,
+                                   &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const FilesContent firstContent{
+            { BIT7Z_STRING( "common.txt" ), to_buffer( "The common file of the first archive." ) },
+            { BIT7Z_STRING( "first.txt" ), to_buffer( "The file only in the first archive." ) }
+        };
+        const FilesContent secondContent{
+            { BIT7Z_STRING( "common.txt" ), to_buffer( "The common file of the second archive." ) },
+            { BIT7Z_STRING( "second.txt" ), to_buffer( "The file only in the second archive." ) }
+        };
+        const fs::path firstPath = tempDir.path() / ( tstring{ BIT7Z_STRING( "first" ) } + format->extension() );
+        const fs::path secondPath = tempDir.path() / ( tstring{ BIT7Z_STRING( "second" ) } + format->extension() );
+        const fs::path outPath = tempDir.path() / ( tstring{ BIT7Z_STRING( "merged" ) } + format->extension() );
+        create_archive( lib, *format, firstPath, firstContent );
+        create_archive( lib, *format, secondPath, secondContent );
+        const std::vector< tstring > inArchives{ path_to_tstring( firstPath ), path_to_tstring( secondPath ) };
+
+        FilesContent expected{
+            { BIT7Z_STRING( "first.txt" ), firstContent.at( BIT7Z_STRING( "first.txt" ) ) },
+            { BIT7Z_STRING( "second.txt" ), secondContent.at( BIT7Z_STRING( "second.txt" ) ) }
+        };
+
+        BitArchiveMerger merger{ lib, *format };
+        SECTION( "Keeping the files of the last archive (default)" ) {
+            REQUIRE( merger.mergePolicy() == MergePolicy::KeepLast );
+            merger.merge( inArchives, path_to_tstring( outPath ) );
+            expected[ BIT7Z_STRING( "common.txt" ) ] = secondContent.at( BIT7Z_STRING( "common.txt" ) );
+            REQUIRE( archive_content( lib, outPath, *format ) == expected );
+        }
+
+        SECTION( "Keeping the files of the first archive" ) {
+            merger.setMergePolicy( MergePolicy::KeepFirst );
+            merger.merge( inArchives, path_to_tstring( outPath ) );
+            expected[ BIT7Z_STRING( "common.txt" ) ] = firstContent.at( BIT7Z_STRING( "common.txt" ) );
+            REQUIRE( archive_content( lib, outPath, *format ) == expected );
+        }
+
+        SECTION( "Failing on the files having the same path" ) {
+            merger.setMergePolicy( MergePolicy::Fail );
+            try {
+                merger.merge( inArchives, path_to_tstring( outPath ) );
+                FAIL( "The merge of archives containing the same file path should fail" );
+            } catch ( const BitException& ex ) {
+                REQUIRE( ex.code() == std::errc::file_exists );
+            }
+            REQUIRE_FALSE( fs::exists( outPath ) );
+        }
+
+        SECTION( "Merging archives without conflicting files" ) {
+            merger.setMergePolicy( MergePolicy::Fail );
+            const fs::path thirdPath = tempDir.path() / ( tstring{ BIT7Z_STRING( "third" ) } + format->extension() );
+            create_archive( lib, *format, thirdPath, { { BIT7Z_STRING( "third.txt" ), to_buffer( "Third file." ) } } );
+            merger.merge( { path_to_tstring( firstPath ), path_to_tstring( thirdPath ) }, path_to_tstring( outPath ) );
+            expected = firstContent;
+            expected[ BIT7Z_STRING( "third.txt" ) ] = to_buffer( "Third file." );
+            REQUIRE( archive_content( lib, outPath, *format ) == expected );
+        }
+
+        // The temporary folder used for merging the archives (if any) is removed.
+        for ( const auto& entry : fs::directory_iterator{ tempDir.path() } ) {
+            REQUIRE( entry.is_regular_file() );
+        }
+    }
+}
+
+TEST_CASE( "BitArchiveMerger: Merging zip archives by copying their entries", "[bitarchivemerger]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempDirectory tempDir{ "bit7z_test_bitarchivemerger" };
+
+    const ZipEntry firstEntry{ "first.txt", "The content of the first archive." };
+    const ZipEntry secondEntry{ "second.txt", "The content of the second archive." };
+    const buffer_t firstArchive = make_zip( { firstEntry } );
+    buffer_t secondArchive = make_zip( { secondEntry } );
+
+    // Adding a comment to the second archive.
+    const std::string comment = "The comment of the second archive.";
+    secondArchive.resize( secondArchive.size() - 2 );
+    append_le( secondArchive, comment.size(), 2 );
+    secondArchive.insert( secondArchive.end(), comment.cbegin(), comment.cend() );
+
+    const fs::path firstPath = tempDir.path() / "first.zip";
+    const fs::path secondPath = tempDir.path() / "second.zip";
+    const fs::path outPath = tempDir.path() / "merged.zip";
+    write_file( firstPath, firstArchive );
+    write_file( secondPath, secondArchive );
+
+    const BitArchiveMerger merger{ lib, BitFormat::Zip };
+    merger.merge( { path_to_tstring( firstPath ), path_to_tstring( secondPath ) }, path_to_tstring( outPath ) );
+
+    // The local headers and the data of the entries are copied as they are.
+    const auto merged = load_file( outPath );
+    constexpr std::size_t kLocalHeaderSize = 30;
+    const auto firstEntrySize = kLocalHeaderSize + firstEntry.name.size() + firstEntry.content.size();
+    const auto secondEntrySize = kLocalHeaderSize + secondEntry.name.size() + secondEntry.content.size();
+    const auto firstEntryEnd = firstArchive.cbegin() + static_cast< std::ptrdiff_t >( firstEntrySize );
+    REQUIRE( contains_at( merged, 0, buffer_t( firstArchive.cbegin(), firstEntryEnd ) ) );
+    REQUIRE( contains_at( merged, firstEntrySize,
+                          buffer_t( secondArchive.cbegin(),
+                                    secondArchive.cbegin() + static_cast< std::ptrdiff_t >( secondEntrySize ) ) ) );
+
+    // The comment of the merged archive is kept.
+    REQUIRE( contains_at( merged, merged.size() - comment.size(), to_buffer( comment ) ) );
+    REQUIRE( read_le( merged, merged.size() - comment.size() - 2, 2 ) == comment.size() );
+
+    const FilesContent expected{
+        { BIT7Z_STRING( "first.txt" ), to_buffer( firstEntry.content ) },
+        { BIT7Z_STRING( "second.txt" ), to_buffer( secondEntry.content ) }
+    };
+    REQUIRE( archive_content( lib, outPath, BitFormat::Zip ) == expected );
+}
+
+TEST_CASE( "BitArchiveMerger: Merging tar archives by copying their entries", "[bitarchivemerger]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempDirectory tempDir{ "bit7z_test_bitarchivemerger" };
+
+    const std::string firstContent = "The content of the first archive.";
+    const std::string secondContent = "The content of the second archive.";
+    const buffer_t firstArchive = make_tar( "first.txt", firstContent, kTarBlockSize );
+    const buffer_t secondArchive = make_tar( "second.txt", secondContent, kTarBlockSize );
+    const fs::path firstPath = tempDir.path() / "first.tar";
+    const fs::path secondPath = tempDir.path() / "second.tar";
+    const fs::path outPath = tempDir.path() / "merged.tar";
+    write_file( firstPath, firstArchive );
+    write_file( secondPath, secondArchive );
+
+    const BitArchiveMerger merger{ lib, BitFormat::Tar };
+    merger.merge( { path_to_tstring( firstPath ), path_to_tstring( secondPath ) }, path_to_tstring( outPath ) );
+
+    // Each entry is made of a header block and a data block, which are copied as they are.
+    constexpr std::size_t kEntrySize = 2 * kTarBlockSize;
+    const auto merged = load_file( outPath );
+    REQUIRE( contains_at( merged, 0, buffer_t( firstArchive.cbegin(), firstArchive.cbegin() + kEntrySize ) ) );
+    REQUIRE( contains_at( merged, kEntrySize,
+                          buffer_t( secondArchive.cbegin(), secondArchive.cbegin() + kEntrySize ) ) );
+
+    const FilesContent expected{
+        { BIT7Z_STRING( "first.txt" ), to_buffer( firstContent ) },
+        { BIT7Z_STRING( "second.txt" ), to_buffer( secondContent ) }
+    };
+    REQUIRE( archive_content( lib, outPath, BitFormat::Tar ) == expected );
+}
+
+TEST_CASE( "BitArchiveMerger: Merging 7z archives by recompressing the smaller ones", "[bitarchivemerger]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TempDirectory tempDir{ "bit7z_test_bitarchivemerger" };
+
+    FilesContent biggerContent;
+    for ( tchar letter = BIT7Z_STRING( 'a' ); letter <= BIT7Z_STRING( 'j' ); ++letter ) {
+        biggerContent[ tstring{ BIT7Z_STRING( "bigger_" ) } + letter + BIT7Z_STRING( ".txt" ) ] =
+            buffer_t( 1000, static_cast< byte_t >( letter ) );
+    }
+    const FilesContent smallerContent{
+        { BIT7Z_STRING( "smaller.txt" ), to_buffer( "The content of the smaller archive." ) }
+    };
+    const fs::path smallerPath = tempDir.path() / "smaller.7z";
+    const fs::path biggerPath = tempDir.path() / "bigger.7z";
+    const fs::path outPath = tempDir.path() / "merged.7z";
+    create_archive( lib, BitFormat::SevenZip, smallerPath, smallerContent );
+    create_archive( lib, BitFormat::SevenZip, biggerPath, biggerContent );
+
+    const BitArchiveMerger merger{ lib, BitFormat::SevenZip };
+    merger.merge( { path_to_tstring( smallerPath ), path_to_tstring( biggerPath ) }, path_to_tstring( outPath ) );
+
+    FilesContent expected = biggerContent;
+    expected.insert( smallerContent.cbegin(), smallerContent.cend() );
+    REQUIRE( archive_content( lib, outPath, BitFormat::SevenZip ) == expected );
+
+    // The items of the smaller archive were extracted into a temporary folder, which was removed.
+    REQUIRE( std::distance( fs::directory_iterator{ tempDir.path() }, fs::directory_iterator{} ) == 3 );
+}
+
+#endif
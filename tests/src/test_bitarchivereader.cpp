@@ -17,11 +17,15 @@
 #include "utils/shared_lib.hpp"
 
 #include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitdigest.hpp>
 #include <bit7z/bitexception.hpp>
 #include <bit7z/bitformat.hpp>
 #include <internal/stringutil.hpp>
 #include <internal/windows.hpp>
 
+#include <map>
+
 // Needed by MSVC for defining the S_XXXX macros.
 #ifndef _CRT_INTERNAL_NONSTDC_NAMES // NOLINT(*-reserved-identifier, *-dcl37-c)
 #define _CRT_INTERNAL_NONSTDC_NAMES 1
@@ -980,4 +984,99 @@ TEST_CASE( "BitArchiveReader: Format detection of archives", "[bitarchivereader]
     }
 }
 
-#endif
\ No newline at end of file
+#endif
+
+TEST_CASE( "BitArchiveReader: Computing the digests of the extracted items", "[bitarchivereader]" ) {
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const std::map< tstring, std::string > files{
+        { BIT7Z_STRING( "abc.txt" ), "abc" },
+        { BIT7Z_STRING( "digits.txt" ), "123456789" },
+        { BIT7Z_STRING( "empty.txt" ), "" }
+    };
+    const std::map< tstring, ItemDigests > expectedDigests{
+        { BIT7Z_STRING( "abc.txt" ), {
+            { DigestType::Crc32, { 0x35, 0x24, 0x41, 0xC2 } },
+            { DigestType::Sha256, { 0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA,
+                                    0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+                                    0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C,
+                                    0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD } }
+        } },
+        { BIT7Z_STRING( "digits.txt" ), {
+            { DigestType::Crc32, { 0xCB, 0xF4, 0x39, 0x26 } },
+            { DigestType::Sha256, { 0x15, 0xE2, 0xB0, 0xD3, 0xC3, 0x38, 0x91, 0xEB,
+                                    0xB0, 0xF1, 0xEF, 0x60, 0x9E, 0xC4, 0x19, 0x42,
+                                    0x0C, 0x20, 0xE3, 0x20, 0xCE, 0x94, 0xC6, 0x5F,
+                                    0xBC, 0x8C, 0x33, 0x12, 0x44, 0x8E, 0xB2, 0x25 } }
+        } },
+        { BIT7Z_STRING( "empty.txt" ), {
+            { DigestType::Crc32, { 0x00, 0x00, 0x00, 0x00 } },
+            { DigestType::Sha256, { 0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14,
+                                    0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+                                    0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C,
+                                    0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55 } }
+        } }
+    };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::SevenZip, &BitFormat::Zip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        buffer_t archive;
+        {
+            BitArchiveWriter writer{ lib, *format };
+            for ( const auto& file : files ) {
+                writer.addFile( buffer_t{ file.second.cbegin(), file.second.cend() }, file.first );
+            }
+            writer.compressTo( archive );
+        }
+
+        BitArchiveReader reader{ lib, archive, *format };
+        std::map< uint32_t, ItemDigests > digests;
+        reader.setDigestCallback( [ &digests ]( uint32_t index, const ItemDigests& itemDigests ) {
+            REQUIRE( digests.count( index ) == 0 );
+            digests[ index ] = itemDigests;
+        } );
+
+        SECTION( "Computing the default digest (CRC32)" ) {
+            std::map< tstring, buffer_t > content;
+            reader.extractTo( content );
+            REQUIRE( digests.size() == files.size() );
+            for ( const auto& item : reader.items() ) {
+                const auto& itemDigests = digests.at( item.index() );
+                REQUIRE( itemDigests.size() == 1 );
+                REQUIRE( itemDigests.at( DigestType::Crc32 ) ==
+                         expectedDigests.at( item.path() ).at( DigestType::Crc32 ) );
+            }
+        }
+
+        SECTION( "Computing several digests" ) {
+            reader.setDigestTypes( { DigestType::Crc32, DigestType::Sha256 } );
+
+            SECTION( "Extracting to a map of buffers" ) {
+                std::map< tstring, buffer_t > content;
+                reader.extractTo( content );
+                REQUIRE( content.size() == files.size() );
+            }
+
+            SECTION( "Extracting each item to a buffer" ) {
+                for ( const auto& item : reader.items() ) {
+                    buffer_t content;
+                    reader.extractTo( content, item.index() );
+                }
+            }
+
+            SECTION( "Extracting to a directory" ) {
+                const TempDirectory tempDir{ "bit7z_test_digests" };
+                reader.extractTo( path_to_tstring( tempDir.path() ) );
+            }
+
+            SECTION( "Testing the archive" ) {
+                reader.test();
+            }
+
+            REQUIRE( digests.size() == files.size() );
+            for ( const auto& item : reader.items() ) {
+                REQUIRE( digests.at( item.index() ) == expectedDigests.at( item.path() ) );
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchiverepacker.hpp>
+#include <bit7z/biterror.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitfilecompressor.hpp>
+#include <bit7z/bitformat.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <iterator>
+#include <map>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+using bit7z::test::write_file;
+
+namespace {
+// The metadata of an item of an archive, as compared after repacking it.
+struct RepackedItem {
+    bool isDir;
+    uint64_t size;
+    time_type lastWriteTime;
+    buffer_t content;
+
+    auto operator==( const RepackedItem& other ) const -> bool {
+        return isDir == other.isDir && size == other.size && lastWriteTime == other.lastWriteTime &&
+               content == other.content;
+    }
+};
+
+auto repacked_items( const Bit7zLibrary& lib,
+                     const tstring& archivePath,
+                     const BitInFormat& format,
+                     const tstring& password = {} ) -> std::map< fs::path, RepackedItem > {
+    const BitArchiveReader reader{ lib, archivePath, format, password };
+    std::map< fs::path, RepackedItem > result;
+    for ( const auto& item : reader.items() ) {
+        RepackedItem repackedItem{ item.isDir(), item.size(), item.lastWriteTime(), {} };
+        if ( !item.isDir() ) {
+            reader.extractTo( repackedItem.content, item.index() );
+        }
+        result.emplace( tstring_to_path( item.path() ), std::move( repackedItem ) );
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE( "BitArchiveRepacker: Repacking a zip archive into a 7z archive", "[bitarchiverepacker]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitarchiverepacker" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directories( inDir / "folder" ) );
+    write_file( inDir / "first.txt", "The content of the first file." );
+    write_file( inDir / "folder" / "second.txt", std::string( 100000, 'x' ) );
+    write_file( inDir / "folder" / "empty.txt", std::string{} );
+    fs::last_write_time( inDir / "first.txt", past_file_time() );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const tstring sourcePath = path_to_tstring( tempDir.path() / "source.zip" );
+    const tstring outPath = path_to_tstring( tempDir.path() / "repacked.7z" );
+    {
+        const TestDirectory testDir{ inDir };
+        const BitFileCompressor compressor{ lib, BitFormat::Zip };
+        const std::vector< tstring > inPaths{ BIT7Z_STRING( "first.txt" ), BIT7Z_STRING( "folder" ) };
+        compressor.compress( inPaths, sourcePath );
+    }
+    const auto sourceItems = repacked_items( lib, sourcePath, BitFormat::Zip );
+    REQUIRE( sourceItems.size() == 4 );
+
+    BitArchiveRepacker repacker{ lib, BitFormat::SevenZip };
+    SECTION( "Using the default settings" ) {}
+
+    SECTION( "Using a memory limit smaller than the items" ) {
+        repacker.setPipeCapacity( 1024 );
+        repacker.setMemoryLimit( 1024 );
+    }
+
+    repacker.repack( sourcePath, outPath, BitFormat::Zip );
+    REQUIRE( repacked_items( lib, outPath, BitFormat::SevenZip ) == sourceItems );
+
+    // The temporary file used for buffering the items (if any) is removed.
+    REQUIRE( std::distance( fs::directory_iterator{ tempDir.path() }, fs::directory_iterator{} ) == 3 );
+}
+
+TEST_CASE( "BitArchiveRepacker: Repacking an encrypted archive", "[bitarchiverepacker]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitarchiverepacker" };
+    write_file( tempDir.path() / "file.txt", "The content of the encrypted file." );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const tstring sourcePath = path_to_tstring( tempDir.path() / "source.7z" );
+    const tstring outPath = path_to_tstring( tempDir.path() / "repacked.zip" );
+    {
+        const TestDirectory testDir{ tempDir.path() };
+        BitFileCompressor compressor{ lib, BitFormat::SevenZip };
+        compressor.setPassword( BIT7Z_STRING( "password" ) );
+        compressor.compress( { BIT7Z_STRING( "file.txt" ) }, sourcePath );
+    }
+
+    const BitArchiveRepacker repacker{ lib, BitFormat::Zip };
+    SECTION( "Using the right password" ) {
+        repacker.repack( sourcePath, outPath, BitFormat::SevenZip, BIT7Z_STRING( "password" ) );
+        REQUIRE( repacked_items( lib, outPath, BitFormat::Zip ) ==
+                 repacked_items( lib, sourcePath, BitFormat::SevenZip, BIT7Z_STRING( "password" ) ) );
+    }
+
+    SECTION( "Using a wrong password" ) {
+        // The extraction error is reported instead of the failure of the compression reading the item.
+        try {
+            repacker.repack( sourcePath, outPath, BitFormat::SevenZip, BIT7Z_STRING( "wrong password" ) );
+            FAIL( "Repacking an encrypted archive with a wrong password should fail" );
+        } catch ( const BitException& ex ) {
+            REQUIRE( ex.code() == BitFailureSource::WrongPassword );
+        }
+    }
+}
+
+#endif
@@ -16,6 +16,22 @@
 
 #include <bit7z/bitarchivewriter.hpp>
 
+#ifdef BIT7Z_TESTS_FILESYSTEM
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitdigest.hpp>
+#include <bit7z/bitfilecompressor.hpp>
+#include <bit7z/bithasher.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#endif
+
 using namespace bit7z;
 
 TEST_CASE( "BitArchiveWriter: TODO", "[bitarchivewriter]" ) {
@@ -23,4 +39,159 @@ TEST_CASE( "BitArchiveWriter: TODO", "[bitarchivewriter]" ) {
 
     const BitArchiveWriter writer{lib, BitFormat::SevenZip};
     REQUIRE( writer.compressionFormat() == BitFormat::SevenZip ); // Just a placeholder test.
-}
\ No newline at end of file
+}
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+using namespace bit7z::test::filesystem;
+using bit7z::test::kTarBlockSize;
+using bit7z::test::read_le;
+using bit7z::test::to_buffer;
+using bit7z::test::write_file;
+
+namespace {
+// The size of the part of the archive preceding its tail (i.e., the central directory of zip archives,
+// or the end marker of tar archives), which is left untouched when appending items in place.
+auto entries_size( const buffer_t& archive, const BitInOutFormat& format ) -> std::size_t {
+    if ( format == BitFormat::Zip ) {
+        // Note: the zip archives created by 7-Zip have no comment after the end of central directory record.
+        constexpr std::size_t kEndOfCentralDirSize = 22;
+        return static_cast< std::size_t >( read_le( archive, archive.size() - kEndOfCentralDirSize + 16, 4 ) );
+    }
+    const auto lastData = std::find_if( archive.crbegin(), archive.crend(), []( byte_t value ) -> bool {
+        return value != 0;
+    } );
+    const auto dataSize = static_cast< std::size_t >( archive.crend() - lastData );
+    return ( ( dataSize + kTarBlockSize - 1 ) / kTarBlockSize ) * kTarBlockSize;
+}
+} // namespace
+
+TEST_CASE( "BitArchiveWriter: Appending items to zip and tar archives", "[bitarchivewriter]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitarchivewriter" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+    write_file( inDir / "old.txt", "The content of the file already in the archive." );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::Tar );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TestDirectory testDir{ inDir };
+        const tstring archiveName = tstring{ BIT7Z_STRING( "archive" ) } + format->extension();
+        const fs::path archivePath = tempDir.path() / archiveName;
+        {
+            const BitFileCompressor compressor{ lib, *format };
+            compressor.compress( { BIT7Z_STRING( "old.txt" ) }, path_to_tstring( archivePath ) );
+        }
+        const auto originalArchive = load_file( archivePath );
+        const auto originalEntriesSize = entries_size( originalArchive, *format );
+        REQUIRE( originalEntriesSize > 0 );
+        REQUIRE( originalEntriesSize < originalArchive.size() );
+
+        write_file( inDir / "new.txt", "The content of the file appended to the archive." );
+        bool isAppendedInPlace = true;
+        SECTION( "Appending in place using a BitFileCompressor" ) {
+            BitFileCompressor compressor{ lib, *format };
+            compressor.setUpdateMode( UpdateMode::Append );
+            compressor.compress( { BIT7Z_STRING( "new.txt" ) }, path_to_tstring( archivePath ) );
+        }
+
+        SECTION( "Appending in place using a BitArchiveWriter" ) {
+            BitArchiveWriter writer{ lib, path_to_tstring( archivePath ), *format };
+            writer.addFile( BIT7Z_STRING( "new.txt" ) );
+            writer.compressTo( path_to_tstring( archivePath ) );
+        }
+
+        SECTION( "Falling back to rewriting the whole archive" ) {
+            // Note: the output mirror needs the whole archive, so it cannot be appended in place.
+            buffer_t mirror;
+            BitArchiveWriter writer{ lib, path_to_tstring( archivePath ), *format };
+            writer.addOutputMirror( mirror );
+            writer.addFile( BIT7Z_STRING( "new.txt" ) );
+            writer.compressTo( path_to_tstring( archivePath ) );
+            REQUIRE( mirror == load_file( archivePath ) );
+            isAppendedInPlace = false;
+        }
+
+        const auto updatedArchive = load_file( archivePath );
+        if ( isAppendedInPlace ) {
+            // The existing entries are left byte for byte as they were.
+            REQUIRE( updatedArchive.size() > originalEntriesSize );
+            REQUIRE( std::equal( originalArchive.cbegin(),
+                                 originalArchive.cbegin() + static_cast< std::ptrdiff_t >( originalEntriesSize ),
+                                 updatedArchive.cbegin() ) );
+        }
+
+        const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), *format };
+        REQUIRE( reader.itemsCount() == 2 );
+        std::map< tstring, buffer_t > content;
+        reader.extractTo( content );
+        const std::map< tstring, buffer_t > expected{
+            { BIT7Z_STRING( "old.txt" ), to_buffer( "The content of the file already in the archive." ) },
+            { BIT7Z_STRING( "new.txt" ), to_buffer( "The content of the file appended to the archive." ) }
+        };
+        REQUIRE( content == expected );
+
+        // No temporary file (e.g., the archive of the new items, or the journal of the append) is left.
+        std::set< tstring > fileNames;
+        for ( const auto& entry : fs::directory_iterator{ tempDir.path() } ) {
+            fileNames.insert( path_to_tstring( entry.path().filename() ) );
+        }
+        REQUIRE( fileNames == std::set< tstring >{ BIT7Z_STRING( "input" ), archiveName } );
+    }
+}
+
+TEST_CASE( "BitArchiveWriter: Mirroring and hashing the archive while writing it", "[bitarchivewriter]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitarchivewriter" };
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const std::vector< DigestType > digestTypes{ DigestType::Crc32, DigestType::Sha1, DigestType::Sha256 };
+    const BitHasher hasher{ lib, digestTypes };
+
+    // Note: 7z and zip archives patch the headers written at the end of the compression, while tar ones don't.
+    const auto* format = GENERATE( as< const BitInOutFormat* >(),
+                                   &BitFormat::SevenZip, &BitFormat::Zip, &BitFormat::Tar );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        BitArchiveWriter writer{ lib, *format };
+        writer.addFile( to_buffer( "The content of the first file." ), BIT7Z_STRING( "first.txt" ) );
+        writer.addFile( to_buffer( std::string( 100000, 'x' ) ), BIT7Z_STRING( "second.txt" ) );
+
+        buffer_t mirror{ 'o', 'l', 'd' }; // The previous content of the mirror is discarded.
+        const fs::path mirrorPath = tempDir.path() / "mirror.bin";
+        writer.addOutputMirror( mirror );
+        writer.addOutputMirror( path_to_tstring( mirrorPath ) );
+        writer.setArchiveDigestTypes( digestTypes );
+
+        buffer_t archive;
+        SECTION( "Compressing to a file" ) {
+            const fs::path archivePath = tempDir.path() / "archive.bin";
+            writer.compressTo( path_to_tstring( archivePath ) );
+            archive = load_file( archivePath );
+        }
+
+        SECTION( "Compressing to a buffer" ) {
+            writer.compressTo( archive );
+        }
+
+        SECTION( "Compressing to a stream" ) {
+            std::stringstream outStream;
+            writer.compressTo( outStream );
+            const auto outString = outStream.str();
+            archive.assign( outString.cbegin(), outString.cend() );
+        }
+
+        REQUIRE_FALSE( archive.empty() );
+        REQUIRE( mirror == archive );
+        REQUIRE( load_file( mirrorPath ) == archive );
+        REQUIRE( writer.archiveDigests() == hasher.hashBuffer( archive ) );
+
+        // Each compression produces a new copy of the archive, and its digests.
+        writer.clearOutputMirrors();
+        writer.addFile( to_buffer( "The content of the third file." ), BIT7Z_STRING( "third.txt" ) );
+        buffer_t newArchive;
+        writer.compressTo( newArchive );
+        REQUIRE( mirror == archive );
+        REQUIRE( writer.archiveDigests() == hasher.hashBuffer( newArchive ) );
+        REQUIRE( writer.archiveDigests() != hasher.hashBuffer( archive ) );
+    }
+}
+
+#endif
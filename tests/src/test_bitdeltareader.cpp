@@ -0,0 +1,201 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitdeltacompressor.hpp>
+#include <bit7z/bitdeltareader.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitfilecompressor.hpp>
+#include <bit7z/bitformat.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <algorithm>
+#include <map>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+using bit7z::test::to_buffer;
+using bit7z::test::write_file;
+
+namespace {
+using FilesContent = std::map< tstring, buffer_t >;
+
+// The paths of the items of the given archive.
+auto archive_paths( const Bit7zLibrary& lib, const fs::path& archivePath, const BitInFormat& format )
+    -> std::vector< tstring > {
+    const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), format };
+    std::vector< tstring > result;
+    for ( const auto& item : reader.items() ) {
+        result.push_back( item.path() );
+    }
+    std::sort( result.begin(), result.end() );
+    return result;
+}
+} // namespace
+
+TEST_CASE( "BitDeltaReader: Reading a chain of delta archives", "[bitdeltareader]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitdeltareader" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+
+    FilesContent expected;
+    const auto setFile = [ & ]( const tstring& name, const std::string& content ) {
+        write_file( inDir / name, content );
+        expected[ name ] = to_buffer( content );
+    };
+    setFile( BIT7Z_STRING( "a.txt" ), "The first version of the a.txt file." );
+    setFile( BIT7Z_STRING( "b.txt" ), "The first version of the b.txt file." );
+    setFile( BIT7Z_STRING( "c.txt" ), "The c.txt file, which will be deleted." );
+    for ( const auto& file : expected ) {
+        fs::last_write_time( inDir / file.first, past_file_time() );
+    }
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::SevenZip, &BitFormat::Zip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TestDirectory testDir{ inDir };
+        const auto archivePath = [ & ]( const tchar* name ) -> tstring {
+            return path_to_tstring( tempDir.path() / ( tstring{ name } + format->extension() ) );
+        };
+        const tstring basePath = archivePath( BIT7Z_STRING( "base" ) );
+        const tstring firstDeltaPath = archivePath( BIT7Z_STRING( "delta1" ) );
+        const tstring secondDeltaPath = archivePath( BIT7Z_STRING( "delta2" ) );
+
+        const BitFileCompressor compressor{ lib, *format };
+        compressor.compress( { BIT7Z_STRING( "a.txt" ), BIT7Z_STRING( "b.txt" ), BIT7Z_STRING( "c.txt" ) },
+                             basePath );
+        const FilesContent baseContent = expected;
+
+        // First delta: b.txt is changed, c.txt is deleted, and d.txt is new.
+        setFile( BIT7Z_STRING( "b.txt" ), "The second version of the b.txt file." );
+        setFile( BIT7Z_STRING( "d.txt" ), "The new d.txt file." );
+        expected.erase( BIT7Z_STRING( "c.txt" ) );
+        const std::vector< tstring > inPaths{ BIT7Z_STRING( "a.txt" ),
+                                              BIT7Z_STRING( "b.txt" ),
+                                              BIT7Z_STRING( "d.txt" ) };
+        const BitDeltaCompressor deltaCompressor{ lib, *format };
+        deltaCompressor.compressDelta( { basePath }, inPaths, firstDeltaPath );
+        const FilesContent firstDeltaContent = expected;
+
+        // The delta archive contains only the changed files, plus the manifest of the unchanged ones.
+        REQUIRE( archive_paths( lib, firstDeltaPath, *format ) ==
+                 std::vector< tstring >{ BIT7Z_STRING( ".bit7z-delta" ), BIT7Z_STRING( "b.txt" ),
+                                         BIT7Z_STRING( "d.txt" ) } );
+
+        // Second delta: a.txt is changed, while b.txt and d.txt are read from the first delta.
+        setFile( BIT7Z_STRING( "a.txt" ), "The second version of the a.txt file." );
+        deltaCompressor.compressDelta( { basePath, firstDeltaPath }, inPaths, secondDeltaPath );
+        REQUIRE( archive_paths( lib, secondDeltaPath, *format ) ==
+                 std::vector< tstring >{ BIT7Z_STRING( ".bit7z-delta" ), BIT7Z_STRING( "a.txt" ) } );
+
+        SECTION( "Listing the items of the chain" ) {
+            const BitDeltaReader reader{ lib, { basePath, firstDeltaPath, secondDeltaPath }, *format };
+            REQUIRE( reader.itemsCount() == 3 );
+            const auto items = reader.items();
+            REQUIRE( items.size() == 3 );
+            REQUIRE( items[ 0 ].path() == BIT7Z_STRING( "a.txt" ) );
+            REQUIRE( items[ 1 ].path() == BIT7Z_STRING( "b.txt" ) );
+            REQUIRE( items[ 2 ].path() == BIT7Z_STRING( "d.txt" ) );
+            for ( uint32_t index = 0; index < items.size(); ++index ) {
+                REQUIRE( items[ index ].index() == index );
+                REQUIRE( items[ index ].size() == expected[ items[ index ].path() ].size() );
+            }
+
+            REQUIRE( reader.contains( BIT7Z_STRING( "a.txt" ) ) );
+            REQUIRE( reader.contains( BIT7Z_STRING( "d.txt" ) ) );
+            REQUIRE_FALSE( reader.contains( BIT7Z_STRING( "c.txt" ) ) ); // Deleted in the first delta.
+            REQUIRE_FALSE( reader.contains( BIT7Z_STRING( ".bit7z-delta" ) ) );
+        }
+
+        SECTION( "Extracting the items of the chain to a map" ) {
+            const BitDeltaReader reader{ lib, { basePath, firstDeltaPath, secondDeltaPath }, *format };
+            FilesContent content;
+            reader.extractTo( content );
+            REQUIRE( content == expected );
+        }
+
+        SECTION( "Extracting the items of the chain to buffers" ) {
+            const BitDeltaReader reader{ lib, { basePath, firstDeltaPath, secondDeltaPath }, *format };
+            const auto items = reader.items();
+            for ( const auto& item : items ) {
+                buffer_t content;
+                reader.extractTo( content, item.index() );
+                REQUIRE( content == expected[ item.path() ] );
+            }
+
+            buffer_t content;
+            REQUIRE_THROWS_AS( reader.extractTo( content, reader.itemsCount() ), BitException );
+        }
+
+        SECTION( "Extracting the items of the chain to a directory" ) {
+            const BitDeltaReader reader{ lib, { basePath, firstDeltaPath, secondDeltaPath }, *format };
+            const fs::path outDir = tempDir.path() / "output";
+            reader.extractTo( path_to_tstring( outDir ) );
+
+            FilesContent content;
+            for ( const auto& entry : fs::directory_iterator{ outDir } ) {
+                content[ path_to_tstring( entry.path().filename() ) ] = load_file( entry.path() );
+            }
+            REQUIRE( content == expected );
+        }
+
+        SECTION( "Reading the previous states of the chain" ) {
+            const BitDeltaReader baseReader{ lib, { basePath }, *format };
+            FilesContent content;
+            baseReader.extractTo( content );
+            REQUIRE( content == baseContent );
+
+            const BitDeltaReader firstDeltaReader{ lib, { basePath, firstDeltaPath }, *format };
+            content.clear();
+            firstDeltaReader.extractTo( content );
+            REQUIRE( content == firstDeltaContent );
+        }
+
+        SECTION( "Reading invalid chains" ) {
+            // The base archive of a chain cannot be a delta archive.
+            REQUIRE_THROWS_AS( BitDeltaReader( lib, { firstDeltaPath }, *format ), BitException );
+            REQUIRE_THROWS_AS( BitDeltaReader( lib, std::vector< tstring >{}, *format ), BitException );
+        }
+    }
+}
+
+TEST_CASE( "BitDeltaCompressor: Compressing a file with the path of the delta manifest", "[bitdeltacompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitdeltacompressor" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+    write_file( inDir / "file.txt", "The content of the file." );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TestDirectory testDir{ inDir };
+    const tstring basePath = path_to_tstring( tempDir.path() / "base.7z" );
+    const BitFileCompressor compressor{ lib, BitFormat::SevenZip };
+    compressor.compress( { BIT7Z_STRING( "file.txt" ) }, basePath );
+
+    write_file( inDir / ".bit7z-delta", "A file of the user." );
+    const fs::path deltaPath = tempDir.path() / "delta.7z";
+    const BitDeltaCompressor deltaCompressor{ lib, BitFormat::SevenZip };
+    REQUIRE_THROWS_AS( deltaCompressor.compressDelta( { basePath },
+                                                      { BIT7Z_STRING( "file.txt" ), BIT7Z_STRING( ".bit7z-delta" ) },
+                                                      path_to_tstring( deltaPath ) ),
+                       BitException );
+    REQUIRE_FALSE( fs::exists( deltaPath ) );
+}
+
+#endif
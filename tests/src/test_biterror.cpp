@@ -51,7 +51,8 @@ TEST_CASE( "BitError: Checking that error values correspond to the correct failu
                                        ERROR_SOURCE( UnsupportedOperation, OperationNotSupported ),
                                        ERROR_SOURCE( UnsupportedVariantType, OperationNotSupported ),
                                        ERROR_SOURCE( WrongUpdateMode, OperationNotPermitted ),
-                                       ERROR_SOURCE( InvalidZipPassword, InvalidArgument ) );
+                                       ERROR_SOURCE( InvalidZipPassword, InvalidArgument ),
+                                       ERROR_SOURCE( InvalidDeltaChain, InvalidArgument ) );
 
     DYNAMIC_SECTION( errorSource.errorName << " vs " << errorSource.sourceName ) {
         const auto errorCode = make_error_code( errorSource.error );
@@ -59,6 +60,13 @@ TEST_CASE( "BitError: Checking that error values correspond to the correct failu
     }
 }
 
+TEST_CASE( "BitError: Checking that the memory budget error corresponds to the not enough memory condition",
+           "[BitError]" ) {
+    const auto errorCode = make_error_code( BitError::MemoryBudgetExceeded );
+    REQUIRE( errorCode == std::errc::not_enough_memory );
+    REQUIRE( errorCode != BitFailureSource::InvalidArgument );
+}
+
 #ifndef BIT7Z_TESTS_PUBLIC_API_ONLY
 using bit7z::OperationResult;
 
@@ -11,11 +11,23 @@
  */
 #include <catch2/catch.hpp>
 
+#include <bit7z/bitarchiveeditor.hpp>
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
 #include <bit7z/bitfilecompressor.hpp>
 #include <bit7z/bitformat.hpp>
+#include <internal/stringutil.hpp>
 
+#include "utils/archivebuilder.hpp"
 #include "utils/shared_lib.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+
 using namespace bit7z;
 using bit7z::Bit7zLibrary;
 using bit7z::BitFileCompressor;
@@ -25,3 +37,423 @@ TEST_CASE( "BitFileCompressor: TODO", "[bitfilecompressor]" ) {
 
 }
 
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+using namespace bit7z::test::filesystem;
+using bit7z::test::to_buffer;
+using bit7z::test::write_file;
+
+namespace {
+auto compress_and_extract( const Bit7zLibrary& lib,
+                           const BitInOutFormat& format,
+                           uint64_t readAheadBudget,
+                           uint32_t readAheadThreads ) -> std::map< tstring, buffer_t > {
+    BitFileCompressor compressor{ lib, format };
+    compressor.setReadAheadBudget( readAheadBudget );
+    compressor.setReadAheadThreads( readAheadThreads );
+
+    const std::vector< tstring > inPaths{ italy.name, lorem_ipsum.name, noext.name, hello_json.name,
+                                          homework.name, clouds.name, folder.name };
+    std::stringstream outStream;
+    compressor.compress( inPaths, outStream );
+
+    const auto archive = outStream.str();
+    const buffer_t archiveBuffer{ archive.cbegin(), archive.cend() };
+    const BitArchiveReader reader{ lib, archiveBuffer, format };
+    std::map< tstring, buffer_t > result;
+    reader.extractTo( result );
+    return result;
+}
+
+auto archive_content( const Bit7zLibrary& lib, const fs::path& archivePath, const BitInOutFormat& format )
+    -> std::map< tstring, buffer_t > {
+    const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), format };
+    std::map< tstring, buffer_t > result;
+    reader.extractTo( result );
+    return result;
+}
+} // namespace
+
+TEST_CASE( "BitFileCompressor: Compressing with the read-ahead of the input files", "[bitfilecompressor]" ) {
+    const TestDirectory testDir{ test_filesystem_dir };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::SevenZip, &BitFormat::Zip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const auto expected = compress_and_extract( lib, *format, 0, 0 );
+        REQUIRE( expected.at( italy.name ).size() == italy.size );
+        REQUIRE( expected.at( clouds.name ).size() == clouds.size );
+
+        // A budget of 256 KiB allows prefetching only the items up to 64 KiB: the other ones are read synchronously.
+        constexpr uint64_t kSmallBudget = 256 * 1024;
+        REQUIRE( clouds.size > kSmallBudget / 4 );
+        REQUIRE( compress_and_extract( lib, *format, kSmallBudget, 1 ) == expected );
+        REQUIRE( compress_and_extract( lib, *format, kSmallBudget, 4 ) == expected );
+
+        // A budget smaller than any item disables the prefetching.
+        REQUIRE( compress_and_extract( lib, *format, 16, 2 ) == expected );
+
+        // A budget big enough to prefetch all the items.
+        REQUIRE( compress_and_extract( lib, *format, 64 * 1024 * 1024, 0 ) == expected );
+    }
+}
+
+TEST_CASE( "BitFileCompressor: Deduplicating the content of the files", "[bitfilecompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_deduplication" };
+    const fs::path& inDir = tempDir.path();
+    REQUIRE( fs::create_directories( inDir / "folder" ) );
+
+    std::string duplicateContent;
+    for ( int line = 0; line < 1000; ++line ) {
+        duplicateContent += "The same line, repeated in many files: " + std::to_string( line ) + "\n";
+    }
+    const std::string otherContent = "A file with a different content.";
+    write_file( inDir / "first.txt", duplicateContent );
+    write_file( inDir / "other.txt", otherContent );
+    write_file( inDir / "folder" / "second.txt", duplicateContent );
+    write_file( inDir / "folder" / "third.txt", duplicateContent );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    /* Tar archives store the duplicates as hard links (if supported by the 7-Zip library),
+     * which must be extracted with the content of the file they refer to. */
+    const auto* format = GENERATE( as< const BitInOutFormat* >(),
+                                   &BitFormat::Tar, &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        std::stringstream outStream;
+        {
+            const TestDirectory testDir{ inDir };
+            BitFileCompressor compressor{ lib, *format };
+            compressor.setDeduplicateContent( true );
+            compressor.compress( std::vector< tstring >{ BIT7Z_STRING( "first.txt" ),
+                                                         BIT7Z_STRING( "other.txt" ),
+                                                         BIT7Z_STRING( "folder" ) }, outStream );
+        }
+        const auto archive = outStream.str();
+        const buffer_t archiveBuffer{ archive.cbegin(), archive.cend() };
+        const BitArchiveReader reader{ lib, archiveBuffer, *format };
+
+        const buffer_t expectedDuplicate{ duplicateContent.cbegin(), duplicateContent.cend() };
+        const buffer_t expectedOther{ otherContent.cbegin(), otherContent.cend() };
+        const std::map< fs::path, buffer_t > expected{
+            { fs::path{ "first.txt" }, expectedDuplicate },
+            { fs::path{ "other.txt" }, expectedOther },
+            { fs::path{ "folder" } / "second.txt", expectedDuplicate },
+            { fs::path{ "folder" } / "third.txt", expectedDuplicate }
+        };
+
+        SECTION( "Extracting to memory" ) {
+            std::map< tstring, buffer_t > extracted;
+            reader.extractTo( extracted );
+
+            std::map< fs::path, buffer_t > result;
+            for ( auto& file : extracted ) {
+                result.emplace( fs::path{ file.first }, std::move( file.second ) );
+            }
+            REQUIRE( result == expected );
+        }
+
+        SECTION( "Extracting to the filesystem" ) {
+            const fs::path outDir = inDir / "extracted";
+            reader.extractTo( outDir.string< tchar >() );
+            for ( const auto& file : expected ) {
+                REQUIRE( load_file( outDir / file.first ) == file.second );
+            }
+        }
+
+        SECTION( "Extracting single items" ) {
+            for ( const auto& item : reader.items() ) {
+                if ( item.isDir() ) {
+                    continue;
+                }
+                buffer_t content;
+                reader.extractTo( content, item.index() );
+                REQUIRE( content == expected.at( fs::path{ item.path() } ) );
+            }
+        }
+    }
+}
+
+TEST_CASE( "BitFileCompressor: Deduplicating the content of the files in solid 7z archives",
+           "[bitfilecompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_solid_deduplication" };
+    const fs::path& inDir = tempDir.path();
+    REQUIRE( fs::create_directories( inDir / "first" ) );
+    REQUIRE( fs::create_directories( inDir / "second" ) );
+
+    // Incompressible content, so that only the deduplication can reduce the size of the archive.
+    constexpr std::size_t kFileSize = 256 * 1024;
+    std::mt19937 randomEngine{ 42 }; // NOLINT(*-msc51-cpp)
+    const auto randomContent = [ &randomEngine ]() -> std::string {
+        std::string content( kFileSize, '\0' );
+        for ( auto& character : content ) {
+            character = static_cast< char >( randomEngine() );
+        }
+        return content;
+    };
+    const std::string duplicateContent = randomContent();
+    write_file( inDir / "first" / "data.bin", duplicateContent );
+    write_file( inDir / "second" / "data.bin", duplicateContent );
+    write_file( inDir / "first" / "other.bin", randomContent() );
+    write_file( inDir / "second" / "other.bin", randomContent() );
+
+    /* With two files per solid block, the copies of data.bin end up in the same block only if sorted by name:
+     * 7-Zip would otherwise sort the files by path (i.e., first/data.bin, first/other.bin, second/data.bin, ...). */
+    SolidOptions solidOptions;
+    solidOptions.maxBlockFiles = 2;
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto compressFiles = [ & ]( bool deduplicate ) -> buffer_t {
+        const TestDirectory testDir{ inDir };
+        BitArchiveWriter writer{ lib, BitFormat::SevenZip };
+        writer.setSolidMode( true );
+        writer.setSolidOptions( solidOptions );
+        writer.setDeduplicateContent( deduplicate );
+        writer.addItems( std::vector< tstring >{ BIT7Z_STRING( "first" ), BIT7Z_STRING( "second" ) } );
+        buffer_t archive;
+        writer.compressTo( archive );
+
+        if ( deduplicate ) {
+            REQUIRE( writer.duplicateSets().size() == 1 );
+            REQUIRE( writer.duplicateSets()[ 0 ].size == kFileSize );
+            REQUIRE( writer.duplicateSets()[ 0 ].paths.size() == 2 );
+        } else {
+            REQUIRE( writer.duplicateSets().empty() );
+        }
+        return archive;
+    };
+
+    const auto plainArchive = compressFiles( false );
+    const auto deduplicatedArchive = compressFiles( true );
+    REQUIRE( plainArchive.size() > 4 * kFileSize );
+    REQUIRE( deduplicatedArchive.size() + ( kFileSize / 2 ) < plainArchive.size() );
+
+    const BitArchiveReader reader{ lib, deduplicatedArchive, BitFormat::SevenZip };
+    std::map< tstring, buffer_t > extracted;
+    reader.extractTo( extracted );
+    const buffer_t expectedDuplicate{ duplicateContent.cbegin(), duplicateContent.cend() };
+    REQUIRE( extracted.size() == 4 );
+    for ( const auto& file : extracted ) {
+        if ( fs::path{ file.first }.filename() == "data.bin" ) {
+            REQUIRE( file.second == expectedDuplicate );
+        }
+    }
+}
+
+TEST_CASE( "BitFileCompressor: Synchronizing an archive with the input files", "[bitfilecompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_sync" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+
+    const auto fileTime = past_file_time();
+    std::map< tstring, buffer_t > expected;
+    const auto setFile = [ & ]( const tstring& name, const std::string& content ) {
+        write_file( inDir / name, content );
+        fs::last_write_time( inDir / name, fileTime );
+        expected[ name ] = to_buffer( content );
+    };
+    setFile( BIT7Z_STRING( "first.txt" ), "The content of the first file." );
+    setFile( BIT7Z_STRING( "second.txt" ), "The content of the second file." );
+    setFile( BIT7Z_STRING( "third.txt" ), "The content of the third file." );
+    const std::vector< tstring > inPaths{ BIT7Z_STRING( "first.txt" ),
+                                          BIT7Z_STRING( "second.txt" ),
+                                          BIT7Z_STRING( "third.txt" ) };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::SevenZip, &BitFormat::Zip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const fs::path archivePath = tempDir.path() / ( tstring{ BIT7Z_STRING( "archive" ) } + format->extension() );
+        const TestDirectory testDir{ inDir };
+        {
+            const BitFileCompressor compressor{ lib, *format };
+            compressor.compress( inPaths, path_to_tstring( archivePath ) );
+        }
+        REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+
+        // The files compressed by the synchronization.
+        std::vector< tstring > compressedFiles;
+        BitFileCompressor compressor{ lib, *format };
+        compressor.setUpdateMode( UpdateMode::Sync );
+        compressor.setFileCallback( [ &compressedFiles ]( const tstring& filePath ) {
+            compressedFiles.push_back( filePath );
+        } );
+        const auto syncArchive = [ & ]( const std::vector< tstring >& syncedPaths ) {
+            compressor.compress( syncedPaths, path_to_tstring( archivePath ) );
+        };
+
+        SECTION( "An archive already in sync is left untouched" ) {
+            const auto archiveData = load_file( archivePath );
+            const auto archiveTime = fs::last_write_time( archivePath );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles.empty() );
+            REQUIRE( load_file( archivePath ) == archiveData );
+            REQUIRE( fs::last_write_time( archivePath ) == archiveTime );
+        }
+
+        SECTION( "Only the changed files are compressed" ) {
+            write_file( inDir / "second.txt", "The second file was changed." );
+            expected[ BIT7Z_STRING( "second.txt" ) ] = to_buffer( "The second file was changed." );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles == std::vector< tstring >{ BIT7Z_STRING( "second.txt" ) } );
+            REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+        }
+
+        SECTION( "Keeping or removing the old items of the missing files" ) {
+            const std::vector< tstring > syncedPaths{ BIT7Z_STRING( "first.txt" ), BIT7Z_STRING( "third.txt" ) };
+            syncArchive( syncedPaths );
+            REQUIRE( compressedFiles.empty() );
+            REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+
+            SyncOptions options;
+            options.removeMissing = true;
+            compressor.setSyncOptions( options );
+            syncArchive( syncedPaths );
+            REQUIRE( compressedFiles.empty() );
+            expected.erase( BIT7Z_STRING( "second.txt" ) );
+            REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+        }
+
+        SECTION( "Comparing the content of files edited without changing the size and modification time" ) {
+            setFile( BIT7Z_STRING( "third.txt" ), "The content of the 3rd file!!" );
+            REQUIRE( expected[ BIT7Z_STRING( "third.txt" ) ].size() == expected[ BIT7Z_STRING( "first.txt" ) ].size() );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles.empty() ); // The edit cannot be detected without comparing the content.
+
+            SyncOptions options;
+            options.compareContent = true;
+            compressor.setSyncOptions( options );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles == std::vector< tstring >{ BIT7Z_STRING( "third.txt" ) } );
+            REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+        }
+
+        SECTION( "Comparing the content of files touched without changing their content" ) {
+            fs::last_write_time( inDir / "first.txt", fileTime + std::chrono::hours{ 1 } );
+            SyncOptions options;
+            options.compareContent = true;
+            compressor.setSyncOptions( options );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles.empty() );
+
+            compressor.setSyncOptions( SyncOptions{} );
+            syncArchive( inPaths );
+            REQUIRE( compressedFiles == std::vector< tstring >{ BIT7Z_STRING( "first.txt" ) } );
+        }
+    }
+}
+
+TEST_CASE( "BitFileCompressor: Synchronizing a 7z archive storing sub-second modification times",
+           "[bitfilecompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_sync_subsecond" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+    write_file( inDir / "file.txt", "The content of the file." );
+    fs::last_write_time( inDir / "file.txt", past_file_time() );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TestDirectory testDir{ inDir };
+    const std::vector< tstring > inPaths{ BIT7Z_STRING( "file.txt" ) };
+    const tstring archivePath = path_to_tstring( tempDir.path() / "archive.7z" );
+    {
+        const BitFileCompressor compressor{ lib, BitFormat::SevenZip };
+        compressor.compress( inPaths, archivePath );
+    }
+    {
+        // E.g., as if the archive was created on Windows, or by 7-Zip (reading the times with sub-second precision).
+        const BitArchiveReader reader{ lib, archivePath, BitFormat::SevenZip };
+        const auto itemTime = reader.items().front().lastWriteTime();
+        BitArchiveEditor editor{ lib, archivePath, BitFormat::SevenZip };
+        editor.setItemLastWriteTime( BIT7Z_STRING( "file.txt" ), itemTime + std::chrono::milliseconds{ 500 } );
+        editor.applyChanges();
+    }
+
+    std::vector< tstring > compressedFiles;
+    BitFileCompressor compressor{ lib, BitFormat::SevenZip };
+    compressor.setUpdateMode( UpdateMode::Sync );
+    compressor.setFileCallback( [ &compressedFiles ]( const tstring& filePath ) {
+        compressedFiles.push_back( filePath );
+    } );
+    compressor.compress( inPaths, archivePath );
+    REQUIRE( compressedFiles.empty() );
+}
+
+TEST_CASE( "BitFileCompressor: Storing the incompressible files", "[bitfilecompressor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_store_incompressible" };
+    const fs::path inDir = tempDir.path() / "input";
+    REQUIRE( fs::create_directory( inDir ) );
+
+    std::mt19937 randomEngine{ 42 }; // NOLINT(*-msc51-cpp)
+    std::string randomContent( 64 * 1024, '\0' );
+    for ( auto& character : randomContent ) {
+        character = static_cast< char >( randomEngine() );
+    }
+    // Detected as incompressible by the entropy of its content.
+    write_file( inDir / "random.bin", randomContent );
+    // Detected as incompressible by its extension (even if its content is compressible).
+    write_file( inDir / "image.jpg", std::string( 16 * 1024, 'j' ) );
+    // Compressible files (the second one is too small to be analyzed).
+    write_file( inDir / "text.txt", std::string( 100 * 1024, 't' ) );
+    write_file( inDir / "small.bin", randomContent.substr( 0, 1024 ) );
+
+    const std::map< tstring, buffer_t > expected{
+        { BIT7Z_STRING( "image.jpg" ), to_buffer( std::string( 16 * 1024, 'j' ) ) },
+        { BIT7Z_STRING( "random.bin" ), to_buffer( randomContent ) },
+        { BIT7Z_STRING( "small.bin" ), to_buffer( randomContent.substr( 0, 1024 ) ) },
+        { BIT7Z_STRING( "text.txt" ), to_buffer( std::string( 100 * 1024, 't' ) ) }
+    };
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::SevenZip, &BitFormat::Zip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const TestDirectory testDir{ inDir };
+        const std::vector< tstring > inPaths{ BIT7Z_STRING( "image.jpg" ), BIT7Z_STRING( "random.bin" ),
+                                              BIT7Z_STRING( "small.bin" ), BIT7Z_STRING( "text.txt" ) };
+        const fs::path archivePath = tempDir.path() / ( tstring{ BIT7Z_STRING( "archive" ) } + format->extension() );
+
+        SECTION( "Compressing to an archive file" ) {
+            // Note: the stored files are appended in place to zip archive files.
+            BitFileCompressor compressor{ lib, *format };
+            compressor.setCompressionPolicy( CompressionPolicy::StoreIncompressible );
+            compressor.compress( inPaths, path_to_tstring( archivePath ) );
+        }
+
+        SECTION( "Compressing to a mirrored archive file" ) {
+            // The output mirror needs the whole archive, so the second pass rewrites it.
+            buffer_t mirror;
+            BitArchiveWriter writer{ lib, *format };
+            writer.setCompressionPolicy( CompressionPolicy::StoreIncompressible );
+            writer.addOutputMirror( mirror );
+            writer.addFiles( inPaths );
+            writer.compressTo( path_to_tstring( archivePath ) );
+            REQUIRE( mirror == load_file( archivePath ) );
+        }
+
+        // The incompressible files are the last items, stored using the Copy method.
+        const tstring storeMethod = *format == BitFormat::Zip ? BIT7Z_STRING( "Store" ) : BIT7Z_STRING( "Copy" );
+        const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), *format };
+        std::vector< tstring > storedPaths;
+        std::vector< tstring > compressedPaths;
+        for ( const auto& item : reader.items() ) {
+            const auto method = reader.itemProperty( item.index(), BitProperty::Method ).getString();
+            if ( method == storeMethod ) {
+                storedPaths.push_back( item.path() );
+            } else {
+                REQUIRE( storedPaths.empty() );
+                compressedPaths.push_back( item.path() );
+            }
+        }
+        std::sort( storedPaths.begin(), storedPaths.end() );
+        std::sort( compressedPaths.begin(), compressedPaths.end() );
+        REQUIRE( storedPaths == std::vector< tstring >{ BIT7Z_STRING( "image.jpg" ), BIT7Z_STRING( "random.bin" ) } );
+        REQUIRE( compressedPaths == std::vector< tstring >{ BIT7Z_STRING( "small.bin" ), BIT7Z_STRING( "text.txt" ) } );
+
+        REQUIRE( archive_content( lib, archivePath, *format ) == expected );
+
+        // The temporary files of the second pass are removed.
+        REQUIRE( std::distance( fs::directory_iterator{ tempDir.path() }, fs::directory_iterator{} ) == 2 );
+    }
+}
+
+#endif
@@ -23,4 +23,346 @@ TEST_CASE( "BitFileExtractor: TODO", "[bitfileextractor]" ) {
 
     const BitFileExtractor extractor{lib, BitFormat::SevenZip};
     REQUIRE( extractor.extractionFormat() == BitFormat::SevenZip ); // Just a placeholder test.
-}
\ No newline at end of file
+}
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+
+#include <bit7z/bitarchivereader.hpp>
+#include <bit7z/bitarchivewriter.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bitfilecompressor.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace bit7z::test::filesystem;
+using bit7z::test::to_buffer;
+
+namespace {
+void write_file( const fs::path& filePath, const std::string& content, fs::file_time_type modifiedTime ) {
+    bit7z::test::write_file( filePath, content );
+    fs::last_write_time( filePath, modifiedTime );
+}
+
+// Compresses the given files of the input directory into the archive at the given path.
+void compress_files( const Bit7zLibrary& lib,
+                     const BitInOutFormat& format,
+                     const fs::path& inDir,
+                     const std::vector< tstring >& inPaths,
+                     const fs::path& archivePath ) {
+    const TestDirectory testDir{ inDir };
+    const BitFileCompressor compressor{ lib, format };
+    compressor.compress( inPaths, archivePath.string< tchar >() );
+}
+} // namespace
+
+TEST_CASE( "BitFileExtractor: Extracting only the outdated files", "[bitfileextractor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitfileextractor" };
+    const fs::path& testDir = tempDir.path();
+    REQUIRE( fs::create_directories( testDir / "input" ) );
+
+    const auto itemTime = past_file_time();
+    const auto newerTime = itemTime + std::chrono::hours{ 24 };
+    const auto olderTime = itemTime - std::chrono::hours{ 24 };
+    const std::map< std::string, std::string > files{
+        { "modified.txt", "The original content." },
+        { "older.txt", "The original content of an older file." },
+        { "newer.txt", "The original content of a newer file." },
+        { "touched.txt", "The original content of a touched file." },
+        { "missing.txt", "The original content of a missing file." }
+    };
+    std::vector< tstring > inPaths;
+    for ( const auto& file : files ) {
+        write_file( testDir / "input" / file.first, file.second, itemTime );
+        inPaths.push_back( fs::path{ file.first }.string< tchar >() );
+    }
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const fs::path archivePath = testDir / ( tstring{ BIT7Z_STRING( "archive" ) } + format->extension() );
+        compress_files( lib, *format, testDir / "input", inPaths, archivePath );
+
+        const fs::path outDir = testDir / "output";
+        BitFileExtractor extractor{ lib, *format };
+        extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+
+        // Same size and modified time of the item, but different content: only a CRC could tell them apart.
+        const std::string modifiedContent = "A modified content!!.";
+        REQUIRE( modifiedContent.size() == files.at( "modified.txt" ).size() );
+        write_file( outDir / "modified.txt", modifiedContent, itemTime );
+        write_file( outDir / "older.txt", "An older content.", olderTime );
+        write_file( outDir / "newer.txt", "A newer content.", newerTime );
+        write_file( outDir / "touched.txt", files.at( "touched.txt" ), newerTime );
+        fs::remove( outDir / "missing.txt" );
+
+        const auto isOriginal = [ & ]( const std::string& name ) -> bool {
+            return load_file( outDir / name ) == to_buffer( files.at( name ) );
+        };
+        const auto isTouched = [ & ]() -> bool {
+            return fs::last_write_time( outDir / "touched.txt" ) == newerTime;
+        };
+
+        SECTION( "Overwriting only the older files" ) {
+            extractor.setOverwriteMode( OverwriteMode::IfNewer );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / "modified.txt" ) == to_buffer( modifiedContent ) );
+            REQUIRE( isOriginal( "older.txt" ) );
+            REQUIRE( load_file( outDir / "newer.txt" ) == to_buffer( "A newer content." ) );
+            REQUIRE( isTouched() );
+            REQUIRE( isOriginal( "missing.txt" ) );
+        }
+
+        SECTION( "Overwriting only the files with a different size or modified time" ) {
+            extractor.setOverwriteMode( OverwriteMode::IfDifferent );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / "modified.txt" ) == to_buffer( modifiedContent ) );
+            REQUIRE( isOriginal( "older.txt" ) );
+            REQUIRE( isOriginal( "newer.txt" ) );
+            REQUIRE( isOriginal( "touched.txt" ) );
+            REQUIRE_FALSE( isTouched() );
+            REQUIRE( isOriginal( "missing.txt" ) );
+        }
+
+        SECTION( "Overwriting only the files with a different size or CRC" ) {
+            extractor.setOverwriteMode( OverwriteMode::IfDifferentContent );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / "modified.txt" ) == to_buffer( modifiedContent ) );
+            REQUIRE( isOriginal( "older.txt" ) );
+            REQUIRE( isOriginal( "newer.txt" ) );
+            REQUIRE( isOriginal( "touched.txt" ) );
+            REQUIRE( isTouched() ); // Only the modified time differs, and the CRC matches the item's one.
+            REQUIRE( isOriginal( "missing.txt" ) );
+        }
+
+        SECTION( "Skipping all the files when they are up to date" ) {
+            extractor.setOverwriteMode( OverwriteMode::Overwrite );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            extractor.setOverwriteMode( OverwriteMode::IfDifferent );
+            REQUIRE_NOTHROW( extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() ) );
+            for ( const auto& file : files ) {
+                REQUIRE( isOriginal( file.first ) );
+            }
+        }
+    }
+}
+
+TEST_CASE( "BitFileExtractor: Extracting the duplicate items only once", "[bitfileextractor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitfileextractor" };
+    const fs::path& testDir = tempDir.path();
+    REQUIRE( fs::create_directories( testDir / "input" / "folder" ) );
+
+    // Note: the duplicates have the same modified time, otherwise they could not be hard linked.
+    const auto itemTime = past_file_time();
+    std::string duplicateContent;
+    for ( int line = 0; line < 100; ++line ) {
+        duplicateContent += "The same line, repeated in many files: " + std::to_string( line ) + "\n";
+    }
+    const std::string otherContent = "A file with a different content.";
+    const std::vector< fs::path > duplicates{ fs::path{ "first.txt" },
+                                              fs::path{ "folder" } / "second.txt",
+                                              fs::path{ "folder" } / "third.txt" };
+    for ( const auto& duplicate : duplicates ) {
+        write_file( testDir / "input" / duplicate, duplicateContent, itemTime );
+    }
+    write_file( testDir / "input" / "other.txt", otherContent, itemTime );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    // Note: the duplicates are found through the CRC of the items, so tar archives are not tested.
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const fs::path archivePath = testDir / ( tstring{ BIT7Z_STRING( "archive" ) } + format->extension() );
+        compress_files( lib,
+                        *format,
+                        testDir / "input",
+                        { BIT7Z_STRING( "first.txt" ), BIT7Z_STRING( "folder" ), BIT7Z_STRING( "other.txt" ) },
+                        archivePath );
+
+        const fs::path outDir = testDir / "output";
+        BitFileExtractor extractor{ lib, *format };
+        const auto checkContent = [ & ]() {
+            for ( const auto& duplicate : duplicates ) {
+                REQUIRE( load_file( outDir / duplicate ) == to_buffer( duplicateContent ) );
+            }
+            REQUIRE( load_file( outDir / "other.txt" ) == to_buffer( otherContent ) );
+        };
+
+        SECTION( "Creating the duplicates as hard links" ) {
+            extractor.setDuplicateItemsMode( DuplicateItemsMode::HardLink );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            checkContent();
+            for ( const auto& duplicate : duplicates ) {
+                REQUIRE( fs::hard_link_count( outDir / duplicate ) == duplicates.size() );
+                REQUIRE( fs::equivalent( outDir / duplicate, outDir / duplicates.front() ) );
+            }
+            REQUIRE( fs::hard_link_count( outDir / "other.txt" ) == 1 );
+        }
+
+        SECTION( "Creating the duplicates as reflinks" ) {
+            extractor.setDuplicateItemsMode( DuplicateItemsMode::Reflink );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            checkContent();
+
+            // The clones (or copies, if the filesystem doesn't support reflinks) are distinct files.
+            for ( const auto& duplicate : duplicates ) {
+                REQUIRE( fs::hard_link_count( outDir / duplicate ) == 1 );
+                REQUIRE( fs::last_write_time( outDir / duplicate ) == itemTime );
+            }
+        }
+
+        SECTION( "Extracting the duplicates on their own when the first one is skipped" ) {
+            // The first item of the set of duplicates is the one with the lowest index.
+            const BitArchiveReader reader{ lib, archivePath.string< tchar >(), *format };
+            fs::path firstDuplicate;
+            for ( const auto& item : reader.items() ) {
+                const fs::path itemPath{ item.path() };
+                if ( std::find( duplicates.cbegin(), duplicates.cend(), itemPath ) != duplicates.cend() ) {
+                    firstDuplicate = itemPath;
+                    break;
+                }
+            }
+            REQUIRE_FALSE( firstDuplicate.empty() );
+
+            const std::string existingContent = "An existing file, which must not be overwritten.";
+            REQUIRE( fs::create_directories( ( outDir / firstDuplicate ).parent_path() ) );
+            write_file( outDir / firstDuplicate, existingContent, itemTime );
+
+            extractor.setOverwriteMode( OverwriteMode::Skip );
+            extractor.setDuplicateItemsMode( DuplicateItemsMode::HardLink );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / firstDuplicate ) == to_buffer( existingContent ) );
+            for ( const auto& duplicate : duplicates ) {
+                if ( duplicate != firstDuplicate ) {
+                    REQUIRE( load_file( outDir / duplicate ) == to_buffer( duplicateContent ) );
+                    REQUIRE_FALSE( fs::equivalent( outDir / duplicate, outDir / firstDuplicate ) );
+                }
+            }
+            REQUIRE( load_file( outDir / "other.txt" ) == to_buffer( otherContent ) );
+        }
+    }
+}
+
+TEST_CASE( "BitFileExtractor: Extracting items with the same path", "[bitfileextractor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitfileextractor" };
+    const fs::path& testDir = tempDir.path();
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    // Note: the files are small enough to be written asynchronously, where supported.
+    const std::string firstContent = "The content of the first item.";
+    const std::string secondContent = "The content of the second item, having the same path.";
+    const fs::path archivePath = testDir / "archive.zip";
+    {
+        BitArchiveWriter writer{ lib, BitFormat::Zip };
+        writer.addFile( to_buffer( firstContent ), BIT7Z_STRING( "file.txt" ) );
+        writer.addFile( to_buffer( secondContent ), BIT7Z_STRING( "file.txt" ) );
+        writer.compressTo( archivePath.string< tchar >() );
+    }
+
+    const auto asyncFileOutput = GENERATE( true, false );
+    DYNAMIC_SECTION( "Asynchronous file output: " << asyncFileOutput ) {
+        const fs::path outDir = testDir / "output";
+        BitFileExtractor extractor{ lib, BitFormat::Zip };
+        extractor.setAsyncFileOutput( asyncFileOutput );
+
+        SECTION( "The last item overwrites the previous one" ) {
+            extractor.setOverwriteMode( OverwriteMode::Overwrite );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / "file.txt" ) == to_buffer( secondContent ) );
+        }
+
+        SECTION( "The last item is skipped" ) {
+            extractor.setOverwriteMode( OverwriteMode::Skip );
+            extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() );
+            REQUIRE( load_file( outDir / "file.txt" ) == to_buffer( firstContent ) );
+        }
+
+        SECTION( "The extraction fails when overwriting is not allowed" ) {
+            extractor.setOverwriteMode( OverwriteMode::None );
+            REQUIRE_THROWS_AS( extractor.extract( archivePath.string< tchar >(), outDir.string< tchar >() ),
+                               BitException );
+        }
+    }
+}
+
+TEST_CASE( "BitFileExtractor: Extracting with the read-ahead hints", "[bitfileextractor]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bitfileextractor" };
+    const fs::path& testDir = tempDir.path();
+    REQUIRE( fs::create_directories( testDir / "input" / "folder" ) );
+
+    std::mt19937 randomEngine{ 42 }; // NOLINT(*-msc51-cpp)
+    std::vector< tstring > inPaths;
+    for ( int file = 0; file < 8; ++file ) {
+        // Some incompressible files, so that the items' data is big enough to be split into several ranges.
+        std::string content( file % 2 == 0 ? 300 * 1024 : 1000, '\0' );
+        for ( auto& character : content ) {
+            character = static_cast< char >( randomEngine() );
+        }
+        const tstring fileName = BIT7Z_STRING( "file" ) + to_tstring( file ) + BIT7Z_STRING( ".bin" );
+        bit7z::test::write_file( testDir / "input" / "folder" / fileName, content );
+    }
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const auto* format = GENERATE( as< const BitInOutFormat* >(),
+                                   &BitFormat::Zip, &BitFormat::Tar, &BitFormat::SevenZip );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const fs::path archivePath = testDir / ( tstring{ BIT7Z_STRING( "archive" ) } + format->extension() );
+        compress_files( lib, *format, testDir / "input", { BIT7Z_STRING( "folder" ) }, archivePath );
+
+        const auto extractAll = [ & ]( uint64_t window ) -> std::map< tstring, buffer_t > {
+            BitFileExtractor extractor{ lib, *format };
+            extractor.setReadAheadWindow( window );
+            std::map< tstring, buffer_t > result;
+            extractor.extract( archivePath.string< tchar >(), result );
+            return result;
+        };
+
+        const auto extractToDir = [ & ]( uint64_t window, const std::vector< uint32_t >& indices ) -> fs::path {
+            const fs::path outDir = testDir / ( "output" + std::to_string( window ) );
+            BitFileExtractor extractor{ lib, *format };
+            extractor.setReadAheadWindow( window );
+            extractor.extractItems( archivePath.string< tchar >(), indices, outDir.string< tchar >() );
+            return outDir;
+        };
+
+        const auto dirContent = []( const fs::path& outDir ) -> std::map< fs::path, buffer_t > {
+            std::map< fs::path, buffer_t > result;
+            for ( const auto& entry : fs::recursive_directory_iterator{ outDir } ) {
+                if ( entry.is_regular_file() ) {
+                    result.emplace( fs::relative( entry.path(), outDir ), load_file( entry.path() ) );
+                }
+            }
+            return result;
+        };
+
+        const auto expected = extractAll( 0 );
+        REQUIRE( expected.size() == 8 );
+
+        const BitArchiveReader reader{ lib, archivePath.string< tchar >(), *format };
+        std::vector< uint32_t > someFiles;
+        for ( const auto& item : reader.items() ) {
+            if ( !item.isDir() && item.index() % 3 != 0 ) {
+                someFiles.push_back( item.index() );
+            }
+        }
+        REQUIRE_FALSE( someFiles.empty() );
+        const auto expectedSomeFiles = dirContent( extractToDir( 0, someFiles ) );
+
+        // Note: the expected results are extracted with a zero window, i.e., without any hint.
+        const auto window = GENERATE( as< uint64_t >(), 1, 64 * 1024, 64 * 1024 * 1024 );
+        DYNAMIC_SECTION( "Read-ahead window: " << window ) {
+            REQUIRE( extractAll( window ) == expected );
+            REQUIRE( dirContent( extractToDir( window, someFiles ) ) == expectedSomeFiles );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <bit7z/bitdigest.hpp>
+#include <bit7z/bitexception.hpp>
+#include <bit7z/bithasher.hpp>
+#include <internal/stringutil.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <map>
+#include <sstream>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+using bit7z::test::write_file;
+
+namespace {
+// The digests of the "123456789" string (checksums are stored in big-endian order).
+auto digits_digests() -> const ItemDigests& {
+    static const ItemDigests kDigests{
+        { DigestType::Crc32, { 0xCB, 0xF4, 0x39, 0x26 } },
+        { DigestType::Crc64, { 0x99, 0x5D, 0xC9, 0xBB, 0xDF, 0x19, 0x39, 0xFA } },
+        { DigestType::Sha1, { 0xF7, 0xC3, 0xBC, 0x1D, 0x80, 0x8E, 0x04, 0x73, 0x2A, 0xDF,
+                              0x67, 0x99, 0x65, 0xCC, 0xC3, 0x4C, 0xA7, 0xAE, 0x34, 0x41 } },
+        { DigestType::Sha256, { 0x15, 0xE2, 0xB0, 0xD3, 0xC3, 0x38, 0x91, 0xEB,
+                                0xB0, 0xF1, 0xEF, 0x60, 0x9E, 0xC4, 0x19, 0x42,
+                                0x0C, 0x20, 0xE3, 0x20, 0xCE, 0x94, 0xC6, 0x5F,
+                                0xBC, 0x8C, 0x33, 0x12, 0x44, 0x8E, 0xB2, 0x25 } }
+    };
+    return kDigests;
+}
+
+// The digests of the empty string.
+auto empty_digests() -> const ItemDigests& {
+    static const ItemDigests kDigests{
+        { DigestType::Crc32, { 0x00, 0x00, 0x00, 0x00 } },
+        { DigestType::Crc64, { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+        { DigestType::Sha1, { 0xDA, 0x39, 0xA3, 0xEE, 0x5E, 0x6B, 0x4B, 0x0D, 0x32, 0x55,
+                              0xBF, 0xEF, 0x95, 0x60, 0x18, 0x90, 0xAF, 0xD8, 0x07, 0x09 } },
+        { DigestType::Sha256, { 0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14,
+                                0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+                                0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C,
+                                0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55 } }
+    };
+    return kDigests;
+}
+
+// The hashed files, indexed by fs::path, so that they match regardless of the path separators.
+auto by_path( const HashedFiles& hashedFiles ) -> std::map< fs::path, ItemDigests > {
+    std::map< fs::path, ItemDigests > result;
+    for ( const auto& hashedFile : hashedFiles ) {
+        result.emplace( tstring_to_path( hashedFile.first ), hashedFile.second );
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE( "BitHasher: Hashing files and directories", "[bithasher]" ) {
+    const TempDirectory tempDir{ "bit7z_test_bithasher" };
+    const fs::path dir = tempDir.path() / "dir";
+    REQUIRE( fs::create_directories( dir / "sub" ) );
+    REQUIRE( fs::create_directories( dir / "empty_folder" ) );
+    write_file( dir / "digits.txt", "123456789" );
+    write_file( dir / "empty.txt", std::string{} );
+    write_file( dir / "sub" / "digits.bin", "123456789" );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const TestDirectory testDir{ tempDir.path() };
+    BitHasher hasher{ lib, { DigestType::Crc32, DigestType::Crc64, DigestType::Sha1, DigestType::Sha256 } };
+
+    const fs::path digitsPath = fs::path{ "dir" } / "digits.txt";
+    const fs::path emptyPath = fs::path{ "dir" } / "empty.txt";
+    const fs::path nestedDigitsPath = fs::path{ "dir" } / "sub" / "digits.bin";
+
+    SECTION( "Hashing a single file" ) {
+        REQUIRE( hasher.hashFile( path_to_tstring( digitsPath ) ) == digits_digests() );
+        REQUIRE( hasher.hashFile( path_to_tstring( emptyPath ) ) == empty_digests() );
+        REQUIRE_THROWS_AS( hasher.hashFile( BIT7Z_STRING( "dir" ) ), BitException );
+        REQUIRE_THROWS_AS( hasher.hashFile( BIT7Z_STRING( "missing.txt" ) ), BitException );
+
+        // The file is hashed through the same code paths of buffers and streams.
+        std::istringstream inStream{ "123456789" };
+        REQUIRE( hasher.hashStream( inStream ) == digits_digests() );
+        REQUIRE( hasher.hashBuffer( { '1', '2', '3', '4', '5', '6', '7', '8', '9' } ) == digits_digests() );
+    }
+
+    SECTION( "Computing only some digests" ) {
+        hasher.setDigestTypes( { DigestType::Sha1 } );
+        const auto digests = hasher.hashFile( path_to_tstring( digitsPath ) );
+        REQUIRE( digests.size() == 1 );
+        REQUIRE( digests.at( DigestType::Sha1 ) == digits_digests().at( DigestType::Sha1 ) );
+    }
+
+    const std::map< fs::path, ItemDigests > allFiles{
+        { digitsPath, digits_digests() },
+        { emptyPath, empty_digests() },
+        { nestedDigitsPath, digits_digests() }
+    };
+
+    SECTION( "Hashing the content of a directory" ) {
+        // The results are indexed by path (the empty folders are skipped), whatever the number of threads used.
+        const auto threadsCount = GENERATE( 0u, 1u, 2u, 8u );
+        hasher.setThreadsCount( threadsCount );
+        REQUIRE( by_path( hasher.hashDirectory( BIT7Z_STRING( "dir" ) ) ) == allFiles );
+        REQUIRE( by_path( hasher.hashFiles( { BIT7Z_STRING( "dir" ) } ) ) == allFiles );
+    }
+
+    SECTION( "Hashing the content of a directory, non-recursively" ) {
+        REQUIRE( by_path( hasher.hashDirectory( BIT7Z_STRING( "dir" ), {}, false ) ) ==
+                 std::map< fs::path, ItemDigests >{ { digitsPath, digits_digests() },
+                                                    { emptyPath, empty_digests() } } );
+    }
+
+    SECTION( "Hashing the files in a directory matching a filter" ) {
+        REQUIRE( by_path( hasher.hashDirectory( BIT7Z_STRING( "dir" ), BIT7Z_STRING( "digits.*" ) ) ) ==
+                 std::map< fs::path, ItemDigests >{ { digitsPath, digits_digests() },
+                                                    { nestedDigitsPath, digits_digests() } } );
+        REQUIRE( hasher.hashDirectory( BIT7Z_STRING( "dir" ), BIT7Z_STRING( "*.none" ) ).empty() );
+    }
+
+    SECTION( "Hashing a list of files" ) {
+        const std::vector< tstring > inPaths{ path_to_tstring( nestedDigitsPath ), path_to_tstring( emptyPath ) };
+        REQUIRE( by_path( hasher.hashFiles( inPaths ) ) ==
+                 std::map< fs::path, ItemDigests >{ { emptyPath, empty_digests() },
+                                                    { nestedDigitsPath, digits_digests() } } );
+    }
+
+    SECTION( "Hashing a list of files containing a missing one" ) {
+        const std::vector< tstring > inPaths{ path_to_tstring( digitsPath ), BIT7Z_STRING( "missing.txt" ) };
+        REQUIRE_THROWS_AS( hasher.hashFiles( inPaths ), BitException );
+    }
+}
+
+#endif
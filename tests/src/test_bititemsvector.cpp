@@ -18,6 +18,7 @@
 #include <bit7z/bititemsvector.hpp>
 #include <internal/genericinputitem.hpp>
 
+#include <fstream>
 #include <string>
 #include <iostream>
 #include <vector>
@@ -1981,4 +1982,148 @@ TEST_CASE( "BitItemsVector: Indexing a single buffer", "[bititemsvector]" ) {
         REQUIRE( itemsVector[ 0 ].path() == BIT7Z_STRING( "custom_name.ext" ) );
         REQUIRE( itemsVector[ 0 ].size() == fs::file_size( testInput ) );
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE( "BitItemsVector: Reordering the indexed items", "[bititemsvector]" ) {
+    static const TestDirectory testDir{ test_filesystem_dir };
+
+    BitItemsVector itemsVector;
+    REQUIRE_NOTHROW( itemsVector.indexDirectory( "." ) );
+    REQUIRE_LOAD_FILE( input_buffer, "italy.svg" );
+    REQUIRE_NOTHROW( itemsVector.indexBuffer( input_buffer, BIT7Z_STRING( "custom_name.ext" ) ) );
+
+    auto expectedPaths = in_archive_paths( itemsVector );
+
+    const auto order = GENERATE( ItemsOrder::Indexing, ItemsOrder::FileIndex, ItemsOrder::PhysicalOffset );
+    DYNAMIC_SECTION( "Items order: " << static_cast< int >( order ) ) {
+        REQUIRE_NOTHROW( itemsVector.reorder( order ) );
+        REQUIRE( itemsVector.size() == expectedPaths.size() );
+
+        auto resultPaths = in_archive_paths( itemsVector );
+        if ( order == ItemsOrder::Indexing ) {
+            REQUIRE( resultPaths == expectedPaths );
+        }
+
+        // Non-filesystem items are always placed after the filesystem ones.
+        REQUIRE( resultPaths.back() == "custom_name.ext" );
+
+        // Reordering must not change the paths of the items inside the archive.
+        std::sort( expectedPaths.begin(), expectedPaths.end() );
+        std::sort( resultPaths.begin(), resultPaths.end() );
+        REQUIRE( resultPaths == expectedPaths );
+    }
+}
+
+TEST_CASE( "BitItemsVector: Reordering the items by physical location keeps their in-archive paths",
+           "[bititemsvector]" ) {
+    static const TestDirectory testDir{ test_filesystem_dir };
+
+    BitItemsVector itemsVector;
+    const std::map< tstring, tstring > inputPaths{
+        { BIT7Z_STRING( "italy.svg" ), BIT7Z_STRING( "renamed/flag.svg" ) },
+        { BIT7Z_STRING( "Lorem Ipsum.pdf" ), BIT7Z_STRING( "docs/lorem.pdf" ) },
+        { BIT7Z_STRING( "noext" ), BIT7Z_STRING( "noext.txt" ) },
+        { BIT7Z_STRING( "folder" ), BIT7Z_STRING( "dir" ) }
+    };
+    REQUIRE_NOTHROW( itemsVector.indexPathsMap( inputPaths ) );
+
+    // The in-archive path of each indexed file, and its size.
+    std::map< tstring, std::pair< fs::path, uint64_t > > expectedItems;
+    for ( const auto& item : itemsVector ) {
+        expectedItems.emplace( item->path(), std::make_pair( item->inArchivePath(), item->size() ) );
+    }
+    REQUIRE( expectedItems.size() == itemsVector.size() );
+
+    const auto order = GENERATE( ItemsOrder::FileIndex, ItemsOrder::PhysicalOffset );
+    DYNAMIC_SECTION( "Items order: " << static_cast< int >( order ) ) {
+        REQUIRE_NOTHROW( itemsVector.reorder( order ) );
+        REQUIRE( itemsVector.size() == expectedItems.size() );
+
+        for ( const auto& item : itemsVector ) {
+            const auto expectedItem = expectedItems.find( item->path() );
+            REQUIRE( expectedItem != expectedItems.end() );
+            REQUIRE( item->inArchivePath() == expectedItem->second.first );
+            REQUIRE( item->size() == expectedItem->second.second );
+        }
+    }
+}
+
+TEST_CASE( "BitItemsVector: Reordering the indexed items by extension", "[bititemsvector]" ) {
+    static const TestDirectory testDir{ test_filesystem_dir };
+
+    BitItemsVector itemsVector;
+    REQUIRE_NOTHROW( itemsVector.indexDirectory( "." ) );
+    REQUIRE_LOAD_FILE( input_buffer, "italy.svg" );
+    REQUIRE_NOTHROW( itemsVector.indexBuffer( input_buffer, BIT7Z_STRING( "custom_name.ext" ) ) );
+
+    auto expectedPaths = in_archive_paths( itemsVector );
+
+    REQUIRE_NOTHROW( itemsVector.reorder( ItemsOrder::Extension ) );
+    REQUIRE( itemsVector.size() == expectedPaths.size() );
+
+    // Items are grouped by extension, and sorted by path within each group.
+    const auto resultPaths = in_archive_paths( itemsVector );
+    REQUIRE( std::is_sorted( resultPaths.cbegin(), resultPaths.cend(),
+                             []( const fs::path& first, const fs::path& second ) -> bool {
+                                 const auto firstExtension = first.extension().string();
+                                 const auto secondExtension = second.extension().string();
+                                 if ( firstExtension != secondExtension ) {
+                                     return firstExtension < secondExtension;
+                                 }
+                                 return first.string() < second.string();
+                             } ) );
+
+    // Reordering must not change the paths of the items inside the archive.
+    auto sortedResultPaths = resultPaths;
+    std::sort( expectedPaths.begin(), expectedPaths.end() );
+    std::sort( sortedResultPaths.begin(), sortedResultPaths.end() );
+    REQUIRE( sortedResultPaths == expectedPaths );
+}
+
+TEST_CASE( "BitItemsVector: Deduplicating the content of the indexed files", "[bititemsvector]" ) {
+    const TempDirectory tempDir{ "bit7z_deduplication" };
+    const fs::path& testPath = tempDir.path();
+    fs::create_directories( testPath / "copies" );
+    const auto writeFile = [ &testPath ]( const char* name, const std::string& content ) {
+        std::ofstream file{ testPath / name, std::ios::binary };
+        file << content;
+    };
+    writeFile( "a.txt", "Lorem ipsum dolor sit amet" );
+    writeFile( "b.txt", "Lorem ipsum dolor sit amEt" ); // Same size, different content.
+    writeFile( "c.txt", "consectetur adipiscing elit" );
+    writeFile( "copies/a.txt", "Lorem ipsum dolor sit amet" );
+    writeFile( "copies/empty1.txt", "" ); // Empty files are never deduplicated.
+    writeFile( "empty2.txt", "" );
+
+    BitItemsVector itemsVector;
+    REQUIRE_NOTHROW( itemsVector.indexDirectory( testPath, BIT7Z_STRING( "" ), FilterPolicy::Include, {} ) );
+    const auto originalPaths = in_archive_paths( itemsVector );
+
+    const bool useHardLinks = GENERATE( false, true );
+    DYNAMIC_SECTION( "Using hard links: " << std::boolalpha << useHardLinks ) {
+        const auto duplicateSets = itemsVector.deduplicate( useHardLinks );
+        REQUIRE( duplicateSets.size() == 1 );
+        REQUIRE( duplicateSets[ 0 ].size == 26 );
+        REQUIRE( duplicateSets[ 0 ].paths.size() == 2 );
+
+        // The order of the items is unchanged.
+        const auto paths = in_archive_paths( itemsVector );
+        REQUIRE( paths == originalPaths );
+
+        const auto first = std::find( paths.cbegin(), paths.cend(), fs::path{ duplicateSets[ 0 ].paths[ 0 ] } );
+        const auto second = std::find( paths.cbegin(), paths.cend(), fs::path{ duplicateSets[ 0 ].paths[ 1 ] } );
+        REQUIRE( first < second );
+        REQUIRE( second != paths.cend() );
+
+        const auto& duplicate = itemsVector[ static_cast< std::size_t >( std::distance( paths.cbegin(), second ) ) ];
+        const auto hardLink = duplicate.itemProperty( BitProperty::HardLink );
+        if ( useHardLinks ) {
+            REQUIRE( duplicate.size() == 0 );
+            REQUIRE( hardLink.isString() );
+            REQUIRE( fs::path{ hardLink.getNativeString() } == fs::path{ duplicateSets[ 0 ].paths[ 0 ] } );
+        } else {
+            REQUIRE( duplicate.size() == 26 );
+            REQUIRE( hardLink.isEmpty() );
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <bit7z/bitresourcelimits.hpp>
+#include <internal/cgroups.hpp>
+
+using namespace bit7z;
+using namespace bit7z::cgroups;
+
+TEST_CASE( "cgroups: Parsing the CPU quota of a cgroup v2", "[cgroups]" ) {
+    REQUIRE( parse_cpu_max( "max 100000" ) == 0 );
+    REQUIRE( parse_cpu_max( "max 100000\n" ) == 0 );
+    REQUIRE( parse_cpu_max( "100000 100000" ) == 1 );
+    REQUIRE( parse_cpu_max( "200000 100000\n" ) == 2 );
+    REQUIRE( parse_cpu_max( "150000 100000" ) == 2 ); // Partial CPUs are rounded up.
+    REQUIRE( parse_cpu_max( "50000 100000" ) == 1 );
+
+    REQUIRE( parse_cpu_max( "" ) == 0 );
+    REQUIRE( parse_cpu_max( "200000" ) == 0 );
+    REQUIRE( parse_cpu_max( "invalid 100000" ) == 0 );
+}
+
+TEST_CASE( "cgroups: Converting the CPU quota of a cgroup v1", "[cgroups]" ) {
+    REQUIRE( cpu_quota_to_count( -1, 100000 ) == 0 );
+    REQUIRE( cpu_quota_to_count( 400000, 100000 ) == 4 );
+    REQUIRE( cpu_quota_to_count( 10000, 100000 ) == 1 );
+    REQUIRE( cpu_quota_to_count( 100000, 0 ) == 0 );
+}
+
+TEST_CASE( "cgroups: Combining the CPU limits of the process", "[cgroups]" ) {
+    REQUIRE( effective_cpu_limit( 0, 0, 8 ) == 0 );
+    REQUIRE( effective_cpu_limit( 0, 8, 8 ) == 0 ); // An affinity mask with all the CPUs is not a limit.
+    REQUIRE( effective_cpu_limit( 16, 8, 8 ) == 0 );
+    REQUIRE( effective_cpu_limit( 0, 4, 8 ) == 4 );
+    REQUIRE( effective_cpu_limit( 2, 8, 8 ) == 2 );
+    REQUIRE( effective_cpu_limit( 2, 4, 8 ) == 2 );
+    REQUIRE( effective_cpu_limit( 6, 4, 8 ) == 4 );
+    REQUIRE( effective_cpu_limit( 2, 0, 0 ) == 2 ); // Unknown number of CPUs of the system.
+}
+
+TEST_CASE( "cgroups: Parsing the memory limit of a cgroup", "[cgroups]" ) {
+    REQUIRE( parse_memory_limit( "max\n" ) == 0 );
+    REQUIRE( parse_memory_limit( "536870912\n" ) == 536870912 );
+    REQUIRE( parse_memory_limit( "9223372036854771712" ) == 0 ); // Unlimited cgroup v1 memory.
+    REQUIRE( parse_memory_limit( "" ) == 0 );
+    REQUIRE( parse_memory_limit( "invalid" ) == 0 );
+}
+
+TEST_CASE( "cgroups: Finding the cgroup path of the process", "[cgroups]" ) {
+    SECTION( "Unified hierarchy (v2)" ) {
+        const std::string content = "0::/system.slice/docker-1234.scope\n";
+        REQUIRE( cgroup_path( content, "" ) == "/system.slice/docker-1234.scope" );
+        REQUIRE( cgroup_path( content, "cpu" ).empty() );
+    }
+
+    SECTION( "Legacy hierarchies (v1)" ) {
+        const std::string content = "12:memory:/docker/abcd\n"
+                                    "4:cpu,cpuacct:/docker/efgh\n"
+                                    "1:name=systemd:/init.scope\n";
+        REQUIRE( cgroup_path( content, "memory" ) == "/docker/abcd" );
+        REQUIRE( cgroup_path( content, "cpu" ) == "/docker/efgh" );
+        REQUIRE( cgroup_path( content, "cpuacct" ) == "/docker/efgh" );
+        REQUIRE( cgroup_path( content, "cpuset" ).empty() );
+        REQUIRE( cgroup_path( content, "" ).empty() );
+    }
+}
+
+TEST_CASE( "cgroups: Overriding the default resource limits", "[cgroups]" ) {
+    ResourceLimits limits;
+    limits.cpuCount = 3;
+    limits.memoryLimit = 1024;
+    set_default_resource_limits( limits );
+    REQUIRE( default_resource_limits().cpuCount == 3 );
+    REQUIRE( default_resource_limits().memoryLimit == 1024 );
+
+    reset_default_resource_limits();
+    REQUIRE( default_resource_limits().cpuCount == detected_resource_limits().cpuCount );
+    REQUIRE( default_resource_limits().memoryLimit == detected_resource_limits().memoryLimit );
+}
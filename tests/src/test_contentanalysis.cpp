@@ -0,0 +1,96 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/contentanalysis.hpp>
+
+#include <cstring>
+
+using bit7z::byte_t;
+using bit7z::buffer_t;
+using bit7z::has_compressed_signature;
+using bit7z::is_compressed_extension;
+using bit7z::shannon_entropy;
+
+TEST_CASE( "contentanalysis: Checking the extensions of already-compressed formats", "[contentanalysis]" ) {
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "jpg" ) ) );
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "JPG" ) ) );
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "mp4" ) ) );
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "7z" ) ) );
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "Zip" ) ) );
+    REQUIRE( is_compressed_extension( BIT7Z_STRING( "docx" ) ) );
+
+    REQUIRE_FALSE( is_compressed_extension( BIT7Z_STRING( "" ) ) );
+    REQUIRE_FALSE( is_compressed_extension( BIT7Z_STRING( "txt" ) ) );
+    REQUIRE_FALSE( is_compressed_extension( BIT7Z_STRING( "cpp" ) ) );
+    REQUIRE_FALSE( is_compressed_extension( BIT7Z_STRING( "bmp" ) ) );
+    REQUIRE_FALSE( is_compressed_extension( BIT7Z_STRING( "jpgx" ) ) );
+}
+
+TEST_CASE( "contentanalysis: Checking the signatures of already-compressed formats", "[contentanalysis]" ) {
+    auto make_data = []( const char* bytes, std::size_t size ) -> buffer_t {
+        buffer_t data( 64, 0 );
+        std::memcpy( data.data(), bytes, size );
+        return data;
+    };
+
+    SECTION( "Known signatures" ) {
+        auto data = make_data( "\xFF\xD8\xFF\xE0", 4 );
+        REQUIRE( has_compressed_signature( data.data(), data.size() ) );
+
+        data = make_data( "\x89PNG\r\n\x1A\n", 8 );
+        REQUIRE( has_compressed_signature( data.data(), data.size() ) );
+
+        data = make_data( "7z\xBC\xAF\x27\x1C", 6 );
+        REQUIRE( has_compressed_signature( data.data(), data.size() ) );
+
+        data = make_data( "\x00\x00\x00\x18" "ftypmp42", 12 );
+        REQUIRE( has_compressed_signature( data.data(), data.size() ) );
+
+        data = make_data( "RIFF\x00\x00\x00\x00WEBP", 12 );
+        REQUIRE( has_compressed_signature( data.data(), data.size() ) );
+    }
+
+    SECTION( "Unknown signatures" ) {
+        auto data = make_data( "Hello, World!", 13 );
+        REQUIRE_FALSE( has_compressed_signature( data.data(), data.size() ) );
+
+        data = make_data( "BM", 2 );
+        REQUIRE_FALSE( has_compressed_signature( data.data(), data.size() ) );
+    }
+
+    SECTION( "Data smaller than the signatures" ) {
+        const buffer_t data{ 0xFF, 0xD8 };
+        REQUIRE_FALSE( has_compressed_signature( data.data(), data.size() ) );
+        REQUIRE_FALSE( has_compressed_signature( data.data(), 0 ) );
+    }
+}
+
+TEST_CASE( "contentanalysis: Computing the entropy of some data", "[contentanalysis]" ) {
+    REQUIRE( shannon_entropy( nullptr, 0 ) == Approx( 0.0 ) );
+
+    const buffer_t constantData( 1024, 42 );
+    REQUIRE( shannon_entropy( constantData.data(), constantData.size() ) == Approx( 0.0 ) );
+
+    buffer_t twoValuesData( 1024, 0 );
+    for ( std::size_t i = 0; i < twoValuesData.size(); i += 2 ) {
+        twoValuesData[ i ] = 1;
+    }
+    REQUIRE( shannon_entropy( twoValuesData.data(), twoValuesData.size() ) == Approx( 1.0 ) );
+
+    buffer_t uniformData( 256 * 16 );
+    for ( std::size_t i = 0; i < uniformData.size(); ++i ) {
+        uniformData[ i ] = static_cast< byte_t >( i % 256 );
+    }
+    REQUIRE( shannon_entropy( uniformData.data(), uniformData.size() ) == Approx( 8.0 ) );
+}
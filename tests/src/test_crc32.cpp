@@ -0,0 +1,37 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/crc32.hpp>
+
+#include <cstring>
+
+using bit7z::buffer_t;
+using bit7z::byte_t;
+using bit7z::crc32_update;
+
+TEST_CASE( "crc32: Computing the CRC32 of some data", "[crc32]" ) {
+    REQUIRE( crc32_update( 0, nullptr, 0 ) == 0u );
+
+    const char* check = "123456789";
+    const auto* checkData = reinterpret_cast< const byte_t* >( check ); // NOLINT
+    REQUIRE( crc32_update( 0, checkData, std::strlen( check ) ) == 0xCBF43926u );
+
+    SECTION( "Computing the CRC32 in chunks" ) {
+        const uint32_t firstChunkCrc = crc32_update( 0, checkData, 4 );
+        REQUIRE( crc32_update( firstChunkCrc, checkData + 4, 5 ) == 0xCBF43926u );
+    }
+
+    const buffer_t zeros( 32, 0 );
+    REQUIRE( crc32_update( 0, zeros.data(), zeros.size() ) == 0x190A55ADu );
+}
@@ -0,0 +1,75 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/cbufferoutstream.hpp>
+#include <internal/cteeoutstream.hpp>
+#include <internal/hasher.hpp>
+#include <internal/util.hpp>
+
+#include <numeric>
+
+using bit7z::buffer_t;
+using bit7z::CBufferOutStream;
+using bit7z::CTeeOutStream;
+using bit7z::DigestType;
+using bit7z::ItemHasher;
+
+TEST_CASE( "CTeeOutStream: Mirroring and hashing the written data", "[cteeoutstream]" ) {
+    const std::vector< DigestType > digestTypes{ DigestType::Crc32, DigestType::Sha256 };
+    buffer_t content( 1000 );
+    std::iota( content.begin(), content.end(), static_cast< bit7z::byte_t >( 0 ) );
+
+    buffer_t mainBuffer;
+    buffer_t mirrorBuffer;
+    std::vector< CMyComPtr< IOutStream > > mirrors;
+    mirrors.push_back( bit7z::make_com< CBufferOutStream, IOutStream >( mirrorBuffer ) );
+    auto teeStream = bit7z::make_com< CTeeOutStream >( bit7z::make_com< CBufferOutStream, IOutStream >( mainBuffer ),
+                                                       std::move( mirrors ),
+                                                       ItemHasher{ digestTypes } );
+
+    UInt32 processedSize = 0;
+    REQUIRE( teeStream->Write( content.data(), 600, &processedSize ) == S_OK );
+    REQUIRE( processedSize == 600 );
+    REQUIRE( teeStream->Write( content.data() + 600, 400, &processedSize ) == S_OK );
+    REQUIRE( processedSize == 400 );
+
+    SECTION( "Writing sequentially" ) {
+        REQUIRE( teeStream->hasValidDigests() );
+        ItemHasher contentHasher{ digestTypes };
+        contentHasher.update( content.data(), content.size() );
+        REQUIRE( teeStream->digests() == contentHasher.finish() );
+    }
+
+    SECTION( "Patching the data already written" ) {
+        UInt64 newPosition = 0;
+        REQUIRE( teeStream->Seek( 10, STREAM_SEEK_SET, &newPosition ) == S_OK );
+        REQUIRE( newPosition == 10 );
+        const buffer_t patch( 5, 0xFF );
+        REQUIRE( teeStream->Write( patch.data(), static_cast< UInt32 >( patch.size() ), &processedSize ) == S_OK );
+        REQUIRE( teeStream->Seek( 0, STREAM_SEEK_END, &newPosition ) == S_OK );
+        REQUIRE( newPosition == content.size() );
+        REQUIRE_FALSE( teeStream->hasValidDigests() );
+
+        std::fill_n( content.begin() + 10, patch.size(), 0xFF );
+    }
+
+    SECTION( "Truncating the output" ) {
+        REQUIRE( teeStream->SetSize( 500 ) == S_OK );
+        REQUIRE_FALSE( teeStream->hasValidDigests() );
+        content.resize( 500 );
+    }
+
+    REQUIRE( mainBuffer == content );
+    REQUIRE( mirrorBuffer == content );
+}
@@ -57,6 +57,12 @@ TEST_CASE( "fsutil: Date conversions", "[fsutil][date functions]" ) {
             auto output = bit7z::time_type::clock::to_time_t( result );
             REQUIRE( output == testDate.dateTime );
         }
+
+        SECTION( "From bit7z::time_type to FILETIME" ) {
+            auto output = time_type_to_FILETIME( bit7z::time_type::clock::from_time_t( testDate.dateTime ) );
+            REQUIRE( output.dwHighDateTime == testDate.fileTime.dwHighDateTime );
+            REQUIRE( output.dwLowDateTime == testDate.fileTime.dwLowDateTime );
+        }
     }
 }
 #endif
\ No newline at end of file
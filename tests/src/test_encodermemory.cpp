@@ -0,0 +1,165 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/encodermemory.hpp>
+
+#include <map>
+#include <string>
+
+using bit7z::apply_format_properties;
+using bit7z::BitCompressionLevel;
+using bit7z::BitCompressionMethod;
+using bit7z::BitPropVariant;
+using bit7z::encoder_memory_usage;
+using bit7z::EncoderSettings;
+using bit7z::tune_encoder_settings;
+
+constexpr uint64_t kMebibyte = 1024 * 1024;
+
+TEST_CASE( "encodermemory: Memory usage of the encoders", "[encodermemory]" ) {
+    EncoderSettings settings{ BitCompressionMethod::Deflate, BitCompressionLevel::Normal, 0, 8, false, 0 };
+
+    SECTION( "Deflate and PPMd encoders use multiple threads only when compressing items in parallel" ) {
+        const uint64_t singleDeflate = encoder_memory_usage( settings );
+        settings.parallelItems = true;
+        REQUIRE( encoder_memory_usage( settings ) == 8 * singleDeflate );
+
+        settings.method = BitCompressionMethod::Ppmd;
+        settings.dictionarySize = 16 * kMebibyte;
+        const uint64_t parallelPpmd = encoder_memory_usage( settings );
+        settings.parallelItems = false;
+        REQUIRE( parallelPpmd == 8 * encoder_memory_usage( settings ) );
+    }
+
+    SECTION( "LZMA encoders compressing items in parallel do not buffer LZMA2 blocks" ) {
+        settings.method = BitCompressionMethod::Lzma;
+        settings.dictionarySize = 16 * kMebibyte;
+        const uint64_t singleLzma = encoder_memory_usage( settings );
+        settings.parallelItems = true;
+        REQUIRE( encoder_memory_usage( settings ) == 4 * singleLzma );
+
+        settings.method = BitCompressionMethod::Lzma2;
+        settings.parallelItems = false;
+        REQUIRE( encoder_memory_usage( settings ) == 4 * ( singleLzma + 64 * kMebibyte ) );
+    }
+
+    SECTION( "LZMA2 blocks are never bigger than the solid blocks" ) {
+        settings.method = BitCompressionMethod::Lzma2;
+        settings.dictionarySize = 16 * kMebibyte;
+        const uint64_t unboundedUsage = encoder_memory_usage( settings );
+        settings.maxBlockSize = kMebibyte;
+        REQUIRE( encoder_memory_usage( settings ) == unboundedUsage - 4 * 63 * kMebibyte );
+        settings.maxBlockSize = 1024 * kMebibyte;
+        REQUIRE( encoder_memory_usage( settings ) == unboundedUsage );
+    }
+
+    SECTION( "Auto-tuning single-threaded encoders" ) {
+        settings.method = BitCompressionMethod::Ppmd;
+        settings.dictionarySize = 64 * kMebibyte;
+        const auto tunedSettings = tune_encoder_settings( settings, 40 * kMebibyte );
+        REQUIRE( tunedSettings.dictionarySize == 32 * kMebibyte );
+        REQUIRE( tunedSettings.threads == 8 ); // Fewer threads would not reduce the memory usage.
+        REQUIRE( encoder_memory_usage( tunedSettings ) <= 40 * kMebibyte );
+    }
+
+    SECTION( "Auto-tuning encoders whose memory usage doesn't depend on the threads" ) {
+        for ( const auto method : { BitCompressionMethod::Copy, BitCompressionMethod::Deflate,
+                                    BitCompressionMethod::Lzma } ) {
+            settings.method = method;
+            settings.dictionarySize = kMebibyte;
+            REQUIRE( tune_encoder_settings( settings, 1 ).threads == 8 );
+        }
+    }
+
+    SECTION( "Auto-tuning the threads of LZMA2 encoders" ) {
+        settings.method = BitCompressionMethod::Lzma2;
+        settings.dictionarySize = 16 * kMebibyte;
+        EncoderSettings sixThreads = settings;
+        sixThreads.threads = 6;
+
+        // Seven threads use three LZMA2 encoders, like six threads: the tuning keeps the highest thread count.
+        const auto tunedSettings = tune_encoder_settings( settings, encoder_memory_usage( sixThreads ) );
+        REQUIRE( tunedSettings.threads == 7 );
+        REQUIRE( tunedSettings.dictionarySize == settings.dictionarySize );
+
+        // Three threads use a single LZMA2 encoder, like a single thread.
+        REQUIRE( tune_encoder_settings( settings, 1 ).threads == 3 );
+    }
+}
+
+TEST_CASE( "encodermemory: Applying the format properties to the encoder settings", "[encodermemory]" ) {
+    EncoderSettings settings{ BitCompressionMethod::Lzma2, BitCompressionLevel::Normal, 16 * kMebibyte, 8, false, 0 };
+    std::map< std::wstring, BitPropVariant > properties;
+
+    SECTION( "No properties" ) {
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 16 * kMebibyte );
+        REQUIRE( settings.threads == 8 );
+    }
+
+    SECTION( "Dictionary sizes with a unit suffix" ) {
+        properties[ L"0d" ] = BitPropVariant{ L"64m" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 64 * kMebibyte );
+
+        properties[ L"0d" ] = BitPropVariant{ L"512k" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 512 * 1024 );
+    }
+
+    SECTION( "Dictionary sizes as powers of two" ) {
+        properties[ L"0d" ] = BitPropVariant{ L"24" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 16 * kMebibyte );
+
+        properties[ L"0d" ] = BitPropVariant{ 26u };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 64 * kMebibyte );
+
+        properties[ L"0d" ] = BitPropVariant{ 1048576u };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == kMebibyte );
+    }
+
+    SECTION( "Dictionary sizes of other methods or invalid" ) {
+        properties[ L"d" ] = BitPropVariant{ L"64m" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 16 * kMebibyte );
+
+        properties[ L"0d" ] = BitPropVariant{ L"64x" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.dictionarySize == 16 * kMebibyte );
+
+        apply_format_properties( settings, properties, nullptr );
+        REQUIRE( settings.dictionarySize == 16 * kMebibyte );
+    }
+
+    SECTION( "Number of threads" ) {
+        properties[ L"mt" ] = BitPropVariant{ 3u };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.threads == 3 );
+
+        properties[ L"mt" ] = BitPropVariant{ false };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.threads == 1 );
+
+        properties[ L"mt" ] = BitPropVariant{ L"5" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.threads == 5 );
+
+        properties[ L"mt" ] = BitPropVariant{ L"off" };
+        apply_format_properties( settings, properties, L"0d" );
+        REQUIRE( settings.threads == 1 );
+    }
+}
@@ -0,0 +1,107 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/hasher.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using bit7z::buffer_t;
+using bit7z::byte_t;
+using bit7z::Digest;
+using bit7z::DigestType;
+using bit7z::ItemHasher;
+using bit7z::make_hasher;
+
+namespace {
+auto to_hex( const Digest& digest ) -> std::string {
+    std::string result;
+    for ( const auto byte : digest ) {
+        char hexByte[ 3 ] = {}; // NOLINT(*-avoid-c-arrays)
+        std::snprintf( hexByte, sizeof( hexByte ), "%02x", static_cast< unsigned >( byte ) ); // NOLINT
+        result += hexByte;
+    }
+    return result;
+}
+
+auto hash_string( DigestType type, const std::string& input ) -> std::string {
+    auto hasher = make_hasher( type );
+    hasher->update( reinterpret_cast< const byte_t* >( input.data() ), input.size() ); // NOLINT
+    return to_hex( hasher->finish() );
+}
+} // namespace
+
+TEST_CASE( "Hasher: Computing the digests of some data", "[hasher]" ) {
+    SECTION( "CRC32" ) {
+        REQUIRE( hash_string( DigestType::Crc32, "" ) == "00000000" );
+        REQUIRE( hash_string( DigestType::Crc32, "123456789" ) == "cbf43926" );
+    }
+
+    SECTION( "CRC64" ) {
+        REQUIRE( hash_string( DigestType::Crc64, "" ) == "0000000000000000" );
+        REQUIRE( hash_string( DigestType::Crc64, "123456789" ) == "995dc9bbdf1939fa" );
+    }
+
+    SECTION( "SHA-1" ) {
+        REQUIRE( hash_string( DigestType::Sha1, "" ) == "da39a3ee5e6b4b0d3255bfef95601890afd80709" );
+        REQUIRE( hash_string( DigestType::Sha1, "abc" ) == "a9993e364706816aba3e25717850c26c9cd0d89d" );
+        REQUIRE( hash_string( DigestType::Sha1, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) ==
+                 "84983e441c3bd26ebaae4aa1f95129e5e54670f1" );
+    }
+
+    SECTION( "SHA-256" ) {
+        REQUIRE( hash_string( DigestType::Sha256, "" ) ==
+                 "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+        REQUIRE( hash_string( DigestType::Sha256, "abc" ) ==
+                 "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+        REQUIRE( hash_string( DigestType::Sha256, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq" ) ==
+                 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+    }
+}
+
+TEST_CASE( "ItemHasher: Computing several digests over data written in chunks", "[hasher]" ) {
+    // One million 'a' characters, written in chunks not aligned to the hashes' block size.
+    const buffer_t data( 1000000, static_cast< byte_t >( 'a' ) );
+    ItemHasher hasher{ { DigestType::Crc32, DigestType::Sha1, DigestType::Sha256 } };
+    constexpr std::size_t kChunkSize = 999;
+    for ( std::size_t offset = 0; offset < data.size(); offset += kChunkSize ) {
+        hasher.update( data.data() + offset, ( std::min )( kChunkSize, data.size() - offset ) );
+    }
+
+    const auto digests = hasher.finish();
+    REQUIRE( digests.size() == 3 );
+    REQUIRE( digests.count( DigestType::Crc64 ) == 0 );
+    REQUIRE( to_hex( digests.at( DigestType::Sha1 ) ) == "34aa973cd4c4daa4f61eeb2bdbad27316534016f" );
+    REQUIRE( to_hex( digests.at( DigestType::Sha256 ) ) ==
+             "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" );
+
+    auto crcHasher = make_hasher( DigestType::Crc32 );
+    crcHasher->update( data.data(), data.size() );
+    REQUIRE( digests.at( DigestType::Crc32 ) == crcHasher->finish() );
+}
+
+TEST_CASE( "ItemHasher: Hashing the content of a standard stream", "[hasher]" ) {
+    std::istringstream stream{ "skip123456789" };
+    stream.seekg( 4 );
+    ItemHasher hasher{ { DigestType::Crc32 } };
+    REQUIRE( bit7z::hash_stream( stream, hasher ) );
+    REQUIRE( to_hex( hasher.finish().at( DigestType::Crc32 ) ) == "cbf43926" );
+}
+
+TEST_CASE( "ItemHasher: Requesting digests not supported by bit7z's own hashers", "[hasher]" ) {
+    REQUIRE( make_hasher( DigestType::Xxh64 ) == nullptr );
+    REQUIRE_THROWS( ItemHasher{ { DigestType::Sha256, DigestType::Blake2sp } } );
+}
@@ -0,0 +1,377 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <catch2/catch.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+
+#include <bit7z/bitformat.hpp>
+#include <internal/crc32.hpp>
+#include <internal/inplaceappend.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using namespace bit7z;
+using namespace bit7z::test;
+using namespace bit7z::test::filesystem;
+
+namespace {
+constexpr auto kBlockSize = kTarBlockSize;
+
+// Reads the names stored in the central directory and in the local headers of the entries of a zip archive.
+auto zip_names( const buffer_t& archive ) -> std::vector< std::pair< std::string, std::string > > {
+    std::vector< std::pair< std::string, std::string > > names;
+    const auto recordOffset = archive.size() - 22;
+    const auto entriesCount = read_le( archive, recordOffset + 10, 2 );
+    auto position = static_cast< std::size_t >( read_le( archive, recordOffset + 16, 4 ) );
+    for ( uint64_t entry = 0; entry < entriesCount; ++entry ) {
+        const auto nameSize = static_cast< std::size_t >( read_le( archive, position + 28, 2 ) );
+        const auto localOffset = static_cast< std::size_t >( read_le( archive, position + 42, 4 ) );
+        const auto localNameSize = static_cast< std::size_t >( read_le( archive, localOffset + 26, 2 ) );
+        const auto* name = reinterpret_cast< const char* >( &archive[ position + 46 ] );
+        const auto* localName = reinterpret_cast< const char* >( &archive[ localOffset + 30 ] );
+        names.emplace_back( std::string( name, nameSize ), std::string( localName, localNameSize ) );
+        position += 46 + nameSize + read_le( archive, position + 30, 2 ) + read_le( archive, position + 32, 2 );
+    }
+    return names;
+}
+
+// The offsets of the central directory headers of the entries of a zip archive.
+auto zip_central_headers( const buffer_t& archive ) -> std::vector< std::size_t > {
+    std::vector< std::size_t > offsets;
+    const auto recordOffset = archive.size() - 22;
+    const auto entriesCount = read_le( archive, recordOffset + 10, 2 );
+    auto position = static_cast< std::size_t >( read_le( archive, recordOffset + 16, 4 ) );
+    for ( uint64_t entry = 0; entry < entriesCount; ++entry ) {
+        offsets.push_back( position );
+        position += 46 + read_le( archive, position + 28, 2 ) + read_le( archive, position + 30, 2 ) +
+                    read_le( archive, position + 32, 2 );
+    }
+    return offsets;
+}
+} // namespace
+
+TEST_CASE( "inplaceappend: Appending a tar archive in place", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path archivePath = tempDir.path() / "archive.tar";
+    const fs::path appendedPath = tempDir.path() / "archive.tar.tmp";
+
+    // The existing archive is padded to the default tar record size (10 KiB).
+    const buffer_t archive = make_tar( "first.txt", "Hello, World!", 20 * kBlockSize );
+    const buffer_t appended = make_tar( "second.txt", std::string( 1000, 'x' ), kBlockSize );
+    write_file( archivePath, archive );
+    write_file( appendedPath, appended );
+
+    REQUIRE( supports_in_place_append( BitFormat::Tar, archivePath ) );
+    REQUIRE_FALSE( supports_in_place_append( BitFormat::Zip, archivePath ) );
+    REQUIRE_FALSE( supports_in_place_append( BitFormat::SevenZip, archivePath ) );
+
+    InPlaceAppendPlan plan{};
+    REQUIRE( plan_in_place_append( BitFormat::Tar, archivePath, appendedPath, plan ) );
+    REQUIRE( plan.originalSize == archive.size() );
+    REQUIRE( plan.tailOffset == 2 * kBlockSize );
+    REQUIRE( plan.appendedDataSize == 3 * kBlockSize );
+
+    REQUIRE_NOTHROW( apply_in_place_append( plan ) );
+    const buffer_t result = load_file( archivePath );
+    REQUIRE( result.size() == 7 * kBlockSize );
+    REQUIRE( std::equal( archive.cbegin(), archive.cbegin() + 2 * kBlockSize, result.cbegin() ) );
+    REQUIRE( std::equal( appended.cbegin(), appended.cbegin() + 3 * kBlockSize, result.cbegin() + 2 * kBlockSize ) );
+    REQUIRE( std::all_of( result.cbegin() + 5 * kBlockSize, result.cend(),
+                          []( byte_t value ) -> bool { return value == 0; } ) );
+
+    fs::path journalPath = archivePath;
+    journalPath += ".journal";
+    REQUIRE_FALSE( fs::exists( journalPath ) );
+}
+
+TEST_CASE( "inplaceappend: Archives not supporting the in place append", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path archivePath = tempDir.path() / "invalid.tar";
+
+    buffer_t archive = make_tar( "file.txt", "Hello, World!", kBlockSize );
+    archive[ 0 ] = 'F'; // Invalidating the header's checksum.
+    write_file( archivePath, archive );
+    REQUIRE_FALSE( supports_in_place_append( BitFormat::Tar, archivePath ) );
+
+    write_file( archivePath, buffer_t( 100, 0x42 ) );
+    REQUIRE_FALSE( supports_in_place_append( BitFormat::Zip, archivePath ) );
+}
+
+TEST_CASE( "inplaceappend: Recovering an interrupted append", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path archivePath = tempDir.path() / "archive.tar";
+    fs::path journalPath = archivePath;
+    journalPath += ".journal";
+
+    const buffer_t archive = make_tar( "file.txt", "Hello, World!", kBlockSize );
+    const uint64_t tailOffset = 2 * kBlockSize;
+
+    // The journal saved before overwriting the tail of the archive.
+    buffer_t journal = { 'B', 'I', 'T', '7', 'Z', 'J', 'N', 'L' };
+    append_le( journal, archive.size(), sizeof( uint64_t ) );
+    append_le( journal, tailOffset, sizeof( uint64_t ) );
+    append_le( journal, 0, sizeof( uint64_t ) ); // Unknown file index.
+    append_le( journal, crc32_update( 0, archive.data(), tailOffset ), sizeof( uint32_t ) );
+    journal.insert( journal.end(), archive.cbegin() + tailOffset, archive.cend() );
+    append_le( journal, crc32_update( 0, journal.data(), journal.size() ), sizeof( uint32_t ) );
+
+    // Simulating a crash after the tail of the archive was overwritten.
+    buffer_t corrupted = archive;
+    corrupted.resize( tailOffset );
+    corrupted.insert( corrupted.end(), 3 * kBlockSize, 0x42 );
+
+    SECTION( "Complete journal" ) {
+        write_file( journalPath, journal );
+        write_file( archivePath, corrupted );
+
+        recover_interrupted_append( archivePath );
+        REQUIRE( load_file( archivePath ) == archive );
+        REQUIRE_FALSE( fs::exists( journalPath ) );
+    }
+
+    SECTION( "Incomplete journal" ) {
+        // Simulating a crash while writing the journal, i.e., before the archive was modified.
+        journal.resize( journal.size() - 1 );
+        write_file( journalPath, journal );
+        write_file( archivePath, archive );
+
+        recover_interrupted_append( archivePath );
+        REQUIRE( load_file( archivePath ) == archive );
+        REQUIRE_FALSE( fs::exists( journalPath ) );
+    }
+
+    SECTION( "Corrupted journal" ) {
+        journal[ journal.size() / 2 ] ^= 0xFFu;
+        write_file( journalPath, journal );
+        write_file( archivePath, corrupted );
+
+        recover_interrupted_append( archivePath );
+        REQUIRE( load_file( archivePath ) == corrupted );
+        REQUIRE_FALSE( fs::exists( journalPath ) );
+    }
+
+    SECTION( "Stale journal" ) {
+        // The archive was replaced after the interrupted append: the journal must not be replayed.
+        const buffer_t otherArchive = make_tar( "other.txt", "Lorem ipsum dolor sit amet", kBlockSize );
+        write_file( journalPath, journal );
+        write_file( archivePath, otherArchive );
+
+        recover_interrupted_append( archivePath );
+        REQUIRE( load_file( archivePath ) == otherArchive );
+        REQUIRE( fs::exists( journalPath ) );
+    }
+}
+
+TEST_CASE( "inplaceappend: Editing the metadata of a zip archive in place", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path archivePath = tempDir.path() / "archive.zip";
+    const buffer_t archive = make_zip( { { "folder/first_file.txt", "Hello, World!" },
+                                         { "folder/second.txt", "Lorem ipsum" },
+                                         { "third.txt", "dolor sit amet" } } );
+    write_file( archivePath, archive );
+
+    InPlaceMetadataEdit edit{};
+    InPlaceAppendPlan plan{};
+
+    SECTION( "Renaming an item to a shorter path" ) {
+        edit.path = "folder/first_file.txt";
+        edit.newPath = "folder/first.txt";
+        REQUIRE( plan_in_place_metadata_edit( BitFormat::Zip, archivePath, { edit }, plan ) );
+        REQUIRE( plan.patches.size() == 1 );
+        REQUIRE( plan.relocations.empty() );
+
+        REQUIRE_NOTHROW( apply_in_place_append( plan ) );
+        const buffer_t result = load_file( archivePath );
+        REQUIRE( result.size() == archive.size() - 5 );
+
+        const auto names = zip_names( result );
+        REQUIRE( names.size() == 3 );
+        REQUIRE( names[ 0 ].first == "folder/first.txt" );
+        REQUIRE( names[ 0 ].second == "folder/first.txt" );
+        REQUIRE( names[ 1 ].first == "folder/second.txt" );
+        REQUIRE( names[ 2 ].first == "third.txt" );
+    }
+
+    SECTION( "Renaming an item to a longer path" ) {
+        edit.path = "third.txt";
+        edit.newPath = "renamed/third.txt";
+        REQUIRE( plan_in_place_metadata_edit( BitFormat::Zip, archivePath, { edit }, plan ) );
+        REQUIRE( plan.patches.empty() );
+        REQUIRE( plan.relocations.size() == 1 );
+
+        REQUIRE_NOTHROW( apply_in_place_append( plan ) );
+        const auto names = zip_names( load_file( archivePath ) );
+        REQUIRE( names.size() == 3 );
+        REQUIRE( names[ 0 ].first == "folder/first_file.txt" );
+        REQUIRE( names[ 2 ].first == "renamed/third.txt" );
+        REQUIRE( names[ 2 ].second == "renamed/third.txt" );
+    }
+
+    SECTION( "Changing the attributes of an item" ) {
+        edit.path = "folder/second.txt";
+        edit.hasNewAttributes = true;
+        edit.attributes = 0x20; // FILE_ATTRIBUTE_ARCHIVE
+        REQUIRE( plan_in_place_metadata_edit( BitFormat::Zip, archivePath, { edit }, plan ) );
+        REQUIRE( plan.patches.empty() );
+        REQUIRE( plan.relocations.empty() );
+
+        REQUIRE_NOTHROW( apply_in_place_append( plan ) );
+        const buffer_t result = load_file( archivePath );
+        REQUIRE( result.size() == archive.size() );
+
+        // Only the external attributes in the central directory header of the item are changed.
+        const auto headers = zip_central_headers( result );
+        REQUIRE( headers.size() == 3 );
+        REQUIRE( read_le( result, headers[ 1 ] + 38, 4 ) == 0x20 );
+        REQUIRE( read_le( archive, headers[ 1 ] + 38, 4 ) == 0 );
+        buffer_t expected = archive;
+        std::copy_n( result.cbegin() + static_cast< std::ptrdiff_t >( headers[ 1 ] + 38 ), 4,
+                     expected.begin() + static_cast< std::ptrdiff_t >( headers[ 1 ] + 38 ) );
+        REQUIRE( result == expected );
+    }
+
+    SECTION( "Changing the last write time of an item" ) {
+        // 2021-06-15 12:34:56 UTC, i.e., 1623760496 seconds since the Unix epoch.
+        constexpr uint64_t kUnixTime = 1623760496;
+        constexpr uint64_t kTicks = ( kUnixTime + 11644473600ull ) * 10000000ull;
+        edit.path = "third.txt";
+        edit.hasNewLastWriteTime = true;
+        edit.lastWriteTime.dwLowDateTime = static_cast< uint32_t >( kTicks & 0xFFFFFFFFu );
+        edit.lastWriteTime.dwHighDateTime = static_cast< uint32_t >( kTicks >> 32u );
+        REQUIRE( plan_in_place_metadata_edit( BitFormat::Zip, archivePath, { edit }, plan ) );
+        REQUIRE( plan.patches.size() == 1 );
+        REQUIRE( plan.relocations.empty() );
+
+        REQUIRE_NOTHROW( apply_in_place_append( plan ) );
+        const buffer_t result = load_file( archivePath );
+        REQUIRE( result.size() == archive.size() );
+        REQUIRE( zip_names( result ) == zip_names( archive ) );
+
+        // The MS-DOS time (in local time) is updated in both the central directory and the local headers.
+        const auto headers = zip_central_headers( result );
+        REQUIRE( headers.size() == 3 );
+        const auto dosTime = read_le( result, headers[ 2 ] + 12, 4 );
+        const auto localOffset = static_cast< std::size_t >( read_le( result, headers[ 2 ] + 42, 4 ) );
+        REQUIRE( read_le( result, localOffset + 10, 4 ) == dosTime );
+
+        const auto unixTime = static_cast< std::time_t >( kUnixTime );
+        const std::tm* localTime = std::localtime( &unixTime ); // NOLINT(concurrency-mt-unsafe)
+        REQUIRE( localTime != nullptr );
+        REQUIRE( ( dosTime >> 25u ) + 1980 == static_cast< uint64_t >( localTime->tm_year + 1900 ) );
+        REQUIRE( ( ( dosTime >> 21u ) & 0x0Fu ) == static_cast< uint64_t >( localTime->tm_mon + 1 ) );
+        REQUIRE( ( ( dosTime >> 16u ) & 0x1Fu ) == static_cast< uint64_t >( localTime->tm_mday ) );
+        REQUIRE( ( ( dosTime >> 11u ) & 0x1Fu ) == static_cast< uint64_t >( localTime->tm_hour ) );
+        REQUIRE( ( ( dosTime >> 5u ) & 0x3Fu ) == static_cast< uint64_t >( localTime->tm_min ) );
+        REQUIRE( ( dosTime & 0x1Fu ) * 2 == static_cast< uint64_t >( localTime->tm_sec ) );
+
+        // The other items are left untouched.
+        REQUIRE( read_le( result, headers[ 0 ] + 12, 4 ) == 0 );
+        REQUIRE( read_le( result, headers[ 1 ] + 12, 4 ) == 0 );
+    }
+
+    SECTION( "Items not matching any entry" ) {
+        edit.path = "missing.txt";
+        edit.newPath = "other.txt";
+        REQUIRE_FALSE( plan_in_place_metadata_edit( BitFormat::Zip, archivePath, { edit }, plan ) );
+    }
+
+    SECTION( "Formats not supporting in place edits" ) {
+        edit.path = "third.txt";
+        edit.newPath = "other.txt";
+        REQUIRE_FALSE( plan_in_place_metadata_edit( BitFormat::SevenZip, archivePath, { edit }, plan ) );
+    }
+
+    fs::path journalPath = archivePath;
+    journalPath += ".journal";
+    REQUIRE_FALSE( fs::exists( journalPath ) );
+}
+
+TEST_CASE( "inplaceappend: Copying the raw entries of zip archives", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path firstPath = tempDir.path() / "first.zip";
+    const fs::path secondPath = tempDir.path() / "second.zip";
+    const fs::path outPath = tempDir.path() / "out.zip";
+    write_file( firstPath, make_zip( { { "folder/", "" }, { "folder/first.txt", "Hello, World!" } } ) );
+    write_file( secondPath, make_zip( { { "second.txt", "Lorem ipsum" }, { "third.txt", "dolor sit amet" } } ) );
+
+    RawEntriesSource first{ firstPath, {}, {} };
+    RawEntriesSource second{ secondPath, {}, {} };
+    REQUIRE( read_raw_entries( BitFormat::Zip, firstPath, first.entries ) );
+    REQUIRE( read_raw_entries( BitFormat::Zip, secondPath, second.entries ) );
+    REQUIRE_FALSE( read_raw_entries( BitFormat::SevenZip, firstPath, first.entries ) );
+    REQUIRE( read_raw_entries( BitFormat::Zip, firstPath, first.entries ) );
+
+    REQUIRE( first.entries.size() == 2 );
+    REQUIRE( first.entries[ 0 ].path == "folder" );
+    REQUIRE( first.entries[ 0 ].isDir );
+    REQUIRE( first.entries[ 1 ].path == "folder/first.txt" );
+    REQUIRE_FALSE( first.entries[ 1 ].isDir );
+    REQUIRE( first.entries[ 1 ].offset == 30 + 7 );
+    REQUIRE( first.entries[ 1 ].size == 30 + 16 + 13 );
+    REQUIRE_FALSE( first.entries[ 0 ].isStored );
+    REQUIRE( first.entries[ 1 ].isStored );
+    REQUIRE( first.entries[ 1 ].dataOffset == 30 + 7 + 30 + 16 );
+    REQUIRE( first.entries[ 1 ].dataSize == 13 );
+
+    second.entries.erase( second.entries.begin() ); // Skipping second.txt
+    REQUIRE( write_raw_archive( BitFormat::Zip, { first, second }, outPath ) );
+    const auto names = zip_names( load_file( outPath ) );
+    REQUIRE( names.size() == 3 );
+    REQUIRE( names[ 0 ].first == "folder/" );
+    REQUIRE( names[ 1 ].first == "folder/first.txt" );
+    REQUIRE( names[ 1 ].second == "folder/first.txt" );
+    REQUIRE( names[ 2 ].first == "third.txt" );
+    REQUIRE( names[ 2 ].second == "third.txt" );
+}
+
+TEST_CASE( "inplaceappend: Copying the raw entries of tar archives", "[inplaceappend]" ) {
+    const TempDirectory tempDir{ "bit7z_test_inplaceappend" };
+    const fs::path firstPath = tempDir.path() / "first.tar";
+    const fs::path secondPath = tempDir.path() / "second.tar";
+    const fs::path outPath = tempDir.path() / "out.tar";
+    const buffer_t firstArchive = make_tar( "first.txt", "Hello, World!", 20 * kBlockSize );
+    const buffer_t secondArchive = make_tar( "second.txt", std::string( 1000, 'x' ), kBlockSize );
+    write_file( firstPath, firstArchive );
+    write_file( secondPath, secondArchive );
+
+    RawEntriesSource first{ firstPath, {}, {} };
+    RawEntriesSource second{ secondPath, {}, {} };
+    REQUIRE( read_raw_entries( BitFormat::Tar, firstPath, first.entries ) );
+    REQUIRE( read_raw_entries( BitFormat::Tar, secondPath, second.entries ) );
+    REQUIRE( first.entries.size() == 1 );
+    REQUIRE( first.entries[ 0 ].path == "first.txt" );
+    REQUIRE( first.entries[ 0 ].size == 2 * kBlockSize );
+    REQUIRE( first.entries[ 0 ].isStored );
+    REQUIRE( first.entries[ 0 ].dataOffset == kBlockSize );
+    REQUIRE( first.entries[ 0 ].dataSize == 13 );
+    REQUIRE( second.entries.size() == 1 );
+    REQUIRE( second.entries[ 0 ].size == 3 * kBlockSize );
+    REQUIRE( second.entries[ 0 ].dataSize == 1000 );
+
+    REQUIRE( write_raw_archive( BitFormat::Tar, { second, first }, outPath ) );
+    const buffer_t result = load_file( outPath );
+    REQUIRE( result.size() == 7 * kBlockSize );
+    REQUIRE( std::equal( secondArchive.cbegin(), secondArchive.cbegin() + 3 * kBlockSize, result.cbegin() ) );
+    REQUIRE( std::equal( firstArchive.cbegin(), firstArchive.cbegin() + 2 * kBlockSize,
+                         result.cbegin() + 3 * kBlockSize ) );
+    REQUIRE( std::all_of( result.cbegin() + 5 * kBlockSize, result.cend(),
+                          []( byte_t value ) -> bool { return value == 0; } ) );
+}
+
+#endif
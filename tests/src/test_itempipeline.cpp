@@ -0,0 +1,155 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/itempipeline.hpp>
+
+#include "utils/filesystem.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+using bit7z::buffer_t;
+using bit7z::ItemPipeline;
+
+constexpr auto kNoMemoryLimit = ( std::numeric_limits< uint64_t >::max )();
+
+namespace {
+auto read_item( ItemPipeline& pipeline, std::size_t index, buffer_t& result ) -> HRESULT {
+    buffer_t chunk( 7 );
+    while ( true ) {
+        uint32_t processedSize = 0;
+        const HRESULT res = pipeline.read( index, chunk.data(), static_cast< uint32_t >( chunk.size() ),
+                                           processedSize );
+        if ( res != S_OK || processedSize == 0 ) {
+            return res;
+        }
+        result.insert( result.end(), chunk.begin(), chunk.begin() + processedSize );
+    }
+}
+
+auto make_content( std::size_t size, std::uint8_t first ) -> buffer_t {
+    buffer_t content( size );
+    std::iota( content.begin(), content.end(), first );
+    return content;
+}
+
+// Note: Catch2 assertions are not thread-safe, so the producer only records the results of the writes.
+auto start_producer( ItemPipeline& pipeline, const std::vector< buffer_t >& contents, bool& writesSucceeded )
+    -> std::thread {
+    return std::thread{ [ &pipeline, &contents, &writesSucceeded ]() {
+        for ( std::size_t index = 0; index < contents.size(); ++index ) {
+            const auto& content = contents[ index ];
+            for ( std::size_t offset = 0; offset < content.size(); offset += 10 ) {
+                const auto size = static_cast< uint32_t >( ( std::min )( content.size() - offset, std::size_t{ 10 } ) );
+                writesSucceeded = writesSucceeded && pipeline.write( index, &content[ offset ], size ) == S_OK;
+            }
+            pipeline.finishItem( index, true );
+        }
+        pipeline.finish();
+    } };
+}
+} // namespace
+
+TEST_CASE( "ItemPipeline: Streaming items through bounded pipes", "[itempipeline]" ) {
+    constexpr uint64_t kCapacity = 16;
+    const std::vector< buffer_t > contents{ make_content( 100, 0 ), make_content( 0, 0 ), make_content( 53, 9 ) };
+    ItemPipeline pipeline{ contents.size(), kCapacity, kNoMemoryLimit, {} };
+
+    bool writesSucceeded = true;
+    std::thread producer = start_producer( pipeline, contents, writesSucceeded );
+
+    std::vector< buffer_t > results( contents.size() );
+    SECTION( "Reading the items in order" ) {
+        for ( std::size_t index = 0; index < contents.size(); ++index ) {
+            REQUIRE( read_item( pipeline, index, results[ index ] ) == S_OK );
+        }
+    }
+
+    SECTION( "Reading the items out of order" ) {
+        // Requesting the last item makes the producer buffer the preceding ones without limits.
+        REQUIRE( read_item( pipeline, 2, results[ 2 ] ) == S_OK );
+        REQUIRE( read_item( pipeline, 0, results[ 0 ] ) == S_OK );
+        REQUIRE( read_item( pipeline, 1, results[ 1 ] ) == S_OK );
+    }
+    producer.join();
+    REQUIRE( writesSucceeded );
+    REQUIRE( results == contents );
+    REQUIRE( pipeline.spilledSize() == 0 );
+}
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+TEST_CASE( "ItemPipeline: Spilling the items buffered out of order", "[itempipeline]" ) {
+    namespace fs = bit7z::fs;
+    using bit7z::test::filesystem::TempDirectory;
+
+    constexpr uint64_t kCapacity = 16;
+    constexpr uint64_t kMemoryLimit = 32;
+    const std::vector< buffer_t > contents{ make_content( 100, 0 ), make_content( 75, 3 ), make_content( 53, 9 ) };
+
+    const TempDirectory tempDir{ "bit7z_test_itempipeline" };
+    const auto spillBasePath = tempDir.path() / "archive";
+    std::vector< buffer_t > results( contents.size() );
+    {
+        ItemPipeline pipeline{ contents.size(), kCapacity, kMemoryLimit, spillBasePath };
+        bool writesSucceeded = true;
+        std::thread producer = start_producer( pipeline, contents, writesSucceeded );
+
+        // Requesting the last item makes the producer buffer the preceding ones beyond the memory limit.
+        REQUIRE( read_item( pipeline, 2, results[ 2 ] ) == S_OK );
+        REQUIRE( read_item( pipeline, 0, results[ 0 ] ) == S_OK );
+        REQUIRE( read_item( pipeline, 1, results[ 1 ] ) == S_OK );
+        producer.join();
+        REQUIRE( writesSucceeded );
+        REQUIRE( results == contents );
+        REQUIRE( pipeline.spilledSize() >= contents[ 0 ].size() + contents[ 1 ].size() - kMemoryLimit );
+        REQUIRE( std::distance( fs::directory_iterator{ tempDir.path() }, fs::directory_iterator{} ) == 1 );
+    }
+    // The temporary file is removed together with the pipeline.
+    REQUIRE( fs::is_empty( tempDir.path() ) );
+}
+#endif
+
+TEST_CASE( "ItemPipeline: Failures and cancellation", "[itempipeline]" ) {
+    ItemPipeline pipeline{ 2, 4, kNoMemoryLimit, {} };
+    const buffer_t content = make_content( 4, 0 );
+    REQUIRE( pipeline.write( 0, content.data(), 4 ) == S_OK );
+
+    SECTION( "An item failed by the producer cannot be read" ) {
+        pipeline.finishItem( 0, false );
+        buffer_t result;
+        REQUIRE( read_item( pipeline, 0, result ) == E_FAIL );
+    }
+
+    SECTION( "The items not written when the producer stops cannot be read" ) {
+        pipeline.finishItem( 0, true );
+        pipeline.finish();
+        buffer_t result;
+        REQUIRE( read_item( pipeline, 0, result ) == S_OK );
+        REQUIRE( result == content );
+        REQUIRE( read_item( pipeline, 1, result ) == E_FAIL );
+    }
+
+    SECTION( "Cancelling the pipeline stops a producer waiting for a full pipe" ) {
+        HRESULT writeResult = S_OK;
+        std::thread producer{ [ &pipeline, &content, &writeResult ]() {
+            writeResult = pipeline.write( 0, content.data(), 4 );
+        } };
+        pipeline.cancel();
+        producer.join();
+        REQUIRE( writeResult == E_ABORT );
+        REQUIRE( pipeline.isCancelled() );
+    }
+}
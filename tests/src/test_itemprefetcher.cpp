@@ -0,0 +1,124 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <catch2/catch.hpp>
+
+#include "utils/filesystem.hpp"
+
+#include <bititemsvector.hpp>
+#include <internal/fs.hpp>
+#include <internal/genericinputitem.hpp>
+#include <internal/itemprefetcher.hpp>
+
+#include <7zip/IStream.h>
+
+#include <fstream>
+#include <numeric>
+#include <string>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+
+namespace {
+auto read_stream( ISequentialInStream* stream ) -> buffer_t {
+    buffer_t result;
+    byte_t chunk[ 4096 ]; // NOLINT(*-avoid-c-arrays)
+    UInt32 processedSize = 0;
+    do {
+        REQUIRE( stream->Read( chunk, sizeof( chunk ), &processedSize ) == S_OK );
+        result.insert( result.end(), chunk, chunk + processedSize ); // NOLINT(*-pointer-arithmetic)
+    } while ( processedSize > 0 );
+    return result;
+}
+} // namespace
+
+TEST_CASE( "ItemPrefetcher: Prefetching the content of the input files", "[itemprefetcher]" ) {
+    const TempDirectory tempDir{ "bit7z_test_itemprefetcher" };
+    const fs::path& inDir = tempDir.path();
+
+    // The budget is 64 KiB, so the files bigger than 16 KiB are not prefetched.
+    constexpr uint64_t kBudget = 64 * 1024;
+    const std::vector< std::size_t > sizes{
+        0, 100, 16 * 1024, 16 * 1024 + 1, 10, 15000, 15000, 15000, 15000, 200000, 1
+    };
+    std::vector< buffer_t > contents;
+    std::vector< tstring > inPaths;
+    for ( std::size_t index = 0; index < sizes.size(); ++index ) {
+        buffer_t content( sizes[ index ] );
+        std::iota( content.begin(), content.end(), static_cast< byte_t >( index ) );
+        const fs::path filePath = inDir / std::to_string( index );
+        std::ofstream stream{ filePath, std::ios::binary };
+        stream.write( reinterpret_cast< const char* >( content.data() ), // NOLINT(*-reinterpret-cast)
+                      static_cast< std::streamsize >( content.size() ) );
+        contents.push_back( std::move( content ) );
+        inPaths.push_back( filePath.string< tchar >() );
+    }
+    fs::create_directory( inDir / "folder" );
+    inPaths.push_back( ( inDir / "folder" ).string< tchar >() );
+
+    BitItemsVector items;
+    items.indexPaths( inPaths );
+    REQUIRE( items.size() == sizes.size() + 1 );
+
+    const auto threadsCount = GENERATE( 1u, 2u, 8u );
+    DYNAMIC_SECTION( "Threads count: " << threadsCount ) {
+        ItemPrefetcher prefetcher{ items, kBudget, threadsCount };
+
+        SECTION( "Taking the items in order" ) {
+            for ( std::size_t index = 0; index < sizes.size(); ++index ) {
+                /* Note: the items are claimed in order, and the budget is enough for the ones following
+                 *       the taken items, so every small item is prefetched before being taken. */
+                prefetcher.waitIdle();
+                const auto stream = prefetcher.take( index );
+                if ( sizes[ index ] > kBudget / 4 ) {
+                    REQUIRE( stream == nullptr ); // The caller must read the item synchronously.
+                } else {
+                    REQUIRE( stream != nullptr );
+                    REQUIRE( read_stream( stream ) == contents[ index ] );
+                }
+            }
+        }
+
+        SECTION( "Taking the items out of order" ) {
+            // The items 0 to 7 (61494 bytes) use most of the budget, so the item 8 waits for it.
+            prefetcher.waitIdle();
+            REQUIRE( prefetcher.take( 8 ) == nullptr );
+
+            // The items waiting for the budget must not block the ones taken before them.
+            for ( const std::size_t index : { 7, 6, 5, 4, 1, 0 } ) {
+                const auto stream = prefetcher.take( index );
+                REQUIRE( stream != nullptr );
+                REQUIRE( read_stream( stream ) == contents[ index ] );
+            }
+
+            // The budget freed by the taken items allows prefetching the last item.
+            prefetcher.waitIdle();
+            const auto stream = prefetcher.take( 10 );
+            REQUIRE( stream != nullptr );
+            REQUIRE( read_stream( stream ) == contents[ 10 ] );
+        }
+
+        SECTION( "Taking an item twice, or not prefetched items" ) {
+            prefetcher.waitIdle();
+            REQUIRE( prefetcher.take( 1 ) != nullptr );
+            REQUIRE( prefetcher.take( 1 ) == nullptr );
+            REQUIRE( prefetcher.take( sizes.size() ) == nullptr ); // Folder.
+            REQUIRE( prefetcher.take( sizes.size() + 1 ) == nullptr ); // Out of range.
+        }
+
+        // Destroying the prefetcher with items not yet taken must not hang.
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <internal/readaheadadvisor.hpp>
+
+using bit7z::coalesce_data_ranges;
+using bit7z::DataRange;
+using bit7z::kNoDataRange;
+
+namespace bit7z { // Note: the operator must be in the namespace of DataRange, to be found by std::vector's operator==.
+auto operator==( const DataRange& first, const DataRange& second ) -> bool {
+    return first.offset == second.offset && first.size == second.size;
+}
+} // namespace bit7z
+
+TEST_CASE( "ReadAheadAdvisor: Coalescing the data ranges of the items", "[readaheadadvisor]" ) {
+    const std::vector< DataRange > ranges{
+        { 5000, 100 }, // 0
+        { 0, 100 },    // 1
+        { 150, 50 },   // 2: 50 bytes after the end of range 1
+        { 0, 0 },      // 3: unknown range
+        { 180, 100 },  // 4: overlapping range 2
+        { 5100, 10 }   // 5: contiguous to range 0
+    };
+    std::vector< std::size_t > rangeIndices;
+
+    SECTION( "Merging only overlapping and contiguous ranges" ) {
+        const auto result = coalesce_data_ranges( ranges, 0, rangeIndices );
+        REQUIRE( result == std::vector< DataRange >{ { 0, 100 }, { 150, 130 }, { 5000, 110 } } );
+        REQUIRE( rangeIndices == std::vector< std::size_t >{ 2, 0, 1, kNoDataRange, 1, 2 } );
+    }
+
+    SECTION( "Merging the ranges separated by small gaps" ) {
+        const auto result = coalesce_data_ranges( ranges, 50, rangeIndices );
+        REQUIRE( result == std::vector< DataRange >{ { 0, 280 }, { 5000, 110 } } );
+        REQUIRE( rangeIndices == std::vector< std::size_t >{ 1, 0, 0, kNoDataRange, 0, 1 } );
+    }
+
+    SECTION( "Merging all the ranges within a big window" ) {
+        const auto result = coalesce_data_ranges( ranges, 10000, rangeIndices );
+        REQUIRE( result == std::vector< DataRange >{ { 0, 5110 } } );
+        REQUIRE( rangeIndices == std::vector< std::size_t >{ 0, 0, 0, kNoDataRange, 0, 0 } );
+    }
+
+    SECTION( "No known ranges" ) {
+        REQUIRE( coalesce_data_ranges( { { 10, 0 } }, 10, rangeIndices ).empty() );
+        REQUIRE( rangeIndices == std::vector< std::size_t >{ kNoDataRange } );
+    }
+}
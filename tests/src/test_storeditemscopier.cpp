@@ -0,0 +1,164 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+// Note: the items are never copied directly on Windows.
+#if defined( BIT7Z_TESTS_FILESYSTEM ) && !defined( _WIN32 )
+
+#include <catch2/catch.hpp>
+
+#include "utils/archivebuilder.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/shared_lib.hpp"
+
+#include <bitarchivereader.hpp>
+#include <bitexception.hpp>
+#include <bitfilecompressor.hpp>
+#include <bitfileextractor.hpp>
+#include <bitformat.hpp>
+#include <internal/storeditemscopier.hpp>
+#include <internal/stringutil.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace bit7z;
+using namespace bit7z::test;
+using namespace bit7z::test::filesystem;
+
+TEST_CASE( "StoredItemsCopier: Copying the stored items of an archive", "[storeditemscopier]" ) {
+    const TempDirectory tempDir{ "bit7z_test_storeditemscopier" };
+    const fs::path& testDir = tempDir.path();
+    REQUIRE( fs::create_directories( testDir / "input" / "folder" ) );
+
+    const std::map< fs::path, std::string > files{
+        { fs::path{ "first.txt" }, "The content of the first file." },
+        { fs::path{ "folder" } / "second.txt", "The content of the second file, stored in a folder." },
+        { fs::path{ "empty.txt" }, "" }
+    };
+    for ( const auto& file : files ) {
+        write_file( testDir / "input" / file.first, file.second );
+    }
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+
+    const auto* format = GENERATE( as< const BitInOutFormat* >(), &BitFormat::Zip, &BitFormat::Tar );
+    DYNAMIC_SECTION( "Archive format: " << format->extension() ) {
+        const auto archivePath = path_to_tstring( testDir / ( tstring{ BIT7Z_STRING( "archive" ) } +
+                                                              format->extension() ) );
+        {
+            const TestDirectory inputDir{ testDir / "input" };
+            BitFileCompressor compressor{ lib, *format };
+            compressor.setCompressionLevel( BitCompressionLevel::None ); // The zip entries use the Copy method.
+            compressor.compress( std::vector< tstring >{ BIT7Z_STRING( "first.txt" ),
+                                                         BIT7Z_STRING( "folder" ),
+                                                         BIT7Z_STRING( "empty.txt" ) }, archivePath );
+        }
+        const BitArchiveReader reader{ lib, archivePath, *format };
+
+        SECTION( "Copying the files" ) {
+            for ( const auto mode : { StoredCopyMode::Verify, StoredCopyMode::NoVerify } ) {
+                const StoredItemsCopier copier{ reader, mode };
+                for ( const auto& item : reader.items() ) {
+                    if ( item.isDir() ) {
+                        REQUIRE_FALSE( copier.canCopy( item.index() ) );
+                        continue;
+                    }
+                    REQUIRE( copier.canCopy( item.index() ) );
+                    const fs::path outPath = testDir / "copied";
+                    copier.copy( item.index(), outPath );
+                    REQUIRE( load_file( outPath ) == to_buffer( files.at( tstring_to_path( item.path() ) ) ) );
+                }
+            }
+        }
+
+        SECTION( "Disabled direct copy" ) {
+            const StoredItemsCopier copier{ reader, StoredCopyMode::Disabled };
+            for ( const auto& item : reader.items() ) {
+                REQUIRE_FALSE( copier.canCopy( item.index() ) );
+            }
+        }
+    }
+}
+
+TEST_CASE( "StoredItemsCopier: Verifying the CRC of the copied items", "[storeditemscopier]" ) {
+    const TempDirectory tempDir{ "bit7z_test_storeditemscopier" };
+    const fs::path& testDir = tempDir.path();
+
+    // The CRC stored in the archive doesn't match the content of the entry.
+    const std::string content = "The content of a file with a wrong CRC.";
+    const fs::path archivePath = testDir / "archive.zip";
+    write_file( archivePath, make_zip( { { "file.txt", content, content_crc( content ) ^ 1u } } ) );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), BitFormat::Zip };
+    const fs::path outPath = testDir / "file.txt";
+
+    SECTION( "Verifying the CRC" ) {
+        const StoredItemsCopier copier{ reader, StoredCopyMode::Verify };
+        REQUIRE( copier.canCopy( 0 ) );
+        REQUIRE_THROWS_AS( copier.copy( 0, outPath ), BitException );
+        REQUIRE_FALSE( fs::exists( outPath ) );
+    }
+
+    SECTION( "Not verifying the CRC" ) {
+        const StoredItemsCopier copier{ reader, StoredCopyMode::NoVerify };
+        REQUIRE( copier.canCopy( 0 ) );
+        REQUIRE_NOTHROW( copier.copy( 0, outPath ) );
+        REQUIRE( load_file( outPath ) == to_buffer( content ) );
+    }
+}
+
+TEST_CASE( "StoredItemsCopier: Entries not matching the items of the archive", "[storeditemscopier]" ) {
+    const TempDirectory tempDir{ "bit7z_test_storeditemscopier" };
+    const fs::path& testDir = tempDir.path();
+
+    /* The central directory lists the entries in the reverse order of their data: since 7-Zip sorts the items
+     * by the position of their local headers, the entries read from the central directory don't match the items
+     * having the same index, and they must not be copied (the files have the same size, so only the paths differ). */
+    const std::string firstContent = "The content of the first file.";
+    const std::string secondContent = "The content of the other file";
+    REQUIRE( firstContent.size() == secondContent.size() );
+    const fs::path archivePath = testDir / "archive.zip";
+    write_file( archivePath, make_zip( { { "first.txt", firstContent }, { "second.txt", secondContent } }, true ) );
+
+    const Bit7zLibrary lib{ test::sevenzip_lib_path() };
+    const std::map< fs::path, buffer_t > expected{
+        { fs::path{ "first.txt" }, to_buffer( firstContent ) },
+        { fs::path{ "second.txt" }, to_buffer( secondContent ) }
+    };
+
+    SECTION( "The copier rejects the mismatched entries" ) {
+        const BitArchiveReader reader{ lib, path_to_tstring( archivePath ), BitFormat::Zip };
+        const StoredItemsCopier copier{ reader, StoredCopyMode::Verify };
+        for ( const auto& item : reader.items() ) {
+            // If an item is copied, its content must be the one of the item, not of the entry at the same position.
+            if ( copier.canCopy( item.index() ) ) {
+                const fs::path outPath = testDir / "copied";
+                copier.copy( item.index(), outPath );
+                REQUIRE( load_file( outPath ) == expected.at( tstring_to_path( item.path() ) ) );
+            }
+        }
+    }
+
+    SECTION( "The extraction falls back to 7-Zip for the mismatched entries" ) {
+        BitFileExtractor extractor{ lib, BitFormat::Zip };
+        extractor.setStoredCopyMode( StoredCopyMode::Verify );
+        const fs::path outDir = testDir / "extracted";
+        extractor.extract( path_to_tstring( archivePath ), path_to_tstring( outDir ) );
+        for ( const auto& file : expected ) {
+            REQUIRE( load_file( outDir / file.first ) == file.second );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,89 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef BIT7Z_TESTS_FILESYSTEM
+
+#include <catch2/catch.hpp>
+
+#include "utils/filesystem.hpp"
+
+#include <bitexception.hpp>
+#include <internal/dateutil.hpp>
+#include <internal/fs.hpp>
+#include <internal/uringfilewriter.hpp>
+
+#include <numeric>
+#include <string>
+
+using namespace bit7z;
+using namespace bit7z::test::filesystem;
+
+TEST_CASE( "UringFileWriter: Writing small files in batches", "[uringfilewriter]" ) {
+    UringFileWriter writer;
+    if ( !writer.isAvailable() ) {
+        return; // E.g., not on Linux, or io_uring is disabled on this system.
+    }
+
+    const TempDirectory tempDir{ "bit7z_test_uringfilewriter" };
+    const fs::path& outDir = tempDir.path();
+
+    // More files than the slots, so that some slots are reused.
+    constexpr std::size_t kFilesCount = UringFileWriter::kSlotsCount * 2 + 3;
+    const FILETIME modifiedTime{ 0x2A2A2A00, 0x01D9A2B3 };
+    std::vector< buffer_t > contents;
+    for ( std::size_t index = 0; index < kFilesCount; ++index ) {
+        const uint32_t slot = writer.acquireSlot();
+        auto& buffer = writer.slotBuffer( slot );
+        buffer.resize( ( index * 997 ) % UringFileWriter::kMaxFileSize + 1 );
+        std::iota( buffer.begin(), buffer.end(), static_cast< byte_t >( index ) );
+        contents.push_back( buffer );
+        writer.writeFile( slot, outDir / std::to_string( index ), 0644, &modifiedTime );
+    }
+
+    SECTION( "A released slot does not create a file" ) {
+        const uint32_t slot = writer.acquireSlot();
+        writer.slotBuffer( slot ).assign( 10, 0 );
+        writer.releaseSlot( slot );
+        REQUIRE_NOTHROW( writer.flush() );
+        REQUIRE_FALSE( fs::exists( outDir / std::to_string( kFilesCount ) ) );
+    }
+
+    SECTION( "A failure is reported by the flush" ) {
+        const uint32_t slot = writer.acquireSlot();
+        writer.slotBuffer( slot ).assign( 10, 0 );
+        writer.writeFile( slot, outDir / "missing" / "file", 0644, nullptr );
+        REQUIRE_THROWS_AS( writer.flush(), BitException );
+        REQUIRE_NOTHROW( writer.flush() ); // The error is reported only once.
+    }
+
+    SECTION( "A queued file is written before its path is reused" ) {
+        const auto filePath = outDir / std::to_string( kFilesCount - 1 );
+        writer.waitFile( filePath );
+        REQUIRE( load_file( filePath ) == contents.back() ); // Even if the other files might be still queued.
+
+        const uint32_t slot = writer.acquireSlot();
+        writer.slotBuffer( slot ).assign( 10, 42 );
+        contents.back() = writer.slotBuffer( slot );
+        writer.writeFile( slot, filePath, 0644, &modifiedTime );
+        writer.waitFile( filePath );
+        REQUIRE( load_file( filePath ) == contents.back() );
+        REQUIRE_NOTHROW( writer.flush() );
+    }
+
+    for ( std::size_t index = 0; index < kFilesCount; ++index ) {
+        const auto filePath = outDir / std::to_string( index );
+        REQUIRE( load_file( filePath ) == contents[ index ] );
+        REQUIRE( fs::last_write_time( filePath ) == FILETIME_to_file_time_type( modifiedTime ) );
+    }
+}
+
+#endif
@@ -0,0 +1,137 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include "archivebuilder.hpp"
+
+#include <internal/crc32.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace test {
+
+ZipEntry::ZipEntry( std::string entryName, std::string entryContent )
+    : name{ std::move( entryName ) }, content{ std::move( entryContent ) }, crc{ content_crc( content ) } {}
+
+ZipEntry::ZipEntry( std::string entryName, std::string entryContent, uint32_t entryCrc )
+    : name{ std::move( entryName ) }, content{ std::move( entryContent ) }, crc{ entryCrc } {}
+
+void append_le( buffer_t& buffer, uint64_t value, std::size_t size ) {
+    for ( std::size_t i = 0; i < size; ++i ) {
+        buffer.push_back( static_cast< byte_t >( ( value >> ( 8 * i ) ) & 0xFFu ) );
+    }
+}
+
+auto read_le( const buffer_t& buffer, std::size_t offset, std::size_t size ) -> uint64_t {
+    uint64_t value = 0;
+    for ( std::size_t i = size; i > 0; --i ) {
+        value = ( value << 8u ) | buffer[ offset + i - 1 ];
+    }
+    return value;
+}
+
+auto to_buffer( const std::string& content ) -> buffer_t {
+    return buffer_t{ content.cbegin(), content.cend() };
+}
+
+auto content_crc( const std::string& content ) -> uint32_t {
+    return crc32_update( 0, reinterpret_cast< const byte_t* >( content.data() ), content.size() ); // NOLINT
+}
+
+auto make_tar( const std::string& name, const std::string& content, std::size_t recordSize ) -> buffer_t {
+    buffer_t archive( kTarBlockSize, 0 );
+    std::memcpy( archive.data(), name.c_str(), name.size() );
+    std::snprintf( reinterpret_cast< char* >( &archive[ 100 ] ), 8, "%07o", 0644 ); // NOLINT
+    std::snprintf( reinterpret_cast< char* >( &archive[ 124 ] ), 12, "%011o", // NOLINT
+                   static_cast< unsigned >( content.size() ) );
+    archive[ 156 ] = '0';
+    std::memset( &archive[ 148 ], ' ', 8 );
+    unsigned checksum = 0;
+    for ( const auto value : archive ) {
+        checksum += value;
+    }
+    std::snprintf( reinterpret_cast< char* >( &archive[ 148 ] ), 8, "%06o", checksum ); // NOLINT
+
+    archive.insert( archive.end(), content.cbegin(), content.cend() );
+    archive.resize( ( ( archive.size() + kTarBlockSize - 1 ) / kTarBlockSize ) * kTarBlockSize, 0 );
+    archive.resize( ( ( archive.size() + 2 * kTarBlockSize + recordSize - 1 ) / recordSize ) * recordSize, 0 );
+    return archive;
+}
+
+auto make_zip( const std::vector< ZipEntry >& entries, bool reverseCentralDirectory ) -> buffer_t {
+    buffer_t archive;
+    std::vector< buffer_t > centralHeaders;
+    for ( const auto& entry : entries ) {
+        const auto localHeaderOffset = archive.size();
+        const auto size = entry.content.size();
+        buffer_t commonFields;
+        append_le( commonFields, 20, 2 ); // Version needed to extract
+        append_le( commonFields, 0, 2 ); // Flags
+        append_le( commonFields, 0, 2 ); // Method (stored)
+        append_le( commonFields, 0, 4 ); // Modification time and date
+        append_le( commonFields, entry.crc, 4 );
+        append_le( commonFields, size, 4 ); // Compressed size
+        append_le( commonFields, size, 4 ); // Uncompressed size
+        append_le( commonFields, entry.name.size(), 2 );
+        append_le( commonFields, 0, 2 ); // Extra field length
+
+        append_le( archive, 0x04034B50, 4 );
+        archive.insert( archive.end(), commonFields.cbegin(), commonFields.cend() );
+        archive.insert( archive.end(), entry.name.cbegin(), entry.name.cend() );
+        archive.insert( archive.end(), entry.content.cbegin(), entry.content.cend() );
+
+        buffer_t centralHeader;
+        append_le( centralHeader, 0x02014B50, 4 );
+        append_le( centralHeader, 20, 2 ); // Version made by
+        centralHeader.insert( centralHeader.end(), commonFields.cbegin(), commonFields.cend() );
+        append_le( centralHeader, 0, 2 ); // Comment length
+        append_le( centralHeader, 0, 2 ); // Disk number
+        append_le( centralHeader, 0, 2 ); // Internal attributes
+        append_le( centralHeader, 0, 4 ); // External attributes
+        append_le( centralHeader, localHeaderOffset, 4 );
+        centralHeader.insert( centralHeader.end(), entry.name.cbegin(), entry.name.cend() );
+        centralHeaders.push_back( std::move( centralHeader ) );
+    }
+    if ( reverseCentralDirectory ) {
+        std::reverse( centralHeaders.begin(), centralHeaders.end() );
+    }
+
+    const auto centralDirOffset = archive.size();
+    for ( const auto& centralHeader : centralHeaders ) {
+        archive.insert( archive.end(), centralHeader.cbegin(), centralHeader.cend() );
+    }
+    append_le( archive, 0x06054B50, 4 );
+    append_le( archive, 0, 4 ); // Disk numbers
+    append_le( archive, entries.size(), 2 );
+    append_le( archive, entries.size(), 2 );
+    append_le( archive, archive.size() - 12 - centralDirOffset, 4 ); // Central directory size
+    append_le( archive, centralDirOffset, 4 );
+    append_le( archive, 0, 2 ); // Comment length
+    return archive;
+}
+
+void write_file( const fs::path& filePath, const buffer_t& content ) {
+    fs::ofstream outFile{ filePath, std::ios::binary | std::ios::trunc };
+    outFile.write( reinterpret_cast< const char* >( content.data() ), // NOLINT(*-reinterpret-cast)
+                   static_cast< std::streamsize >( content.size() ) );
+}
+
+void write_file( const fs::path& filePath, const std::string& content ) {
+    fs::ofstream outFile{ filePath, std::ios::binary | std::ios::trunc };
+    outFile << content;
+}
+
+} // namespace test
+} // namespace bit7z
@@ -0,0 +1,57 @@
+/*
+ * bit7z - A C++ static library to interface with the 7-zip shared libraries.
+ * Copyright (c) 2014-2023 Riccardo Ostani - All Rights Reserved.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef ARCHIVEBUILDER_HPP
+#define ARCHIVEBUILDER_HPP
+
+#include <bit7z/bittypes.hpp>
+#include <internal/fs.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
+namespace test {
+
+constexpr std::size_t kTarBlockSize = 512;
+
+struct ZipEntry {
+    std::string name;
+    std::string content;
+    uint32_t crc; // The CRC stored in the headers of the entry (not necessarily matching the content).
+
+    ZipEntry( std::string entryName, std::string entryContent );
+
+    ZipEntry( std::string entryName, std::string entryContent, uint32_t entryCrc );
+};
+
+void append_le( buffer_t& buffer, uint64_t value, std::size_t size );
+
+auto read_le( const buffer_t& buffer, std::size_t offset, std::size_t size ) -> uint64_t;
+
+auto to_buffer( const std::string& content ) -> buffer_t;
+
+auto content_crc( const std::string& content ) -> uint32_t;
+
+// Creates a tar archive containing a single file with the given name and content.
+auto make_tar( const std::string& name, const std::string& content, std::size_t recordSize ) -> buffer_t;
+
+// Creates a zip archive storing the given entries without compression, optionally listing them
+// in the central directory in the reverse order of their local headers.
+auto make_zip( const std::vector< ZipEntry >& entries, bool reverseCentralDirectory = false ) -> buffer_t;
+
+void write_file( const fs::path& filePath, const buffer_t& content );
+
+void write_file( const fs::path& filePath, const std::string& content );
+
+} // namespace test
+} // namespace bit7z
+
+#endif //ARCHIVEBUILDER_HPP
@@ -10,6 +10,11 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+
 #include "filesystem.hpp"
 
 namespace bit7z { // NOLINT(modernize-concat-nested-namespaces)
@@ -158,6 +163,31 @@ TestDirectory::~TestDirectory() {
     set_current_dir( mOldCurrentDirectory );
 }
 
+TempDirectory::TempDirectory( const std::string& prefix ) {
+    static std::atomic< unsigned > counter{ 0 };
+    std::random_device randomDevice;
+    const fs::path tempDir = fs::temp_directory_path();
+    do {
+        mPath = tempDir / ( prefix + "_" + std::to_string( randomDevice() ) + "_" + std::to_string( counter++ ) );
+    } while ( !fs::create_directory( mPath ) );
+}
+
+TempDirectory::~TempDirectory() {
+    std::error_code error;
+    fs::remove_all( mPath, error );
+}
+
+auto TempDirectory::path() const -> const fs::path& {
+    return mPath;
+}
+
+auto past_file_time() -> fs::file_time_type {
+    using std::chrono::duration_cast;
+    const auto time = fs::file_time_type::clock::now() - std::chrono::hours{ 24 * 30 };
+    const auto seconds = duration_cast< std::chrono::seconds >( time.time_since_epoch() );
+    return fs::file_time_type{ duration_cast< fs::file_time_type::duration >( seconds - ( seconds % 2 ) ) };
+}
+
 } // namespace filesystem
 } // namespace test
 } // namespace bit7z
\ No newline at end of file
@@ -148,6 +148,29 @@ class TestDirectory {
         ~TestDirectory();
 };
 
+// A uniquely named directory, created inside the temporary directory of the system, and removed with its content.
+class TempDirectory {
+        fs::path mPath;
+    public:
+        explicit TempDirectory( const std::string& prefix );
+
+        explicit TempDirectory( const TempDirectory& ) = delete;
+
+        explicit TempDirectory( TempDirectory&& ) = delete;
+
+        auto operator=( const TempDirectory& ) -> TempDirectory& = delete;
+
+        auto operator=( TempDirectory&& ) -> TempDirectory& = delete;
+
+        ~TempDirectory();
+
+        auto path() const -> const fs::path&;
+};
+
+/* A modification time in the past, with an even number of seconds,
+ * so that it is stored exactly even by the formats using the two seconds precision of DOS times (e.g., zip). */
+auto past_file_time() -> fs::file_time_type;
+
 #endif
 
 } // namespace filesystem